@@ -0,0 +1,86 @@
+package main
+
+import (
+	"bytes"
+	"encoding/binary"
+	"encoding/hex"
+	"time"
+
+	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
+
+	"github.com/bluenviron/mediamtx/internal/test"
+)
+
+// the send time is written in hexadecimal form, in order to prevent
+// the generation of start codes or emulation prevention bytes.
+const sendTimeSize = 16
+
+// filler byte that never generates start codes.
+const fillerByte = 0xAA
+
+// generateAccessUnit generates a H264 access unit that contains the send time.
+// Parameters are prepended to IDRs, like encoders usually do.
+func generateAccessUnit(frameSize int, idr bool, sendTime time.Time) [][]byte {
+	if frameSize < 1+sendTimeSize {
+		frameSize = 1 + sendTimeSize
+	}
+
+	frame := bytes.Repeat([]byte{fillerByte}, frameSize)
+
+	if idr {
+		frame[0] = 0x65
+	} else {
+		frame[0] = 0x41
+	}
+
+	var ts [8]byte
+	binary.BigEndian.PutUint64(ts[:], uint64(sendTime.UnixNano()))
+	hex.Encode(frame[1:], ts[:])
+
+	if idr {
+		return [][]byte{
+			test.FormatH264.SPS,
+			test.FormatH264.PPS,
+			frame,
+		}
+	}
+
+	return [][]byte{frame}
+}
+
+// accessUnitSendTime extracts the send time from an access unit generated by generateAccessUnit.
+func accessUnitSendTime(au [][]byte) (time.Time, bool) {
+	for _, nalu := range au {
+		if len(nalu) == 0 {
+			continue
+		}
+
+		typ := h264.NALUType(nalu[0] & 0x1F)
+		if typ != h264.NALUTypeIDR && typ != h264.NALUTypeNonIDR {
+			continue
+		}
+
+		if len(nalu) < 1+sendTimeSize {
+			return time.Time{}, false
+		}
+
+		var ts [8]byte
+		_, err := hex.Decode(ts[:], nalu[1:1+sendTimeSize])
+		if err != nil {
+			return time.Time{}, false
+		}
+
+		return time.Unix(0, int64(binary.BigEndian.Uint64(ts[:]))), true
+	}
+
+	return time.Time{}, false
+}
+
+// accessUnitSize returns the size of an access unit.
+func accessUnitSize(au [][]byte) uint64 {
+	n := uint64(0)
+	for _, nalu := range au {
+		n += uint64(len(nalu))
+	}
+	return n
+}
@@ -0,0 +1,28 @@
+package main
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestAccessUnitSendTime(t *testing.T) {
+	for _, ca := range []string{"idr", "non-idr"} {
+		t.Run(ca, func(t *testing.T) {
+			sendTime := time.Date(2024, 5, 6, 7, 8, 9, 123456789, time.UTC)
+
+			au := generateAccessUnit(100, ca == "idr", sendTime)
+			require.Equal(t, 100, len(au[len(au)-1]))
+
+			frame := au[len(au)-1]
+			for i := 0; i < len(frame)-1; i++ {
+				require.False(t, frame[i] == 0 && frame[i+1] == 0)
+			}
+
+			dec, ok := accessUnitSendTime(au)
+			require.True(t, ok)
+			require.True(t, sendTime.Equal(dec))
+		})
+	}
+}
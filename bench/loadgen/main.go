@@ -0,0 +1,202 @@
+// Load generator, that starts a server and measures its performance
+// with publishers and readers that run in the same process.
+package main
+
+import (
+	"context"
+	"fmt"
+	"os"
+	"runtime"
+	"strconv"
+	"sync"
+	"time"
+
+	"github.com/alecthomas/kong"
+
+	"github.com/bluenviron/mediamtx/internal/core"
+	"github.com/bluenviron/mediamtx/internal/profiler"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
+	"github.com/bluenviron/mediamtx/internal/test"
+)
+
+var cli struct {
+	Publishers      int           `help:"number of publishers. Each one publishes to a different path." default:"1"`
+	PublishProtocol string        `help:"protocol of publishers." enum:"rtsp-tcp,rtsp-udp,rtmp,srt,webrtc" default:"rtsp-tcp"` //nolint:lll
+	Readers         int           `help:"number of readers. They are distributed among paths." default:"50"`
+	ReadProtocol    string        `help:"protocol of readers." enum:"rtsp-tcp,rtsp-udp,rtmp,srt,hls,webrtc,relay" default:"rtsp-tcp"` //nolint:lll
+	FPS             int           `help:"frames per second of each publisher." default:"30"`
+	GOP             int           `help:"distance between key frames, in frames." default:"30"`
+	FrameSize       int           `help:"size of each frame, in bytes." default:"10000"`
+	Warmup          time.Duration `help:"time to wait before measuring." default:"5s"`
+	Duration        time.Duration `help:"measurement duration." default:"15s"`
+	JSON            bool          `help:"print the report in JSON format."`
+}
+
+func writeConf() (string, error) {
+	cnf := "logLevel: warn\n"
+
+	if cli.ReadProtocol == "relay" {
+		cnf += "relay: yes\n"
+	}
+
+	cnf += "paths:\n" +
+		"  all_others:\n"
+
+	return test.CreateTempFile([]byte(cnf))
+}
+
+func memStats() (uint64, uint64) {
+	var ms runtime.MemStats
+	runtime.ReadMemStats(&ms)
+	return ms.Mallocs, ms.TotalAlloc
+}
+
+func run() error {
+	if cli.Publishers < 1 {
+		return fmt.Errorf("at least one publisher is needed")
+	}
+	if cli.FPS < 1 || cli.GOP < 1 {
+		return fmt.Errorf("FPS and GOP must be greater than zero")
+	}
+
+	confPath, err := writeConf()
+	if err != nil {
+		return err
+	}
+	defer os.Remove(confPath)
+
+	s, ok := core.New([]string{confPath})
+	if !ok {
+		return fmt.Errorf("unable to start the server")
+	}
+	defer s.Close()
+
+	ctx, ctxCancel := context.WithCancel(context.Background())
+
+	var wg sync.WaitGroup
+	var readers []*reader
+
+	defer func() {
+		ctxCancel()
+		for _, r := range readers {
+			r.wait()
+		}
+		wg.Wait()
+	}()
+
+	publishers := make([]*publisher, cli.Publishers)
+
+	for i := range publishers {
+		p := &publisher{
+			protocol:  cli.PublishProtocol,
+			pathName:  "bench" + strconv.FormatInt(int64(i), 10),
+			fps:       cli.FPS,
+			gop:       cli.GOP,
+			frameSize: cli.FrameSize,
+		}
+		err = p.initialize(ctx)
+		if err != nil {
+			return fmt.Errorf("unable to start publisher %d: %w", i, err)
+		}
+		publishers[i] = p
+
+		wg.Add(1)
+		go func() {
+			defer wg.Done()
+			p.run(ctx)
+		}()
+	}
+
+	relayClients := &relay.ClientPool{
+		ReadTimeout:  readerTimeout,
+		WriteTimeout: readerTimeout,
+	}
+	relayClients.Initialize()
+
+	for i := 0; i < cli.Readers; i++ {
+		r := &reader{
+			protocol:     cli.ReadProtocol,
+			pathName:     publishers[i%len(publishers)].pathName,
+			relayClients: relayClients,
+		}
+		err = r.initialize()
+		if err != nil {
+			return err
+		}
+		readers = append(readers, r)
+
+		go r.run(ctx)
+	}
+
+	select {
+	case <-time.After(cli.Warmup):
+	case <-ctx.Done():
+	}
+
+	var unitsSent, writeErrors uint64
+	for _, p := range publishers {
+		units, errors := p.counters()
+		unitsSent -= units
+		writeErrors -= errors
+	}
+
+	for _, r := range readers {
+		r.startMeasuring()
+	}
+
+	allocsStart, allocBytesStart := memStats()
+	start := time.Now()
+
+	cpu, err := profiler.SampleCPU(ctx, cli.Duration)
+	if err != nil {
+		return err
+	}
+
+	duration := time.Since(start)
+	allocsEnd, allocBytesEnd := memStats()
+
+	stats := make([]readerStats, len(readers))
+	for i, r := range readers {
+		stats[i] = r.stopMeasuring()
+	}
+
+	for _, p := range publishers {
+		units, errors := p.counters()
+		unitsSent += units
+		writeErrors += errors
+	}
+
+	rep := &report{
+		PublishProtocol: cli.PublishProtocol,
+		ReadProtocol:    cli.ReadProtocol,
+		Publishers:      len(publishers),
+		Readers:         len(readers),
+		FrameSize:       cli.FrameSize,
+		FPS:             cli.FPS,
+		Duration:        duration.Seconds(),
+		UnitsSent:       unitsSent,
+		WriteErrors:     writeErrors,
+	}
+	rep.fillReaders(stats, duration)
+	rep.fillCPU(cpu)
+	rep.fillAllocs(allocsEnd-allocsStart, allocBytesEnd-allocBytesStart)
+
+	if cli.JSON {
+		return rep.writeJSON(os.Stdout)
+	}
+
+	rep.writeText(os.Stdout)
+	return nil
+}
+
+func main() {
+	kong.Parse(&cli,
+		kong.Description("Measures the performance of the server with in-process publishers and readers."),
+		kong.UsageOnError())
+
+	err := run()
+	if err != nil {
+		fmt.Fprintf(os.Stderr, "ERR: %s\n", err)
+		os.Exit(1)
+	}
+}
@@ -0,0 +1,352 @@
+package main
+
+import (
+	"bufio"
+	"context"
+	"fmt"
+	"net"
+	"net/http"
+	"net/url"
+	"sync/atomic"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4"
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/gortsplib/v4/pkg/format/rtph264"
+	"github.com/bluenviron/gortsplib/v4/pkg/rtptime"
+	"github.com/bluenviron/mediacommon/pkg/formats/mpegts"
+	srt "github.com/datarhei/gosrt"
+	"github.com/pion/rtp"
+
+	"github.com/bluenviron/mediamtx/internal/protocols/rtmp"
+	"github.com/bluenviron/mediamtx/internal/protocols/webrtc"
+	"github.com/bluenviron/mediamtx/internal/test"
+)
+
+const (
+	// maximum size of RTP payloads, compatible with both RTSP and WebRTC.
+	rtpPayloadMaxSize = 1188
+
+	// size of SRT payloads, that is 7 MPEG-TS packets.
+	srtPayloadSize = 1316
+)
+
+func newFormatH264() *format.H264 {
+	return &format.H264{
+		PayloadTyp:        96,
+		SPS:               test.FormatH264.SPS,
+		PPS:               test.FormatH264.PPS,
+		PacketizationMode: 1,
+	}
+}
+
+type publisherConn interface {
+	writeAccessUnit(au [][]byte, pts time.Duration, idr bool) error
+	close()
+}
+
+// rtpPacketizer converts access units into RTP packets.
+type rtpPacketizer struct {
+	encoder     *rtph264.Encoder
+	timeEncoder *rtptime.Encoder
+}
+
+func (p *rtpPacketizer) initialize(forma *format.H264) error {
+	p.encoder = &rtph264.Encoder{
+		PayloadMaxSize:    rtpPayloadMaxSize,
+		PayloadType:       forma.PayloadTyp,
+		PacketizationMode: forma.PacketizationMode,
+	}
+	err := p.encoder.Init()
+	if err != nil {
+		return err
+	}
+
+	p.timeEncoder = &rtptime.Encoder{
+		ClockRate: forma.ClockRate(),
+	}
+	return p.timeEncoder.Initialize()
+}
+
+func (p *rtpPacketizer) packetize(au [][]byte, pts time.Duration) ([]*rtp.Packet, error) {
+	pkts, err := p.encoder.Encode(au)
+	if err != nil {
+		return nil, err
+	}
+
+	ts := p.timeEncoder.Encode(pts)
+	for _, pkt := range pkts {
+		pkt.Timestamp += ts
+	}
+
+	return pkts, nil
+}
+
+type publisherConnRTSP struct {
+	client     *gortsplib.Client
+	media      *description.Media
+	packetizer rtpPacketizer
+}
+
+func newPublisherConnRTSP(pathName string, transport gortsplib.Transport) (publisherConn, error) {
+	forma := newFormatH264()
+
+	c := &publisherConnRTSP{
+		client: &gortsplib.Client{
+			Transport: &transport,
+		},
+		media: &description.Media{
+			Type:    description.MediaTypeVideo,
+			Formats: []format.Format{forma},
+		},
+	}
+
+	err := c.packetizer.initialize(forma)
+	if err != nil {
+		return nil, err
+	}
+
+	err = c.client.StartRecording("rtsp://localhost:8554/"+pathName,
+		&description.Session{Medias: []*description.Media{c.media}})
+	if err != nil {
+		return nil, err
+	}
+
+	return c, nil
+}
+
+func (c *publisherConnRTSP) writeAccessUnit(au [][]byte, pts time.Duration, _ bool) error {
+	pkts, err := c.packetizer.packetize(au, pts)
+	if err != nil {
+		return err
+	}
+
+	for _, pkt := range pkts {
+		err = c.client.WritePacketRTP(c.media, pkt)
+		if err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+func (c *publisherConnRTSP) close() {
+	c.client.Close()
+}
+
+type publisherConnRTMP struct {
+	nconn net.Conn
+	w     *rtmp.Writer
+}
+
+func newPublisherConnRTMP(pathName string) (publisherConn, error) {
+	u, err := url.Parse("rtmp://localhost:1935/" + pathName)
+	if err != nil {
+		return nil, err
+	}
+
+	nconn, err := net.Dial("tcp", u.Host)
+	if err != nil {
+		return nil, err
+	}
+
+	conn, err := rtmp.NewClientConn(nconn, u, true)
+	if err != nil {
+		nconn.Close()
+		return nil, err
+	}
+
+	w, err := rtmp.NewWriter(conn, newFormatH264(), nil)
+	if err != nil {
+		nconn.Close()
+		return nil, err
+	}
+
+	return &publisherConnRTMP{
+		nconn: nconn,
+		w:     w,
+	}, nil
+}
+
+func (c *publisherConnRTMP) writeAccessUnit(au [][]byte, pts time.Duration, idr bool) error {
+	return c.w.WriteH264(pts, pts, idr, au)
+}
+
+func (c *publisherConnRTMP) close() {
+	c.nconn.Close()
+}
+
+type publisherConnSRT struct {
+	conn  srt.Conn
+	bw    *bufio.Writer
+	track *mpegts.Track
+	w     *mpegts.Writer
+}
+
+func newPublisherConnSRT(pathName string) (publisherConn, error) {
+	srtConf := srt.DefaultConfig()
+	srtConf.StreamId = "publish:" + pathName
+
+	conn, err := srt.Dial("srt", "localhost:8890", srtConf)
+	if err != nil {
+		return nil, err
+	}
+
+	c := &publisherConnSRT{
+		conn: conn,
+		bw:   bufio.NewWriterSize(conn, srtPayloadSize),
+		track: &mpegts.Track{
+			Codec: &mpegts.CodecH264{},
+		},
+	}
+
+	c.w = mpegts.NewWriter(c.bw, []*mpegts.Track{c.track})
+
+	return c, nil
+}
+
+func (c *publisherConnSRT) writeAccessUnit(au [][]byte, pts time.Duration, idr bool) error {
+	ts := int64(pts) * 90000 / int64(time.Second)
+
+	err := c.w.WriteH264(c.track, ts, ts, idr, au)
+	if err != nil {
+		return err
+	}
+
+	return c.bw.Flush()
+}
+
+func (c *publisherConnSRT) close() {
+	c.conn.Close()
+}
+
+type publisherConnWebRTC struct {
+	client     *webrtc.WHIPClient
+	track      *webrtc.OutgoingTrack
+	packetizer rtpPacketizer
+}
+
+func newPublisherConnWebRTC(ctx context.Context, pathName string) (publisherConn, error) {
+	u, err := url.Parse("http://localhost:8889/" + pathName + "/whip")
+	if err != nil {
+		return nil, err
+	}
+
+	forma := newFormatH264()
+
+	c := &publisherConnWebRTC{
+		client: &webrtc.WHIPClient{
+			HTTPClient: &http.Client{},
+			URL:        u,
+			Log:        test.NilLogger,
+		},
+	}
+
+	err = c.packetizer.initialize(forma)
+	if err != nil {
+		return nil, err
+	}
+
+	tracks, err := c.client.Publish(ctx, forma, nil)
+	if err != nil {
+		return nil, err
+	}
+	c.track = tracks[0]
+
+	return c, nil
+}
+
+func (c *publisherConnWebRTC) writeAccessUnit(au [][]byte, pts time.Duration, _ bool) error {
+	pkts, err := c.packetizer.packetize(au, pts)
+	if err != nil {
+		return err
+	}
+
+	for _, pkt := range pkts {
+		err = c.track.WriteRTP(pkt)
+		if err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+func (c *publisherConnWebRTC) close() {
+	c.client.Close() //nolint:errcheck
+}
+
+// publisher publishes a synthetic H264 stream to a path, at a fixed frame rate.
+type publisher struct {
+	protocol  string
+	pathName  string
+	fps       int
+	gop       int
+	frameSize int
+
+	conn        publisherConn
+	unitsSent   *uint64
+	writeErrors *uint64
+}
+
+func (p *publisher) initialize(ctx context.Context) error {
+	p.unitsSent = new(uint64)
+	p.writeErrors = new(uint64)
+
+	var err error
+
+	switch p.protocol {
+	case "rtsp-tcp":
+		p.conn, err = newPublisherConnRTSP(p.pathName, gortsplib.TransportTCP)
+
+	case "rtsp-udp":
+		p.conn, err = newPublisherConnRTSP(p.pathName, gortsplib.TransportUDP)
+
+	case "rtmp":
+		p.conn, err = newPublisherConnRTMP(p.pathName)
+
+	case "srt":
+		p.conn, err = newPublisherConnSRT(p.pathName)
+
+	case "webrtc":
+		p.conn, err = newPublisherConnWebRTC(ctx, p.pathName)
+
+	default:
+		err = fmt.Errorf("unsupported publish protocol: %s", p.protocol)
+	}
+
+	return err
+}
+
+func (p *publisher) run(ctx context.Context) {
+	defer p.conn.close()
+
+	frameDuration := time.Second / time.Duration(p.fps)
+	ticker := time.NewTicker(frameDuration)
+	defer ticker.Stop()
+
+	for i := 0; ; i++ {
+		idr := (i%p.gop == 0)
+		au := generateAccessUnit(p.frameSize, idr, time.Now())
+
+		err := p.conn.writeAccessUnit(au, time.Duration(i)*frameDuration, idr)
+		if err != nil {
+			atomic.AddUint64(p.writeErrors, 1)
+		} else {
+			atomic.AddUint64(p.unitsSent, 1)
+		}
+
+		select {
+		case <-ticker.C:
+		case <-ctx.Done():
+			return
+		}
+	}
+}
+
+// counters returns the number of units that have been sent and the number of write errors.
+func (p *publisher) counters() (uint64, uint64) {
+	return atomic.LoadUint64(p.unitsSent), atomic.LoadUint64(p.writeErrors)
+}
@@ -0,0 +1,243 @@
+package main
+
+import (
+	"context"
+	"fmt"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
+	hlssource "github.com/bluenviron/mediamtx/internal/staticsources/hls"
+	relaysource "github.com/bluenviron/mediamtx/internal/staticsources/relay"
+	rtmpsource "github.com/bluenviron/mediamtx/internal/staticsources/rtmp"
+	rtspsource "github.com/bluenviron/mediamtx/internal/staticsources/rtsp"
+	srtsource "github.com/bluenviron/mediamtx/internal/staticsources/srt"
+	webrtcsource "github.com/bluenviron/mediamtx/internal/staticsources/webrtc"
+	"github.com/bluenviron/mediamtx/internal/stream"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+const (
+	readerTimeout   = 10 * time.Second
+	readerQueueSize = 512
+)
+
+// reader reads a path with the client of a static source and measures what it receives.
+type reader struct {
+	protocol     string
+	pathName     string
+	relayClients *relay.ClientPool
+
+	source defs.StaticSource
+	conf   *conf.Path
+	url    string
+	done   chan struct{}
+
+	mutex     sync.Mutex
+	stream    *stream.Stream
+	writer    *asyncwriter.Writer
+	measuring bool
+	units     uint64
+	bytes     uint64
+	latencies []time.Duration
+	errors    uint64
+}
+
+func (r *reader) initialize() error {
+	r.conf = &conf.Path{}
+	r.done = make(chan struct{})
+
+	switch r.protocol {
+	case "rtsp-tcp", "rtsp-udp":
+		transport := gortsplib.TransportTCP
+		if r.protocol == "rtsp-udp" {
+			transport = gortsplib.TransportUDP
+		}
+		r.conf.RTSPTransport = conf.RTSPTransport{Transport: &transport}
+
+		r.url = "rtsp://localhost:8554/" + r.pathName
+		r.source = &rtspsource.Source{
+			ReadTimeout:    conf.StringDuration(readerTimeout),
+			WriteTimeout:   conf.StringDuration(readerTimeout),
+			WriteQueueSize: readerQueueSize,
+			Parent:         r,
+		}
+
+	case "rtmp":
+		r.url = "rtmp://localhost:1935/" + r.pathName
+		r.source = &rtmpsource.Source{
+			ReadTimeout:  conf.StringDuration(readerTimeout),
+			WriteTimeout: conf.StringDuration(readerTimeout),
+			Parent:       r,
+		}
+
+	case "srt":
+		r.url = "srt://localhost:8890?streamid=read:" + r.pathName
+		r.source = &srtsource.Source{
+			ReadTimeout: conf.StringDuration(readerTimeout),
+			Parent:      r,
+		}
+
+	case "hls":
+		r.url = "http://localhost:8888/" + r.pathName + "/index.m3u8"
+		r.source = &hlssource.Source{
+			ReadTimeout: conf.StringDuration(readerTimeout),
+			Parent:      r,
+		}
+
+	case "webrtc":
+		r.url = "whep://localhost:8889/" + r.pathName + "/whep"
+		r.source = &webrtcsource.Source{
+			ReadTimeout: conf.StringDuration(readerTimeout),
+			Parent:      r,
+		}
+
+	case "relay":
+		r.url = "relay://localhost:8891/" + r.pathName
+		r.source = &relaysource.Source{
+			ReadTimeout: conf.StringDuration(readerTimeout),
+			Clients:     r.relayClients,
+			Parent:      r,
+		}
+
+	default:
+		return fmt.Errorf("unsupported read protocol: %s", r.protocol)
+	}
+
+	return nil
+}
+
+func (r *reader) run(ctx context.Context) {
+	defer close(r.done)
+
+	for {
+		r.source.Run(defs.StaticSourceRunParams{ //nolint:errcheck
+			Context:        ctx,
+			ResolvedSource: r.url,
+			Conf:           r.conf,
+		})
+
+		select {
+		case <-time.After(time.Second):
+		case <-ctx.Done():
+			return
+		}
+	}
+}
+
+// Log implements defs.StaticSourceParent.
+func (r *reader) Log(_ logger.Level, _ string, _ ...interface{}) {
+}
+
+// SetReady implements defs.StaticSourceParent.
+func (r *reader) SetReady(req defs.PathSourceStaticSetReadyReq) defs.PathSourceStaticSetReadyRes {
+	var forma *format.H264
+	medi := req.Desc.FindFormat(&forma)
+	if medi == nil {
+		return defs.PathSourceStaticSetReadyRes{Err: fmt.Errorf("H264 track not found")}
+	}
+
+	strm, err := stream.New(
+		1460,
+		req.Desc,
+		req.GenerateRTPPackets,
+		r,
+	)
+	if err != nil {
+		return defs.PathSourceStaticSetReadyRes{Err: err}
+	}
+
+	writer := asyncwriter.New(readerQueueSize, r)
+
+	strm.AddReader(writer, medi, forma, func(u unit.Unit) error {
+		r.onUnit(u.(*unit.H264))
+		return nil
+	})
+	writer.Start()
+
+	r.mutex.Lock()
+	r.stream = strm
+	r.writer = writer
+	r.mutex.Unlock()
+
+	return defs.PathSourceStaticSetReadyRes{
+		Stream: strm,
+	}
+}
+
+// SetNotReady implements defs.StaticSourceParent.
+func (r *reader) SetNotReady(_ defs.PathSourceStaticSetNotReadyReq) {
+	r.mutex.Lock()
+	strm, writer := r.stream, r.writer
+	r.stream, r.writer = nil, nil
+	r.mutex.Unlock()
+
+	if strm != nil {
+		strm.RemoveReader(writer)
+		writer.Stop()
+		strm.Close()
+	}
+}
+
+func (r *reader) onUnit(u *unit.H264) {
+	if u.AU == nil {
+		return
+	}
+
+	now := time.Now()
+	sendTime, ok := accessUnitSendTime(u.AU)
+
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	if !r.measuring {
+		return
+	}
+
+	r.units++
+	r.bytes += accessUnitSize(u.AU)
+
+	if ok {
+		r.latencies = append(r.latencies, now.Sub(sendTime))
+	} else {
+		r.errors++
+	}
+}
+
+// startMeasuring discards what has been received during the warmup.
+func (r *reader) startMeasuring() {
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	r.measuring = true
+	r.units = 0
+	r.bytes = 0
+	r.latencies = nil
+	r.errors = 0
+}
+
+func (r *reader) stopMeasuring() readerStats {
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	r.measuring = false
+
+	return readerStats{
+		units:     r.units,
+		bytes:     r.bytes,
+		latencies: r.latencies,
+		errors:    r.errors,
+	}
+}
+
+func (r *reader) wait() {
+	<-r.done
+	r.SetNotReady(defs.PathSourceStaticSetNotReadyReq{})
+}
@@ -0,0 +1,176 @@
+package main
+
+import (
+	"encoding/json"
+	"fmt"
+	"io"
+	"sort"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/profiler"
+)
+
+type readerStats struct {
+	units     uint64
+	bytes     uint64
+	latencies []time.Duration
+	errors    uint64
+}
+
+type reportLatency struct {
+	P50 float64 `json:"p50Ms"`
+	P90 float64 `json:"p90Ms"`
+	P99 float64 `json:"p99Ms"`
+	Max float64 `json:"maxMs"`
+}
+
+type reportCPU struct {
+	// CPU time of the whole process, load generator included.
+	Total float64 `json:"totalSeconds"`
+	// CPU time of goroutines of the server, grouped by role.
+	Roles map[string]float64 `json:"roles"`
+	// CPU time of server goroutines that serve readers, divided by readers.
+	PerReader float64 `json:"perReaderMs"`
+}
+
+type reportAllocs struct {
+	// allocations of the whole process, load generator included.
+	Count uint64 `json:"count"`
+	Bytes uint64 `json:"bytes"`
+	// allocations divided by readers.
+	PerReader      uint64 `json:"perReader"`
+	BytesPerReader uint64 `json:"bytesPerReader"`
+}
+
+type report struct {
+	PublishProtocol string        `json:"publishProtocol"`
+	ReadProtocol    string        `json:"readProtocol"`
+	Publishers      int           `json:"publishers"`
+	Readers         int           `json:"readers"`
+	ReadersActive   int           `json:"readersActive"`
+	FrameSize       int           `json:"frameSize"`
+	FPS             int           `json:"fps"`
+	Duration        float64       `json:"durationSeconds"`
+	UnitsSent       uint64        `json:"unitsSent"`
+	UnitsReceived   uint64        `json:"unitsReceived"`
+	UnitsPerSecond  float64       `json:"unitsPerSecond"`
+	BytesPerSecond  float64       `json:"bytesPerSecond"`
+	WriteErrors     uint64        `json:"writeErrors"`
+	InvalidUnits    uint64        `json:"invalidUnits"`
+	Latency         reportLatency `json:"latency"`
+	CPU             reportCPU     `json:"cpu"`
+	Allocs          reportAllocs  `json:"allocs"`
+}
+
+func durationMs(d time.Duration) float64 {
+	return float64(d) / float64(time.Millisecond)
+}
+
+// percentile returns the p-th percentile of sorted values, with the nearest-rank method.
+func percentile(sorted []time.Duration, p float64) time.Duration {
+	if len(sorted) == 0 {
+		return 0
+	}
+
+	i := int(float64(len(sorted))*p/100+0.5) - 1
+	if i < 0 {
+		i = 0
+	} else if i >= len(sorted) {
+		i = len(sorted) - 1
+	}
+
+	return sorted[i]
+}
+
+func (r *report) fillReaders(stats []readerStats, duration time.Duration) {
+	var latencies []time.Duration
+	var bytes uint64
+
+	for _, s := range stats {
+		if s.units != 0 {
+			r.ReadersActive++
+		}
+		r.UnitsReceived += s.units
+		r.InvalidUnits += s.errors
+		bytes += s.bytes
+		latencies = append(latencies, s.latencies...)
+	}
+
+	r.UnitsPerSecond = float64(r.UnitsReceived) / duration.Seconds()
+	r.BytesPerSecond = float64(bytes) / duration.Seconds()
+
+	sort.Slice(latencies, func(i, j int) bool {
+		return latencies[i] < latencies[j]
+	})
+
+	r.Latency = reportLatency{
+		P50: durationMs(percentile(latencies, 50)),
+		P90: durationMs(percentile(latencies, 90)),
+		P99: durationMs(percentile(latencies, 99)),
+		Max: durationMs(percentile(latencies, 100)),
+	}
+}
+
+func (r *report) fillCPU(cpu *profiler.CPUBreakdown) {
+	r.CPU.Total = cpu.Total.Seconds()
+	r.CPU.Roles = make(map[string]float64)
+
+	var readersCPU time.Duration
+
+	for labels, d := range cpu.Items {
+		if labels.Role == "" {
+			continue
+		}
+
+		r.CPU.Roles[labels.Role] += d.Seconds()
+
+		if labels.Role == "reader" || labels.Role == "muxer" {
+			readersCPU += d
+		}
+	}
+
+	if r.Readers != 0 {
+		r.CPU.PerReader = durationMs(readersCPU / time.Duration(r.Readers))
+	}
+}
+
+func (r *report) fillAllocs(count uint64, bytes uint64) {
+	r.Allocs.Count = count
+	r.Allocs.Bytes = bytes
+
+	if r.Readers != 0 {
+		r.Allocs.PerReader = count / uint64(r.Readers)
+		r.Allocs.BytesPerReader = bytes / uint64(r.Readers)
+	}
+}
+
+func (r *report) writeJSON(w io.Writer) error {
+	enc := json.NewEncoder(w)
+	enc.SetIndent("", "  ")
+	return enc.Encode(r)
+}
+
+func (r *report) writeText(w io.Writer) {
+	fmt.Fprintf(w, "publishers:       %d (%s)\n", r.Publishers, r.PublishProtocol)
+	fmt.Fprintf(w, "readers:          %d (%s), %d active\n", r.Readers, r.ReadProtocol, r.ReadersActive)
+	fmt.Fprintf(w, "duration:         %.1fs\n", r.Duration)
+	fmt.Fprintf(w, "units sent:       %d (%d write errors)\n", r.UnitsSent, r.WriteErrors)
+	fmt.Fprintf(w, "units received:   %d (%d invalid)\n", r.UnitsReceived, r.InvalidUnits)
+	fmt.Fprintf(w, "throughput:       %.1f units/s, %.1f MB/s\n", r.UnitsPerSecond, r.BytesPerSecond/1e6)
+	fmt.Fprintf(w, "latency:          p50 %.2fms, p90 %.2fms, p99 %.2fms, max %.2fms\n",
+		r.Latency.P50, r.Latency.P90, r.Latency.P99, r.Latency.Max)
+	fmt.Fprintf(w, "CPU:              %.2fs total, %.2fms per reader\n", r.CPU.Total, r.CPU.PerReader)
+
+	roles := make([]string, 0, len(r.CPU.Roles))
+	for role := range r.CPU.Roles {
+		roles = append(roles, role)
+	}
+	sort.Strings(roles)
+
+	for _, role := range roles {
+		fmt.Fprintf(w, "  %-16s%.2fs\n", role+":", r.CPU.Roles[role])
+	}
+
+	fmt.Fprintf(w, "allocs:           %d (%d bytes), %d per reader (%d bytes)\n",
+		r.Allocs.Count, r.Allocs.Bytes, r.Allocs.PerReader, r.Allocs.BytesPerReader)
+}
@@ -0,0 +1,21 @@
+package main
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestPercentile(t *testing.T) {
+	var values []time.Duration
+	for i := 1; i <= 100; i++ {
+		values = append(values, time.Duration(i)*time.Millisecond)
+	}
+
+	require.Equal(t, time.Duration(0), percentile(nil, 50))
+	require.Equal(t, 50*time.Millisecond, percentile(values, 50))
+	require.Equal(t, 99*time.Millisecond, percentile(values, 99))
+	require.Equal(t, 100*time.Millisecond, percentile(values, 100))
+	require.Equal(t, time.Millisecond, percentile(values, 0))
+}
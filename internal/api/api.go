@@ -2,6 +2,7 @@
 package api
 
 import (
+	"context"
 	"encoding/json"
 	"errors"
 	"fmt"
@@ -10,6 +11,7 @@ import (
 	"os"
 	"reflect"
 	"sort"
+	"strconv"
 	"strings"
 	"sync"
 	"time"
@@ -21,6 +23,7 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 	"github.com/bluenviron/mediamtx/internal/protocols/httpp"
 	"github.com/bluenviron/mediamtx/internal/record"
 	"github.com/bluenviron/mediamtx/internal/restrictnetwork"
@@ -31,6 +34,10 @@ import (
 	"github.com/bluenviron/mediamtx/internal/servers/webrtc"
 )
 
+const (
+	maxCPUSamplingDuration = 60 * time.Second
+)
+
 func interfaceIsEmpty(i interface{}) bool {
 	return reflect.ValueOf(i).Kind() != reflect.Ptr || reflect.ValueOf(i).IsNil()
 }
@@ -60,6 +67,8 @@ func paramName(ctx *gin.Context) (string, bool) {
 type PathManager interface {
 	APIPathsList() (*defs.APIPathList, error)
 	APIPathsGet(string) (*defs.APIPath, error)
+	APIPathsEvents(queueSize int, bytesPeriod time.Duration) (defs.APIPathEventSubscription, error)
+	APIStaticSourceUpstreams() *defs.APIStaticSourceUpstreams
 }
 
 // HLSServer contains methods used by the API and Metrics server.
@@ -96,6 +105,7 @@ type WebRTCServer interface {
 	APISessionsList() (*defs.APIWebRTCSessionList, error)
 	APISessionsGet(uuid.UUID) (*defs.APIWebRTCSession, error)
 	APISessionsKick(uuid.UUID) error
+	APISessionSetupTimes() *defs.APIHistogram
 }
 
 type apiAuthManager interface {
@@ -105,6 +115,7 @@ type apiAuthManager interface {
 type apiParent interface {
 	logger.Writer
 	APIConfigSet(conf *conf.Conf)
+	APIStartupTimeline() *defs.APIStartupTimeline
 }
 
 // API is an API server.
@@ -128,12 +139,16 @@ type API struct {
 	SRTServer      SRTServer
 	Parent         apiParent
 
+	ctx        context.Context
+	ctxCancel  func()
 	httpServer *httpp.WrappedServer
 	mutex      sync.RWMutex
 }
 
 // Initialize initializes API.
 func (a *API) Initialize() error {
+	a.ctx, a.ctxCancel = context.WithCancel(context.Background())
+
 	router := gin.New()
 	router.SetTrustedProxies(a.TrustedProxies.ToTrustedProxies()) //nolint:errcheck
 
@@ -155,6 +170,10 @@ func (a *API) Initialize() error {
 
 	group.GET("/v3/paths/list", a.onPathsList)
 	group.GET("/v3/paths/get/*name", a.onPathsGet)
+	group.GET("/v3/paths/events", a.onPathsEvents)
+	group.GET("/v3/paths/cpu", a.onPathsCPU)
+
+	group.GET("/v3/startup/get", a.onStartupGet)
 
 	if !interfaceIsEmpty(a.HLSServer) {
 		group.GET("/v3/hlsmuxers/list", a.onHLSMuxersList)
@@ -219,6 +238,7 @@ func (a *API) Initialize() error {
 	}
 	err := a.httpServer.Initialize()
 	if err != nil {
+		a.ctxCancel()
 		return err
 	}
 
@@ -230,12 +250,13 @@ func (a *API) Initialize() error {
 // Close closes the API.
 func (a *API) Close() {
 	a.Log(logger.Info, "listener is closing")
+	a.ctxCancel()
 	a.httpServer.Close()
 }
 
 // Log implements logger.Writer.
 func (a *API) Log(level logger.Level, format string, args ...interface{}) {
-	a.Parent.Log(level, "[API] "+format, args...)
+	a.Parent.Log(level, format, logger.WithField(logger.Module("API"), args)...)
 }
 
 func (a *API) writeError(ctx *gin.Context, status int, err error) {
@@ -548,6 +569,10 @@ func (a *API) onConfigPathsDelete(ctx *gin.Context) {
 	ctx.Status(http.StatusOK)
 }
 
+func (a *API) onStartupGet(ctx *gin.Context) {
+	ctx.JSON(http.StatusOK, a.Parent.APIStartupTimeline())
+}
+
 func (a *API) onPathsList(ctx *gin.Context) {
 	data, err := a.PathManager.APIPathsList()
 	if err != nil {
@@ -586,6 +611,150 @@ func (a *API) onPathsGet(ctx *gin.Context) {
 	ctx.JSON(http.StatusOK, data)
 }
 
+func (a *API) onPathsCPU(ctx *gin.Context) {
+	duration := 5 * time.Second
+	if v := ctx.Query("duration"); v != "" {
+		var err error
+		duration, err = time.ParseDuration(v)
+		if err != nil || duration <= 0 || duration > maxCPUSamplingDuration {
+			a.writeError(ctx, http.StatusBadRequest, fmt.Errorf("invalid duration"))
+			return
+		}
+	}
+
+	b, err := profiler.SampleCPU(ctx.Request.Context(), duration)
+	if err != nil {
+		a.writeError(ctx, http.StatusInternalServerError, err)
+		return
+	}
+
+	data := &defs.APIPathCPUBreakdown{
+		Duration: duration.Seconds(),
+		CPUTime:  b.Total.Seconds(),
+		Items:    []*defs.APIPathCPU{},
+	}
+
+	paths := make(map[string]*defs.APIPathCPU)
+
+	for l, d := range b.Items {
+		if l.Path == "" {
+			data.UnattributedCPUTime += d.Seconds()
+			continue
+		}
+
+		item, ok := paths[l.Path]
+		if !ok {
+			item = &defs.APIPathCPU{Name: l.Path}
+			paths[l.Path] = item
+			data.Items = append(data.Items, item)
+		}
+
+		item.CPUTime += d.Seconds()
+		item.Entries = append(item.Entries, defs.APIPathCPUEntry{
+			Role:     l.Role,
+			Protocol: l.Protocol,
+			CPUTime:  d.Seconds(),
+		})
+	}
+
+	sort.Slice(data.Items, func(i, j int) bool {
+		return data.Items[i].CPUTime > data.Items[j].CPUTime
+	})
+
+	for _, item := range data.Items {
+		sort.Slice(item.Entries, func(i, j int) bool {
+			return item.Entries[i].CPUTime > item.Entries[j].CPUTime
+		})
+	}
+
+	ctx.JSON(http.StatusOK, data)
+}
+
+func (a *API) onPathsEvents(ctx *gin.Context) {
+	bytesPeriod := 10 * time.Second
+	if v := ctx.Query("bytesPeriod"); v != "" {
+		var err error
+		bytesPeriod, err = time.ParseDuration(v)
+		if err != nil || bytesPeriod < 0 {
+			a.writeError(ctx, http.StatusBadRequest, fmt.Errorf("invalid bytesPeriod"))
+			return
+		}
+	}
+
+	queueSize := 0
+	if v := ctx.Query("queueSize"); v != "" {
+		tmp, err := strconv.ParseUint(v, 10, 31)
+		if err != nil {
+			a.writeError(ctx, http.StatusBadRequest, fmt.Errorf("invalid queueSize"))
+			return
+		}
+		queueSize = int(tmp)
+	}
+
+	sub, err := a.PathManager.APIPathsEvents(queueSize, bytesPeriod)
+	if err != nil {
+		a.writeError(ctx, http.StatusInternalServerError, err)
+		return
+	}
+	defer sub.Close()
+
+	ctx.Writer.Header().Set("Content-Type", "text/event-stream")
+	ctx.Writer.Header().Set("Cache-Control", "no-cache")
+	ctx.Writer.WriteHeader(http.StatusOK)
+	ctx.Writer.Flush()
+
+	writeDropped := func() error {
+		dropped := sub.Dropped()
+		if dropped == 0 {
+			return nil
+		}
+
+		return writePathEvent(ctx.Writer, &defs.APIPathEvent{
+			Type:    defs.APIPathEventTypeOverflow,
+			Time:    time.Now(),
+			Dropped: &dropped,
+		})
+	}
+
+	for {
+		select {
+		case evt := <-sub.Events():
+			err = writePathEvent(ctx.Writer, evt)
+			if err == nil {
+				err = writeDropped()
+			}
+
+		case <-sub.Done():
+			return
+
+		case <-ctx.Request.Context().Done():
+			return
+
+		case <-a.ctx.Done():
+			return
+		}
+
+		if err != nil {
+			return
+		}
+	}
+}
+
+func writePathEvent(w gin.ResponseWriter, evt *defs.APIPathEvent) error {
+	byts, err := json.Marshal(evt)
+	if err != nil {
+		return err
+	}
+
+	_, err = w.Write([]byte("event: " + string(evt.Type) + "\ndata: " + string(byts) + "\n\n"))
+	if err != nil {
+		return err
+	}
+
+	w.Flush()
+	return nil
+}
+
 func (a *API) onRTSPConnsList(ctx *gin.Context) {
 	data, err := a.RTSPServer.APIConnsList()
 	if err != nil {
@@ -13,6 +13,7 @@ import (
 
 	"github.com/bluenviron/mediamtx/internal/auth"
 	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
 	"github.com/bluenviron/mediamtx/internal/test"
 	"github.com/stretchr/testify/require"
@@ -25,6 +26,10 @@ func (testParent) Log(_ logger.Level, _ string, _ ...interface{}) {
 
 func (testParent) APIConfigSet(_ *conf.Conf) {}
 
+func (testParent) APIStartupTimeline() *defs.APIStartupTimeline {
+	return &defs.APIStartupTimeline{}
+}
+
 func tempConf(t *testing.T, cnt string) *conf.Conf {
 	fi, err := test.CreateTempFile([]byte(cnt))
 	require.NoError(t, err)
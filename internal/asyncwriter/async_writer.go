@@ -3,16 +3,49 @@ package asyncwriter
 
 import (
 	"fmt"
+	"sync"
+	"sync/atomic"
+	"time"
 
 	"github.com/bluenviron/gortsplib/v4/pkg/ringbuffer"
 
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 )
 
+// QueueDelayBuckets are the recommended buckets of histograms passed to SetQueueDelay().
+var QueueDelayBuckets = []time.Duration{
+	1 * time.Millisecond,
+	5 * time.Millisecond,
+	10 * time.Millisecond,
+	50 * time.Millisecond,
+	100 * time.Millisecond,
+	500 * time.Millisecond,
+	1 * time.Second,
+	5 * time.Second,
+}
+
+// one every queueDelaySampleRate elements carries the time it has been pushed,
+// in order to avoid reading the clock for every element.
+const queueDelaySampleRate = 32
+
+// DelayObserver receives durations.
+type DelayObserver interface {
+	Observe(time.Duration)
+}
+
 // Writer is an asynchronous writer.
 type Writer struct {
 	writeErrLogger logger.Writer
 	buffer         *ringbuffer.RingBuffer
+	budget         *membudget.Budget
+	queueDelay     DelayObserver
+	queuedBytes    *uint64
+	pushCount      *uint64
+
+	// elements pushed after Stop() are discarded, since nobody would pull them.
+	closedMutex sync.RWMutex
+	closed      bool
 
 	// out
 	err chan error
@@ -28,19 +61,45 @@ func New(
 	return &Writer{
 		writeErrLogger: logger.NewLimitedLogger(parent),
 		buffer:         buffer,
+		queuedBytes:    new(uint64),
+		pushCount:      new(uint64),
 		err:            make(chan error),
 	}
 }
 
 // Start starts the writer routine.
 func (w *Writer) Start() {
+	w.budget.AddCounter(membudget.SubsystemReaderQueues, w.queuedBytes)
 	go w.run()
 }
 
+// SetMemoryBudget sets a memory budget that accounts for bytes of elements
+// pushed with PushSized().
+// Bytes are counted by the writer and are summed by the budget only when it is read.
+// It must be called before Start().
+func (w *Writer) SetMemoryBudget(b *membudget.Budget) {
+	w.budget = b
+}
+
+// SetQueueDelay sets an observer of the time between the moment an element is pushed
+// and the moment its callback has been completed.
+// Only one element every queueDelaySampleRate is observed.
+// It must be called before Start().
+func (w *Writer) SetQueueDelay(o DelayObserver) {
+	w.queueDelay = o
+}
+
 // Stop stops the writer routine.
 func (w *Writer) Stop() {
+	w.closedMutex.Lock()
+	w.closed = true
+	w.closedMutex.Unlock()
+
 	w.buffer.Close()
 	<-w.err
+
+	// this also releases elements that have not been pulled
+	w.budget.RemoveCounter(membudget.SubsystemReaderQueues, w.queuedBytes)
 }
 
 // Error returns whenever there's an error.
@@ -55,22 +114,118 @@ func (w *Writer) run() {
 
 func (w *Writer) runInner() error {
 	for {
-		cb, ok := w.buffer.Pull()
+		el, ok := w.buffer.Pull()
 		if !ok {
 			return fmt.Errorf("terminated")
 		}
 
-		err := cb.(func() error)()
+		if e, ok := el.(*element); ok {
+			err := e.run(w)
+			if err != nil {
+				return err
+			}
+			continue
+		}
+
+		err := el.(func() error)()
 		if err != nil {
 			return err
 		}
 	}
 }
 
+// element is an element that holds bytes or carries the time it has been pushed.
+// Elements are pooled, since they would be otherwise allocated for every unit of every reader.
+type element struct {
+	cb       func() error
+	size     uint64
+	pushTime time.Time
+}
+
+var elementPool = sync.Pool{
+	New: func() interface{} {
+		return &element{}
+	},
+}
+
+func (e *element) run(w *Writer) error {
+	if e.size != 0 {
+		w.release(e.size)
+	}
+
+	err := e.cb()
+
+	if !e.pushTime.IsZero() {
+		w.queueDelay.Observe(time.Since(e.pushTime))
+	}
+
+	*e = element{}
+	elementPool.Put(e)
+
+	return err
+}
+
+func (w *Writer) push(cb func() error, size uint64) bool {
+	var pushTime time.Time
+	if w.queueDelay != nil && atomic.AddUint64(w.pushCount, 1)%queueDelaySampleRate == 1 {
+		pushTime = time.Now()
+	}
+
+	if size == 0 && pushTime.IsZero() {
+		return w.buffer.Push(cb)
+	}
+
+	e := elementPool.Get().(*element)
+	e.cb = cb
+	e.size = size
+	e.pushTime = pushTime
+
+	ok := w.buffer.Push(e)
+	if !ok {
+		*e = element{}
+		elementPool.Put(e)
+	}
+	return ok
+}
+
 // Push appends an element to the queue.
 func (w *Writer) Push(cb func() error) {
-	ok := w.buffer.Push(cb)
+	w.closedMutex.RLock()
+	defer w.closedMutex.RUnlock()
+
+	if w.closed {
+		return
+	}
+
+	ok := w.push(cb, 0)
 	if !ok {
 		w.writeErrLogger.Log(logger.Warn, "write queue is full")
 	}
 }
+
+// PushSized appends an element that holds the given amount of bytes to the queue.
+func (w *Writer) PushSized(size uint64, cb func() error) {
+	if w.budget == nil {
+		w.Push(cb)
+		return
+	}
+
+	w.closedMutex.RLock()
+	defer w.closedMutex.RUnlock()
+
+	if w.closed {
+		return
+	}
+
+	atomic.AddUint64(w.queuedBytes, size)
+
+	ok := w.push(cb, size)
+	if !ok {
+		w.release(size)
+		w.writeErrLogger.Log(logger.Warn, "write queue is full")
+	}
+}
+
+func (w *Writer) release(size uint64) {
+	atomic.AddUint64(w.queuedBytes, ^(size - 1))
+}
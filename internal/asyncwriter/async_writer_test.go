@@ -3,8 +3,11 @@ package asyncwriter
 import (
 	"fmt"
 	"testing"
+	"time"
 
 	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/membudget"
 )
 
 func TestAsyncWriter(t *testing.T) {
@@ -20,3 +23,76 @@ func TestAsyncWriter(t *testing.T) {
 	err := <-w.Error()
 	require.EqualError(t, err, "testerror")
 }
+
+type delayObserver chan time.Duration
+
+func (o delayObserver) Observe(d time.Duration) {
+	o <- d
+}
+
+func TestAsyncWriterQueueDelay(t *testing.T) {
+	o := make(delayObserver, 1)
+
+	w := New(512, nil)
+	w.SetQueueDelay(o)
+
+	w.Start()
+	defer w.Stop()
+
+	w.Push(func() error {
+		time.Sleep(50 * time.Millisecond)
+		return nil
+	})
+
+	d := <-o
+	require.GreaterOrEqual(t, d, 50*time.Millisecond)
+}
+
+func TestAsyncWriterQueueDelaySampling(t *testing.T) {
+	o := make(delayObserver, 4)
+
+	w := New(512, nil)
+	w.SetQueueDelay(o)
+
+	w.Start()
+
+	for i := 0; i < 2*queueDelaySampleRate; i++ {
+		w.Push(func() error {
+			return nil
+		})
+	}
+
+	done := make(chan struct{})
+	w.Push(func() error {
+		close(done)
+		return nil
+	})
+	<-done
+
+	w.Stop()
+
+	require.Equal(t, 3, len(o))
+}
+
+func TestAsyncWriterMemoryBudget(t *testing.T) {
+	budget := &membudget.Budget{}
+	budget.Initialize()
+
+	for i := 0; i < 100; i++ {
+		w := New(512, nil)
+		w.SetMemoryBudget(budget)
+		w.Start()
+
+		w.PushSized(100, func() error {
+			return nil
+		})
+
+		w.Stop()
+
+		w.PushSized(100, func() error {
+			return nil
+		})
+	}
+
+	require.Equal(t, uint64(0), budget.Used(membudget.SubsystemReaderQueues))
+}
@@ -41,6 +41,7 @@ const (
 	ProtocolHLS    Protocol = "hls"
 	ProtocolWebRTC Protocol = "webrtc"
 	ProtocolSRT    Protocol = "srt"
+	ProtocolRelay  Protocol = "relay"
 )
 
 // Request is an authentication request.
@@ -9,8 +9,10 @@ import (
 	"net"
 	"os"
 	"reflect"
+	"runtime"
 	"sort"
 	"strings"
+	"sync"
 	"time"
 
 	"github.com/bluenviron/gohlslib"
@@ -161,11 +163,15 @@ type Conf struct {
 	LogLevel            LogLevel        `json:"logLevel"`
 	LogDestinations     LogDestinations `json:"logDestinations"`
 	LogFile             string          `json:"logFile"`
+	LogStructured       bool            `json:"logStructured"`
 	ReadTimeout         StringDuration  `json:"readTimeout"`
 	WriteTimeout        StringDuration  `json:"writeTimeout"`
 	ReadBufferCount     *int            `json:"readBufferCount,omitempty"` // deprecated
 	WriteQueueSize      int             `json:"writeQueueSize"`
 	UDPMaxPayloadSize   int             `json:"udpMaxPayloadSize"`
+	SourceMaxConnecting int             `json:"sourceMaxConnecting"`
+	MemoryBudget        StringSize      `json:"memoryBudget"`
+	MemoryBudgetDegrade bool            `json:"memoryBudgetDegrade"`
 	RunOnConnect        string          `json:"runOnConnect"`
 	RunOnConnectRestart bool            `json:"runOnConnectRestart"`
 	RunOnDisconnect     string          `json:"runOnDisconnect"`
@@ -275,6 +281,7 @@ type Conf struct {
 	WebRTCICEServers2           WebRTCICEServers `json:"webrtcICEServers2"`
 	WebRTCHandshakeTimeout      StringDuration   `json:"webrtcHandshakeTimeout"`
 	WebRTCTrackGatherTimeout    StringDuration   `json:"webrtcTrackGatherTimeout"`
+	WebRTCAudioTranscoding      bool             `json:"webrtcAudioTranscoding"`
 	WebRTCICEUDPMuxAddress      *string          `json:"webrtcICEUDPMuxAddress,omitempty"`  // deprecated
 	WebRTCICETCPMuxAddress      *string          `json:"webrtcICETCPMuxAddress,omitempty"`  // deprecated
 	WebRTCICEHostNAT1To1IPs     *[]string        `json:"webrtcICEHostNAT1To1IPs,omitempty"` // deprecated
@@ -284,6 +291,10 @@ type Conf struct {
 	SRT        bool   `json:"srt"`
 	SRTAddress string `json:"srtAddress"`
 
+	// Relay server
+	Relay        bool   `json:"relay"`
+	RelayAddress string `json:"relayAddress"`
+
 	// Record (deprecated)
 	Record                *bool           `json:"record,omitempty"`                // deprecated
 	RecordPath            *string         `json:"recordPath,omitempty"`            // deprecated
@@ -404,6 +415,10 @@ func (conf *Conf) setDefaults() {
 	conf.SRT = true
 	conf.SRTAddress = ":8890"
 
+	// Relay server
+	conf.Relay = false
+	conf.RelayAddress = ":8891"
+
 	conf.PathDefaults.setDefaults()
 }
 
@@ -502,6 +517,9 @@ func (conf *Conf) Validate() error {
 	if conf.UDPMaxPayloadSize > 1472 {
 		return fmt.Errorf("'udpMaxPayloadSize' must be less than 1472")
 	}
+	if conf.SourceMaxConnecting < 0 {
+		return fmt.Errorf("'sourceMaxConnecting' must be greater or equal than zero")
+	}
 
 	// Authentication
 	if conf.ExternalAuthenticationURL != nil {
@@ -682,9 +700,11 @@ func (conf *Conf) Validate() error {
 		}
 	}
 
-	conf.Paths = make(map[string]*Path)
+	names := sortedKeys(conf.OptionalPaths)
+	pconfs := make([]*Path, len(names))
+	conf.Paths = make(map[string]*Path, len(names))
 
-	for _, name := range sortedKeys(conf.OptionalPaths) {
+	for i, name := range names {
 		optional := conf.OptionalPaths[name]
 		if optional == nil {
 			optional = &OptionalPath{
@@ -693,15 +713,76 @@ func (conf *Conf) Validate() error {
 			conf.OptionalPaths[name] = optional
 		}
 
-		pconf := newPath(&conf.PathDefaults, optional)
-		conf.Paths[name] = pconf
+		pconfs[i] = newPath(&conf.PathDefaults, optional)
+		conf.Paths[name] = pconfs[i]
+	}
 
-		err := pconf.validate(conf, name, deprecatedCredentialsMode)
+	// deprecated credentials are appended to the global configuration,
+	// therefore they must be processed in order.
+	if deprecatedCredentialsMode {
+		for i, name := range names {
+			err := pconfs[i].validate(conf, name, deprecatedCredentialsMode)
+			if err != nil {
+				return err
+			}
+		}
+	} else {
+		err := validatePathsInParallel(conf, names, pconfs)
 		if err != nil {
 			return err
 		}
 	}
 
+	return checkRPICameraIDs(names, pconfs)
+}
+
+// validatePathsInParallel validates paths and compiles their regular expressions
+// with a worker per CPU. The returned error is the one of the first failing path
+// in alphabetical order, like in a serial validation.
+func validatePathsInParallel(conf *Conf, names []string, pconfs []*Path) error {
+	errs := make([]error, len(names))
+
+	workerCount := runtime.GOMAXPROCS(0)
+	if workerCount > len(names) {
+		workerCount = len(names)
+	}
+
+	var wg sync.WaitGroup
+	wg.Add(workerCount)
+
+	for w := 0; w < workerCount; w++ {
+		go func(w int) {
+			defer wg.Done()
+			for i := w; i < len(names); i += workerCount {
+				errs[i] = pconfs[i].validate(conf, names[i], false)
+			}
+		}(w)
+	}
+
+	wg.Wait()
+
+	for _, err := range errs {
+		if err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+func checkRPICameraIDs(names []string, pconfs []*Path) error {
+	camIDs := make(map[int]string)
+
+	for i, name := range names {
+		if pconfs[i].Source == "rpiCamera" {
+			if otherName, ok := camIDs[pconfs[i].RPICameraCamID]; ok {
+				return fmt.Errorf("'rpiCamera' with same camera ID %d is used as source in two paths, '%s' and '%s'",
+					pconfs[i].RPICameraCamID, name, otherName)
+			}
+			camIDs[pconfs[i].RPICameraCamID] = name
+		}
+	}
+
 	return nil
 }
 
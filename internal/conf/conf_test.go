@@ -52,6 +52,12 @@ func TestConfFromFile(t *testing.T) {
 			Source:                     "publisher",
 			SourceOnDemandStartTimeout: 10 * StringDuration(time.Second),
 			SourceOnDemandCloseAfter:   10 * StringDuration(time.Second),
+			SourceRetryMinPause:        1 * StringDuration(time.Second),
+			SourceRetryMaxPause:        30 * StringDuration(time.Second),
+			SourceRetryJitter:          0.5,
+			SourceAlternates:           []string{},
+			RTPJitterBufferMinDelay:    20 * StringDuration(time.Millisecond),
+			RTPJitterBufferMaxDelay:    1 * StringDuration(time.Second),
 			RecordPath:                 "./recordings/%path/%Y-%m-%d_%H-%M-%S-%f",
 			RecordFormat:               RecordFormatFMP4,
 			RecordPartDuration:         StringDuration(1 * time.Second),
@@ -304,6 +310,14 @@ func TestConfErrors(t *testing.T) {
 				"    source: publisher\n",
 			"invalid path name '': cannot be empty",
 		},
+		{
+			"invalid source share connection",
+			"paths:\n" +
+				"  cam1:\n" +
+				"    source: publisher\n" +
+				"    sourceShareConnection: yes\n",
+			"'sourceShareConnection' can only be used when source is an URL",
+		},
 		{
 			"double raspberry pi camera",
 			"paths:\n" +
@@ -313,6 +327,21 @@ func TestConfErrors(t *testing.T) {
 				"    source: rpiCamera\n",
 			"'rpiCamera' with same camera ID 0 is used as source in two paths, 'cam2' and 'cam1'",
 		},
+		{
+			"invalid rpi camera output fps",
+			"paths:\n" +
+				"  mypath:\n" +
+				"    rpiCameraFPS: 30\n" +
+				"    rpiCameraOutputFPS: 60\n",
+			`invalid 'rpiCameraOutputFPS' value`,
+		},
+		{
+			"invalid rpi camera image overlays",
+			"paths:\n" +
+				"  mypath:\n" +
+				"    rpiCameraImageOverlays: 2,0,/logo.png\n",
+			`invalid 'rpiCameraImageOverlays': coordinates of overlay '2,0,/logo.png' must be between 0 and 1`,
+		},
 		{
 			"invalid srt publish passphrase",
 			"paths:\n" +
@@ -7,6 +7,7 @@ import (
 	gourl "net/url"
 	"reflect"
 	"regexp"
+	"strconv"
 	"strings"
 	"time"
 
@@ -45,6 +46,29 @@ func srtCheckPassphrase(passphrase string) error {
 	}
 }
 
+func rpiCameraCheckImageOverlays(overlays string) error {
+	items := strings.Split(overlays, ";")
+	if len(items) > 4 {
+		return fmt.Errorf("at most 4 overlays are supported")
+	}
+
+	for _, item := range items {
+		parts := strings.SplitN(item, ",", 3)
+		if len(parts) != 3 || parts[2] == "" {
+			return fmt.Errorf("overlay '%s' is not in format x,y,path", item)
+		}
+
+		for _, part := range parts[:2] {
+			v, err := strconv.ParseFloat(strings.TrimSpace(part), 64)
+			if err != nil || v < 0 || v > 1 {
+				return fmt.Errorf("coordinates of overlay '%s' must be between 0 and 1", item)
+			}
+		}
+	}
+
+	return nil
+}
+
 // FindPathConf returns the configuration corresponding to the given path name.
 func FindPathConf(pathConfs map[string]*Path, name string) (string, *Path, []string, error) {
 	err := isValidPathName(name)
@@ -80,6 +104,86 @@ func FindPathConf(pathConfs map[string]*Path, name string) (string, *Path, []str
 	return "", nil, nil, fmt.Errorf("path '%s' is not configured", name)
 }
 
+func validateSourceURL(source string) error {
+	switch {
+	case strings.HasPrefix(source, "rtsp://") ||
+		strings.HasPrefix(source, "rtsps://"):
+		_, err := base.ParseURL(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+
+	case strings.HasPrefix(source, "rtmp://") ||
+		strings.HasPrefix(source, "rtmps://"):
+		u, err := gourl.Parse(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+
+		if u.User != nil {
+			pass, _ := u.User.Password()
+			user := u.User.Username()
+			if user != "" && pass == "" ||
+				user == "" && pass != "" {
+				return fmt.Errorf("username and password must be both provided")
+			}
+		}
+
+	case strings.HasPrefix(source, "http://") ||
+		strings.HasPrefix(source, "https://"):
+		u, err := gourl.Parse(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+		if u.Scheme != "http" && u.Scheme != "https" {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+
+		if u.User != nil {
+			pass, _ := u.User.Password()
+			user := u.User.Username()
+			if user != "" && pass == "" ||
+				user == "" && pass != "" {
+				return fmt.Errorf("username and password must be both provided")
+			}
+		}
+
+	case strings.HasPrefix(source, "udp://"):
+		_, _, err := net.SplitHostPort(source[len("udp://"):])
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid UDP URL", source)
+		}
+
+	case strings.HasPrefix(source, "srt://"):
+
+		_, err := gourl.Parse(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+
+	case strings.HasPrefix(source, "whep://") ||
+		strings.HasPrefix(source, "wheps://"):
+		_, err := gourl.Parse(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+
+	case strings.HasPrefix(source, "relay://"):
+		u, err := gourl.Parse(source)
+		if err != nil {
+			return fmt.Errorf("'%s' is not a valid URL", source)
+		}
+		if u.Host == "" {
+			return fmt.Errorf("'%s' does not contain a host", source)
+		}
+
+	default:
+		return fmt.Errorf("invalid source: '%s'", source)
+	}
+
+	return nil
+}
+
 // Path is a path configuration.
 // WARNING: Avoid using slices directly due to https://github.com/golang/go/issues/21092
 type Path struct {
@@ -92,6 +196,14 @@ type Path struct {
 	SourceOnDemand             bool           `json:"sourceOnDemand"`
 	SourceOnDemandStartTimeout StringDuration `json:"sourceOnDemandStartTimeout"`
 	SourceOnDemandCloseAfter   StringDuration `json:"sourceOnDemandCloseAfter"`
+	SourceRetryMinPause        StringDuration `json:"sourceRetryMinPause"`
+	SourceRetryMaxPause        StringDuration `json:"sourceRetryMaxPause"`
+	SourceRetryJitter          float64        `json:"sourceRetryJitter"`
+	SourceAlternates           []string       `json:"sourceAlternates"`
+	SourceShareConnection      bool           `json:"sourceShareConnection"`
+	RTPJitterBuffer            bool           `json:"rtpJitterBuffer"`
+	RTPJitterBufferMinDelay    StringDuration `json:"rtpJitterBufferMinDelay"`
+	RTPJitterBufferMaxDelay    StringDuration `json:"rtpJitterBufferMaxDelay"`
 	MaxReaders                 int            `json:"maxReaders"`
 	SRTReadPassphrase          string         `json:"srtReadPassphrase"`
 	Fallback                   string         `json:"fallback"`
@@ -131,6 +243,7 @@ type Path struct {
 
 	// Raspberry Pi Camera source
 	RPICameraCamID             int       `json:"rpiCameraCamID"`
+	RPICameraDetached          bool      `json:"rpiCameraDetached"`
 	RPICameraWidth             int       `json:"rpiCameraWidth"`
 	RPICameraHeight            int       `json:"rpiCameraHeight"`
 	RPICameraHFlip             bool      `json:"rpiCameraHFlip"`
@@ -148,11 +261,14 @@ type Path struct {
 	RPICameraGain              float64   `json:"rpiCameraGain"`
 	RPICameraEV                float64   `json:"rpiCameraEV"`
 	RPICameraROI               string    `json:"rpiCameraROI"`
+	RPICameraROITransition     int       `json:"rpiCameraROITransition"`
 	RPICameraHDR               bool      `json:"rpiCameraHDR"`
 	RPICameraTuningFile        string    `json:"rpiCameraTuningFile"`
 	RPICameraMode              string    `json:"rpiCameraMode"`
 	RPICameraFPS               float64   `json:"rpiCameraFPS"`
+	RPICameraOutputFPS         float64   `json:"rpiCameraOutputFPS"`
 	RPICameraIDRPeriod         int       `json:"rpiCameraIDRPeriod"`
+	RPICameraIntraRefresh      int       `json:"rpiCameraIntraRefresh"`
 	RPICameraBitrate           int       `json:"rpiCameraBitrate"`
 	RPICameraProfile           string    `json:"rpiCameraProfile"`
 	RPICameraLevel             string    `json:"rpiCameraLevel"`
@@ -163,6 +279,7 @@ type Path struct {
 	RPICameraAfWindow          string    `json:"rpiCameraAfWindow"`
 	RPICameraTextOverlayEnable bool      `json:"rpiCameraTextOverlayEnable"`
 	RPICameraTextOverlay       string    `json:"rpiCameraTextOverlay"`
+	RPICameraImageOverlays     string    `json:"rpiCameraImageOverlays"`
 
 	// Hooks
 	RunOnInit                  string         `json:"runOnInit"`
@@ -187,6 +304,12 @@ func (pconf *Path) setDefaults() {
 	pconf.Source = "publisher"
 	pconf.SourceOnDemandStartTimeout = 10 * StringDuration(time.Second)
 	pconf.SourceOnDemandCloseAfter = 10 * StringDuration(time.Second)
+	pconf.SourceRetryMinPause = 1 * StringDuration(time.Second)
+	pconf.SourceRetryMaxPause = 30 * StringDuration(time.Second)
+	pconf.SourceRetryJitter = 0.5
+	pconf.SourceAlternates = []string{}
+	pconf.RTPJitterBufferMinDelay = 20 * StringDuration(time.Millisecond)
+	pconf.RTPJitterBufferMaxDelay = 1 * StringDuration(time.Second)
 
 	// Record
 	pconf.RecordPath = "./recordings/%path/%Y-%m-%d_%H-%M-%S-%f"
@@ -284,80 +407,49 @@ func (pconf *Path) validate(
 	switch {
 	case pconf.Source == "publisher":
 
-	case strings.HasPrefix(pconf.Source, "rtsp://") ||
-		strings.HasPrefix(pconf.Source, "rtsps://"):
-		_, err := base.ParseURL(pconf.Source)
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-
-	case strings.HasPrefix(pconf.Source, "rtmp://") ||
-		strings.HasPrefix(pconf.Source, "rtmps://"):
-		u, err := gourl.Parse(pconf.Source)
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-
-		if u.User != nil {
-			pass, _ := u.User.Password()
-			user := u.User.Username()
-			if user != "" && pass == "" ||
-				user == "" && pass != "" {
-				return fmt.Errorf("username and password must be both provided")
-			}
-		}
-
-	case strings.HasPrefix(pconf.Source, "http://") ||
-		strings.HasPrefix(pconf.Source, "https://"):
-		u, err := gourl.Parse(pconf.Source)
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-		if u.Scheme != "http" && u.Scheme != "https" {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-
-		if u.User != nil {
-			pass, _ := u.User.Password()
-			user := u.User.Username()
-			if user != "" && pass == "" ||
-				user == "" && pass != "" {
-				return fmt.Errorf("username and password must be both provided")
-			}
-		}
-
-	case strings.HasPrefix(pconf.Source, "udp://"):
-		_, _, err := net.SplitHostPort(pconf.Source[len("udp://"):])
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid UDP URL", pconf.Source)
-		}
-
-	case strings.HasPrefix(pconf.Source, "srt://"):
-
-		_, err := gourl.Parse(pconf.Source)
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-
-	case strings.HasPrefix(pconf.Source, "whep://") ||
-		strings.HasPrefix(pconf.Source, "wheps://"):
-		_, err := gourl.Parse(pconf.Source)
-		if err != nil {
-			return fmt.Errorf("'%s' is not a valid URL", pconf.Source)
-		}
-
 	case pconf.Source == "redirect":
 
 	case pconf.Source == "rpiCamera":
 
 	default:
-		return fmt.Errorf("invalid source: '%s'", pconf.Source)
+		err := validateSourceURL(pconf.Source)
+		if err != nil {
+			return err
+		}
 	}
 	if pconf.SourceOnDemand {
 		if pconf.Source == "publisher" {
 			return fmt.Errorf("'sourceOnDemand' is useless when source is 'publisher'")
 		}
 	}
+	if len(pconf.SourceAlternates) != 0 {
+		if !pconf.HasStaticSource() || pconf.Source == "rpiCamera" {
+			return fmt.Errorf("'sourceAlternates' can only be used when source is an URL")
+		}
+		for _, alt := range pconf.SourceAlternates {
+			err := validateSourceURL(alt)
+			if err != nil {
+				return err
+			}
+		}
+	}
+	if pconf.SourceShareConnection {
+		if !pconf.HasStaticSource() || pconf.Source == "rpiCamera" {
+			return fmt.Errorf("'sourceShareConnection' can only be used when source is an URL")
+		}
+		if len(pconf.SourceAlternates) != 0 {
+			return fmt.Errorf("'sourceShareConnection' can't be used together with 'sourceAlternates'")
+		}
+	}
+	if pconf.RTPJitterBufferMinDelay > pconf.RTPJitterBufferMaxDelay {
+		return fmt.Errorf("'rtpJitterBufferMinDelay' must be less or equal than 'rtpJitterBufferMaxDelay'")
+	}
+	if pconf.SourceRetryMinPause > pconf.SourceRetryMaxPause {
+		return fmt.Errorf("'sourceRetryMinPause' must be less or equal than 'sourceRetryMaxPause'")
+	}
+	if pconf.SourceRetryJitter < 0 || pconf.SourceRetryJitter > 1 {
+		return fmt.Errorf("'sourceRetryJitter' must be between 0 and 1")
+	}
 	if pconf.SRTReadPassphrase != "" {
 		err := srtCheckPassphrase(pconf.SRTReadPassphrase)
 		if err != nil {
@@ -502,15 +594,6 @@ func (pconf *Path) validate(
 
 	// Raspberry Pi Camera source
 
-	if pconf.Source == "rpiCamera" {
-		for otherName, otherPath := range conf.Paths {
-			if otherPath != pconf && otherPath != nil &&
-				otherPath.Source == "rpiCamera" && otherPath.RPICameraCamID == pconf.RPICameraCamID {
-				return fmt.Errorf("'rpiCamera' with same camera ID %d is used as source in two paths, '%s' and '%s'",
-					pconf.RPICameraCamID, name, otherName)
-			}
-		}
-	}
 	switch pconf.RPICameraExposure {
 	case "normal", "short", "long", "custom":
 	default:
@@ -549,6 +632,21 @@ func (pconf *Path) validate(
 	default:
 		return fmt.Errorf("invalid 'rpiCameraAfSpeed' value")
 	}
+	if pconf.RPICameraOutputFPS < 0 || (pconf.RPICameraFPS > 0 && pconf.RPICameraOutputFPS > pconf.RPICameraFPS) {
+		return fmt.Errorf("invalid 'rpiCameraOutputFPS' value")
+	}
+	if pconf.RPICameraROITransition < 0 {
+		return fmt.Errorf("invalid 'rpiCameraROITransition' value")
+	}
+	if pconf.RPICameraIntraRefresh < 0 {
+		return fmt.Errorf("invalid 'rpiCameraIntraRefresh' value")
+	}
+	if pconf.RPICameraImageOverlays != "" {
+		err := rpiCameraCheckImageOverlays(pconf.RPICameraImageOverlays)
+		if err != nil {
+			return fmt.Errorf("invalid 'rpiCameraImageOverlays': %w", err)
+		}
+	}
 
 	// Hooks
 
@@ -580,6 +678,7 @@ func (pconf Path) HasStaticSource() bool {
 		strings.HasPrefix(pconf.Source, "srt://") ||
 		strings.HasPrefix(pconf.Source, "whep://") ||
 		strings.HasPrefix(pconf.Source, "wheps://") ||
+		strings.HasPrefix(pconf.Source, "relay://") ||
 		pconf.Source == "rpiCamera"
 }
 
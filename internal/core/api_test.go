@@ -12,6 +12,7 @@ import (
 	"net/http"
 	"net/url"
 	"os"
+	"strings"
 	"testing"
 	"time"
 
@@ -340,6 +341,160 @@ func TestAPIPathsGet(t *testing.T) {
 	}
 }
 
+func TestAPIPathsEvents(t *testing.T) {
+	p, ok := newInstance("api: yes\n" +
+		"paths:\n" +
+		"  mypath:\n")
+	require.Equal(t, true, ok)
+	defer p.Close()
+
+	tr := &http.Transport{}
+	defer tr.CloseIdleConnections()
+	hc := &http.Client{Transport: tr}
+
+	res, err := hc.Get("http://localhost:9997/v3/paths/events?bytesPeriod=0s")
+	require.NoError(t, err)
+	defer res.Body.Close()
+
+	require.Equal(t, http.StatusOK, res.StatusCode)
+	require.Equal(t, "text/event-stream", res.Header.Get("Content-Type"))
+
+	source := gortsplib.Client{}
+	err = source.StartRecording(
+		"rtsp://localhost:8554/mypath",
+		&description.Session{Medias: []*description.Media{test.UniqueMediaH264()}})
+	require.NoError(t, err)
+
+	type event struct {
+		Type   string   `json:"type"`
+		Path   string   `json:"path"`
+		Tracks []string `json:"tracks"`
+	}
+
+	br := bufio.NewReader(res.Body)
+
+	readEvent := func() event {
+		var evt event
+		for {
+			line, err2 := br.ReadString('\n')
+			require.NoError(t, err2)
+
+			if strings.HasPrefix(line, "data: ") {
+				err2 = json.Unmarshal([]byte(line[len("data: "):]), &evt)
+				require.NoError(t, err2)
+			} else if line == "\n" {
+				return evt
+			}
+		}
+	}
+
+	require.Equal(t, event{Type: "publisherAdded", Path: "mypath"}, readEvent())
+	require.Equal(t, event{Type: "ready", Path: "mypath", Tracks: []string{"H264"}}, readEvent())
+
+	source.Close()
+
+	require.Equal(t, event{Type: "notReady", Path: "mypath"}, readEvent())
+	require.Equal(t, event{Type: "publisherRemoved", Path: "mypath"}, readEvent())
+}
+
+func TestAPIPathsEventsBytes(t *testing.T) {
+	p, ok := newInstance("api: yes\n" +
+		"paths:\n" +
+		"  mypath:\n")
+	require.Equal(t, true, ok)
+	defer p.Close()
+
+	medi := test.UniqueMediaH264()
+
+	source := gortsplib.Client{}
+	err := source.StartRecording(
+		"rtsp://localhost:8554/mypath",
+		&description.Session{Medias: []*description.Media{medi}})
+	require.NoError(t, err)
+	defer source.Close()
+
+	err = source.WritePacketRTP(medi, &rtp.Packet{
+		Header: rtp.Header{
+			Version:        2,
+			Marker:         true,
+			PayloadType:    96,
+			SequenceNumber: 123,
+			Timestamp:      45343,
+			SSRC:           563423,
+		},
+		Payload: []byte{5, 1, 2, 3, 4},
+	})
+	require.NoError(t, err)
+
+	tr := &http.Transport{}
+	defer tr.CloseIdleConnections()
+	hc := &http.Client{Transport: tr}
+
+	type event struct {
+		Type          string `json:"type"`
+		Path          string `json:"path"`
+		BytesReceived uint64 `json:"bytesReceived"`
+	}
+
+	// subscribers with the same period share the same byte counters.
+	for i := 0; i < 2; i++ {
+		res, err2 := hc.Get("http://localhost:9997/v3/paths/events?bytesPeriod=100ms")
+		require.NoError(t, err2)
+		defer res.Body.Close()
+
+		require.Equal(t, http.StatusOK, res.StatusCode)
+
+		br := bufio.NewReader(res.Body)
+
+		for {
+			line, err2 := br.ReadString('\n')
+			require.NoError(t, err2)
+
+			if strings.HasPrefix(line, "data: ") {
+				var evt event
+				err2 = json.Unmarshal([]byte(line[len("data: "):]), &evt)
+				require.NoError(t, err2)
+
+				require.Equal(t, "bytes", evt.Type)
+				require.Equal(t, "mypath", evt.Path)
+
+				if evt.BytesReceived != 0 {
+					break
+				}
+			}
+		}
+	}
+}
+
+func TestAPIStartupGet(t *testing.T) {
+	p, ok := newInstance("api: yes\n" +
+		"paths:\n" +
+		"  mypath:\n")
+	require.Equal(t, true, ok)
+	defer p.Close()
+
+	tr := &http.Transport{}
+	defer tr.CloseIdleConnections()
+	hc := &http.Client{Transport: tr}
+
+	var out struct {
+		Duration float64 `json:"duration"`
+		Phases   []struct {
+			Name string `json:"name"`
+		} `json:"phases"`
+	}
+	httpRequest(t, hc, http.MethodGet, "http://localhost:9997/v3/startup/get", nil, &out)
+
+	names := make([]string, len(out.Phases))
+	for i, phase := range out.Phases {
+		names[i] = phase.Name
+	}
+
+	require.Equal(t, []string{"configuration", "logger", "pathManager"}, names[:3])
+	require.Contains(t, names, "api")
+	require.Greater(t, out.Duration, float64(0))
+}
+
 func TestAPIProtocolListGet(t *testing.T) {
 	serverCertFpath, err := test.CreateTempFile(test.TLSCertPub)
 	require.NoError(t, err)
@@ -10,6 +10,7 @@ import (
 	"reflect"
 	"sort"
 	"strings"
+	"sync"
 	"time"
 
 	"github.com/alecthomas/kong"
@@ -20,14 +21,17 @@ import (
 	"github.com/bluenviron/mediamtx/internal/auth"
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/confwatcher"
+	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/metrics"
 	"github.com/bluenviron/mediamtx/internal/playback"
 	"github.com/bluenviron/mediamtx/internal/pprof"
 	"github.com/bluenviron/mediamtx/internal/record"
 	"github.com/bluenviron/mediamtx/internal/rlimit"
 	"github.com/bluenviron/mediamtx/internal/servers/hls"
+	"github.com/bluenviron/mediamtx/internal/servers/relay"
 	"github.com/bluenviron/mediamtx/internal/servers/rtmp"
 	"github.com/bluenviron/mediamtx/internal/servers/rtsp"
 	"github.com/bluenviron/mediamtx/internal/servers/srt"
@@ -88,8 +92,10 @@ type Core struct {
 	confPath        string
 	conf            *conf.Conf
 	logger          *logger.Logger
+	loggerMutex     sync.RWMutex
 	externalCmdPool *externalcmd.Pool
 	authManager     *auth.Manager
+	memoryBudget    *membudget.Budget
 	metrics         *metrics.Metrics
 	pprof           *pprof.PPROF
 	recordCleaner   *record.Cleaner
@@ -102,8 +108,10 @@ type Core struct {
 	hlsServer       *hls.Server
 	webRTCServer    *webrtc.Server
 	srtServer       *srt.Server
+	relayServer     *relay.Server
 	api             *api.API
 	confWatcher     *confwatcher.ConfWatcher
+	startupTimeline *startupTimeline
 
 	// in
 	chAPIConfigSet chan *conf.Conf
@@ -141,18 +149,23 @@ func New(args []string) (*Core, bool) {
 	ctx, ctxCancel := context.WithCancel(context.Background())
 
 	p := &Core{
-		ctx:            ctx,
-		ctxCancel:      ctxCancel,
-		chAPIConfigSet: make(chan *conf.Conf),
-		done:           make(chan struct{}),
+		ctx:             ctx,
+		ctxCancel:       ctxCancel,
+		chAPIConfigSet:  make(chan *conf.Conf),
+		startupTimeline: &startupTimeline{},
+		done:            make(chan struct{}),
 	}
 
+	p.startupTimeline.initialize()
+
 	p.conf, p.confPath, err = conf.Load(cli.Confpath, defaultConfPaths)
 	if err != nil {
 		fmt.Printf("ERR: %s\n", err)
 		return nil, false
 	}
 
+	p.startupTimeline.mark("configuration")
+
 	err = p.createResources(true)
 	if err != nil {
 		if p.logger != nil {
@@ -164,6 +177,8 @@ func New(args []string) (*Core, bool) {
 		return nil, false
 	}
 
+	p.Log(logger.Info, "startup completed in %v", p.startupTimeline.finish())
+
 	go p.run()
 
 	return p, true
@@ -182,7 +197,12 @@ func (p *Core) Wait() {
 
 // Log implements logger.Writer.
 func (p *Core) Log(level logger.Level, format string, args ...interface{}) {
-	p.logger.Log(level, format, args...)
+	p.loggerMutex.RLock()
+	defer p.loggerMutex.RUnlock()
+
+	if p.logger != nil {
+		p.logger.Log(level, format, args...)
+	}
 }
 
 func (p *Core) run() {
@@ -204,12 +224,16 @@ outer:
 		case <-confChanged:
 			p.Log(logger.Info, "reloading configuration (file changed)")
 
+			start := time.Now()
+
 			newConf, _, err := conf.Load(p.confPath, nil)
 			if err != nil {
 				p.Log(logger.Error, "%s", err)
 				break outer
 			}
 
+			p.Log(logger.Debug, "configuration loaded in %v", time.Since(start))
+
 			err = p.reloadConf(newConf, false)
 			if err != nil {
 				p.Log(logger.Error, "%s", err)
@@ -243,14 +267,16 @@ func (p *Core) createResources(initial bool) error {
 	var err error
 
 	if p.logger == nil {
-		p.logger, err = logger.New(
-			logger.Level(p.conf.LogLevel),
-			p.conf.LogDestinations,
-			p.conf.LogFile,
-		)
+		var l *logger.Logger
+		l, err = p.newLogger(p.conf)
 		if err != nil {
 			return err
 		}
+
+		p.loggerMutex.Lock()
+		p.logger = l
+		p.loggerMutex.Unlock()
+		p.startupTimeline.mark("logger")
 	}
 
 	if initial {
@@ -280,6 +306,14 @@ func (p *Core) createResources(initial bool) error {
 		p.externalCmdPool = externalcmd.NewPool()
 	}
 
+	if p.memoryBudget == nil {
+		p.memoryBudget = &membudget.Budget{}
+		p.memoryBudget.Initialize()
+	}
+
+	// the budget is kept across reloads, in order to preserve accounting.
+	p.memoryBudget.SetLimit(uint64(p.conf.MemoryBudget), p.conf.MemoryBudgetDegrade)
+
 	if p.authManager == nil {
 		p.authManager = &auth.Manager{
 			Method:          p.conf.AuthMethod,
@@ -303,6 +337,7 @@ func (p *Core) createResources(initial bool) error {
 			TrustedProxies: p.conf.MetricsTrustedProxies,
 			ReadTimeout:    p.conf.ReadTimeout,
 			AuthManager:    p.authManager,
+			MemoryBudget:   p.memoryBudget,
 			Parent:         p,
 		}
 		err = i.Initialize()
@@ -310,6 +345,10 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.metrics = i
+		p.startupTimeline.mark("metrics")
+
+		// metrics may be recreated while other resources are kept running
+		p.setMetricsResources()
 	}
 
 	if p.conf.PPROF &&
@@ -330,6 +369,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.pprof = i
+		p.startupTimeline.mark("pprof")
 	}
 
 	cleanerEntries := gatherCleanerEntries(p.conf.Paths)
@@ -340,6 +380,7 @@ func (p *Core) createResources(initial bool) error {
 			Parent:  p,
 		}
 		p.recordCleaner.Initialize()
+		p.startupTimeline.mark("recordCleaner")
 	}
 
 	if p.conf.Playback &&
@@ -361,6 +402,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.playbackServer = i
+		p.startupTimeline.mark("playbackServer")
 	}
 
 	if p.pathManager == nil {
@@ -372,11 +414,14 @@ func (p *Core) createResources(initial bool) error {
 			writeTimeout:      p.conf.WriteTimeout,
 			writeQueueSize:    p.conf.WriteQueueSize,
 			udpMaxPayloadSize: p.conf.UDPMaxPayloadSize,
+			maxConnecting:     p.conf.SourceMaxConnecting,
+			memoryBudget:      p.memoryBudget,
 			pathConfs:         p.conf.Paths,
 			externalCmdPool:   p.externalCmdPool,
 			parent:            p,
 		}
 		p.pathManager.initialize()
+		p.startupTimeline.mark("pathManager")
 
 		if p.metrics != nil {
 			p.metrics.SetPathManager(p.pathManager)
@@ -420,6 +465,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.rtspServer = i
+		p.startupTimeline.mark("rtspServer")
 
 		if p.metrics != nil {
 			p.metrics.SetRTSPServer(p.rtspServer)
@@ -460,6 +506,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.rtspsServer = i
+		p.startupTimeline.mark("rtspsServer")
 
 		if p.metrics != nil {
 			p.metrics.SetRTSPSServer(p.rtspsServer)
@@ -491,6 +538,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.rtmpServer = i
+		p.startupTimeline.mark("rtmpServer")
 
 		if p.metrics != nil {
 			p.metrics.SetRTMPServer(p.rtmpServer)
@@ -522,6 +570,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.rtmpsServer = i
+		p.startupTimeline.mark("rtmpsServer")
 
 		if p.metrics != nil {
 			p.metrics.SetRTMPSServer(p.rtmpsServer)
@@ -547,6 +596,7 @@ func (p *Core) createResources(initial bool) error {
 			ReadTimeout:     p.conf.ReadTimeout,
 			WriteQueueSize:  p.conf.WriteQueueSize,
 			MuxerCloseAfter: p.conf.HLSMuxerCloseAfter,
+			MemoryBudget:    p.memoryBudget,
 			PathManager:     p.pathManager,
 			Parent:          p,
 		}
@@ -555,6 +605,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.hlsServer = i
+		p.startupTimeline.mark("hlsServer")
 
 		p.pathManager.setHLSServer(p.hlsServer)
 
@@ -582,6 +633,7 @@ func (p *Core) createResources(initial bool) error {
 			ICEServers:            p.conf.WebRTCICEServers2,
 			HandshakeTimeout:      p.conf.WebRTCHandshakeTimeout,
 			TrackGatherTimeout:    p.conf.WebRTCTrackGatherTimeout,
+			AudioTranscoding:      p.conf.WebRTCAudioTranscoding,
 			ExternalCmdPool:       p.externalCmdPool,
 			PathManager:           p.pathManager,
 			Parent:                p,
@@ -591,6 +643,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.webRTCServer = i
+		p.startupTimeline.mark("webRTCServer")
 
 		if p.metrics != nil {
 			p.metrics.SetWebRTCServer(p.webRTCServer)
@@ -618,12 +671,31 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.srtServer = i
+		p.startupTimeline.mark("srtServer")
 
 		if p.metrics != nil {
 			p.metrics.SetSRTServer(p.srtServer)
 		}
 	}
 
+	if p.conf.Relay &&
+		p.relayServer == nil {
+		i := &relay.Server{
+			Address:        p.conf.RelayAddress,
+			ReadTimeout:    p.conf.ReadTimeout,
+			WriteTimeout:   p.conf.WriteTimeout,
+			WriteQueueSize: p.conf.WriteQueueSize,
+			PathManager:    p.pathManager,
+			Parent:         p,
+		}
+		err = i.Initialize()
+		if err != nil {
+			return err
+		}
+		p.relayServer = i
+		p.startupTimeline.mark("relayServer")
+	}
+
 	if p.conf.API &&
 		p.api == nil {
 		i := &api.API{
@@ -651,6 +723,7 @@ func (p *Core) createResources(initial bool) error {
 			return err
 		}
 		p.api = i
+		p.startupTimeline.mark("api")
 	}
 
 	if initial && p.confPath != "" {
@@ -658,16 +731,16 @@ func (p *Core) createResources(initial bool) error {
 		if err != nil {
 			return err
 		}
+		p.startupTimeline.mark("confWatcher")
 	}
 
 	return nil
 }
 
 func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
-	closeLogger := newConf == nil ||
-		newConf.LogLevel != p.conf.LogLevel ||
-		!reflect.DeepEqual(newConf.LogDestinations, p.conf.LogDestinations) ||
-		newConf.LogFile != p.conf.LogFile
+	// when reloading, the logger is replaced by reloadLogger()
+	// without closing other resources.
+	closeLogger := newConf == nil
 
 	closeAuthManager := newConf == nil ||
 		newConf.AuthMethod != p.conf.AuthMethod ||
@@ -689,8 +762,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.MetricsAllowOrigin != p.conf.MetricsAllowOrigin ||
 		!reflect.DeepEqual(newConf.MetricsTrustedProxies, p.conf.MetricsTrustedProxies) ||
 		newConf.ReadTimeout != p.conf.ReadTimeout ||
-		closeAuthManager ||
-		closeLogger
+		closeAuthManager
 
 	closePPROF := newConf == nil ||
 		newConf.PPROF != p.conf.PPROF ||
@@ -701,12 +773,10 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.PPROFAllowOrigin != p.conf.PPROFAllowOrigin ||
 		!reflect.DeepEqual(newConf.PPROFTrustedProxies, p.conf.PPROFTrustedProxies) ||
 		newConf.ReadTimeout != p.conf.ReadTimeout ||
-		closeAuthManager ||
-		closeLogger
+		closeAuthManager
 
 	closeRecorderCleaner := newConf == nil ||
-		!reflect.DeepEqual(gatherCleanerEntries(newConf.Paths), gatherCleanerEntries(p.conf.Paths)) ||
-		closeLogger
+		!reflect.DeepEqual(gatherCleanerEntries(newConf.Paths), gatherCleanerEntries(p.conf.Paths))
 
 	closePlaybackServer := newConf == nil ||
 		newConf.Playback != p.conf.Playback ||
@@ -717,25 +787,23 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.PlaybackAllowOrigin != p.conf.PlaybackAllowOrigin ||
 		!reflect.DeepEqual(newConf.PlaybackTrustedProxies, p.conf.PlaybackTrustedProxies) ||
 		newConf.ReadTimeout != p.conf.ReadTimeout ||
-		closeAuthManager ||
-		closeLogger
+		closeAuthManager
 	if !closePlaybackServer && p.playbackServer != nil && !reflect.DeepEqual(newConf.Paths, p.conf.Paths) {
 		p.playbackServer.ReloadPathConfs(newConf.Paths)
 	}
 
 	closePathManager := newConf == nil ||
-		newConf.LogLevel != p.conf.LogLevel ||
 		newConf.RTSPAddress != p.conf.RTSPAddress ||
 		!reflect.DeepEqual(newConf.RTSPAuthMethods, p.conf.RTSPAuthMethods) ||
 		newConf.ReadTimeout != p.conf.ReadTimeout ||
 		newConf.WriteTimeout != p.conf.WriteTimeout ||
 		newConf.WriteQueueSize != p.conf.WriteQueueSize ||
 		newConf.UDPMaxPayloadSize != p.conf.UDPMaxPayloadSize ||
-		closeMetrics ||
-		closeAuthManager ||
-		closeLogger
-	if !closePathManager && !reflect.DeepEqual(newConf.Paths, p.conf.Paths) {
-		p.pathManager.ReloadPathConfs(newConf.Paths)
+		newConf.SourceMaxConnecting != p.conf.SourceMaxConnecting ||
+		closeAuthManager
+	if !closePathManager && (newConf.LogLevel != p.conf.LogLevel ||
+		!reflect.DeepEqual(newConf.Paths, p.conf.Paths)) {
+		p.pathManager.ReloadConf(newConf.LogLevel, newConf.Paths)
 	}
 
 	closeRTSPServer := newConf == nil ||
@@ -757,9 +825,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.RunOnConnect != p.conf.RunOnConnect ||
 		newConf.RunOnConnectRestart != p.conf.RunOnConnectRestart ||
 		newConf.RunOnDisconnect != p.conf.RunOnDisconnect ||
-		closeMetrics ||
-		closePathManager ||
-		closeLogger
+		closePathManager
 
 	closeRTSPSServer := newConf == nil ||
 		newConf.RTSP != p.conf.RTSP ||
@@ -776,9 +842,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.RunOnConnect != p.conf.RunOnConnect ||
 		newConf.RunOnConnectRestart != p.conf.RunOnConnectRestart ||
 		newConf.RunOnDisconnect != p.conf.RunOnDisconnect ||
-		closeMetrics ||
-		closePathManager ||
-		closeLogger
+		closePathManager
 
 	closeRTMPServer := newConf == nil ||
 		newConf.RTMP != p.conf.RTMP ||
@@ -791,9 +855,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.RunOnConnect != p.conf.RunOnConnect ||
 		newConf.RunOnConnectRestart != p.conf.RunOnConnectRestart ||
 		newConf.RunOnDisconnect != p.conf.RunOnDisconnect ||
-		closeMetrics ||
-		closePathManager ||
-		closeLogger
+		closePathManager
 
 	closeRTMPSServer := newConf == nil ||
 		newConf.RTMP != p.conf.RTMP ||
@@ -808,9 +870,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.RunOnConnect != p.conf.RunOnConnect ||
 		newConf.RunOnConnectRestart != p.conf.RunOnConnectRestart ||
 		newConf.RunOnDisconnect != p.conf.RunOnDisconnect ||
-		closeMetrics ||
-		closePathManager ||
-		closeLogger
+		closePathManager
 
 	closeHLSServer := newConf == nil ||
 		newConf.HLS != p.conf.HLS ||
@@ -830,9 +890,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.ReadTimeout != p.conf.ReadTimeout ||
 		newConf.WriteQueueSize != p.conf.WriteQueueSize ||
 		newConf.HLSMuxerCloseAfter != p.conf.HLSMuxerCloseAfter ||
-		closePathManager ||
-		closeMetrics ||
-		closeLogger
+		closePathManager
 
 	closeWebRTCServer := newConf == nil ||
 		newConf.WebRTC != p.conf.WebRTC ||
@@ -852,9 +910,8 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		!reflect.DeepEqual(newConf.WebRTCICEServers2, p.conf.WebRTCICEServers2) ||
 		newConf.WebRTCHandshakeTimeout != p.conf.WebRTCHandshakeTimeout ||
 		newConf.WebRTCTrackGatherTimeout != p.conf.WebRTCTrackGatherTimeout ||
-		closeMetrics ||
-		closePathManager ||
-		closeLogger
+		newConf.WebRTCAudioTranscoding != p.conf.WebRTCAudioTranscoding ||
+		closePathManager
 
 	closeSRTServer := newConf == nil ||
 		newConf.SRT != p.conf.SRT ||
@@ -867,8 +924,15 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		newConf.RunOnConnect != p.conf.RunOnConnect ||
 		newConf.RunOnConnectRestart != p.conf.RunOnConnectRestart ||
 		newConf.RunOnDisconnect != p.conf.RunOnDisconnect ||
-		closePathManager ||
-		closeLogger
+		closePathManager
+
+	closeRelayServer := newConf == nil ||
+		newConf.Relay != p.conf.Relay ||
+		newConf.RelayAddress != p.conf.RelayAddress ||
+		newConf.ReadTimeout != p.conf.ReadTimeout ||
+		newConf.WriteTimeout != p.conf.WriteTimeout ||
+		newConf.WriteQueueSize != p.conf.WriteQueueSize ||
+		closePathManager
 
 	closeAPI := newConf == nil ||
 		newConf.API != p.conf.API ||
@@ -886,8 +950,7 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		closeRTMPServer ||
 		closeHLSServer ||
 		closeWebRTCServer ||
-		closeSRTServer ||
-		closeLogger
+		closeSRTServer
 
 	if newConf == nil && p.confWatcher != nil {
 		p.confWatcher.Close()
@@ -903,6 +966,11 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 		}
 	}
 
+	if closeRelayServer && p.relayServer != nil {
+		p.relayServer.Close()
+		p.relayServer = nil
+	}
+
 	if closeSRTServer && p.srtServer != nil {
 		if p.metrics != nil {
 			p.metrics.SetSRTServer(nil)
@@ -1007,15 +1075,102 @@ func (p *Core) closeResources(newConf *conf.Conf, calledByAPI bool) {
 	}
 
 	if closeLogger && p.logger != nil {
-		p.logger.Close()
+		p.loggerMutex.Lock()
+		l := p.logger
 		p.logger = nil
+		p.loggerMutex.Unlock()
+
+		l.Close()
+	}
+}
+
+func (p *Core) newLogger(c *conf.Conf) (*logger.Logger, error) {
+	return logger.New(
+		logger.Level(c.LogLevel),
+		c.LogDestinations,
+		c.LogFile,
+		c.LogStructured,
+	)
+}
+
+// reloadLogger replaces the logger without touching other resources,
+// that keep logging through Core.Log().
+func (p *Core) reloadLogger(newConf *conf.Conf) error {
+	if newConf.LogLevel == p.conf.LogLevel &&
+		reflect.DeepEqual(newConf.LogDestinations, p.conf.LogDestinations) &&
+		newConf.LogFile == p.conf.LogFile &&
+		newConf.LogStructured == p.conf.LogStructured {
+		return nil
+	}
+
+	l, err := p.newLogger(newConf)
+	if err != nil {
+		return err
+	}
+
+	p.loggerMutex.Lock()
+	old := p.logger
+	p.logger = l
+	p.loggerMutex.Unlock()
+
+	old.Close()
+	return nil
+}
+
+func (p *Core) setMetricsResources() {
+	if p.pathManager != nil {
+		p.metrics.SetPathManager(p.pathManager)
+	}
+	if p.rtspServer != nil {
+		p.metrics.SetRTSPServer(p.rtspServer)
+	}
+	if p.rtspsServer != nil {
+		p.metrics.SetRTSPSServer(p.rtspsServer)
+	}
+	if p.rtmpServer != nil {
+		p.metrics.SetRTMPServer(p.rtmpServer)
+	}
+	if p.rtmpsServer != nil {
+		p.metrics.SetRTMPSServer(p.rtmpsServer)
+	}
+	if p.hlsServer != nil {
+		p.metrics.SetHLSServer(p.hlsServer)
+	}
+	if p.webRTCServer != nil {
+		p.metrics.SetWebRTCServer(p.webRTCServer)
+	}
+	if p.srtServer != nil {
+		p.metrics.SetSRTServer(p.srtServer)
 	}
 }
 
 func (p *Core) reloadConf(newConf *conf.Conf, calledByAPI bool) error {
+	start := time.Now()
+
+	err := p.reloadLogger(newConf)
+	if err != nil {
+		return err
+	}
+
 	p.closeResources(newConf, calledByAPI)
+	closeDuration := time.Since(start)
+
 	p.conf = newConf
-	return p.createResources(false)
+
+	err = p.createResources(false)
+	if err != nil {
+		return err
+	}
+
+	p.Log(logger.Info, "configuration reloaded in %v (%v closing resources, %v creating resources)",
+		time.Since(start), closeDuration, time.Since(start)-closeDuration)
+
+	return nil
+}
+
+// APIStartupTimeline is called by api.
+func (p *Core) APIStartupTimeline() *defs.APIStartupTimeline {
+	return p.startupTimeline.apiDescribe()
 }
 
 // APIConfigSet is called by api.
@@ -73,6 +73,18 @@ func TestMetrics(t *testing.T) {
 		bo := httpPullFile(t, hc, "http://localhost:9998/metrics")
 
 		require.Equal(t, `paths 0
+static_source_upstreams 0
+static_source_upstreams_shared 0
+static_source_upstream_paths 0
+static_source_upstreams_bytes_received 0
+static_source_upstreams_bytes_sent 0
+memory_budget_limit_bytes 0
+memory_budget_used_bytes{subsystem="readerQueues"} 0
+memory_budget_used_bytes{subsystem="hlsSegments"} 0
+memory_budget_used_bytes{subsystem="keyFrameCache"} 0
+memory_budget_used_bytes{subsystem="recorderBuffers"} 0
+memory_budget_readers_rejected 0
+memory_budget_readers_degraded 0
 hls_muxers 0
 hls_muxers_bytes_sent 0
 rtsp_conns 0
@@ -99,6 +111,16 @@ srt_conns_bytes_sent 0
 webrtc_sessions 0
 webrtc_sessions_bytes_received 0
 webrtc_sessions_bytes_sent 0
+webrtc_sessions_setup_seconds_bucket{le="0.1"} 0
+webrtc_sessions_setup_seconds_bucket{le="0.25"} 0
+webrtc_sessions_setup_seconds_bucket{le="0.5"} 0
+webrtc_sessions_setup_seconds_bucket{le="1"} 0
+webrtc_sessions_setup_seconds_bucket{le="2"} 0
+webrtc_sessions_setup_seconds_bucket{le="5"} 0
+webrtc_sessions_setup_seconds_bucket{le="10"} 0
+webrtc_sessions_setup_seconds_bucket{le="+Inf"} 0
+webrtc_sessions_setup_seconds_sum 0
+webrtc_sessions_setup_seconds_count 0
 `, string(bo))
 	})
 
@@ -238,21 +260,45 @@ webrtc_sessions_bytes_sent 0
 			`^paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
 				`paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
 				`paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
 				`paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
 				`paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
 				`paths\{name=".*?",state="ready"\} 1`+"\n"+
 				`paths_bytes_received\{name=".*?",state="ready"\} [0-9]+`+"\n"+
 				`paths_bytes_sent\{name=".*?",state="ready"\} [0-9]+`+"\n"+
+				`paths_transcoding_cpu_seconds\{name=".*?",state="ready"\} [0-9.e+-]+`+"\n"+
+				`(paths_readers_queue_delay_seconds_\S+ [0-9.e+-]+`+"\n"+`)*`+
+				`static_source_upstreams 0`+"\n"+
+				`static_source_upstreams_shared 0`+"\n"+
+				`static_source_upstream_paths 0`+"\n"+
+				`static_source_upstreams_bytes_received 0`+"\n"+
+				`static_source_upstreams_bytes_sent 0`+"\n"+
+				`memory_budget_limit_bytes 0`+"\n"+
+				`memory_budget_used_bytes\{subsystem="readerQueues"\} [0-9]+`+"\n"+
+				`memory_budget_used_bytes\{subsystem="hlsSegments"\} [0-9]+`+"\n"+
+				`memory_budget_used_bytes\{subsystem="keyFrameCache"\} [0-9]+`+"\n"+
+				`memory_budget_used_bytes\{subsystem="recorderBuffers"\} [0-9]+`+"\n"+
+				`memory_budget_readers_rejected 0`+"\n"+
+				`memory_budget_readers_degraded 0`+"\n"+
 				`hls_muxers\{name=".*?"\} 1`+"\n"+
 				`hls_muxers_bytes_sent\{name=".*?"\} 0`+"\n"+
 				`hls_muxers\{name=".*?"\} 1`+"\n"+
@@ -338,6 +384,9 @@ webrtc_sessions_bytes_sent 0
 				`webrtc_sessions\{id=".*?",state="publish"\} 1`+"\n"+
 				`webrtc_sessions_bytes_received\{id=".*?",state="publish"\} [0-9]+`+"\n"+
 				`webrtc_sessions_bytes_sent\{id=".*?",state="publish"\} [0-9]+`+"\n"+
+				`(webrtc_sessions_setup_seconds_bucket\{le=".*?"\} 0`+"\n){8}"+
+				`webrtc_sessions_setup_seconds_sum 0`+"\n"+
+				`webrtc_sessions_setup_seconds_count 0`+"\n"+
 				"$",
 			string(bo))
 
@@ -358,6 +407,18 @@ webrtc_sessions_bytes_sent 0
 
 		bo := httpPullFile(t, hc, "http://localhost:9998/metrics")
 
-		require.Equal(t, "paths 0\n", string(bo))
+		require.Equal(t, "paths 0\n"+
+			"static_source_upstreams 0\n"+
+			"static_source_upstreams_shared 0\n"+
+			"static_source_upstream_paths 0\n"+
+			"static_source_upstreams_bytes_received 0\n"+
+			"static_source_upstreams_bytes_sent 0\n"+
+			"memory_budget_limit_bytes 0\n"+
+			"memory_budget_used_bytes{subsystem=\"readerQueues\"} 0\n"+
+			"memory_budget_used_bytes{subsystem=\"hlsSegments\"} 0\n"+
+			"memory_budget_used_bytes{subsystem=\"keyFrameCache\"} 0\n"+
+			"memory_budget_used_bytes{subsystem=\"recorderBuffers\"} 0\n"+
+			"memory_budget_readers_rejected 0\n"+
+			"memory_budget_readers_degraded 0\n", string(bo))
 	})
 }
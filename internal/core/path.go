@@ -15,8 +15,12 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/hooks"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
+	"github.com/bluenviron/mediamtx/internal/profiler"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
 	"github.com/bluenviron/mediamtx/internal/record"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
@@ -27,6 +31,19 @@ func emptyTimer() *time.Timer {
 	return t
 }
 
+func apiDescribeSource(s defs.Source) *defs.APIPathSourceOrReader {
+	if s == nil {
+		return nil
+	}
+	v := s.APISourceDescribe()
+	return &v
+}
+
+func apiDescribeReader(r defs.Reader) *defs.APIPathSourceOrReader {
+	v := r.APIReaderDescribe()
+	return &v
+}
+
 type pathParent interface {
 	logger.Writer
 	pathReady(*path)
@@ -64,20 +81,26 @@ type pathAPIPathsGetReq struct {
 }
 
 type path struct {
-	parentCtx         context.Context
-	logLevel          conf.LogLevel
-	rtspAddress       string
-	readTimeout       conf.StringDuration
-	writeTimeout      conf.StringDuration
-	writeQueueSize    int
-	udpMaxPayloadSize int
-	confName          string
-	conf              *conf.Path
-	name              string
-	matches           []string
-	wg                *sync.WaitGroup
-	externalCmdPool   *externalcmd.Pool
-	parent            pathParent
+	parentCtx              context.Context
+	logLevel               conf.LogLevel
+	rtspAddress            string
+	readTimeout            conf.StringDuration
+	writeTimeout           conf.StringDuration
+	writeQueueSize         int
+	udpMaxPayloadSize      int
+	confName               string
+	conf                   *conf.Path
+	name                   string
+	matches                []string
+	staticSourceStartDelay time.Duration
+	wg                     *sync.WaitGroup
+	externalCmdPool        *externalcmd.Pool
+	events                 *pathEvents
+	sharedSources          *sharedStaticSources
+	relayClients           *relay.ClientPool
+	connectLimiter         *staticSourceConnectLimiter
+	memoryBudget           *membudget.Budget
+	parent                 pathParent
 
 	ctx                            context.Context
 	ctxCancel                      func()
@@ -85,11 +108,13 @@ type path struct {
 	source                         defs.Source
 	publisherQuery                 string
 	stream                         *stream.Stream
+	streamShared                   bool
 	recordAgent                    *record.Agent
 	readyTime                      time.Time
 	onUnDemandHook                 func(string)
 	onNotReadyHook                 func()
 	readers                        map[defs.Reader]struct{}
+	removedReaderQueueDelays       map[string]*defs.APIHistogram
 	describeRequestsOnHold         []defs.PathDescribeReq
 	readerAddRequestsOnHold        []defs.PathAddReaderReq
 	onDemandStaticSourceState      pathOnDemandState
@@ -122,6 +147,7 @@ func (pa *path) initialize() {
 	pa.ctx = ctx
 	pa.ctxCancel = ctxCancel
 	pa.readers = make(map[defs.Reader]struct{})
+	pa.removedReaderQueueDelays = make(map[string]*defs.APIHistogram)
 	pa.onDemandStaticSourceReadyTimer = emptyTimer()
 	pa.onDemandStaticSourceCloseTimer = emptyTimer()
 	pa.onDemandPublisherReadyTimer = emptyTimer()
@@ -155,7 +181,11 @@ func (pa *path) wait() {
 
 // Log implements logger.Writer.
 func (pa *path) Log(level logger.Level, format string, args ...interface{}) {
-	pa.parent.Log(level, "[path "+pa.name+"] "+format, args...)
+	pa.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "path",
+		Label: "path",
+		Value: pa.name,
+	}, args)...)
 }
 
 func (pa *path) Name() string {
@@ -166,17 +196,26 @@ func (pa *path) run() {
 	defer close(pa.done)
 	defer pa.wg.Done()
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: pa.name, Role: "path"})
+
 	if pa.conf.Source == "redirect" {
 		pa.source = &sourceRedirect{}
 	} else if pa.conf.HasStaticSource() {
 		pa.source = &staticSourceHandler{
-			conf:           pa.conf,
-			logLevel:       pa.logLevel,
-			readTimeout:    pa.readTimeout,
-			writeTimeout:   pa.writeTimeout,
-			writeQueueSize: pa.writeQueueSize,
-			matches:        pa.matches,
-			parent:         pa,
+			conf:              pa.conf,
+			pathName:          pa.name,
+			logLevel:          pa.logLevel,
+			readTimeout:       pa.readTimeout,
+			writeTimeout:      pa.writeTimeout,
+			writeQueueSize:    pa.writeQueueSize,
+			udpMaxPayloadSize: pa.udpMaxPayloadSize,
+			matches:           pa.matches,
+			startDelay:        pa.staticSourceStartDelay,
+			sharedSources:     pa.sharedSources,
+			relayClients:      pa.relayClients,
+			connectLimiter:    pa.connectLimiter,
+			memoryBudget:      pa.memoryBudget,
+			parent:            pa,
 		}
 		pa.source.(*staticSourceHandler).initialize()
 
@@ -378,7 +417,7 @@ func (pa *path) doReloadConf(newConf *conf.Path) {
 }
 
 func (pa *path) doSourceStaticSetReady(req defs.PathSourceStaticSetReadyReq) {
-	err := pa.setReady(req.Desc, req.GenerateRTPPackets)
+	err := pa.setReady(req.Desc, req.GenerateRTPPackets, req.Stream)
 	if err != nil {
 		req.Res <- defs.PathSourceStaticSetReadyRes{Err: err}
 		return
@@ -487,6 +526,11 @@ func (pa *path) doAddPublisher(req defs.PathAddPublisherReq) {
 	pa.source = req.Author
 	pa.publisherQuery = req.AccessRequest.Query
 
+	pa.emitEvent(&defs.APIPathEvent{
+		Type:   defs.APIPathEventTypePublisherAdded,
+		Source: apiDescribeSource(pa.source),
+	})
+
 	req.Res <- defs.PathAddPublisherRes{Path: pa}
 }
 
@@ -496,7 +540,7 @@ func (pa *path) doStartPublisher(req defs.PathStartPublisherReq) {
 		return
 	}
 
-	err := pa.setReady(req.Desc, req.GenerateRTPPackets)
+	err := pa.setReady(req.Desc, req.GenerateRTPPackets, nil)
 	if err != nil {
 		req.Res <- defs.PathStartPublisherRes{Err: err}
 		return
@@ -573,14 +617,8 @@ func (pa *path) doAPIPathsGet(req pathAPIPathsGetReq) {
 		data: &defs.APIPath{
 			Name:     pa.name,
 			ConfName: pa.confName,
-			Source: func() *defs.APIPathSourceOrReader {
-				if pa.source == nil {
-					return nil
-				}
-				v := pa.source.APISourceDescribe()
-				return &v
-			}(),
-			Ready: pa.stream != nil,
+			Source:   apiDescribeSource(pa.source),
+			Ready:    pa.stream != nil,
 			ReadyTime: func() *time.Time {
 				if pa.stream == nil {
 					return nil
@@ -594,18 +632,48 @@ func (pa *path) doAPIPathsGet(req pathAPIPathsGetReq) {
 				}
 				return defs.MediasToCodecs(pa.stream.Desc().Medias)
 			}(),
+			// traffic of shared streams is attributed to the shared upstream connection.
 			BytesReceived: func() uint64 {
-				if pa.stream == nil {
+				if pa.stream == nil || pa.streamShared {
 					return 0
 				}
 				return pa.stream.BytesReceived()
 			}(),
 			BytesSent: func() uint64 {
-				if pa.stream == nil {
+				if pa.stream == nil || pa.streamShared {
 					return 0
 				}
 				return pa.stream.BytesSent()
 			}(),
+			TranscodingCPUTime: func() float64 {
+				if pa.stream == nil || pa.streamShared {
+					return 0
+				}
+				return pa.stream.TranscodingCPUTime().Seconds()
+			}(),
+			SourceErrors: func() uint64 {
+				if source, ok := pa.source.(*staticSourceHandler); ok {
+					return source.errors()
+				}
+				return 0
+			}(),
+			JitterBuffer: func() *defs.APIPathJitterBuffer {
+				if pa.stream == nil {
+					return nil
+				}
+				stats := pa.stream.JitterBufferStats()
+				if stats == nil {
+					return nil
+				}
+				return &defs.APIPathJitterBuffer{
+					PacketsReordered: stats.PacketsReordered,
+					PacketsLate:      stats.PacketsLate,
+					PacketsDuplicate: stats.PacketsDuplicate,
+					PacketsLost:      stats.PacketsLost,
+					ReorderDepth:     stats.ReorderDepth,
+					Delay:            stats.Delay.Seconds(),
+				}
+			}(),
 			Readers: func() []defs.APIPathSourceOrReader {
 				ret := []defs.APIPathSourceOrReader{}
 				for r := range pa.readers {
@@ -613,10 +681,33 @@ func (pa *path) doAPIPathsGet(req pathAPIPathsGetReq) {
 				}
 				return ret
 			}(),
+			ReaderQueueDelays: pa.readerQueueDelays(),
 		},
 	}
 }
 
+// readerQueueDelays returns queue delays of current and removed readers, grouped by reader type.
+func (pa *path) readerQueueDelays() map[string]*defs.APIHistogram {
+	ret := make(map[string]*defs.APIHistogram)
+
+	for typ, h := range pa.removedReaderQueueDelays {
+		ret[typ] = &defs.APIHistogram{}
+		histogram.Merge(ret[typ], h)
+	}
+
+	for r := range pa.readers {
+		if rq, ok := r.(defs.ReaderWithQueueDelay); ok {
+			typ := r.APIReaderDescribe().Type
+			if _, ok := ret[typ]; !ok {
+				ret[typ] = &defs.APIHistogram{}
+			}
+			histogram.Merge(ret[typ], rq.APIReaderQueueDelay())
+		}
+	}
+
+	return ret
+}
+
 func (pa *path) SafeConf() *conf.Path {
 	pa.confMutex.RLock()
 	defer pa.confMutex.RUnlock()
@@ -709,16 +800,30 @@ func (pa *path) onDemandPublisherStop(reason string) {
 	pa.onDemandPublisherState = pathOnDemandStateInitial
 }
 
-func (pa *path) setReady(desc *description.Session, allocateEncoder bool) error {
-	var err error
-	pa.stream, err = stream.New(
-		pa.udpMaxPayloadSize,
-		desc,
-		allocateEncoder,
-		logger.NewLimitedLogger(pa.source),
-	)
-	if err != nil {
-		return err
+func (pa *path) setReady(desc *description.Session, allocateEncoder bool, sharedStream *stream.Stream) error {
+	if sharedStream != nil {
+		pa.stream = sharedStream
+		pa.streamShared = true
+	} else {
+		var err error
+		pa.stream, err = stream.New(
+			pa.udpMaxPayloadSize,
+			desc,
+			allocateEncoder,
+			pa.source,
+		)
+		if err != nil {
+			return err
+		}
+		pa.streamShared = false
+
+		pa.stream.SetMemoryBudget(pa.memoryBudget)
+
+		if pa.conf.RTPJitterBuffer {
+			pa.stream.EnableJitterBuffer(
+				time.Duration(pa.conf.RTPJitterBufferMinDelay),
+				time.Duration(pa.conf.RTPJitterBufferMaxDelay))
+		}
 	}
 
 	if pa.conf.Record {
@@ -738,6 +843,12 @@ func (pa *path) setReady(desc *description.Session, allocateEncoder bool) error
 
 	pa.parent.pathReady(pa)
 
+	pa.emitEvent(&defs.APIPathEvent{
+		Type:   defs.APIPathEventTypeReady,
+		Source: apiDescribeSource(pa.source),
+		Tracks: defs.MediasToCodecs(desc.Medias),
+	})
+
 	return nil
 }
 
@@ -758,6 +869,10 @@ func (pa *path) consumeOnHoldRequests() {
 func (pa *path) setNotReady() {
 	pa.parent.pathNotReady(pa)
 
+	pa.emitEvent(&defs.APIPathEvent{
+		Type: defs.APIPathEventTypeNotReady,
+	})
+
 	for r := range pa.readers {
 		pa.executeRemoveReader(r)
 		r.Close()
@@ -771,7 +886,10 @@ func (pa *path) setNotReady() {
 	}
 
 	if pa.stream != nil {
-		pa.stream.Close()
+		// shared streams are closed by their owner.
+		if !pa.streamShared {
+			pa.stream.Close()
+		}
 		pa.stream = nil
 	}
 }
@@ -785,6 +903,7 @@ func (pa *path) startRecording() {
 		SegmentDuration: time.Duration(pa.conf.RecordSegmentDuration),
 		PathName:        pa.name,
 		Stream:          pa.stream,
+		MemoryBudget:    pa.memoryBudget,
 		OnSegmentCreate: func(segmentPath string) {
 			if pa.conf.RunOnRecordSegmentCreate != "" {
 				env := pa.ExternalCmdEnv()
@@ -821,6 +940,20 @@ func (pa *path) startRecording() {
 
 func (pa *path) executeRemoveReader(r defs.Reader) {
 	delete(pa.readers, r)
+
+	// keep queue delays of removed readers.
+	if rq, ok := r.(defs.ReaderWithQueueDelay); ok {
+		typ := r.APIReaderDescribe().Type
+		if _, ok := pa.removedReaderQueueDelays[typ]; !ok {
+			pa.removedReaderQueueDelays[typ] = &defs.APIHistogram{}
+		}
+		histogram.Merge(pa.removedReaderQueueDelays[typ], rq.APIReaderQueueDelay())
+	}
+
+	pa.emitEvent(&defs.APIPathEvent{
+		Type:   defs.APIPathEventTypeReaderRemoved,
+		Reader: apiDescribeReader(r),
+	})
 }
 
 func (pa *path) executeRemovePublisher() {
@@ -828,9 +961,24 @@ func (pa *path) executeRemovePublisher() {
 		pa.setNotReady()
 	}
 
+	pa.emitEvent(&defs.APIPathEvent{
+		Type:   defs.APIPathEventTypePublisherRemoved,
+		Source: apiDescribeSource(pa.source),
+	})
+
 	pa.source = nil
 }
 
+func (pa *path) emitEvent(evt *defs.APIPathEvent) {
+	if pa.events == nil || !pa.events.hasSubscribers() {
+		return
+	}
+
+	evt.Time = time.Now()
+	evt.Path = pa.name
+	pa.events.publish(evt)
+}
+
 func (pa *path) addReaderPost(req defs.PathAddReaderReq) {
 	if _, ok := pa.readers[req.Author]; ok {
 		req.Res <- defs.PathAddReaderRes{
@@ -845,8 +993,18 @@ func (pa *path) addReaderPost(req defs.PathAddReaderReq) {
 		return
 	}
 
+	if !pa.memoryBudget.AdmitReader() {
+		req.Res <- defs.PathAddReaderRes{Err: fmt.Errorf("memory budget exceeded")}
+		return
+	}
+
 	pa.readers[req.Author] = struct{}{}
 
+	pa.emitEvent(&defs.APIPathEvent{
+		Type:   defs.APIPathEventTypeReaderAdded,
+		Reader: apiDescribeReader(req.Author),
+	})
+
 	if pa.conf.HasOnDemandStaticSource() {
 		if pa.onDemandStaticSourceState == pathOnDemandStateClosing {
 			pa.onDemandStaticSourceState = pathOnDemandStateReady
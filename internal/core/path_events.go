@@ -0,0 +1,251 @@
+package core
+
+import (
+	"sync"
+	"sync/atomic"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/defs"
+)
+
+const (
+	pathEventsDefaultQueueSize = 1024
+)
+
+type pathEventsSubscription struct {
+	parent      *pathEvents
+	bytesPeriod time.Duration
+
+	ch        chan *defs.APIPathEvent
+	dropped   *uint64
+	done      chan struct{}
+	closeOnce sync.Once
+}
+
+// Events implements defs.APIPathEventSubscription.
+func (s *pathEventsSubscription) Events() <-chan *defs.APIPathEvent {
+	return s.ch
+}
+
+// Done implements defs.APIPathEventSubscription.
+func (s *pathEventsSubscription) Done() <-chan struct{} {
+	return s.done
+}
+
+// Dropped implements defs.APIPathEventSubscription.
+func (s *pathEventsSubscription) Dropped() uint64 {
+	return atomic.SwapUint64(s.dropped, 0)
+}
+
+// Close implements defs.APIPathEventSubscription.
+func (s *pathEventsSubscription) Close() {
+	s.parent.unsubscribe(s)
+	s.terminate()
+}
+
+func (s *pathEventsSubscription) terminate() {
+	s.closeOnce.Do(func() {
+		close(s.done)
+	})
+}
+
+func (s *pathEventsSubscription) push(evt *defs.APIPathEvent) {
+	select {
+	case s.ch <- evt:
+	default:
+		atomic.AddUint64(s.dropped, 1)
+	}
+}
+
+// pathEventsBytesProducer periodically reads byte counters of paths
+// and sends changed ones to all subscriptions with the same period,
+// in order to list paths once per period instead of once per subscription.
+type pathEventsBytesProducer struct {
+	period time.Duration
+	parent *pathEvents
+
+	// value is true when the subscription has not received counters yet (protected by parent.mutex)
+	subscriptions map[*pathEventsSubscription]bool
+	lastBytes     map[string][2]uint64
+	terminate     chan struct{}
+}
+
+func (p *pathEventsBytesProducer) initialize() {
+	p.subscriptions = make(map[*pathEventsSubscription]bool)
+	p.lastBytes = make(map[string][2]uint64)
+	p.terminate = make(chan struct{})
+
+	go p.run()
+}
+
+func (p *pathEventsBytesProducer) run() {
+	ticker := time.NewTicker(p.period)
+	defer ticker.Stop()
+
+	for {
+		select {
+		case <-ticker.C:
+			p.produce()
+
+		case <-p.terminate:
+			return
+		}
+	}
+}
+
+func (p *pathEventsBytesProducer) produce() {
+	data, err := p.parent.listPaths()
+	if err != nil {
+		return
+	}
+
+	now := time.Now()
+	all := make([]*defs.APIPathEvent, 0, len(data.Items))
+	var changed []*defs.APIPathEvent
+	present := make(map[string]struct{}, len(data.Items))
+
+	for _, item := range data.Items {
+		present[item.Name] = struct{}{}
+
+		cur := [2]uint64{item.BytesReceived, item.BytesSent}
+		evt := &defs.APIPathEvent{
+			Type:          defs.APIPathEventTypeBytes,
+			Time:          now,
+			Path:          item.Name,
+			BytesReceived: &cur[0],
+			BytesSent:     &cur[1],
+		}
+		all = append(all, evt)
+
+		if prev, ok := p.lastBytes[item.Name]; !ok || prev != cur {
+			p.lastBytes[item.Name] = cur
+			changed = append(changed, evt)
+		}
+	}
+
+	for name := range p.lastBytes {
+		if _, ok := present[name]; !ok {
+			delete(p.lastBytes, name)
+		}
+	}
+
+	p.parent.mutex.Lock()
+	defer p.parent.mutex.Unlock()
+
+	for s, first := range p.subscriptions {
+		evts := changed
+		if first {
+			evts = all
+			p.subscriptions[s] = false
+		}
+
+		for _, evt := range evts {
+			s.push(evt)
+		}
+	}
+}
+
+// pathEvents dispatches path events to subscribers.
+// Publishing never blocks: when the queue of a subscriber is full,
+// the event is dropped and counted, and the subscriber is notified later.
+type pathEvents struct {
+	listPaths func() (*defs.APIPathList, error)
+
+	mutex          sync.RWMutex
+	subscriptions  map[*pathEventsSubscription]struct{}
+	bytesProducers map[time.Duration]*pathEventsBytesProducer
+}
+
+func (e *pathEvents) initialize() {
+	e.subscriptions = make(map[*pathEventsSubscription]struct{})
+	e.bytesProducers = make(map[time.Duration]*pathEventsBytesProducer)
+}
+
+func (e *pathEvents) close() {
+	e.mutex.Lock()
+	defer e.mutex.Unlock()
+
+	for s := range e.subscriptions {
+		s.terminate()
+	}
+	e.subscriptions = nil
+
+	for _, p := range e.bytesProducers {
+		close(p.terminate)
+	}
+	e.bytesProducers = nil
+}
+
+// subscribe adds a subscription.
+// When bytesPeriod is not zero, byte counters of paths are sent with that period.
+func (e *pathEvents) subscribe(queueSize int, bytesPeriod time.Duration) *pathEventsSubscription {
+	if queueSize <= 0 {
+		queueSize = pathEventsDefaultQueueSize
+	}
+
+	s := &pathEventsSubscription{
+		parent:      e,
+		bytesPeriod: bytesPeriod,
+		ch:          make(chan *defs.APIPathEvent, queueSize),
+		dropped:     new(uint64),
+		done:        make(chan struct{}),
+	}
+
+	e.mutex.Lock()
+	defer e.mutex.Unlock()
+
+	if e.subscriptions == nil {
+		s.terminate()
+		return s
+	}
+
+	e.subscriptions[s] = struct{}{}
+
+	if bytesPeriod != 0 {
+		p, ok := e.bytesProducers[bytesPeriod]
+		if !ok {
+			p = &pathEventsBytesProducer{
+				period: bytesPeriod,
+				parent: e,
+			}
+			p.initialize()
+			e.bytesProducers[bytesPeriod] = p
+		}
+
+		p.subscriptions[s] = true
+	}
+
+	return s
+}
+
+func (e *pathEvents) unsubscribe(s *pathEventsSubscription) {
+	e.mutex.Lock()
+	defer e.mutex.Unlock()
+
+	delete(e.subscriptions, s)
+
+	if p, ok := e.bytesProducers[s.bytesPeriod]; ok {
+		delete(p.subscriptions, s)
+
+		if len(p.subscriptions) == 0 {
+			close(p.terminate)
+			delete(e.bytesProducers, s.bytesPeriod)
+		}
+	}
+}
+
+func (e *pathEvents) publish(evt *defs.APIPathEvent) {
+	e.mutex.RLock()
+	defer e.mutex.RUnlock()
+
+	for s := range e.subscriptions {
+		s.push(evt)
+	}
+}
+
+func (e *pathEvents) hasSubscribers() bool {
+	e.mutex.RLock()
+	defer e.mutex.RUnlock()
+
+	return len(e.subscriptions) != 0
+}
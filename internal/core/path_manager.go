@@ -5,15 +5,23 @@ import (
 	"fmt"
 	"sort"
 	"sync"
+	"time"
 
 	"github.com/bluenviron/mediamtx/internal/auth"
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
 
+const (
+	pathManagerStaticSourceStartInterval  = 20 * time.Millisecond
+	pathManagerStaticSourceMaxStartSpread = 5 * time.Second
+)
+
 func pathConfCanBeUpdated(oldPathConf *conf.Path, newPathConf *conf.Path) bool {
 	clone := oldPathConf.Clone()
 
@@ -31,6 +39,8 @@ func pathConfCanBeUpdated(oldPathConf *conf.Path, newPathConf *conf.Path) bool {
 	clone.RPICameraMetering = newPathConf.RPICameraMetering
 	clone.RPICameraGain = newPathConf.RPICameraGain
 	clone.RPICameraEV = newPathConf.RPICameraEV
+	clone.RPICameraROI = newPathConf.RPICameraROI
+	clone.RPICameraROITransition = newPathConf.RPICameraROITransition
 	clone.RPICameraFPS = newPathConf.RPICameraFPS
 	clone.RPICameraIDRPeriod = newPathConf.RPICameraIDRPeriod
 	clone.RPICameraBitrate = newPathConf.RPICameraBitrate
@@ -38,6 +48,11 @@ func pathConfCanBeUpdated(oldPathConf *conf.Path, newPathConf *conf.Path) bool {
 	return newPathConf.Equal(clone)
 }
 
+type pathManagerReloadConfReq struct {
+	logLevel  conf.LogLevel
+	pathConfs map[string]*conf.Path
+}
+
 type pathManagerHLSServer interface {
 	PathReady(defs.Path)
 	PathNotReady(defs.Path)
@@ -55,19 +70,25 @@ type pathManager struct {
 	writeTimeout      conf.StringDuration
 	writeQueueSize    int
 	udpMaxPayloadSize int
+	maxConnecting     int
+	memoryBudget      *membudget.Budget
 	pathConfs         map[string]*conf.Path
 	externalCmdPool   *externalcmd.Pool
 	parent            pathManagerParent
 
-	ctx         context.Context
-	ctxCancel   func()
-	wg          sync.WaitGroup
-	hlsManager  pathManagerHLSServer
-	paths       map[string]*path
-	pathsByConf map[string]map[*path]struct{}
+	ctx            context.Context
+	ctxCancel      func()
+	wg             sync.WaitGroup
+	hlsManager     pathManagerHLSServer
+	paths          map[string]*path
+	pathsByConf    map[string]map[*path]struct{}
+	events         *pathEvents
+	sharedSources  *sharedStaticSources
+	relayClients   *relay.ClientPool
+	connectLimiter *staticSourceConnectLimiter
 
 	// in
-	chReloadConf   chan map[string]*conf.Path
+	chReloadConf   chan pathManagerReloadConfReq
 	chSetHLSServer chan pathManagerHLSServer
 	chClosePath    chan *path
 	chPathReady    chan *path
@@ -87,7 +108,22 @@ func (pm *pathManager) initialize() {
 	pm.ctxCancel = ctxCancel
 	pm.paths = make(map[string]*path)
 	pm.pathsByConf = make(map[string]map[*path]struct{})
-	pm.chReloadConf = make(chan map[string]*conf.Path)
+	pm.events = &pathEvents{
+		listPaths: pm.APIPathsList,
+	}
+	pm.events.initialize()
+	pm.sharedSources = &sharedStaticSources{
+		udpMaxPayloadSize: pm.udpMaxPayloadSize,
+		parent:            pm,
+	}
+	pm.sharedSources.initialize()
+	pm.relayClients = &relay.ClientPool{
+		ReadTimeout:  time.Duration(pm.readTimeout),
+		WriteTimeout: time.Duration(pm.writeTimeout),
+	}
+	pm.relayClients.Initialize()
+	pm.connectLimiter = newStaticSourceConnectLimiter(pm.maxConnecting)
+	pm.chReloadConf = make(chan pathManagerReloadConfReq)
 	pm.chSetHLSServer = make(chan pathManagerHLSServer)
 	pm.chClosePath = make(chan *path)
 	pm.chPathReady = make(chan *path)
@@ -99,11 +135,7 @@ func (pm *pathManager) initialize() {
 	pm.chAPIPathsList = make(chan pathAPIPathsListReq)
 	pm.chAPIPathsGet = make(chan pathAPIPathsGetReq)
 
-	for pathConfName, pathConf := range pm.pathConfs {
-		if pathConf.Regexp == nil {
-			pm.createPath(pathConfName, pathConf, pathConfName, nil)
-		}
-	}
+	pm.createStaticPaths()
 
 	pm.Log(logger.Debug, "path manager created")
 
@@ -115,6 +147,7 @@ func (pm *pathManager) close() {
 	pm.Log(logger.Debug, "path manager is shutting down")
 	pm.ctxCancel()
 	pm.wg.Wait()
+	pm.events.close()
 }
 
 // Log implements logger.Writer.
@@ -128,8 +161,8 @@ func (pm *pathManager) run() {
 outer:
 	for {
 		select {
-		case newPaths := <-pm.chReloadConf:
-			pm.doReloadConf(newPaths)
+		case req := <-pm.chReloadConf:
+			pm.doReloadConf(req)
 
 		case m := <-pm.chSetHLSServer:
 			pm.doSetHLSServer(m)
@@ -169,41 +202,74 @@ outer:
 	pm.ctxCancel()
 }
 
-func (pm *pathManager) doReloadConf(newPaths map[string]*conf.Path) {
+func (pm *pathManager) doReloadConf(req pathManagerReloadConfReq) {
+	start := time.Now()
+
+	// the log level is passed to the Raspberry Pi Camera only
+	logLevelChanged := req.logLevel != pm.logLevel
+	pm.logLevel = req.logLevel
+
+	updated := 0
+	toClose := make(map[*path]struct{})
+
 	for confName, pathConf := range pm.pathConfs {
-		if newPath, ok := newPaths[confName]; ok {
-			// configuration has changed
-			if !newPath.Equal(pathConf) {
-				if pathConfCanBeUpdated(pathConf, newPath) { // paths associated with the configuration can be updated
-					for pa := range pm.pathsByConf[confName] {
-						go pa.reloadConf(newPath)
-					}
-				} else { // paths associated with the configuration must be recreated
-					for pa := range pm.pathsByConf[confName] {
-						pm.removePath(pa)
-						pa.close()
-						pa.wait() // avoid conflicts between sources
-					}
-				}
+		newPathConf, ok := req.pathConfs[confName]
+		equal := ok && newPathConf.Equal(pathConf)
+		logLevelAffects := logLevelChanged && pathConf.Source == "rpiCamera"
+
+		switch {
+		// configuration has been deleted, remove associated paths
+		case !ok:
+			for pa := range pm.pathsByConf[confName] {
+				toClose[pa] = struct{}{}
 			}
-		} else {
-			// configuration has been deleted, remove associated paths
+
+		// configuration has not changed
+		case equal && !logLevelAffects:
+
+		// paths associated with the configuration can be updated
+		case !equal && !logLevelAffects && pathConfCanBeUpdated(pathConf, newPathConf):
 			for pa := range pm.pathsByConf[confName] {
-				pm.removePath(pa)
-				pa.close()
-				pa.wait() // avoid conflicts between sources
+				go pa.reloadConf(newPathConf)
+				updated++
+			}
+
+		// paths associated with the configuration must be recreated
+		default:
+			for pa := range pm.pathsByConf[confName] {
+				toClose[pa] = struct{}{}
 			}
 		}
 	}
 
-	pm.pathConfs = newPaths
+	// paths created by a regular expression may now be associated with another configuration
+	for name, pa := range pm.paths {
+		if _, ok := toClose[pa]; ok || pm.pathConfs[pa.confName].Regexp == nil {
+			continue
+		}
 
-	// add new paths
-	for pathConfName, pathConf := range pm.pathConfs {
-		if _, ok := pm.paths[pathConfName]; !ok && pathConf.Regexp == nil {
-			pm.createPath(pathConfName, pathConf, pathConfName, nil)
+		newConfName, _, _, err := conf.FindPathConf(req.pathConfs, name)
+		if err != nil || newConfName != pa.confName {
+			toClose[pa] = struct{}{}
 		}
 	}
+
+	// close paths in parallel, then wait for all of them to avoid conflicts between sources
+	for pa := range toClose {
+		pm.removePath(pa)
+		pa.close()
+	}
+	for pa := range toClose {
+		pa.wait()
+	}
+
+	pm.pathConfs = req.pathConfs
+
+	// add new paths
+	added := pm.createStaticPaths()
+
+	pm.Log(logger.Debug, "path configurations reloaded in %v: %d paths updated, %d closed, %d created",
+		time.Since(start), updated, len(toClose), added)
 }
 
 func (pm *pathManager) doSetHLSServer(m pathManagerHLSServer) {
@@ -260,7 +326,7 @@ func (pm *pathManager) doDescribe(req defs.PathDescribeReq) {
 
 	// create path if it doesn't exist
 	if _, ok := pm.paths[req.AccessRequest.Name]; !ok {
-		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches)
+		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches, 0)
 	}
 
 	req.Res <- defs.PathDescribeRes{Path: pm.paths[req.AccessRequest.Name]}
@@ -283,7 +349,7 @@ func (pm *pathManager) doAddReader(req defs.PathAddReaderReq) {
 
 	// create path if it doesn't exist
 	if _, ok := pm.paths[req.AccessRequest.Name]; !ok {
-		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches)
+		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches, 0)
 	}
 
 	req.Res <- defs.PathAddReaderRes{Path: pm.paths[req.AccessRequest.Name]}
@@ -306,7 +372,7 @@ func (pm *pathManager) doAddPublisher(req defs.PathAddPublisherReq) {
 
 	// create path if it doesn't exist
 	if _, ok := pm.paths[req.AccessRequest.Name]; !ok {
-		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches)
+		pm.createPath(pathConfName, pathConf, req.AccessRequest.Name, pathMatches, 0)
 	}
 
 	req.Res <- defs.PathAddPublisherRes{Path: pm.paths[req.AccessRequest.Name]}
@@ -337,22 +403,29 @@ func (pm *pathManager) createPath(
 	pathConf *conf.Path,
 	name string,
 	matches []string,
+	staticSourceStartDelay time.Duration,
 ) {
 	pa := &path{
-		parentCtx:         pm.ctx,
-		logLevel:          pm.logLevel,
-		rtspAddress:       pm.rtspAddress,
-		readTimeout:       pm.readTimeout,
-		writeTimeout:      pm.writeTimeout,
-		writeQueueSize:    pm.writeQueueSize,
-		udpMaxPayloadSize: pm.udpMaxPayloadSize,
-		confName:          pathConfName,
-		conf:              pathConf,
-		name:              name,
-		matches:           matches,
-		wg:                &pm.wg,
-		externalCmdPool:   pm.externalCmdPool,
-		parent:            pm,
+		parentCtx:              pm.ctx,
+		logLevel:               pm.logLevel,
+		rtspAddress:            pm.rtspAddress,
+		readTimeout:            pm.readTimeout,
+		writeTimeout:           pm.writeTimeout,
+		writeQueueSize:         pm.writeQueueSize,
+		udpMaxPayloadSize:      pm.udpMaxPayloadSize,
+		confName:               pathConfName,
+		conf:                   pathConf,
+		name:                   name,
+		matches:                matches,
+		staticSourceStartDelay: staticSourceStartDelay,
+		wg:                     &pm.wg,
+		externalCmdPool:        pm.externalCmdPool,
+		events:                 pm.events,
+		sharedSources:          pm.sharedSources,
+		relayClients:           pm.relayClients,
+		connectLimiter:         pm.connectLimiter,
+		memoryBudget:           pm.memoryBudget,
+		parent:                 pm,
 	}
 	pa.initialize()
 
@@ -364,6 +437,51 @@ func (pm *pathManager) createPath(
 	pm.pathsByConf[pathConfName][pa] = struct{}{}
 }
 
+// createStaticPaths creates paths that are not based on regular expressions
+// and that do not exist yet. Static sources that are not on demand are started
+// one after the other, in order not to connect to all of them at once.
+func (pm *pathManager) createStaticPaths() int {
+	var names []string
+	staticSourceCount := 0
+
+	for pathConfName, pathConf := range pm.pathConfs {
+		if _, ok := pm.paths[pathConfName]; !ok && pathConf.Regexp == nil {
+			names = append(names, pathConfName)
+
+			if pathConf.HasStaticSource() && !pathConf.SourceOnDemand {
+				staticSourceCount++
+			}
+		}
+	}
+
+	sort.Strings(names)
+
+	interval := pathManagerStaticSourceStartInterval
+	if staticSourceCount > 1 &&
+		interval*time.Duration(staticSourceCount-1) > pathManagerStaticSourceMaxStartSpread {
+		interval = pathManagerStaticSourceMaxStartSpread / time.Duration(staticSourceCount-1)
+	}
+
+	var delay time.Duration
+
+	for _, name := range names {
+		pathConf := pm.pathConfs[name]
+
+		if pathConf.HasStaticSource() && !pathConf.SourceOnDemand {
+			pm.createPath(name, pathConf, name, nil, delay)
+			delay += interval
+		} else {
+			pm.createPath(name, pathConf, name, nil, 0)
+		}
+	}
+
+	if staticSourceCount > 1 {
+		pm.Log(logger.Debug, "starting %d static sources in %v", staticSourceCount, delay-interval)
+	}
+
+	return len(names)
+}
+
 func (pm *pathManager) removePath(pa *path) {
 	delete(pm.pathsByConf[pa.confName], pa)
 	if len(pm.pathsByConf[pa.confName]) == 0 {
@@ -372,10 +490,10 @@ func (pm *pathManager) removePath(pa *path) {
 	delete(pm.paths, pa.name)
 }
 
-// ReloadPathConfs is called by core.
-func (pm *pathManager) ReloadPathConfs(pathConfs map[string]*conf.Path) {
+// ReloadConf is called by core.
+func (pm *pathManager) ReloadConf(logLevel conf.LogLevel, pathConfs map[string]*conf.Path) {
 	select {
-	case pm.chReloadConf <- pathConfs:
+	case pm.chReloadConf <- pathManagerReloadConfReq{logLevel: logLevel, pathConfs: pathConfs}:
 	case <-pm.ctx.Done():
 	}
 }
@@ -538,3 +656,22 @@ func (pm *pathManager) APIPathsGet(name string) (*defs.APIPath, error) {
 		return nil, fmt.Errorf("terminated")
 	}
 }
+
+// APIPathsEvents is called by api.
+func (pm *pathManager) APIPathsEvents(
+	queueSize int,
+	bytesPeriod time.Duration,
+) (defs.APIPathEventSubscription, error) {
+	select {
+	case <-pm.ctx.Done():
+		return nil, fmt.Errorf("terminated")
+	default:
+	}
+
+	return pm.events.subscribe(queueSize, bytesPeriod), nil
+}
+
+// APIStaticSourceUpstreams is called by api and metrics.
+func (pm *pathManager) APIStaticSourceUpstreams() *defs.APIStaticSourceUpstreams {
+	return pm.sharedSources.apiDescribe()
+}
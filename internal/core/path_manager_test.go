@@ -3,11 +3,17 @@ package core
 import (
 	"bufio"
 	"net"
+	"os"
 	"testing"
 
+	"github.com/bluenviron/gortsplib/v4"
 	"github.com/bluenviron/gortsplib/v4/pkg/base"
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
 	"github.com/bluenviron/gortsplib/v4/pkg/headers"
 	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/test"
 )
 
 func TestPathAutoDeletion(t *testing.T) {
@@ -82,3 +88,73 @@ func TestPathAutoDeletion(t *testing.T) {
 		})
 	}
 }
+
+func TestPathManagerReloadConf(t *testing.T) {
+	p, ok := newInstance("paths:\n" +
+		"  keep:\n" +
+		"  update:\n" +
+		"  recreate:\n" +
+		"  remove:\n" +
+		"  '~^reg_(.+)$':\n")
+	require.Equal(t, true, ok)
+	defer p.Close()
+
+	for _, name := range []string{"reg_a", "reg_b"} {
+		source := gortsplib.Client{}
+		err := source.StartRecording("rtsp://localhost:8554/"+name,
+			&description.Session{Medias: []*description.Media{test.UniqueMediaH264()}})
+		require.NoError(t, err)
+		defer source.Close()
+	}
+
+	// paths are read through the path manager loop,
+	// that processes requests after configuration reloads.
+	getPaths := func() map[string]*path {
+		req := pathAPIPathsListReq{res: make(chan pathAPIPathsListRes)}
+		p.pathManager.chAPIPathsList <- req
+		return (<-req.res).paths
+	}
+
+	before := getPaths()
+	require.Len(t, before, 6)
+
+	tmpf, err := test.CreateTempFile([]byte("paths:\n" +
+		"  keep:\n" +
+		"  update:\n" +
+		"    record: yes\n" +
+		"  recreate:\n" +
+		"    maxReaders: 1\n" +
+		"  reg_a:\n" +
+		"  '~^reg_(.+)$':\n"))
+	require.NoError(t, err)
+	defer os.Remove(tmpf)
+
+	newConf, _, err := conf.Load(tmpf, nil)
+	require.NoError(t, err)
+
+	p.pathManager.ReloadConf(newConf.LogLevel, newConf.Paths)
+
+	after := getPaths()
+	require.Len(t, after, 5)
+
+	// configuration has not changed
+	require.Same(t, before["keep"], after["keep"])
+	require.Same(t, before["reg_b"], after["reg_b"])
+
+	// configuration can be updated without recreating the path
+	require.Same(t, before["update"], after["update"])
+	require.Equal(t, true, after["update"].SafeConf().Record)
+
+	// configuration must be recreated
+	require.NotSame(t, before["recreate"], after["recreate"])
+	require.Equal(t, 1, after["recreate"].SafeConf().MaxReaders)
+
+	// configuration has been deleted
+	_, ok = after["remove"]
+	require.Equal(t, false, ok)
+
+	// path is now associated with another configuration
+	require.NotSame(t, before["reg_a"], after["reg_a"])
+	require.Equal(t, "~^reg_(.+)$", before["reg_a"].confName)
+	require.Equal(t, "reg_a", after["reg_a"].confName)
+}
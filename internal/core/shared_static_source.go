@@ -0,0 +1,359 @@
+package core
+
+import (
+	"context"
+	"encoding/json"
+	"fmt"
+	"net/url"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/stream"
+)
+
+// sharedStaticSourceKey returns a key that identifies the upstream connection of a static source.
+// Static sources with the same key can share the same connection.
+func sharedStaticSourceKey(resolvedSource string, pconf *conf.Path) string {
+	byts, _ := json.Marshal(struct {
+		Source                  string
+		SourceFingerprint       string
+		RTSPTransport           conf.RTSPTransport
+		RTSPAnyPort             bool
+		RTSPRangeType           conf.RTSPRangeType
+		RTSPRangeStart          string
+		RTPJitterBuffer         bool
+		RTPJitterBufferMinDelay conf.StringDuration
+		RTPJitterBufferMaxDelay conf.StringDuration
+	}{
+		Source:                  resolvedSource,
+		SourceFingerprint:       pconf.SourceFingerprint,
+		RTSPTransport:           pconf.RTSPTransport,
+		RTSPAnyPort:             pconf.RTSPAnyPort,
+		RTSPRangeType:           pconf.RTSPRangeType,
+		RTSPRangeStart:          pconf.RTSPRangeStart,
+		RTPJitterBuffer:         pconf.RTPJitterBuffer,
+		RTPJitterBufferMinDelay: pconf.RTPJitterBufferMinDelay,
+		RTPJitterBufferMaxDelay: pconf.RTPJitterBufferMaxDelay,
+	})
+	return string(byts)
+}
+
+// redactSource removes credentials from a source URL, in order to print it.
+func redactSource(resolvedSource string) string {
+	u, err := url.Parse(resolvedSource)
+	if err != nil {
+		return "(invalid URL)"
+	}
+	u.RawQuery = ""
+	return u.Redacted()
+}
+
+// sharedStaticSources is a registry of upstream connections of static sources.
+// Paths whose static sources have the same resolved URL and settings
+// share a single upstream connection and a single stream.
+type sharedStaticSources struct {
+	udpMaxPayloadSize int
+	parent            logger.Writer
+
+	mutex   sync.Mutex
+	sources map[string]*sharedStaticSource
+
+	// traffic of closed streams
+	bytesReceived uint64
+	bytesSent     uint64
+}
+
+func (r *sharedStaticSources) initialize() {
+	r.sources = make(map[string]*sharedStaticSource)
+}
+
+// Log implements logger.Writer.
+func (r *sharedStaticSources) Log(level logger.Level, format string, args ...interface{}) {
+	r.parent.Log(level, format, args...)
+}
+
+// acquire returns the shared source with the given key, creating it if it doesn't exist.
+// first is used to fill the configuration of new sources.
+func (r *sharedStaticSources) acquire(
+	key string,
+	resolvedSource string,
+	first *staticSourceHandler,
+) *sharedStaticSource {
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	ss, ok := r.sources[key]
+	if !ok {
+		ss = &sharedStaticSource{
+			key:            key,
+			resolvedSource: resolvedSource,
+			parent:         r,
+		}
+		ss.initialize(first)
+		r.sources[key] = ss
+	}
+
+	ss.refs++
+
+	return ss
+}
+
+// release decreases the reference count of a shared source and closes it when it is not used anymore.
+func (r *sharedStaticSources) release(ss *sharedStaticSource) {
+	r.mutex.Lock()
+	ss.refs--
+	unused := (ss.refs == 0)
+	if unused {
+		delete(r.sources, ss.key)
+	}
+	r.mutex.Unlock()
+
+	// close outside the mutex, since it waits for the upstream connection to be closed.
+	if unused {
+		ss.close()
+	}
+}
+
+func (r *sharedStaticSources) apiDescribe() *defs.APIStaticSourceUpstreams {
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	ret := &defs.APIStaticSourceUpstreams{
+		Upstreams:     len(r.sources),
+		BytesReceived: r.bytesReceived,
+		BytesSent:     r.bytesSent,
+	}
+
+	for _, ss := range r.sources {
+		if ss.refs > 1 {
+			ret.SharedUpstreams++
+		}
+		ret.Paths += ss.refs
+
+		if ss.stream != nil {
+			ret.BytesReceived += ss.stream.BytesReceived()
+			ret.BytesSent += ss.stream.BytesSent()
+		}
+	}
+
+	return ret
+}
+
+// sharedStaticSource is an upstream connection shared by the static sources of one or more paths.
+type sharedStaticSource struct {
+	key            string
+	resolvedSource string
+	parent         *sharedStaticSources
+
+	refs        int // protected by parent.mutex
+	ctx         context.Context
+	ctxCancel   func()
+	handler     *staticSourceHandler
+	subscribers map[*staticSourceHandler]bool // value is true when the path is ready
+	stream      *stream.Stream                // written under parent.mutex
+	readyReq    defs.PathSourceStaticSetReadyReq
+
+	// in
+	chSubscribe   chan *staticSourceHandler
+	chUnsubscribe chan *staticSourceHandler
+	chSetReady    chan defs.PathSourceStaticSetReadyReq
+	chSetNotReady chan defs.PathSourceStaticSetNotReadyReq
+
+	// out
+	done chan struct{}
+}
+
+func (ss *sharedStaticSource) initialize(first *staticSourceHandler) {
+	ss.ctx, ss.ctxCancel = context.WithCancel(context.Background())
+	ss.subscribers = make(map[*staticSourceHandler]bool)
+	ss.chSubscribe = make(chan *staticSourceHandler)
+	ss.chUnsubscribe = make(chan *staticSourceHandler)
+	ss.chSetReady = make(chan defs.PathSourceStaticSetReadyReq)
+	ss.chSetNotReady = make(chan defs.PathSourceStaticSetNotReadyReq)
+	ss.done = make(chan struct{})
+
+	ss.handler = &staticSourceHandler{
+		conf:           first.conf,
+		pathName:       first.pathName, // CPU usage is attributed to the first path
+		logLevel:       first.logLevel,
+		readTimeout:    first.readTimeout,
+		writeTimeout:   first.writeTimeout,
+		writeQueueSize: first.writeQueueSize,
+		matches:        first.matches,
+		relayClients:   first.relayClients,
+		connectLimiter: first.connectLimiter,
+		memoryBudget:   first.memoryBudget,
+		parent:         ss,
+	}
+	ss.handler.initialize()
+
+	go ss.run()
+
+	ss.handler.start(false, first.query)
+}
+
+func (ss *sharedStaticSource) close() {
+	ss.handler.close("not needed by any path")
+	ss.ctxCancel()
+	<-ss.done
+}
+
+// Log implements logger.Writer.
+func (ss *sharedStaticSource) Log(level logger.Level, format string, args ...interface{}) {
+	ss.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "upstream",
+		Label: "upstream",
+		Value: redactSource(ss.resolvedSource),
+	}, args)...)
+}
+
+func (ss *sharedStaticSource) run() {
+	defer close(ss.done)
+
+	for {
+		select {
+		case sub := <-ss.chSubscribe:
+			ss.subscribers[sub] = false
+			ss.Log(logger.Debug, "used by %d paths", len(ss.subscribers))
+
+			if ss.stream != nil {
+				ss.notifyReady(sub)
+			}
+
+		case sub := <-ss.chUnsubscribe:
+			delete(ss.subscribers, sub)
+			ss.Log(logger.Debug, "used by %d paths", len(ss.subscribers))
+
+		case req := <-ss.chSetReady:
+			strm, err := stream.New(
+				ss.parent.udpMaxPayloadSize,
+				req.Desc,
+				req.GenerateRTPPackets,
+				ss,
+			)
+			if err != nil {
+				req.Res <- defs.PathSourceStaticSetReadyRes{Err: err}
+				continue
+			}
+
+			strm.SetMemoryBudget(ss.handler.memoryBudget)
+
+			if ss.handler.conf.RTPJitterBuffer {
+				strm.EnableJitterBuffer(
+					time.Duration(ss.handler.conf.RTPJitterBufferMinDelay),
+					time.Duration(ss.handler.conf.RTPJitterBufferMaxDelay))
+			}
+
+			ss.parent.mutex.Lock()
+			ss.stream = strm
+			ss.parent.mutex.Unlock()
+
+			ss.readyReq = req
+
+			for sub := range ss.subscribers {
+				ss.notifyReady(sub)
+			}
+
+			req.Res <- defs.PathSourceStaticSetReadyRes{Stream: strm}
+
+		case req := <-ss.chSetNotReady:
+			ss.setNotReady()
+			close(req.Res)
+
+		case <-ss.ctx.Done():
+			ss.setNotReady()
+			return
+		}
+	}
+}
+
+func (ss *sharedStaticSource) setNotReady() {
+	if ss.stream == nil {
+		return
+	}
+
+	for sub, ready := range ss.subscribers {
+		if ready {
+			ss.notifyNotReady(sub)
+		}
+	}
+
+	ss.stream.Close()
+
+	// keep traffic of the stream in the totals.
+	ss.parent.mutex.Lock()
+	ss.parent.bytesReceived += ss.stream.BytesReceived()
+	ss.parent.bytesSent += ss.stream.BytesSent()
+	ss.stream = nil
+	ss.parent.mutex.Unlock()
+}
+
+func (ss *sharedStaticSource) notifyReady(sub *staticSourceHandler) {
+	req := defs.PathSourceStaticSetReadyReq{
+		Desc:               ss.readyReq.Desc,
+		GenerateRTPPackets: ss.readyReq.GenerateRTPPackets,
+		Stream:             ss.stream,
+		Res:                make(chan defs.PathSourceStaticSetReadyRes, 1),
+	}
+	sub.parent.staticSourceHandlerSetReady(sub.ctx, req)
+	res := <-req.Res
+
+	ss.subscribers[sub] = (res.Err == nil)
+}
+
+func (ss *sharedStaticSource) notifyNotReady(sub *staticSourceHandler) {
+	req := defs.PathSourceStaticSetNotReadyReq{
+		Res: make(chan struct{}),
+	}
+	sub.parent.staticSourceHandlerSetNotReady(sub.ctx, req)
+	<-req.Res
+
+	ss.subscribers[sub] = false
+}
+
+func (ss *sharedStaticSource) subscribe(sub *staticSourceHandler) {
+	select {
+	case ss.chSubscribe <- sub:
+	case <-ss.ctx.Done():
+	}
+}
+
+func (ss *sharedStaticSource) unsubscribe(sub *staticSourceHandler) {
+	select {
+	case ss.chUnsubscribe <- sub:
+	case <-ss.ctx.Done():
+	}
+}
+
+// staticSourceHandlerSetReady is called by staticSourceHandler.
+func (ss *sharedStaticSource) staticSourceHandlerSetReady(
+	staticSourceHandlerCtx context.Context, req defs.PathSourceStaticSetReadyReq,
+) {
+	select {
+	case ss.chSetReady <- req:
+
+	case <-ss.ctx.Done():
+		req.Res <- defs.PathSourceStaticSetReadyRes{Err: fmt.Errorf("terminated")}
+
+	case <-staticSourceHandlerCtx.Done():
+		req.Res <- defs.PathSourceStaticSetReadyRes{Err: fmt.Errorf("terminated")}
+	}
+}
+
+// staticSourceHandlerSetNotReady is called by staticSourceHandler.
+func (ss *sharedStaticSource) staticSourceHandlerSetNotReady(
+	staticSourceHandlerCtx context.Context, req defs.PathSourceStaticSetNotReadyReq,
+) {
+	select {
+	case ss.chSetNotReady <- req:
+
+	case <-ss.ctx.Done():
+		close(req.Res)
+
+	case <-staticSourceHandlerCtx.Done():
+		close(req.Res)
+	}
+}
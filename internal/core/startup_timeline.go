@@ -0,0 +1,62 @@
+package core
+
+import (
+	"sync"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/defs"
+)
+
+// startupTimeline records how much time each phase of the startup takes.
+type startupTimeline struct {
+	mutex    sync.RWMutex
+	start    time.Time
+	last     time.Time
+	phases   []defs.APIStartupPhase
+	finished bool
+}
+
+func (t *startupTimeline) initialize() {
+	t.start = time.Now()
+	t.last = t.start
+}
+
+// mark ends the current phase. It does nothing after the startup has finished,
+// in order to allow calling it from code that is also used when reloading.
+func (t *startupTimeline) mark(name string) {
+	t.mutex.Lock()
+	defer t.mutex.Unlock()
+
+	if t.finished {
+		return
+	}
+
+	now := time.Now()
+
+	t.phases = append(t.phases, defs.APIStartupPhase{
+		Name:     name,
+		Start:    t.last,
+		Duration: now.Sub(t.last).Seconds(),
+	})
+	t.last = now
+}
+
+func (t *startupTimeline) finish() time.Duration {
+	t.mutex.Lock()
+	defer t.mutex.Unlock()
+
+	t.finished = true
+
+	return t.last.Sub(t.start)
+}
+
+func (t *startupTimeline) apiDescribe() *defs.APIStartupTimeline {
+	t.mutex.RLock()
+	defer t.mutex.RUnlock()
+
+	return &defs.APIStartupTimeline{
+		Start:    t.start,
+		Duration: t.last.Sub(t.start).Seconds(),
+		Phases:   append([]defs.APIStartupPhase(nil), t.phases...),
+	}
+}
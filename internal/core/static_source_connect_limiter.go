@@ -0,0 +1,36 @@
+package core
+
+import (
+	"context"
+)
+
+// staticSourceConnectLimiter limits the number of static sources that are connecting at the same time.
+// A nil limiter does not limit anything.
+type staticSourceConnectLimiter struct {
+	slots chan struct{}
+}
+
+func newStaticSourceConnectLimiter(maxConnecting int) *staticSourceConnectLimiter {
+	if maxConnecting == 0 {
+		return nil
+	}
+
+	return &staticSourceConnectLimiter{
+		slots: make(chan struct{}, maxConnecting),
+	}
+}
+
+// acquire waits for a free slot. It returns false if the context is canceled before.
+func (l *staticSourceConnectLimiter) acquire(ctx context.Context) bool {
+	select {
+	case l.slots <- struct{}{}:
+		return true
+	case <-ctx.Done():
+		return false
+	}
+}
+
+// release frees a slot acquired with acquire().
+func (l *staticSourceConnectLimiter) release() {
+	<-l.slots
+}
@@ -0,0 +1,555 @@
+package core
+
+import (
+	"context"
+	"fmt"
+	"strconv"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/gortsplib/v4/pkg/sdp"
+
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/stream"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+func unitBase(u unit.Unit) *unit.Base {
+	switch tunit := u.(type) {
+	case *unit.AC3:
+		return &tunit.Base
+	case *unit.AV1:
+		return &tunit.Base
+	case *unit.G711:
+		return &tunit.Base
+	case *unit.Generic:
+		return &tunit.Base
+	case *unit.H264:
+		return &tunit.Base
+	case *unit.H265:
+		return &tunit.Base
+	case *unit.LPCM:
+		return &tunit.Base
+	case *unit.MJPEG:
+		return &tunit.Base
+	case *unit.MPEG1Audio:
+		return &tunit.Base
+	case *unit.MPEG1Video:
+		return &tunit.Base
+	case *unit.MPEG4Audio:
+		return &tunit.Base
+	case *unit.MPEG4Video:
+		return &tunit.Base
+	case *unit.Opus:
+		return &tunit.Base
+	case *unit.VP8:
+		return &tunit.Base
+	case *unit.VP9:
+		return &tunit.Base
+	}
+	return nil
+}
+
+// failoverDescription returns a copy of the description of a source,
+// that is used as description of the path.
+// A copy is needed since formats are updated by the stream that uses them.
+func failoverDescription(desc *description.Session) (*description.Session, error) {
+	byts, err := desc.Marshal(false)
+	if err != nil {
+		return nil, err
+	}
+
+	var sd sdp.SessionDescription
+	err = sd.Unmarshal(byts)
+	if err != nil {
+		return nil, err
+	}
+
+	var ret description.Session
+	err = ret.Unmarshal(&sd)
+	if err != nil {
+		return nil, err
+	}
+
+	// RTP packets of the path are generated again, in order to keep them continuous
+	// when the source changes. This is not possible with generic formats.
+	var medias []*description.Media
+
+	for _, medi := range ret.Medias {
+		var formats []format.Format
+
+		for _, forma := range medi.Formats {
+			if _, ok := forma.(*format.Generic); !ok {
+				formats = append(formats, forma)
+			}
+		}
+
+		if len(formats) != 0 {
+			medi.Formats = formats
+			medias = append(medias, medi)
+		}
+	}
+
+	if len(medias) == 0 {
+		return nil, fmt.Errorf("source has no supported tracks")
+	}
+
+	ret.Medias = medias
+
+	return &ret, nil
+}
+
+type staticSourceFailoverTrack struct {
+	medi      *description.Media
+	forma     format.Format
+	pathMedi  *description.Media
+	pathForma format.Format
+}
+
+// failoverTracks associates every format of the path with a format of a source with the same codec.
+func failoverTracks(pathDesc *description.Session, desc *description.Session) []staticSourceFailoverTrack {
+	var ret []staticSourceFailoverTrack
+	used := make(map[format.Format]struct{})
+
+	for _, pathMedi := range pathDesc.Medias {
+		for _, pathForma := range pathMedi.Formats {
+		outer:
+			for _, medi := range desc.Medias {
+				if medi.Type != pathMedi.Type {
+					continue
+				}
+
+				for _, forma := range medi.Formats {
+					if _, ok := used[forma]; !ok && forma.Codec() == pathForma.Codec() {
+						used[forma] = struct{}{}
+						ret = append(ret, staticSourceFailoverTrack{
+							medi:      medi,
+							forma:     forma,
+							pathMedi:  pathMedi,
+							pathForma: pathForma,
+						})
+						break outer
+					}
+				}
+			}
+		}
+	}
+
+	return ret
+}
+
+func failoverMemberConf(pconf *conf.Path, source string) *conf.Path {
+	ret := pconf.Clone()
+	ret.Source = source
+	ret.SourceAlternates = nil
+	return ret
+}
+
+type staticSourceFailoverSetReadyReq struct {
+	member *staticSourceFailoverMember
+	req    defs.PathSourceStaticSetReadyReq
+}
+
+type staticSourceFailoverSetNotReadyReq struct {
+	member *staticSourceFailoverMember
+	req    defs.PathSourceStaticSetNotReadyReq
+}
+
+// staticSourceFailoverMember is the main source or an alternate source of a path.
+type staticSourceFailoverMember struct {
+	index    int
+	source   string
+	failover *staticSourceFailover
+
+	handler  *staticSourceHandler
+	hasVideo bool
+
+	// owned by staticSourceFailover.run()
+	stream *stream.Stream
+	writer *asyncwriter.Writer
+
+	// protected by staticSourceFailover.mutex
+	offset         time.Duration
+	formatsStarted map[format.Format]struct{}
+}
+
+func (m *staticSourceFailoverMember) name() string {
+	if m.index == 0 {
+		return "main source"
+	}
+	return "alternate source " + strconv.FormatInt(int64(m.index), 10)
+}
+
+// Log implements logger.Writer.
+func (m *staticSourceFailoverMember) Log(level logger.Level, format string, args ...interface{}) {
+	m.failover.parent.Log(level, format, logger.WithField(logger.Module(m.name()), args)...)
+}
+
+// staticSourceHandlerSetReady is called by staticSourceHandler.
+func (m *staticSourceFailoverMember) staticSourceHandlerSetReady(
+	staticSourceHandlerCtx context.Context, req defs.PathSourceStaticSetReadyReq,
+) {
+	select {
+	case m.failover.chMemberSetReady <- staticSourceFailoverSetReadyReq{member: m, req: req}:
+
+	case <-m.failover.ctx.Done():
+		req.Res <- defs.PathSourceStaticSetReadyRes{Err: fmt.Errorf("terminated")}
+
+	case <-staticSourceHandlerCtx.Done():
+		req.Res <- defs.PathSourceStaticSetReadyRes{Err: fmt.Errorf("terminated")}
+	}
+}
+
+// staticSourceHandlerSetNotReady is called by staticSourceHandler.
+func (m *staticSourceFailoverMember) staticSourceHandlerSetNotReady(
+	staticSourceHandlerCtx context.Context, req defs.PathSourceStaticSetNotReadyReq,
+) {
+	select {
+	case m.failover.chMemberSetNotReady <- staticSourceFailoverSetNotReadyReq{member: m, req: req}:
+
+	case <-m.failover.ctx.Done():
+		close(req.Res)
+
+	case <-staticSourceHandlerCtx.Done():
+		close(req.Res)
+	}
+}
+
+// staticSourceFailover keeps the main source of a path and its alternate sources connected.
+// Each source writes into a private stream. Units of the active source are copied into the stream
+// of the path, with timestamps rebased, therefore readers stay attached when the active source changes.
+type staticSourceFailover struct {
+	parent *staticSourceHandler
+
+	ctx       context.Context
+	ctxCancel func()
+	members   []*staticSourceFailoverMember
+	desc      *description.Session
+
+	mutex         sync.Mutex
+	stream        *stream.Stream
+	active        *staticSourceFailoverMember
+	next          *staticSourceFailoverMember
+	ptsWritten    bool
+	lastPTS       time.Duration
+	lastWriteTime time.Time
+
+	// in
+	chMemberSetReady    chan staticSourceFailoverSetReadyReq
+	chMemberSetNotReady chan staticSourceFailoverSetNotReadyReq
+
+	// out
+	done chan struct{}
+}
+
+func (fo *staticSourceFailover) initialize() {
+	fo.ctx, fo.ctxCancel = context.WithCancel(context.Background())
+	fo.chMemberSetReady = make(chan staticSourceFailoverSetReadyReq)
+	fo.chMemberSetNotReady = make(chan staticSourceFailoverSetNotReadyReq)
+	fo.done = make(chan struct{})
+
+	sources := append([]string{fo.parent.conf.Source}, fo.parent.conf.SourceAlternates...)
+
+	for i, source := range sources {
+		m := &staticSourceFailoverMember{
+			index:    i,
+			source:   source,
+			failover: fo,
+		}
+		m.handler = &staticSourceHandler{
+			conf:              failoverMemberConf(fo.parent.conf, source),
+			pathName:          fo.parent.pathName,
+			logLevel:          fo.parent.logLevel,
+			readTimeout:       fo.parent.readTimeout,
+			writeTimeout:      fo.parent.writeTimeout,
+			writeQueueSize:    fo.parent.writeQueueSize,
+			udpMaxPayloadSize: fo.parent.udpMaxPayloadSize,
+			matches:           fo.parent.matches,
+			relayClients:      fo.parent.relayClients,
+			connectLimiter:    fo.parent.connectLimiter,
+			memoryBudget:      fo.parent.memoryBudget,
+			parent:            m,
+		}
+		m.handler.initialize()
+		fo.members = append(fo.members, m)
+	}
+
+	go fo.run()
+
+	for _, m := range fo.members {
+		m.handler.start(false, fo.parent.query)
+	}
+}
+
+func (fo *staticSourceFailover) close() {
+	for _, m := range fo.members {
+		m.handler.close("path source stopped")
+	}
+
+	fo.ctxCancel()
+	<-fo.done
+}
+
+func (fo *staticSourceFailover) reloadConf(newConf *conf.Path) {
+	for _, m := range fo.members {
+		m.handler.reloadConf(failoverMemberConf(newConf, m.source))
+	}
+}
+
+func (fo *staticSourceFailover) errors() uint64 {
+	n := uint64(0)
+	for _, m := range fo.members {
+		n += m.handler.errors()
+	}
+	return n
+}
+
+func (fo *staticSourceFailover) run() {
+	defer close(fo.done)
+
+	for {
+		select {
+		case req := <-fo.chMemberSetReady:
+			fo.doMemberSetReady(req)
+
+		case req := <-fo.chMemberSetNotReady:
+			fo.detach(req.member)
+			close(req.req.Res)
+			fo.selectActive()
+
+		case <-fo.ctx.Done():
+			for _, m := range fo.members {
+				fo.detach(m)
+			}
+			return
+		}
+	}
+}
+
+func (fo *staticSourceFailover) doMemberSetReady(req staticSourceFailoverSetReadyReq) {
+	m := req.member
+
+	strm, err := stream.New(
+		fo.parent.udpMaxPayloadSize,
+		req.req.Desc,
+		req.req.GenerateRTPPackets,
+		m,
+	)
+	if err != nil {
+		req.req.Res <- defs.PathSourceStaticSetReadyRes{Err: err}
+		return
+	}
+
+	strm.SetMemoryBudget(fo.parent.memoryBudget)
+
+	if fo.parent.conf.RTPJitterBuffer {
+		strm.EnableJitterBuffer(
+			time.Duration(fo.parent.conf.RTPJitterBufferMinDelay),
+			time.Duration(fo.parent.conf.RTPJitterBufferMaxDelay))
+	}
+
+	if fo.desc == nil {
+		err = fo.setPathReady(req.req.Desc)
+		if err != nil {
+			strm.Close()
+			req.req.Res <- defs.PathSourceStaticSetReadyRes{Err: err}
+			return
+		}
+	}
+
+	tracks := failoverTracks(fo.desc, req.req.Desc)
+	if len(tracks) == 0 {
+		strm.Close()
+		req.req.Res <- defs.PathSourceStaticSetReadyRes{
+			Err: fmt.Errorf("source has no tracks in common with the path"),
+		}
+		return
+	}
+
+	m.stream = strm
+	m.writer = asyncwriter.New(fo.parent.writeQueueSize, m)
+	m.hasVideo = false
+
+	for _, track := range tracks {
+		ctrack := track
+		if ctrack.medi.Type == description.MediaTypeVideo {
+			m.hasVideo = true
+		}
+
+		strm.AddReader(m.writer, ctrack.medi, ctrack.forma, func(u unit.Unit) error {
+			fo.writeUnit(m, ctrack, u)
+			return nil
+		})
+	}
+
+	m.writer.Start()
+
+	req.req.Res <- defs.PathSourceStaticSetReadyRes{Stream: strm}
+
+	fo.selectActive()
+}
+
+func (fo *staticSourceFailover) setPathReady(desc *description.Session) error {
+	pathDesc, err := failoverDescription(desc)
+	if err != nil {
+		return err
+	}
+
+	req := defs.PathSourceStaticSetReadyReq{
+		Desc:               pathDesc,
+		GenerateRTPPackets: true,
+		Res:                make(chan defs.PathSourceStaticSetReadyRes, 1),
+	}
+	fo.parent.parent.staticSourceHandlerSetReady(fo.parent.ctx, req)
+	res := <-req.Res
+	if res.Err != nil {
+		return res.Err
+	}
+
+	fo.parent.Log(logger.Info, "ready: %s", defs.MediasInfo(pathDesc.Medias))
+
+	fo.desc = pathDesc
+
+	fo.mutex.Lock()
+	fo.stream = res.Stream
+	fo.ptsWritten = false
+	fo.mutex.Unlock()
+
+	return nil
+}
+
+func (fo *staticSourceFailover) setPathNotReady() {
+	fo.mutex.Lock()
+	fo.stream = nil
+	fo.active = nil
+	fo.next = nil
+	fo.mutex.Unlock()
+
+	fo.desc = nil
+
+	req := defs.PathSourceStaticSetNotReadyReq{
+		Res: make(chan struct{}),
+	}
+	fo.parent.parent.staticSourceHandlerSetNotReady(fo.parent.ctx, req)
+	<-req.Res
+}
+
+func (fo *staticSourceFailover) detach(m *staticSourceFailoverMember) {
+	if m.stream == nil {
+		return
+	}
+
+	fo.mutex.Lock()
+	if fo.active == m {
+		fo.active = nil
+	}
+	if fo.next == m {
+		fo.next = nil
+	}
+	fo.mutex.Unlock()
+
+	m.stream.RemoveReader(m.writer)
+	m.writer.Stop()
+	m.stream.Close()
+	m.stream = nil
+}
+
+// selectActive selects the first ready source.
+// The path is set as not ready when there are no ready sources.
+func (fo *staticSourceFailover) selectActive() {
+	var best *staticSourceFailoverMember
+	for _, m := range fo.members {
+		if m.stream != nil {
+			best = m
+			break
+		}
+	}
+
+	if best == nil {
+		if fo.desc != nil {
+			fo.setPathNotReady()
+		}
+		return
+	}
+
+	fo.mutex.Lock()
+	defer fo.mutex.Unlock()
+
+	if fo.active == best {
+		fo.next = nil
+		return
+	}
+
+	// the new source replaces the active one when it provides a random access point.
+	fo.next = best
+}
+
+func (fo *staticSourceFailover) writeUnit(
+	m *staticSourceFailoverMember,
+	track staticSourceFailoverTrack,
+	u unit.Unit,
+) {
+	fo.mutex.Lock()
+	defer fo.mutex.Unlock()
+
+	if fo.stream == nil {
+		return
+	}
+
+	keyFrame, isVideo := stream.IsKeyFrame(u)
+
+	if m == fo.next {
+		if m.hasVideo && !keyFrame {
+			return
+		}
+
+		prev := fo.active
+		fo.active = m
+		fo.next = nil
+
+		// rebase timestamps in order to make them continue from the last written ones.
+		if fo.ptsWritten {
+			m.offset = fo.lastPTS + time.Since(fo.lastWriteTime) - u.GetPTS()
+		} else {
+			m.offset = 0
+		}
+		m.formatsStarted = make(map[format.Format]struct{})
+
+		if prev != nil || fo.ptsWritten {
+			fo.parent.Log(logger.Info, "switched to %s", m.name())
+		}
+	}
+
+	if m != fo.active {
+		return
+	}
+
+	// decoding of video formats must start from a key frame.
+	if _, ok := m.formatsStarted[track.pathForma]; !ok {
+		if isVideo && !keyFrame {
+			return
+		}
+		m.formatsStarted[track.pathForma] = struct{}{}
+	}
+
+	base := unitBase(u)
+	if base == nil {
+		// timestamps of unknown unit types can't be rebased.
+		return
+	}
+
+	base.PTS += m.offset
+
+	if !fo.ptsWritten || base.PTS > fo.lastPTS {
+		fo.ptsWritten = true
+		fo.lastPTS = base.PTS
+		fo.lastWriteTime = time.Now()
+	}
+
+	fo.stream.WriteUnit(track.pathMedi, track.pathForma, u)
+}
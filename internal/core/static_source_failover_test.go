@@ -0,0 +1,259 @@
+package core
+
+import (
+	"testing"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4"
+	"github.com/bluenviron/gortsplib/v4/pkg/base"
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
+	"github.com/pion/rtp"
+	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/test"
+)
+
+// failoverTestSource is a RTSP server that provides a H264 stream
+// whose frames contain the ID of the source.
+type failoverTestSource struct {
+	s         *gortsplib.Server
+	stream    *gortsplib.ServerStream
+	terminate chan struct{}
+	done      chan struct{}
+}
+
+func newFailoverTestSource(t *testing.T, address string, id byte, baseTimestamp uint32) *failoverTestSource {
+	ts := &failoverTestSource{
+		terminate: make(chan struct{}),
+		done:      make(chan struct{}),
+	}
+
+	ts.s = &gortsplib.Server{
+		Handler: &testServer{
+			onDescribe: func(_ *gortsplib.ServerHandlerOnDescribeCtx,
+			) (*base.Response, *gortsplib.ServerStream, error) {
+				return &base.Response{
+					StatusCode: base.StatusOK,
+				}, ts.stream, nil
+			},
+			onSetup: func(_ *gortsplib.ServerHandlerOnSetupCtx) (*base.Response, *gortsplib.ServerStream, error) {
+				return &base.Response{
+					StatusCode: base.StatusOK,
+				}, ts.stream, nil
+			},
+			onPlay: func(_ *gortsplib.ServerHandlerOnPlayCtx) (*base.Response, error) {
+				return &base.Response{
+					StatusCode: base.StatusOK,
+				}, nil
+			},
+		},
+		RTSPAddress: address,
+	}
+
+	err := ts.s.Start()
+	require.NoError(t, err)
+
+	medi := test.UniqueMediaH264()
+	ts.stream = gortsplib.NewServerStream(ts.s, &description.Session{Medias: []*description.Media{medi}})
+
+	// write a frame every 10ms and a key frame every 5 frames.
+	go func() {
+		defer close(ts.done)
+
+		ticker := time.NewTicker(10 * time.Millisecond)
+		defer ticker.Stop()
+
+		for i := 0; ; i++ {
+			select {
+			case <-ticker.C:
+			case <-ts.terminate:
+				return
+			}
+
+			typ := byte(h264.NALUTypeNonIDR)
+			if (i % 5) == 0 {
+				typ = byte(h264.NALUTypeIDR)
+			}
+
+			ts.stream.WritePacketRTP(medi, &rtp.Packet{ //nolint:errcheck
+				Header: rtp.Header{
+					Version:        2,
+					Marker:         true,
+					PayloadType:    96,
+					SequenceNumber: uint16(i),
+					Timestamp:      baseTimestamp + uint32(i)*900,
+					SSRC:           uint32(id),
+				},
+				Payload: []byte{typ, id},
+			})
+		}
+	}()
+
+	return ts
+}
+
+func (ts *failoverTestSource) close() {
+	close(ts.terminate)
+	<-ts.done
+	ts.stream.Close()
+	ts.s.Close()
+}
+
+type failoverTestFrame struct {
+	pts      time.Duration
+	sourceID byte
+	keyFrame bool
+}
+
+func TestStaticSourceFailover(t *testing.T) {
+	mainSource := newFailoverTestSource(t, "127.0.0.1:8555", 1, 100000)
+
+	altSource := newFailoverTestSource(t, "127.0.0.1:8556", 2, 3000000000)
+	defer altSource.close()
+
+	p, ok := newInstance("paths:\n" +
+		"  test:\n" +
+		"    source: rtsp://127.0.0.1:8555/main\n" +
+		"    sourceAlternates: [rtsp://127.0.0.1:8556/alt]\n" +
+		"    sourceRetryMinPause: 100ms\n" +
+		"    sourceRetryMaxPause: 100ms\n" +
+		"    rtspTransport: tcp\n")
+	require.Equal(t, true, ok)
+	defer p.Close()
+
+	u, err := base.ParseURL("rtsp://127.0.0.1:8554/test")
+	require.NoError(t, err)
+
+	reader := gortsplib.Client{}
+
+	err = reader.Start(u.Scheme, u.Host)
+	require.NoError(t, err)
+	defer reader.Close()
+
+	var desc *description.Session
+
+	for i := 0; ; i++ {
+		desc, _, err = reader.Describe(u)
+		if err == nil {
+			break
+		}
+		require.Less(t, i, 50)
+		time.Sleep(100 * time.Millisecond)
+	}
+
+	err = reader.SetupAll(desc.BaseURL, desc.Medias)
+	require.NoError(t, err)
+
+	forma := desc.Medias[0].Formats[0].(*format.H264)
+	dec, err := forma.CreateDecoder()
+	require.NoError(t, err)
+
+	frames := make(chan failoverTestFrame, 1024)
+
+	reader.OnPacketRTP(desc.Medias[0], forma, func(pkt *rtp.Packet) {
+		pts, ok := reader.PacketPTS(desc.Medias[0], pkt)
+		if !ok {
+			return
+		}
+
+		au, err := dec.Decode(pkt)
+		if err != nil {
+			return
+		}
+
+		for _, nalu := range au {
+			typ := h264.NALUType(nalu[0] & 0x1f)
+			if typ == h264.NALUTypeIDR || typ == h264.NALUTypeNonIDR {
+				frames <- failoverTestFrame{
+					pts:      pts,
+					sourceID: nalu[1],
+					keyFrame: typ == h264.NALUTypeIDR,
+				}
+			}
+		}
+	})
+
+	_, err = reader.Play(nil)
+	require.NoError(t, err)
+
+	var prev *failoverTestFrame
+
+	// reads frames until the given source is active,
+	// checking that timestamps are rebased and monotonic.
+	waitSource := func(sourceID byte) {
+		count := 0
+
+		for count < 10 {
+			select {
+			case fr := <-frames:
+				if prev != nil {
+					require.Greater(t, fr.pts, prev.pts)
+					require.Less(t, fr.pts-prev.pts, 2*time.Second)
+
+					// the switch happens at a key frame.
+					if fr.sourceID != prev.sourceID {
+						require.Equal(t, true, fr.keyFrame)
+					}
+				}
+				prev = &fr
+
+				if fr.sourceID == sourceID {
+					count++
+				}
+
+			case <-time.After(5 * time.Second):
+				t.Errorf("source %d did not become active", sourceID)
+				t.FailNow()
+			}
+		}
+	}
+
+	waitSource(1)
+
+	// kill the main source, the alternate one is used.
+	mainSource.close()
+	waitSource(2)
+
+	// restore the main source, it replaces the alternate one.
+	mainSource = newFailoverTestSource(t, "127.0.0.1:8555", 1, 500000)
+	defer mainSource.close()
+	waitSource(1)
+}
+
+func TestStaticSourceFailoverTracks(t *testing.T) {
+	pathDesc := &description.Session{
+		Medias: []*description.Media{
+			{
+				Type:    description.MediaTypeVideo,
+				Formats: []format.Format{&format.H264{PayloadTyp: 96, PacketizationMode: 1}},
+			},
+			{
+				Type:    description.MediaTypeAudio,
+				Formats: []format.Format{&format.Opus{PayloadTyp: 97, ChannelCount: 2}},
+			},
+		},
+	}
+
+	desc := &description.Session{
+		Medias: []*description.Media{
+			{
+				Type:    description.MediaTypeAudio,
+				Formats: []format.Format{&format.G711{PayloadTyp: 0, MULaw: true, SampleRate: 8000, ChannelCount: 1}},
+			},
+			{
+				Type:    description.MediaTypeVideo,
+				Formats: []format.Format{&format.H264{PayloadTyp: 98, PacketizationMode: 1}},
+			},
+		},
+	}
+
+	tracks := failoverTracks(pathDesc, desc)
+	require.Equal(t, []staticSourceFailoverTrack{{
+		medi:      desc.Medias[1],
+		forma:     desc.Medias[1].Formats[0],
+		pathMedi:  pathDesc.Medias[0],
+		pathForma: pathDesc.Medias[0].Formats[0],
+	}}, tracks)
+}
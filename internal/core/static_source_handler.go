@@ -3,14 +3,21 @@ package core
 import (
 	"context"
 	"fmt"
+	"math/rand"
 	"strconv"
 	"strings"
+	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
+	"github.com/bluenviron/mediamtx/internal/profiler"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
 	hlssource "github.com/bluenviron/mediamtx/internal/staticsources/hls"
+	relaysource "github.com/bluenviron/mediamtx/internal/staticsources/relay"
 	rpicamerasource "github.com/bluenviron/mediamtx/internal/staticsources/rpicamera"
 	rtmpsource "github.com/bluenviron/mediamtx/internal/staticsources/rtmp"
 	rtspsource "github.com/bluenviron/mediamtx/internal/staticsources/rtsp"
@@ -19,10 +26,6 @@ import (
 	webrtcsource "github.com/bluenviron/mediamtx/internal/staticsources/webrtc"
 )
 
-const (
-	staticSourceHandlerRetryPause = 5 * time.Second
-)
-
 func resolveSource(s string, matches []string, query string) string {
 	if len(matches) > 1 {
 		for i, ma := range matches[1:] {
@@ -35,6 +38,29 @@ func resolveSource(s string, matches []string, query string) string {
 	return s
 }
 
+// staticSourceRetryPause returns the pause before the given retry of a failed source.
+// The first retry is immediate, then the pause starts from sourceRetryMinPause and is doubled
+// after every failure, up to sourceRetryMaxPause. A random fraction of the pause is removed,
+// in order to prevent sources that failed together from being retried together.
+func staticSourceRetryPause(pconf *conf.Path, attempt int, rnd float64) time.Duration {
+	if attempt == 0 {
+		return 0
+	}
+
+	maxPause := time.Duration(pconf.SourceRetryMaxPause)
+	pause := time.Duration(pconf.SourceRetryMinPause)
+
+	for i := 1; i < attempt && pause < maxPause; i++ {
+		pause *= 2
+	}
+
+	if pause > maxPause {
+		pause = maxPause
+	}
+
+	return pause - time.Duration(pconf.SourceRetryJitter*rnd*float64(pause))
+}
+
 type staticSourceHandlerParent interface {
 	logger.Writer
 	staticSourceHandlerSetReady(context.Context, defs.PathSourceStaticSetReadyReq)
@@ -43,19 +69,30 @@ type staticSourceHandlerParent interface {
 
 // staticSourceHandler is a static source handler.
 type staticSourceHandler struct {
-	conf           *conf.Path
-	logLevel       conf.LogLevel
-	readTimeout    conf.StringDuration
-	writeTimeout   conf.StringDuration
-	writeQueueSize int
-	matches        []string
-	parent         staticSourceHandlerParent
-
-	ctx       context.Context
-	ctxCancel func()
-	instance  defs.StaticSource
-	running   bool
-	query     string
+	conf              *conf.Path
+	pathName          string
+	logLevel          conf.LogLevel
+	readTimeout       conf.StringDuration
+	writeTimeout      conf.StringDuration
+	writeQueueSize    int
+	udpMaxPayloadSize int
+	matches           []string
+	startDelay        time.Duration
+	sharedSources     *sharedStaticSources // optional
+	relayClients      *relay.ClientPool
+	connectLimiter    *staticSourceConnectLimiter // optional
+	memoryBudget      *membudget.Budget           // optional
+	parent            staticSourceHandlerParent
+
+	ctx          context.Context
+	ctxCancel    func()
+	instance     defs.StaticSource
+	running      bool
+	query        string
+	errorCount   *uint64
+	mutex        sync.Mutex
+	sharedSource *sharedStaticSource
+	failover     *staticSourceFailover
 
 	// in
 	chReloadConf          chan *conf.Path
@@ -67,6 +104,7 @@ type staticSourceHandler struct {
 }
 
 func (s *staticSourceHandler) initialize() {
+	s.errorCount = new(uint64)
 	s.chReloadConf = make(chan *conf.Path)
 	s.chInstanceSetReady = make(chan defs.PathSourceStaticSetReadyReq)
 	s.chInstanceSetNotReady = make(chan defs.PathSourceStaticSetNotReadyReq)
@@ -115,6 +153,13 @@ func (s *staticSourceHandler) initialize() {
 			Parent:      s,
 		}
 
+	case strings.HasPrefix(s.conf.Source, "relay://"):
+		s.instance = &relaysource.Source{
+			ReadTimeout: s.readTimeout,
+			Clients:     s.relayClients,
+			Parent:      s,
+		}
+
 	case s.conf.Source == "rpiCamera":
 		s.instance = &rpicamerasource.Source{
 			LogLevel: s.logLevel,
@@ -137,6 +182,9 @@ func (s *staticSourceHandler) start(onDemand bool, query string) {
 
 	s.running = true
 	s.query = query
+	if onDemand {
+		s.startDelay = 0
+	}
 	s.ctx, s.ctxCancel = context.WithCancel(context.Background())
 	s.done = make(chan struct{})
 
@@ -171,15 +219,63 @@ func (s *staticSourceHandler) Log(level logger.Level, format string, args ...int
 	s.parent.Log(level, format, args...)
 }
 
+// isShared returns whether the upstream connection can be shared with other paths.
+func (s *staticSourceHandler) isShared() bool {
+	return s.sharedSources != nil && s.conf.SourceShareConnection
+}
+
+// waitStartDelay waits for the start delay.
+// The first start of a source that is not on demand can be delayed,
+// in order to spread connections when many sources are started together.
+func (s *staticSourceHandler) waitStartDelay() bool {
+	if s.startDelay == 0 {
+		return true
+	}
+
+	t := time.NewTimer(s.startDelay)
+	s.startDelay = 0
+
+	select {
+	case <-t.C:
+		return true
+	case <-s.ctx.Done():
+		t.Stop()
+		return false
+	}
+}
+
 func (s *staticSourceHandler) run() {
 	defer close(s.done)
 
+	profiler.SetGoroutineLabels(profiler.Labels{
+		Path:     s.pathName,
+		Protocol: profiler.SourceProtocol(s.conf.Source),
+		Role:     "source",
+	})
+
+	if len(s.conf.SourceAlternates) != 0 {
+		s.runFailover()
+		return
+	}
+
+	if s.isShared() {
+		s.runShared()
+		return
+	}
+
 	var runCtx context.Context
 	var runCtxCancel func()
 	runErr := make(chan error)
 	runReloadConf := make(chan *conf.Path)
+	running := false
+
+	var slotCtx context.Context
+	var slotCtxCancel func()
+	slotAcquired := make(chan struct{})
+	waitingSlot := false
+	holdingSlot := false
 
-	recreate := func() {
+	run := func() {
 		resolvedSource := resolveSource(s.conf.Source, s.matches, s.query)
 
 		runCtx, runCtxCancel = context.WithCancel(context.Background())
@@ -191,22 +287,76 @@ func (s *staticSourceHandler) run() {
 				ReloadConf:     runReloadConf,
 			})
 		}()
+		running = true
 	}
 
-	recreate()
+	// a connection slot is held from the start of the source until it is ready or it fails.
+	connect := func() {
+		if s.connectLimiter == nil {
+			run()
+			return
+		}
 
-	recreating := false
-	recreateTimer := emptyTimer()
+		slotCtx, slotCtxCancel = context.WithCancel(context.Background())
+		waitingSlot = true
+
+		go func(ctx context.Context) {
+			if s.connectLimiter.acquire(ctx) {
+				select {
+				case slotAcquired <- struct{}{}:
+				case <-ctx.Done():
+					s.connectLimiter.release()
+				}
+			}
+		}(slotCtx)
+	}
+
+	releaseSlot := func() {
+		if holdingSlot {
+			s.connectLimiter.release()
+			holdingSlot = false
+		}
+	}
+
+	attempt := 0
+	retryTimer := emptyTimer()
+
+	// the first start of a source that is not on demand can be delayed,
+	// in order to spread connections when many sources are started together.
+	if s.startDelay != 0 {
+		retryTimer = time.NewTimer(s.startDelay)
+		s.startDelay = 0
+	} else {
+		connect()
+	}
 
 	for {
 		select {
+		case <-slotAcquired:
+			slotCtxCancel()
+			waitingSlot = false
+			holdingSlot = true
+			run()
+
 		case err := <-runErr:
 			runCtxCancel()
+			running = false
+			releaseSlot()
+			atomic.AddUint64(s.errorCount, 1)
 			s.instance.Log(logger.Error, err.Error())
-			recreating = true
-			recreateTimer = time.NewTimer(staticSourceHandlerRetryPause)
+
+			pause := staticSourceRetryPause(s.conf, attempt, rand.Float64())
+			attempt++
+
+			if pause == 0 {
+				connect()
+			} else {
+				retryTimer = time.NewTimer(pause)
+			}
 
 		case req := <-s.chInstanceSetReady:
+			attempt = 0
+			releaseSlot()
 			s.parent.staticSourceHandlerSetReady(s.ctx, req)
 
 		case req := <-s.chInstanceSetNotReady:
@@ -214,7 +364,7 @@ func (s *staticSourceHandler) run() {
 
 		case newConf := <-s.chReloadConf:
 			s.conf = newConf
-			if !recreating {
+			if running {
 				cReloadConf := runReloadConf
 				cInnerCtx := runCtx
 				go func() {
@@ -225,15 +375,106 @@ func (s *staticSourceHandler) run() {
 				}()
 			}
 
-		case <-recreateTimer.C:
-			recreate()
-			recreating = false
+		case <-retryTimer.C:
+			connect()
 
 		case <-s.ctx.Done():
-			if !recreating {
+			retryTimer.Stop()
+			if waitingSlot {
+				slotCtxCancel()
+			}
+			if running {
 				runCtxCancel()
 				<-runErr
 			}
+			releaseSlot()
+			return
+		}
+	}
+}
+
+// runShared attaches the path to a connection that is shared with other paths
+// that have the same source, instead of opening a dedicated one.
+func (s *staticSourceHandler) runShared() {
+	if !s.waitStartDelay() {
+		return
+	}
+
+	resolvedSource := resolveSource(s.conf.Source, s.matches, s.query)
+	key := sharedStaticSourceKey(resolvedSource, s.conf)
+
+	attach := func() *sharedStaticSource {
+		ss := s.sharedSources.acquire(key, resolvedSource, s)
+		ss.subscribe(s)
+
+		s.mutex.Lock()
+		s.sharedSource = ss
+		s.mutex.Unlock()
+
+		return ss
+	}
+
+	detach := func(ss *sharedStaticSource) {
+		s.mutex.Lock()
+		s.sharedSource = nil
+		s.mutex.Unlock()
+
+		ss.unsubscribe(s)
+		s.sharedSources.release(ss)
+	}
+
+	ss := attach()
+
+	for {
+		select {
+		case newConf := <-s.chReloadConf:
+			s.conf = newConf
+
+			// when settings that identify the connection change,
+			// move the path to the connection that matches the new settings.
+			newResolvedSource := resolveSource(newConf.Source, s.matches, s.query)
+			newKey := sharedStaticSourceKey(newResolvedSource, newConf)
+			if newKey != key {
+				detach(ss)
+				resolvedSource, key = newResolvedSource, newKey
+				ss = attach()
+			}
+
+		case <-s.ctx.Done():
+			detach(ss)
+			return
+		}
+	}
+}
+
+// runFailover runs the main source together with alternate sources,
+// and switches between them without disconnecting readers.
+func (s *staticSourceHandler) runFailover() {
+	if !s.waitStartDelay() {
+		return
+	}
+
+	fo := &staticSourceFailover{
+		parent: s,
+	}
+	fo.initialize()
+
+	s.mutex.Lock()
+	s.failover = fo
+	s.mutex.Unlock()
+
+	for {
+		select {
+		case newConf := <-s.chReloadConf:
+			s.conf = newConf
+			fo.reloadConf(newConf)
+
+		case <-s.ctx.Done():
+			s.mutex.Lock()
+			s.failover = nil
+			s.mutex.Unlock()
+
+			fo.close()
 			return
 		}
 	}
@@ -254,6 +495,26 @@ func (s *staticSourceHandler) reloadConf(newConf *conf.Path) {
 	}()
 }
 
+// errors returns the number of times the source failed.
+// When the upstream connection is shared, failures of the shared connection are returned.
+// When there are alternate sources, failures of all sources are returned.
+func (s *staticSourceHandler) errors() uint64 {
+	s.mutex.Lock()
+	ss := s.sharedSource
+	fo := s.failover
+	s.mutex.Unlock()
+
+	if ss != nil {
+		return ss.handler.errors()
+	}
+
+	if fo != nil {
+		return fo.errors()
+	}
+
+	return atomic.LoadUint64(s.errorCount)
+}
+
 // APISourceDescribe instanceements source.
 func (s *staticSourceHandler) APISourceDescribe() defs.APIPathSourceOrReader {
 	return s.instance.APISourceDescribe()
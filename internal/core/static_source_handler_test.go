@@ -0,0 +1,35 @@
+package core
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+)
+
+func TestStaticSourceRetryPause(t *testing.T) {
+	pconf := &conf.Path{
+		SourceRetryMinPause: conf.StringDuration(1 * time.Second),
+		SourceRetryMaxPause: conf.StringDuration(10 * time.Second),
+		SourceRetryJitter:   0.5,
+	}
+
+	for _, ca := range []struct {
+		attempt int
+		rnd     float64
+		pause   time.Duration
+	}{
+		{0, 1, 0},
+		{1, 0, 1 * time.Second},
+		{2, 0, 2 * time.Second},
+		{4, 0, 8 * time.Second},
+		{5, 0, 10 * time.Second},
+		{100, 0, 10 * time.Second},
+		{3, 1, 2 * time.Second},
+		{3, 0.5, 3 * time.Second},
+	} {
+		require.Equal(t, ca.pause, staticSourceRetryPause(pconf, ca.attempt, ca.rnd))
+	}
+}
@@ -28,15 +28,29 @@ type APIPathSourceOrReader struct {
 
 // APIPath is a path.
 type APIPath struct {
-	Name          string                  `json:"name"`
-	ConfName      string                  `json:"confName"`
-	Source        *APIPathSourceOrReader  `json:"source"`
-	Ready         bool                    `json:"ready"`
-	ReadyTime     *time.Time              `json:"readyTime"`
-	Tracks        []string                `json:"tracks"`
-	BytesReceived uint64                  `json:"bytesReceived"`
-	BytesSent     uint64                  `json:"bytesSent"`
-	Readers       []APIPathSourceOrReader `json:"readers"`
+	Name               string                   `json:"name"`
+	ConfName           string                   `json:"confName"`
+	Source             *APIPathSourceOrReader   `json:"source"`
+	Ready              bool                     `json:"ready"`
+	ReadyTime          *time.Time               `json:"readyTime"`
+	Tracks             []string                 `json:"tracks"`
+	BytesReceived      uint64                   `json:"bytesReceived"`
+	BytesSent          uint64                   `json:"bytesSent"`
+	TranscodingCPUTime float64                  `json:"transcodingCPUTime"`
+	SourceErrors       uint64                   `json:"sourceErrors"`
+	JitterBuffer       *APIPathJitterBuffer     `json:"jitterBuffer"`
+	Readers            []APIPathSourceOrReader  `json:"readers"`
+	ReaderQueueDelays  map[string]*APIHistogram `json:"readerQueueDelays"`
+}
+
+// APIPathJitterBuffer contains statistics about jitter buffers of a path.
+type APIPathJitterBuffer struct {
+	PacketsReordered uint64  `json:"packetsReordered"`
+	PacketsLate      uint64  `json:"packetsLate"`
+	PacketsDuplicate uint64  `json:"packetsDuplicate"`
+	PacketsLost      uint64  `json:"packetsLost"`
+	ReorderDepth     uint64  `json:"reorderDepth"`
+	Delay            float64 `json:"delay"`
 }
 
 // APIPathList is a list of paths.
@@ -46,6 +60,107 @@ type APIPathList struct {
 	Items     []*APIPath `json:"items"`
 }
 
+// APIPathCPUEntry is the CPU time consumed by a role of a path.
+type APIPathCPUEntry struct {
+	Role     string  `json:"role"`
+	Protocol string  `json:"protocol"`
+	CPUTime  float64 `json:"cpuTime"`
+}
+
+// APIPathCPU is the CPU time consumed by a path.
+type APIPathCPU struct {
+	Name    string            `json:"name"`
+	CPUTime float64           `json:"cpuTime"`
+	Entries []APIPathCPUEntry `json:"entries"`
+}
+
+// APIPathCPUBreakdown is the CPU time consumed by each path during a sampling window.
+type APIPathCPUBreakdown struct {
+	Duration            float64       `json:"duration"`
+	CPUTime             float64       `json:"cpuTime"`
+	UnattributedCPUTime float64       `json:"unattributedCPUTime"`
+	Items               []*APIPathCPU `json:"items"`
+}
+
+// APIStaticSourceUpstreams contains statistics about upstream connections of static sources.
+type APIStaticSourceUpstreams struct {
+	Upstreams       int    `json:"upstreams"`
+	SharedUpstreams int    `json:"sharedUpstreams"`
+	Paths           int    `json:"paths"`
+	BytesReceived   uint64 `json:"bytesReceived"`
+	BytesSent       uint64 `json:"bytesSent"`
+}
+
+// APIPathEventType is the type of a path event.
+type APIPathEventType string
+
+// path event types.
+const (
+	APIPathEventTypeReady            APIPathEventType = "ready"
+	APIPathEventTypeNotReady         APIPathEventType = "notReady"
+	APIPathEventTypePublisherAdded   APIPathEventType = "publisherAdded"
+	APIPathEventTypePublisherRemoved APIPathEventType = "publisherRemoved"
+	APIPathEventTypeReaderAdded      APIPathEventType = "readerAdded"
+	APIPathEventTypeReaderRemoved    APIPathEventType = "readerRemoved"
+	APIPathEventTypeBytes            APIPathEventType = "bytes"
+	APIPathEventTypeOverflow         APIPathEventType = "overflow"
+)
+
+// APIPathEvent is a path event.
+type APIPathEvent struct {
+	Type          APIPathEventType       `json:"type"`
+	Time          time.Time              `json:"time"`
+	Path          string                 `json:"path,omitempty"`
+	Source        *APIPathSourceOrReader `json:"source,omitempty"`
+	Reader        *APIPathSourceOrReader `json:"reader,omitempty"`
+	Tracks        []string               `json:"tracks,omitempty"`
+	BytesReceived *uint64                `json:"bytesReceived,omitempty"`
+	BytesSent     *uint64                `json:"bytesSent,omitempty"`
+	Dropped       *uint64                `json:"dropped,omitempty"`
+}
+
+// APIHistogramBucket is a histogram bucket.
+type APIHistogramBucket struct {
+	Le    float64 `json:"le"`
+	Count uint64  `json:"count"`
+}
+
+// APIHistogram is a histogram of durations, in seconds.
+type APIHistogram struct {
+	Buckets []APIHistogramBucket `json:"buckets"`
+	Count   uint64               `json:"count"`
+	Sum     float64              `json:"sum"`
+}
+
+// APIStartupPhase is a phase of the startup.
+type APIStartupPhase struct {
+	Name     string    `json:"name"`
+	Start    time.Time `json:"start"`
+	Duration float64   `json:"duration"`
+}
+
+// APIStartupTimeline is the startup timeline.
+type APIStartupTimeline struct {
+	Start    time.Time         `json:"start"`
+	Duration float64           `json:"duration"`
+	Phases   []APIStartupPhase `json:"phases"`
+}
+
+// APIPathEventSubscription is a subscription to path events.
+type APIPathEventSubscription interface {
+	// Events returns the channel that receives events.
+	Events() <-chan *APIPathEvent
+
+	// Done returns a channel that is closed when the subscription is terminated.
+	Done() <-chan struct{}
+
+	// Dropped returns the number of events dropped since the last call.
+	Dropped() uint64
+
+	// Close closes the subscription.
+	Close()
+}
+
 // APIHLSMuxer is an HLS muxer.
 type APIHLSMuxer struct {
 	Path        string    `json:"path"`
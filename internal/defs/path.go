@@ -168,6 +168,7 @@ type PathSourceStaticSetReadyRes struct {
 type PathSourceStaticSetReadyReq struct {
 	Desc               *description.Session
 	GenerateRTPPackets bool
+	Stream             *stream.Stream // optional, an existing stream shared with other paths
 	Res                chan PathSourceStaticSetReadyRes
 }
 
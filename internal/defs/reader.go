@@ -1,7 +1,29 @@
 package defs
 
+import (
+	"net/url"
+	"strconv"
+)
+
 // Reader is an entity that can read a stream.
 type Reader interface {
 	Close()
 	APIReaderDescribe() APIPathSourceOrReader
 }
+
+// ReaderWithQueueDelay is a reader that measures how long data waits in its write queue.
+type ReaderWithQueueDelay interface {
+	Reader
+	APIReaderQueueDelay() *APIHistogram
+}
+
+// ReaderKeyFramesOnly returns whether the query of a reader asks for key frames only.
+func ReaderKeyFramesOnly(rawQuery string) bool {
+	q, err := url.ParseQuery(rawQuery)
+	if err != nil {
+		return false
+	}
+
+	v, _ := strconv.ParseBool(q.Get("keyframes"))
+	return v
+}
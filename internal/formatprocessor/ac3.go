@@ -73,6 +73,10 @@ func (t *formatProcessorAC3) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorAC3) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorAC3) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
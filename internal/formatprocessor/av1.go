@@ -74,6 +74,10 @@ func (t *formatProcessorAV1) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorAV1) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorAV1) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
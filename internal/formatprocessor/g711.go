@@ -75,6 +75,10 @@ func (t *formatProcessorG711) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorG711) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorG711) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
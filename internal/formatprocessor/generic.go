@@ -32,6 +32,9 @@ func (t *formatProcessorGeneric) ProcessUnit(_ unit.Unit) error {
 	return fmt.Errorf("using a generic unit without RTP is not supported")
 }
 
+func (t *formatProcessorGeneric) ResetDecoder() {
+}
+
 func (t *formatProcessorGeneric) ProcessRTPPacket(
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -187,6 +187,15 @@ func (t *formatProcessorH264) remuxAccessUnit(au [][]byte) [][]byte {
 					n += 2
 				}
 			}
+
+		case h264.NALUTypeSEI: // recovery point: prepend parameters, like key frames
+			if !isKeyFrame && h264IsRecoveryPoint(nalu) {
+				isKeyFrame = true
+
+				if t.format.SPS != nil && t.format.PPS != nil {
+					n += 2
+				}
+			}
 		}
 		n++
 	}
@@ -244,6 +253,10 @@ func (t *formatProcessorH264) ProcessUnit(uu unit.Unit) error {
 	return nil
 }
 
+func (t *formatProcessorH264) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorH264) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -0,0 +1,107 @@
+package formatprocessor
+
+import (
+	"errors"
+	"time"
+
+	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
+)
+
+// SEI payload type of recovery points (H264, D.1.8).
+const h264SEIPayloadTypeRecoveryPoint = 6
+
+// h264IsRecoveryPoint returns whether a SEI NALU contains a recovery point.
+// Recovery points are emitted by encoders that use intra refresh instead of periodic IDRs,
+// and allow decoding to start from non-IDR frames.
+func h264IsRecoveryPoint(nalu []byte) bool {
+	pos := 1
+
+	for pos < len(nalu) && nalu[pos] != 0x80 {
+		payloadType := 0
+		for pos < len(nalu) && nalu[pos] == 0xFF {
+			payloadType += 255
+			pos++
+		}
+		if pos >= len(nalu) {
+			return false
+		}
+		payloadType += int(nalu[pos])
+		pos++
+
+		if payloadType == h264SEIPayloadTypeRecoveryPoint {
+			return true
+		}
+
+		payloadSize := 0
+		for pos < len(nalu) && nalu[pos] == 0xFF {
+			payloadSize += 255
+			pos++
+		}
+		if pos >= len(nalu) {
+			return false
+		}
+		payloadSize += int(nalu[pos])
+		pos++
+
+		pos += payloadSize
+	}
+
+	return false
+}
+
+// H264IsRandomAccess returns whether an access unit contains an IDR or a recovery point.
+func H264IsRandomAccess(au [][]byte) bool {
+	for _, nalu := range au {
+		switch h264.NALUType(nalu[0] & 0x1F) {
+		case h264.NALUTypeIDR:
+			return true
+
+		case h264.NALUTypeSEI:
+			if h264IsRecoveryPoint(nalu) {
+				return true
+			}
+		}
+	}
+	return false
+}
+
+// ErrH264DTSNotReady is returned by H264DTSExtractor when decoding can't start from an access unit.
+var ErrH264DTSNotReady = errors.New("waiting for a random access point")
+
+// H264DTSExtractor is a DTS extractor that can start from recovery points.
+//
+// The DTS extractor of mediacommon computes DTS from picture order counts,
+// therefore it needs an IDR to start. Until an IDR is received, access units that
+// follow a recovery point get a DTS equal to their PTS. This is correct when frames are
+// not reordered, as it happens with encoders that use intra refresh.
+// If reordered frames are detected, access units are skipped until the next random access point.
+type H264DTSExtractor struct {
+	extractor  *h264.DTSExtractor
+	recovering bool
+	prevDTS    time.Duration
+}
+
+// Extract returns the DTS of an access unit.
+func (e *H264DTSExtractor) Extract(au [][]byte, pts time.Duration) (time.Duration, error) {
+	if e.extractor == nil && h264.IDRPresent(au) {
+		e.extractor = h264.NewDTSExtractor()
+		e.recovering = false
+	}
+
+	if e.extractor != nil {
+		return e.extractor.Extract(au, pts)
+	}
+
+	if !e.recovering {
+		if !H264IsRandomAccess(au) {
+			return 0, ErrH264DTSNotReady
+		}
+		e.recovering = true
+	} else if pts < e.prevDTS {
+		e.recovering = false
+		return 0, ErrH264DTSNotReady
+	}
+
+	e.prevDTS = pts
+	return pts, nil
+}
@@ -206,3 +206,60 @@ func FuzzRTPH264ExtractParams(f *testing.F) {
 		rtpH264ExtractParams(b)
 	})
 }
+
+func TestH264RecoveryPoint(t *testing.T) {
+	forma := &format.H264{
+		PayloadTyp:        96,
+		SPS:               []byte{7, 4, 5, 6},
+		PPS:               []byte{8, 1},
+		PacketizationMode: 1,
+	}
+
+	p, err := New(1472, forma, true)
+	require.NoError(t, err)
+
+	recoveryPoint := []byte{byte(h264.NALUTypeSEI), 6, 2, 0x0f, 0xc4, 0x80}
+	userData := []byte{byte(h264.NALUTypeSEI), 5, 1, 0, 0x80}
+
+	require.True(t, H264IsRandomAccess([][]byte{recoveryPoint, {byte(h264.NALUTypeNonIDR)}}))
+	require.False(t, H264IsRandomAccess([][]byte{userData, {byte(h264.NALUTypeNonIDR)}}))
+
+	u := &unit.H264{
+		AU: [][]byte{recoveryPoint, {byte(h264.NALUTypeNonIDR)}},
+	}
+
+	err = p.ProcessUnit(u)
+	require.NoError(t, err)
+
+	require.Equal(t, [][]byte{
+		{7, 4, 5, 6},
+		{8, 1},
+		recoveryPoint,
+		{byte(h264.NALUTypeNonIDR)},
+	}, u.AU)
+}
+
+func TestH264DTSExtractorRecoveryPoint(t *testing.T) {
+	recoveryPoint := []byte{byte(h264.NALUTypeSEI), 6, 2, 0x0f, 0xc4, 0x80}
+	nonIDR := []byte{byte(h264.NALUTypeNonIDR)}
+
+	var e H264DTSExtractor
+
+	_, err := e.Extract([][]byte{nonIDR}, 0)
+	require.ErrorIs(t, err, ErrH264DTSNotReady)
+
+	dts, err := e.Extract([][]byte{recoveryPoint, nonIDR}, 1*time.Second)
+	require.NoError(t, err)
+	require.Equal(t, 1*time.Second, dts)
+
+	dts, err = e.Extract([][]byte{nonIDR}, 2*time.Second)
+	require.NoError(t, err)
+	require.Equal(t, 2*time.Second, dts)
+
+	// reordered frames can't be handled without an IDR.
+	_, err = e.Extract([][]byte{nonIDR}, 1500*time.Millisecond)
+	require.ErrorIs(t, err, ErrH264DTSNotReady)
+
+	_, err = e.Extract([][]byte{nonIDR}, 3*time.Second)
+	require.ErrorIs(t, err, ErrH264DTSNotReady)
+}
@@ -263,6 +263,10 @@ func (t *formatProcessorH265) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorH265) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorH265) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -75,6 +75,10 @@ func (t *formatProcessorLPCM) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorLPCM) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorLPCM) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
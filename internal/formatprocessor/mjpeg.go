@@ -74,6 +74,10 @@ func (t *formatProcessorMJPEG) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorMJPEG) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorMJPEG) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
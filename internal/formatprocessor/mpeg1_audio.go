@@ -73,6 +73,10 @@ func (t *formatProcessorMPEG1Audio) ProcessUnit(uu unit.Unit) error { //nolint:d
 	return nil
 }
 
+func (t *formatProcessorMPEG1Audio) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorMPEG1Audio) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
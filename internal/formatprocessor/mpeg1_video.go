@@ -74,6 +74,10 @@ func (t *formatProcessorMPEG1Video) ProcessUnit(uu unit.Unit) error { //nolint:d
 	return nil
 }
 
+func (t *formatProcessorMPEG1Video) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorMPEG1Video) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
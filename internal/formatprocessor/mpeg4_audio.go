@@ -77,6 +77,10 @@ func (t *formatProcessorMPEG4Audio) ProcessUnit(uu unit.Unit) error { //nolint:d
 	return nil
 }
 
+func (t *formatProcessorMPEG4Audio) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorMPEG4Audio) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -114,6 +114,10 @@ func (t *formatProcessorMPEG4Video) ProcessUnit(uu unit.Unit) error { //nolint:d
 	return nil
 }
 
+func (t *formatProcessorMPEG4Video) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorMPEG4Video) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
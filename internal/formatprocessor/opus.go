@@ -81,6 +81,10 @@ func (t *formatProcessorOpus) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorOpus) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorOpus) ProcessRTPPacket(
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -22,6 +22,10 @@ type Processor interface {
 		pts time.Duration,
 		hasNonRTSPReaders bool,
 	) (Unit, error)
+
+	// discard the unit that is being decoded from RTP packets.
+	// It is called when packets are lost.
+	ResetDecoder()
 }
 
 // New allocates a Processor.
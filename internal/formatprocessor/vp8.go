@@ -74,6 +74,10 @@ func (t *formatProcessorVP8) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorVP8) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorVP8) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
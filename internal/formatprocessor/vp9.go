@@ -74,6 +74,10 @@ func (t *formatProcessorVP9) ProcessUnit(uu unit.Unit) error { //nolint:dupl
 	return nil
 }
 
+func (t *formatProcessorVP9) ResetDecoder() {
+	t.decoder = nil
+}
+
 func (t *formatProcessorVP9) ProcessRTPPacket( //nolint:dupl
 	pkt *rtp.Packet,
 	ntp time.Time,
@@ -0,0 +1,74 @@
+// Package histogram contains a histogram of durations.
+package histogram
+
+import (
+	"sync/atomic"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/defs"
+)
+
+// Histogram is a histogram of durations with fixed buckets.
+// It can be updated by multiple goroutines without locks.
+type Histogram struct {
+	// upper bounds of buckets, in ascending order.
+	Buckets []time.Duration
+
+	counts []uint64 // one more than Buckets, for values above the last bound
+	sum    *uint64
+}
+
+// Initialize initializes a Histogram.
+func (h *Histogram) Initialize() {
+	h.counts = make([]uint64, len(h.Buckets)+1)
+	h.sum = new(uint64)
+}
+
+// Observe adds a value to the histogram.
+func (h *Histogram) Observe(d time.Duration) {
+	i := 0
+	for i < len(h.Buckets) && d > h.Buckets[i] {
+		i++
+	}
+
+	atomic.AddUint64(&h.counts[i], 1)
+	atomic.AddUint64(h.sum, uint64(d))
+}
+
+// APIDescribe returns the histogram, with cumulative bucket counts.
+func (h *Histogram) APIDescribe() *defs.APIHistogram {
+	out := &defs.APIHistogram{
+		Buckets: make([]defs.APIHistogramBucket, len(h.Buckets)),
+	}
+
+	for i, bound := range h.Buckets {
+		out.Count += atomic.LoadUint64(&h.counts[i])
+		out.Buckets[i] = defs.APIHistogramBucket{
+			Le:    bound.Seconds(),
+			Count: out.Count,
+		}
+	}
+
+	out.Count += atomic.LoadUint64(&h.counts[len(h.Buckets)])
+	out.Sum = time.Duration(atomic.LoadUint64(h.sum)).Seconds()
+
+	return out
+}
+
+// Merge adds counts of src to dst.
+// Histograms must have the same buckets, or dst must be empty.
+func Merge(dst *defs.APIHistogram, src *defs.APIHistogram) {
+	if dst.Buckets == nil {
+		dst.Buckets = make([]defs.APIHistogramBucket, len(src.Buckets))
+		for i, b := range src.Buckets {
+			dst.Buckets[i].Le = b.Le
+		}
+	}
+
+	for i, b := range src.Buckets {
+		dst.Buckets[i].Count += b.Count
+	}
+
+	dst.Count += src.Count
+	dst.Sum += src.Sum
+}
@@ -0,0 +1,59 @@
+package histogram
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/defs"
+)
+
+func TestHistogram(t *testing.T) {
+	h := &Histogram{
+		Buckets: []time.Duration{500 * time.Millisecond, time.Second},
+	}
+	h.Initialize()
+
+	h.Observe(250 * time.Millisecond)
+	h.Observe(500 * time.Millisecond)
+	h.Observe(750 * time.Millisecond)
+	h.Observe(2 * time.Second)
+
+	require.Equal(t, &defs.APIHistogram{
+		Buckets: []defs.APIHistogramBucket{
+			{Le: 0.5, Count: 2},
+			{Le: 1, Count: 3},
+		},
+		Count: 4,
+		Sum:   3.5,
+	}, h.APIDescribe())
+}
+
+func TestMerge(t *testing.T) {
+	h1 := &Histogram{
+		Buckets: []time.Duration{500 * time.Millisecond, time.Second},
+	}
+	h1.Initialize()
+	h1.Observe(250 * time.Millisecond)
+	h1.Observe(2 * time.Second)
+
+	h2 := &Histogram{
+		Buckets: []time.Duration{500 * time.Millisecond, time.Second},
+	}
+	h2.Initialize()
+	h2.Observe(750 * time.Millisecond)
+
+	out := &defs.APIHistogram{}
+	Merge(out, h1.APIDescribe())
+	Merge(out, h2.APIDescribe())
+
+	require.Equal(t, &defs.APIHistogram{
+		Buckets: []defs.APIHistogramBucket{
+			{Le: 0.5, Count: 1},
+			{Le: 1, Count: 2},
+		},
+		Count: 3,
+		Sum:   3,
+	}, out)
+}
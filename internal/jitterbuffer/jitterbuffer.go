@@ -0,0 +1,302 @@
+// Package jitterbuffer contains a RTP jitter buffer.
+package jitterbuffer
+
+import (
+	"sort"
+	"sync/atomic"
+	"time"
+
+	"github.com/pion/rtp"
+)
+
+const (
+	// maximum number of packets that can wait for a missing one.
+	maxSize = 512
+
+	// minimum increase of the delay when a packet arrives too late.
+	minDelayIncrease = 10 * time.Millisecond
+)
+
+// Entry is a packet with its timestamps.
+type Entry struct {
+	Packet *rtp.Packet
+	NTP    time.Time
+	PTS    time.Duration
+
+	// whether one or more packets before this one have been skipped.
+	AfterLoss bool
+}
+
+type bufferedEntry struct {
+	Entry
+	arrival time.Time
+}
+
+// Stats are statistics of a jitter buffer.
+type Stats struct {
+	// packets that arrived out of order and have been put back in order.
+	PacketsReordered uint64
+	// packets that arrived after their position has been skipped.
+	PacketsLate uint64
+	// packets that arrived after a copy of them has already been released.
+	PacketsDuplicate uint64
+	// packets that have been skipped since they did not arrive in time.
+	PacketsLost uint64
+	// maximum number of packets that have been received before a reordered one.
+	ReorderDepth uint64
+	// current time a packet can wait for a missing one.
+	Delay time.Duration
+}
+
+// JitterBuffer is a RTP jitter buffer.
+//
+// Packets that arrive in order are released immediately.
+// When a packet is missing, following packets are held until the missing one arrives,
+// or until they have waited for longer than the delay; in this case, the missing packet is skipped.
+// The delay adapts to the interarrival jitter (RFC3550) and grows when packets arrive too late,
+// between MinDelay and MaxDelay.
+//
+// It is not thread safe, except for Stats().
+type JitterBuffer struct {
+	ClockRate int
+	MinDelay  time.Duration
+	MaxDelay  time.Duration
+
+	initialized   bool
+	expected      uint16
+	buffer        []bufferedEntry // sorted by sequence number
+	jitter        float64         // in clock rate units
+	lastArrival   time.Time
+	lastTimestamp uint32
+
+	// bitmap of the last maxSize sequence numbers, indexed by sequence number modulo maxSize.
+	// A bit is set when the packet has been released, and is cleared when the packet has been skipped.
+	released [maxSize / 64]uint64
+
+	delay            *int64
+	packetsReordered *uint64
+	packetsLate      *uint64
+	packetsDuplicate *uint64
+	packetsLost      *uint64
+	reorderDepth     *uint64
+}
+
+// Initialize initializes a JitterBuffer.
+func (b *JitterBuffer) Initialize() {
+	b.delay = new(int64)
+	b.packetsReordered = new(uint64)
+	b.packetsLate = new(uint64)
+	b.packetsDuplicate = new(uint64)
+	b.packetsLost = new(uint64)
+	b.reorderDepth = new(uint64)
+
+	atomic.StoreInt64(b.delay, int64(b.MinDelay))
+}
+
+func (b *JitterBuffer) getDelay() time.Duration {
+	return time.Duration(atomic.LoadInt64(b.delay))
+}
+
+func (b *JitterBuffer) setDelay(d time.Duration) {
+	if d < b.MinDelay {
+		d = b.MinDelay
+	} else if d > b.MaxDelay {
+		d = b.MaxDelay
+	}
+	atomic.StoreInt64(b.delay, int64(d))
+}
+
+func (b *JitterBuffer) updateJitter(pkt *rtp.Packet, now time.Time) {
+	if !b.lastArrival.IsZero() {
+		arrivalDiff := now.Sub(b.lastArrival).Seconds() * float64(b.ClockRate)
+		timestampDiff := float64(int32(pkt.Timestamp - b.lastTimestamp))
+		d := arrivalDiff - timestampDiff
+		if d < 0 {
+			d = -d
+		}
+		b.jitter += (d - b.jitter) / 16
+	}
+
+	b.lastArrival = now
+	b.lastTimestamp = pkt.Timestamp
+}
+
+// decreaseDelay moves the delay slowly towards a multiple of the jitter.
+func (b *JitterBuffer) decreaseDelay() {
+	target := time.Duration(3 * b.jitter / float64(b.ClockRate) * float64(time.Second))
+	delay := b.getDelay()
+
+	if delay > target {
+		b.setDelay(delay - (delay-target)/128)
+	}
+}
+
+// increaseDelay doubles the delay, since a packet arrived too late.
+func (b *JitterBuffer) increaseDelay() {
+	delay := b.getDelay() * 2
+	if delay < minDelayIncrease {
+		delay = minDelayIncrease
+	}
+	b.setDelay(delay)
+}
+
+func (b *JitterBuffer) setReleased(seq uint16, released bool) {
+	i := seq % maxSize
+	if released {
+		b.released[i/64] |= 1 << (i % 64)
+	} else {
+		b.released[i/64] &^= 1 << (i % 64)
+	}
+}
+
+func (b *JitterBuffer) isReleased(seq uint16) bool {
+	i := seq % maxSize
+	return b.released[i/64]&(1<<(i%64)) != 0
+}
+
+// release removes packets that follow the last released one.
+func (b *JitterBuffer) release(out []Entry) []Entry {
+	n := 0
+	for n < len(b.buffer) && b.buffer[n].Packet.SequenceNumber == b.expected {
+		out = append(out, b.buffer[n].Entry)
+		b.setReleased(b.expected, true)
+		b.expected++
+		n++
+	}
+	b.buffer = b.buffer[n:]
+	return out
+}
+
+// skip skips missing packets until the first buffered one.
+func (b *JitterBuffer) skip(out []Entry) []Entry {
+	atomic.AddUint64(b.packetsLost, uint64(b.buffer[0].Packet.SequenceNumber-b.expected))
+	for b.expected != b.buffer[0].Packet.SequenceNumber {
+		b.setReleased(b.expected, false)
+		b.expected++
+	}
+	b.buffer[0].AfterLoss = true
+	return b.release(out)
+}
+
+// Push adds a packet. It returns packets that can be released, in order.
+func (b *JitterBuffer) Push(e Entry, now time.Time) []Entry {
+	seq := e.Packet.SequenceNumber
+
+	if !b.initialized {
+		b.initialized = true
+		b.expected = seq
+	}
+
+	diff := int16(seq - b.expected)
+
+	// discontinuity: release waiting packets and restart from this one.
+	if diff < -maxSize || diff > maxSize {
+		out := make([]Entry, 0, len(b.buffer)+1)
+		for _, be := range b.buffer {
+			out = append(out, be.Entry)
+		}
+		b.buffer = b.buffer[:0]
+		b.released = [maxSize / 64]uint64{}
+		b.setReleased(seq, true)
+		b.expected = seq + 1
+		b.lastArrival = time.Time{}
+		e.AfterLoss = true
+		return append(out, e)
+	}
+
+	if diff < 0 {
+		// a duplicate of a released packet does not mean that the delay is too short.
+		if b.isReleased(seq) {
+			atomic.AddUint64(b.packetsDuplicate, 1)
+			return nil
+		}
+
+		atomic.AddUint64(b.packetsLate, 1)
+		b.increaseDelay()
+		return nil
+	}
+
+	b.updateJitter(e.Packet, now)
+
+	// fast path: packet is in order and there are no packets waiting.
+	if diff == 0 && len(b.buffer) == 0 {
+		b.setReleased(seq, true)
+		b.expected++
+		b.decreaseDelay()
+		return []Entry{e}
+	}
+
+	pos := sort.Search(len(b.buffer), func(i int) bool {
+		return int16(b.buffer[i].Packet.SequenceNumber-b.expected) >= diff
+	})
+
+	// duplicate of a waiting packet
+	if pos < len(b.buffer) && b.buffer[pos].Packet.SequenceNumber == seq {
+		atomic.AddUint64(b.packetsDuplicate, 1)
+		return nil
+	}
+
+	b.buffer = append(b.buffer, bufferedEntry{})
+	copy(b.buffer[pos+1:], b.buffer[pos:])
+	b.buffer[pos] = bufferedEntry{Entry: e, arrival: now}
+
+	if depth := uint64(len(b.buffer) - 1 - pos); depth != 0 {
+		atomic.AddUint64(b.packetsReordered, 1)
+		if depth > atomic.LoadUint64(b.reorderDepth) {
+			atomic.StoreUint64(b.reorderDepth, depth)
+		}
+	}
+
+	out := b.release(nil)
+
+	for len(b.buffer) > maxSize {
+		out = b.skip(out)
+	}
+
+	return out
+}
+
+// waitStart returns the arrival time of the packet that is waiting since the longest time.
+func (b *JitterBuffer) waitStart() time.Time {
+	ret := b.buffer[0].arrival
+	for _, e := range b.buffer[1:] {
+		if e.arrival.Before(ret) {
+			ret = e.arrival
+		}
+	}
+	return ret
+}
+
+// Expire skips packets that did not arrive in time.
+// It returns packets that can be released, in order.
+func (b *JitterBuffer) Expire(now time.Time) []Entry {
+	var out []Entry
+	delay := b.getDelay()
+
+	for len(b.buffer) != 0 && now.Sub(b.waitStart()) >= delay {
+		out = b.skip(out)
+	}
+
+	return out
+}
+
+// Deadline returns the time at which Expire() must be called,
+// and whether there are packets waiting.
+func (b *JitterBuffer) Deadline() (time.Time, bool) {
+	if len(b.buffer) == 0 {
+		return time.Time{}, false
+	}
+	return b.waitStart().Add(b.getDelay()), true
+}
+
+// Stats returns statistics.
+func (b *JitterBuffer) Stats() Stats {
+	return Stats{
+		PacketsReordered: atomic.LoadUint64(b.packetsReordered),
+		PacketsLate:      atomic.LoadUint64(b.packetsLate),
+		PacketsDuplicate: atomic.LoadUint64(b.packetsDuplicate),
+		PacketsLost:      atomic.LoadUint64(b.packetsLost),
+		ReorderDepth:     atomic.LoadUint64(b.reorderDepth),
+		Delay:            b.getDelay(),
+	}
+}
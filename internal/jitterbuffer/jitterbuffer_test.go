@@ -0,0 +1,122 @@
+package jitterbuffer
+
+import (
+	"testing"
+	"time"
+
+	"github.com/pion/rtp"
+	"github.com/stretchr/testify/require"
+)
+
+func entry(seq uint16) Entry {
+	return Entry{
+		Packet: &rtp.Packet{
+			Header: rtp.Header{
+				SequenceNumber: seq,
+				Timestamp:      uint32(seq) * 3000,
+			},
+		},
+	}
+}
+
+func sequenceNumbers(entries []Entry) []uint16 {
+	ret := []uint16{}
+	for _, e := range entries {
+		ret = append(ret, e.Packet.SequenceNumber)
+	}
+	return ret
+}
+
+func TestJitterBufferReorder(t *testing.T) {
+	b := &JitterBuffer{
+		ClockRate: 90000,
+		MinDelay:  100 * time.Millisecond,
+		MaxDelay:  time.Second,
+	}
+	b.Initialize()
+
+	now := time.Date(2010, 1, 1, 0, 0, 0, 0, time.UTC)
+
+	require.Equal(t, []uint16{65534}, sequenceNumbers(b.Push(entry(65534), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(0), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(1), now)))
+
+	_, ok := b.Deadline()
+	require.Equal(t, true, ok)
+
+	require.Equal(t, []uint16{65535, 0, 1}, sequenceNumbers(b.Push(entry(65535), now)))
+	require.Equal(t, []uint16{2}, sequenceNumbers(b.Push(entry(2), now)))
+
+	_, ok = b.Deadline()
+	require.Equal(t, false, ok)
+
+	stats := b.Stats()
+	require.Equal(t, uint64(1), stats.PacketsReordered)
+	require.Equal(t, uint64(2), stats.ReorderDepth)
+}
+
+func TestJitterBufferLoss(t *testing.T) {
+	b := &JitterBuffer{
+		ClockRate: 90000,
+		MinDelay:  100 * time.Millisecond,
+		MaxDelay:  time.Second,
+	}
+	b.Initialize()
+
+	now := time.Date(2010, 1, 1, 0, 0, 0, 0, time.UTC)
+
+	out := b.Push(entry(10), now)
+	require.Equal(t, []uint16{10}, sequenceNumbers(out))
+	require.Equal(t, false, out[0].AfterLoss)
+
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(13), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Expire(now.Add(50*time.Millisecond))))
+
+	deadline, ok := b.Deadline()
+	require.Equal(t, true, ok)
+	require.Equal(t, now.Add(100*time.Millisecond), deadline)
+
+	out = b.Expire(deadline)
+	require.Equal(t, []uint16{13}, sequenceNumbers(out))
+	require.Equal(t, true, out[0].AfterLoss)
+
+	// a late packet increases the delay
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(11), deadline)))
+
+	stats := b.Stats()
+	require.Equal(t, uint64(2), stats.PacketsLost)
+	require.Equal(t, uint64(1), stats.PacketsLate)
+	require.Equal(t, 200*time.Millisecond, stats.Delay)
+}
+
+func TestJitterBufferDuplicate(t *testing.T) {
+	b := &JitterBuffer{
+		ClockRate: 90000,
+		MinDelay:  100 * time.Millisecond,
+		MaxDelay:  time.Second,
+	}
+	b.Initialize()
+
+	now := time.Date(2010, 1, 1, 0, 0, 0, 0, time.UTC)
+
+	require.Equal(t, []uint16{65535}, sequenceNumbers(b.Push(entry(65535), now)))
+	require.Equal(t, []uint16{0}, sequenceNumbers(b.Push(entry(0), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(3), now)))
+
+	// duplicates of released and waiting packets do not change the delay
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(65535), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(0), now)))
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(3), now)))
+
+	out := b.Expire(now.Add(100 * time.Millisecond))
+	require.Equal(t, []uint16{3}, sequenceNumbers(out))
+
+	// a skipped packet is late, not a duplicate
+	require.Equal(t, []uint16{}, sequenceNumbers(b.Push(entry(1), now.Add(100*time.Millisecond))))
+
+	stats := b.Stats()
+	require.Equal(t, uint64(3), stats.PacketsDuplicate)
+	require.Equal(t, uint64(1), stats.PacketsLate)
+	require.Equal(t, uint64(2), stats.PacketsLost)
+	require.Equal(t, 200*time.Millisecond, stats.Delay)
+}
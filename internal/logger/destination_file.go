@@ -3,30 +3,35 @@ package logger
 import (
 	"bytes"
 	"os"
-	"time"
 )
 
 type destinationFile struct {
-	file *os.File
-	buf  bytes.Buffer
+	file       *os.File
+	structured bool
+	buf        bytes.Buffer
 }
 
-func newDestinationFile(filePath string) (destination, error) {
+func newDestinationFile(filePath string, structured bool) (destination, error) {
 	f, err := os.OpenFile(filePath, os.O_APPEND|os.O_CREATE|os.O_WRONLY, 0o644)
 	if err != nil {
 		return nil, err
 	}
 
 	return &destinationFile{
-		file: f,
+		file:       f,
+		structured: structured,
 	}, nil
 }
 
-func (d *destinationFile) log(t time.Time, level Level, format string, args ...interface{}) {
+func (d *destinationFile) log(e *entry) {
 	d.buf.Reset()
-	writeTime(&d.buf, t, false)
-	writeLevel(&d.buf, level, false)
-	writeContent(&d.buf, format, args)
+	if d.structured {
+		writeStructured(&d.buf, e)
+	} else {
+		writeTime(&d.buf, e.t, false)
+		writeLevel(&d.buf, e.level, false)
+		writeContent(&d.buf, e.fields, e.content)
+	}
 	d.file.Write(d.buf.Bytes()) //nolint:errcheck
 }
 
@@ -3,28 +3,33 @@ package logger
 import (
 	"bytes"
 	"os"
-	"time"
 
 	"golang.org/x/term"
 )
 
 type destinationStdout struct {
-	useColor bool
+	useColor   bool
+	structured bool
 
 	buf bytes.Buffer
 }
 
-func newDestionationStdout() destination {
+func newDestionationStdout(structured bool) destination {
 	return &destinationStdout{
-		useColor: term.IsTerminal(int(os.Stdout.Fd())),
+		useColor:   !structured && term.IsTerminal(int(os.Stdout.Fd())),
+		structured: structured,
 	}
 }
 
-func (d *destinationStdout) log(t time.Time, level Level, format string, args ...interface{}) {
+func (d *destinationStdout) log(e *entry) {
 	d.buf.Reset()
-	writeTime(&d.buf, t, d.useColor)
-	writeLevel(&d.buf, level, d.useColor)
-	writeContent(&d.buf, format, args)
+	if d.structured {
+		writeStructured(&d.buf, e)
+	} else {
+		writeTime(&d.buf, e.t, d.useColor)
+		writeLevel(&d.buf, e.level, d.useColor)
+		writeContent(&d.buf, e.fields, e.content)
+	}
 	os.Stdout.Write(d.buf.Bytes()) //nolint:errcheck
 }
 
@@ -3,30 +3,35 @@ package logger
 import (
 	"bytes"
 	"io"
-	"time"
 )
 
 type destinationSysLog struct {
-	syslog io.WriteCloser
-	buf    bytes.Buffer
+	syslog     io.WriteCloser
+	structured bool
+	buf        bytes.Buffer
 }
 
-func newDestinationSyslog() (destination, error) {
+func newDestinationSyslog(structured bool) (destination, error) {
 	syslog, err := newSysLog("mediamtx")
 	if err != nil {
 		return nil, err
 	}
 
 	return &destinationSysLog{
-		syslog: syslog,
+		syslog:     syslog,
+		structured: structured,
 	}, nil
 }
 
-func (d *destinationSysLog) log(t time.Time, level Level, format string, args ...interface{}) {
+func (d *destinationSysLog) log(e *entry) {
 	d.buf.Reset()
-	writeTime(&d.buf, t, false)
-	writeLevel(&d.buf, level, false)
-	writeContent(&d.buf, format, args)
+	if d.structured {
+		writeStructured(&d.buf, e)
+	} else {
+		writeTime(&d.buf, e.t, false)
+		writeLevel(&d.buf, e.level, false)
+		writeContent(&d.buf, e.fields, e.content)
+	}
 	d.syslog.Write(d.buf.Bytes())
 }
 
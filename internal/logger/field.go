@@ -0,0 +1,117 @@
+package logger
+
+import (
+	"bytes"
+	"fmt"
+	"strconv"
+)
+
+// Field is a property of a log entry.
+// Fields are passed to Log() before the arguments of the format string,
+// are printed as bracketed prefixes in plain text logs
+// and as separate keys in structured logs.
+type Field struct {
+	// key of the field in structured logs.
+	// Fields with key "module", and fields whose key has already been used
+	// by a previous field of the same entry, are joined into the "module" key.
+	Key string
+
+	// label that precedes the value in plain text logs (i.e. "conn" in "[conn 127.0.0.1:3455]").
+	Label string
+
+	// value of the field.
+	// Integers are written as JSON numbers.
+	Value interface{}
+
+	// whether the field is printed after the message in plain text logs.
+	Trailing bool
+}
+
+// Module returns a field that contains the name of the module that produced an entry.
+func Module(name string) Field {
+	return Field{
+		Key:   "module",
+		Value: name,
+	}
+}
+
+// WithField returns the arguments of Log() with a field in front of them.
+func WithField(f Field, args []interface{}) []interface{} {
+	return append([]interface{}{f}, args...)
+}
+
+// splitFields separates leading fields from the arguments of the format string.
+func splitFields(args []interface{}) ([]interface{}, []interface{}) {
+	n := 0
+	for n < len(args) {
+		if _, ok := args[n].(Field); !ok {
+			break
+		}
+		n++
+	}
+	return args[:n], args[n:]
+}
+
+func writeFieldValue(buf *bytes.Buffer, v interface{}) {
+	switch v := v.(type) {
+	case string:
+		buf.WriteString(v)
+
+	case int:
+		buf.Write(strconv.AppendInt(buf.AvailableBuffer(), int64(v), 10))
+
+	case int64:
+		buf.Write(strconv.AppendInt(buf.AvailableBuffer(), v, 10))
+
+	case uint:
+		buf.Write(strconv.AppendUint(buf.AvailableBuffer(), uint64(v), 10))
+
+	case uint32:
+		buf.Write(strconv.AppendUint(buf.AvailableBuffer(), uint64(v), 10))
+
+	case uint64:
+		buf.Write(strconv.AppendUint(buf.AvailableBuffer(), v, 10))
+
+	default:
+		fmt.Fprint(buf, v)
+	}
+}
+
+func isNumericFieldValue(v interface{}) bool {
+	switch v.(type) {
+	case int, int64, uint, uint32, uint64:
+		return true
+	}
+	return false
+}
+
+func writeField(buf *bytes.Buffer, f Field) {
+	buf.WriteByte('[')
+	if f.Label != "" {
+		buf.WriteString(f.Label)
+		buf.WriteByte(' ')
+	}
+	writeFieldValue(buf, f.Value)
+	buf.WriteByte(']')
+}
+
+// writeContent writes fields and message of a plain text entry.
+func writeContent(buf *bytes.Buffer, fields []Field, content []byte) {
+	for _, f := range fields {
+		if !f.Trailing {
+			writeField(buf, f)
+			buf.WriteByte(' ')
+		}
+	}
+
+	buf.Write(content)
+
+	for _, f := range fields {
+		if f.Trailing {
+			buf.WriteByte(' ')
+			writeField(buf, f)
+		}
+	}
+
+	buf.WriteByte('\n')
+}
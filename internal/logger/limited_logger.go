@@ -13,9 +13,12 @@ type limitedLogger struct {
 	w           Writer
 	mutex       sync.Mutex
 	lastPrinted time.Time
+	suppressed  uint64
 }
 
 // NewLimitedLogger is a wrapper around a Writer that limits printed messages.
+// Messages that are not printed are counted, and their count
+// is attached to the next printed message as a "suppressed" field.
 func NewLimitedLogger(w Writer) Writer {
 	return &limitedLogger{
 		w: w,
@@ -26,9 +29,19 @@ func NewLimitedLogger(w Writer) Writer {
 func (l *limitedLogger) Log(level Level, format string, args ...interface{}) {
 	now := time.Now()
 	l.mutex.Lock()
-	if now.Sub(l.lastPrinted) >= minIntervalBetweenWarnings {
-		l.lastPrinted = now
-		l.w.Log(level, format, args...)
+	defer l.mutex.Unlock()
+
+	if now.Sub(l.lastPrinted) < minIntervalBetweenWarnings {
+		l.suppressed++
+		return
 	}
-	l.mutex.Unlock()
+
+	l.lastPrinted = now
+
+	if l.suppressed != 0 {
+		args = WithField(suppressedField(l.suppressed), args)
+		l.suppressed = 0
+	}
+
+	l.w.Log(level, format, args...)
 }
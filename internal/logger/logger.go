@@ -4,59 +4,167 @@ package logger
 import (
 	"bytes"
 	"fmt"
+	"strconv"
+	"strings"
 	"sync"
+	"sync/atomic"
 	"time"
 
 	"github.com/gookit/color"
 )
 
+const (
+	// size of the queue between Log() and the writer routine.
+	queueSize = 4096
+)
+
+type entry struct {
+	t       time.Time
+	level   Level
+	fields  []Field
+	content []byte
+}
+
+var entryPool = sync.Pool{
+	New: func() interface{} {
+		return &entry{
+			content: make([]byte, 0, 256),
+		}
+	},
+}
+
 // Logger is a log handler.
+// Entries are formatted by the caller into pooled buffers and written
+// to destinations by a dedicated routine, in order to prevent slow destinations
+// from blocking the caller. When the queue is full, entries are dropped and counted.
 type Logger struct {
 	level Level
 
 	destinations []destination
-	mutex        sync.Mutex
+	queue        chan *entry
+	dropped      *uint64
+
+	// in
+	terminate chan struct{}
+
+	// out
+	done chan struct{}
 }
 
 // New allocates a log handler.
-func New(level Level, destinations []Destination, filePath string) (*Logger, error) {
+func New(level Level, destinations []Destination, filePath string, structured bool) (*Logger, error) {
 	lh := &Logger{
-		level: level,
+		level:     level,
+		queue:     make(chan *entry, queueSize),
+		dropped:   new(uint64),
+		terminate: make(chan struct{}),
+		done:      make(chan struct{}),
 	}
 
 	for _, destType := range destinations {
 		switch destType {
 		case DestinationStdout:
-			lh.destinations = append(lh.destinations, newDestionationStdout())
+			lh.destinations = append(lh.destinations, newDestionationStdout(structured))
 
 		case DestinationFile:
-			dest, err := newDestinationFile(filePath)
+			dest, err := newDestinationFile(filePath, structured)
 			if err != nil {
-				lh.Close()
+				lh.closeDestinations()
 				return nil, err
 			}
 			lh.destinations = append(lh.destinations, dest)
 
 		case DestinationSyslog:
-			dest, err := newDestinationSyslog()
+			dest, err := newDestinationSyslog(structured)
 			if err != nil {
-				lh.Close()
+				lh.closeDestinations()
 				return nil, err
 			}
 			lh.destinations = append(lh.destinations, dest)
 		}
 	}
 
+	go lh.run()
+
 	return lh, nil
 }
 
 // Close closes a log handler.
+// Entries that are still in queue are written before returning.
 func (lh *Logger) Close() {
+	close(lh.terminate)
+	<-lh.done
+}
+
+func (lh *Logger) closeDestinations() {
 	for _, dest := range lh.destinations {
 		dest.close()
 	}
 }
 
+// Dropped returns the number of entries that have been dropped since the logger was created.
+func (lh *Logger) Dropped() uint64 {
+	return atomic.LoadUint64(lh.dropped)
+}
+
+func (lh *Logger) run() {
+	defer close(lh.done)
+
+	reportedDropped := uint64(0)
+
+	for {
+		select {
+		case e := <-lh.queue:
+			lh.write(e)
+			reportedDropped = lh.reportDropped(reportedDropped)
+
+		case <-lh.terminate:
+			for {
+				select {
+				case e := <-lh.queue:
+					lh.write(e)
+
+				default:
+					lh.reportDropped(reportedDropped)
+					lh.closeDestinations()
+					return
+				}
+			}
+		}
+	}
+}
+
+func (lh *Logger) write(e *entry) {
+	for _, dest := range lh.destinations {
+		dest.log(e)
+	}
+
+	clear(e.fields) // do not keep references to field values
+	e.fields = e.fields[:0]
+
+	if cap(e.content) <= 64*1024 { // do not keep large buffers in pool
+		entryPool.Put(e)
+	}
+}
+
+func (lh *Logger) reportDropped(reported uint64) uint64 {
+	dropped := atomic.LoadUint64(lh.dropped)
+	if dropped == reported {
+		return reported
+	}
+
+	e := entryPool.Get().(*entry)
+	e.t = time.Now()
+	e.level = Warn
+	e.fields = e.fields[:0]
+	e.content = append(e.content[:0], "log queue is full, "...)
+	e.content = strconv.AppendUint(e.content, dropped-reported, 10)
+	e.content = append(e.content, " entries have been dropped"...)
+	lh.write(e)
+
+	return dropped
+}
+
 // https://golang.org/src/log/log.go#L78
 func itoa(i int, wid int) []byte {
 	// Assemble decimal in reverse order.
@@ -74,84 +182,102 @@ func itoa(i int, wid int) []byte {
 	return b[bp:]
 }
 
-func writeTime(buf *bytes.Buffer, t time.Time, useColor bool) {
-	var intbuf bytes.Buffer
+func appendTime(buf *bytes.Buffer, t time.Time) {
+	var b [20]byte
+	intbuf := b[:0]
 
 	// date
 	year, month, day := t.Date()
-	intbuf.Write(itoa(year, 4))
-	intbuf.WriteByte('/')
-	intbuf.Write(itoa(int(month), 2))
-	intbuf.WriteByte('/')
-	intbuf.Write(itoa(day, 2))
-	intbuf.WriteByte(' ')
+	intbuf = append(intbuf, itoa(year, 4)...)
+	intbuf = append(intbuf, '/')
+	intbuf = append(intbuf, itoa(int(month), 2)...)
+	intbuf = append(intbuf, '/')
+	intbuf = append(intbuf, itoa(day, 2)...)
+	intbuf = append(intbuf, ' ')
 
 	// time
 	hour, min, sec := t.Clock()
-	intbuf.Write(itoa(hour, 2))
-	intbuf.WriteByte(':')
-	intbuf.Write(itoa(min, 2))
-	intbuf.WriteByte(':')
-	intbuf.Write(itoa(sec, 2))
-	intbuf.WriteByte(' ')
+	intbuf = append(intbuf, itoa(hour, 2)...)
+	intbuf = append(intbuf, ':')
+	intbuf = append(intbuf, itoa(min, 2)...)
+	intbuf = append(intbuf, ':')
+	intbuf = append(intbuf, itoa(sec, 2)...)
+	intbuf = append(intbuf, ' ')
 
-	if useColor {
-		buf.WriteString(color.RenderString(color.Gray.Code(), intbuf.String()))
-	} else {
-		buf.WriteString(intbuf.String())
+	buf.Write(intbuf)
+}
+
+// colorDelimiters returns the escape sequences that surround a colored string.
+// They are empty when colors are not supported.
+func colorDelimiters(code string) (string, string) {
+	rendered := color.RenderString(code, "\x00")
+	i := strings.IndexByte(rendered, 0)
+	if i < 0 {
+		return "", ""
 	}
+	return rendered[:i], rendered[i+1:]
 }
 
-func writeLevel(buf *bytes.Buffer, level Level, useColor bool) {
-	switch level {
-	case Debug:
-		if useColor {
-			buf.WriteString(color.RenderString(color.Debug.Code(), "DEB"))
-		} else {
-			buf.WriteString("DEB")
-		}
+var (
+	timeColorStart, timeColorEnd = colorDelimiters(color.Gray.Code())
 
-	case Info:
-		if useColor {
-			buf.WriteString(color.RenderString(color.Green.Code(), "INF"))
-		} else {
-			buf.WriteString("INF")
-		}
+	levelStrings = map[Level]string{
+		Debug: "DEB",
+		Info:  "INF",
+		Warn:  "WAR",
+		Error: "ERR",
+	}
 
-	case Warn:
-		if useColor {
-			buf.WriteString(color.RenderString(color.Warn.Code(), "WAR"))
-		} else {
-			buf.WriteString("WAR")
-		}
+	levelColorStrings = map[Level]string{
+		Debug: color.RenderString(color.Debug.Code(), "DEB"),
+		Info:  color.RenderString(color.Green.Code(), "INF"),
+		Warn:  color.RenderString(color.Warn.Code(), "WAR"),
+		Error: color.RenderString(color.Error.Code(), "ERR"),
+	}
+)
 
-	case Error:
-		if useColor {
-			buf.WriteString(color.RenderString(color.Error.Code(), "ERR"))
-		} else {
-			buf.WriteString("ERR")
-		}
+func writeTime(buf *bytes.Buffer, t time.Time, useColor bool) {
+	if useColor {
+		buf.WriteString(timeColorStart)
+		appendTime(buf, t)
+		buf.WriteString(timeColorEnd)
+	} else {
+		appendTime(buf, t)
 	}
-	buf.WriteByte(' ')
 }
 
-func writeContent(buf *bytes.Buffer, format string, args []interface{}) {
-	buf.Write([]byte(fmt.Sprintf(format, args...)))
-	buf.WriteByte('\n')
+func writeLevel(buf *bytes.Buffer, level Level, useColor bool) {
+	if useColor {
+		buf.WriteString(levelColorStrings[level])
+	} else {
+		buf.WriteString(levelStrings[level])
+	}
+	buf.WriteByte(' ')
 }
 
 // Log writes a log entry.
+// Arguments of type Field that precede the arguments of the format string
+// are stored into the entry as fields.
 func (lh *Logger) Log(level Level, format string, args ...interface{}) {
 	if level < lh.level {
 		return
 	}
 
-	lh.mutex.Lock()
-	defer lh.mutex.Unlock()
+	fields, args := splitFields(args)
 
-	t := time.Now()
+	e := entryPool.Get().(*entry)
+	e.t = time.Now()
+	e.level = level
+	e.fields = e.fields[:0]
+	for _, f := range fields {
+		e.fields = append(e.fields, f.(Field))
+	}
+	e.content = fmt.Appendf(e.content[:0], format, args...)
 
-	for _, dest := range lh.destinations {
-		dest.log(t, level, format, args...)
+	select {
+	case lh.queue <- e:
+	default:
+		atomic.AddUint64(lh.dropped, 1)
+		entryPool.Put(e)
 	}
 }
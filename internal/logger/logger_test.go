@@ -0,0 +1,174 @@
+package logger
+
+import (
+	"encoding/json"
+	"os"
+	"path/filepath"
+	"regexp"
+	"strings"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestLoggerFile(t *testing.T) {
+	dir, err := os.MkdirTemp("", "mediamtx-logger")
+	require.NoError(t, err)
+	defer os.RemoveAll(dir)
+
+	fpath := filepath.Join(dir, "mediamtx.log")
+
+	l, err := New(Info, []Destination{DestinationFile}, fpath, false)
+	require.NoError(t, err)
+
+	l.Log(Debug, "not printed")
+	l.Log(Info, "test %d", 1)
+	l.Log(Warn, "test %s", "2")
+	l.Log(Error, "test")
+	l.Log(Info, "test %d", Module("RTSP"), Field{Key: "remoteAddr", Label: "conn", Value: "[::1]:8554"}, 3)
+	l.Log(Warn, "test", Field{Key: "suppressed", Label: "suppressed", Value: uint64(5), Trailing: true}, Module("HLS"))
+	l.Close()
+
+	byts, err := os.ReadFile(fpath)
+	require.NoError(t, err)
+
+	require.Regexp(t, regexp.MustCompile(
+		`^[0-9]{4}/[0-9]{2}/[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2} INF test 1\n`+
+			`[0-9]{4}/[0-9]{2}/[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2} WAR test 2\n`+
+			`[0-9]{4}/[0-9]{2}/[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2} ERR test\n`+
+			`[0-9]{4}/[0-9]{2}/[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2} INF \[RTSP\] \[conn \[::1\]:8554\] test 3\n`+
+			`[0-9]{4}/[0-9]{2}/[0-9]{2} [0-9]{2}:[0-9]{2}:[0-9]{2} WAR \[HLS\] test \[suppressed 5\]\n$`), string(byts))
+
+	require.Equal(t, uint64(0), l.Dropped())
+}
+
+func TestLoggerStructured(t *testing.T) {
+	dir, err := os.MkdirTemp("", "mediamtx-logger")
+	require.NoError(t, err)
+	defer os.RemoveAll(dir)
+
+	fpath := filepath.Join(dir, "mediamtx.log")
+
+	l, err := New(Info, []Destination{DestinationFile}, fpath, true)
+	require.NoError(t, err)
+
+	conn := Field{Key: "remoteAddr", Label: "conn", Value: "127.0.0.1:3455"}
+	session := Field{Key: "session", Label: "session", Value: "e2b2c4f1"}
+	path := Field{Key: "path", Label: "path", Value: "mypath"}
+
+	l.Log(Info, "is reading from path '%s'", Module("RTSP"), conn, session, "mypath")
+	l.Log(Warn, "\"quoted\"\tand\ttabbed", path, Module("RTSP source"))
+	l.Log(Info, "opened", Module("RTSP"), Field{Key: "remoteAddr", Label: "conn", Value: "[::1]:8554"})
+	l.Log(Info, "packet received", path, Module("WebRTC"), Module("RTP"),
+		Field{Key: "path", Label: "muxer", Value: "other"})
+
+	ll := NewLimitedLogger(l)
+	ll.Log(Warn, "write queue is full", path)
+	ll.Log(Warn, "write queue is full", path)
+	ll.Log(Warn, "write queue is full", path)
+	ll.(*limitedLogger).lastPrinted = time.Time{}
+	ll.Log(Warn, "write queue is full", path)
+
+	l.Close()
+
+	byts, err := os.ReadFile(fpath)
+	require.NoError(t, err)
+
+	lines := strings.Split(strings.TrimSuffix(string(byts), "\n"), "\n")
+	require.Len(t, lines, 6)
+
+	for i, ca := range []map[string]interface{}{
+		{
+			"level":      "info",
+			"module":     "RTSP",
+			"remoteAddr": "127.0.0.1:3455",
+			"session":    "e2b2c4f1",
+			"message":    "is reading from path 'mypath'",
+		},
+		{
+			"level":   "warn",
+			"path":    "mypath",
+			"module":  "RTSP source",
+			"message": "\"quoted\"\tand\ttabbed",
+		},
+		{
+			"level":      "info",
+			"module":     "RTSP",
+			"remoteAddr": "[::1]:8554",
+			"message":    "opened",
+		},
+		{
+			"level":   "info",
+			"path":    "mypath",
+			"module":  "WebRTC/RTP/muxer other",
+			"message": "packet received",
+		},
+		{
+			"level":   "warn",
+			"path":    "mypath",
+			"message": "write queue is full",
+		},
+		{
+			"level":      "warn",
+			"suppressed": float64(2),
+			"path":       "mypath",
+			"message":    "write queue is full",
+		},
+	} {
+		var out map[string]interface{}
+		err = json.Unmarshal([]byte(lines[i]), &out)
+		require.NoError(t, err)
+
+		_, err = time.Parse(time.RFC3339Nano, out["time"].(string))
+		require.NoError(t, err)
+		delete(out, "time")
+
+		require.Equal(t, ca, out)
+	}
+}
+
+type testWriter struct {
+	entries [][]interface{}
+}
+
+func (w *testWriter) Log(_ Level, format string, args ...interface{}) {
+	w.entries = append(w.entries, append([]interface{}{format}, args...))
+}
+
+func TestSampler(t *testing.T) {
+	w := &testWriter{}
+	s := NewSampler(w)
+
+	path := Field{Key: "path", Label: "path", Value: "mypath"}
+
+	for i := 0; i < 250; i++ {
+		s.Sample(EventPacketsLost, Warn, "%d packets lost", path, i)
+	}
+	s.Sample(EventDecodeError, Warn, "decode error")
+	s.Sample(EventDecodeError, Warn, "decode error")
+
+	require.Equal(t, [][]interface{}{
+		{"%d packets lost", path, 0},
+		{"%d packets lost", suppressedField(99), path, 100},
+		{"%d packets lost", suppressedField(99), path, 200},
+		{"decode error"},
+	}, w.entries)
+}
+
+func BenchmarkLog(b *testing.B) {
+	dir, err := os.MkdirTemp("", "mediamtx-logger")
+	require.NoError(b, err)
+	defer os.RemoveAll(dir)
+
+	l, err := New(Info, []Destination{DestinationFile}, filepath.Join(dir, "mediamtx.log"), false)
+	require.NoError(b, err)
+	defer l.Close()
+
+	b.ReportAllocs()
+	b.ResetTimer()
+
+	for i := 0; i < b.N; i++ {
+		l.Log(Warn, "write queue is full", Field{Key: "path", Label: "path", Value: "mypath"})
+	}
+}
@@ -0,0 +1,94 @@
+package logger
+
+import (
+	"sync"
+)
+
+// keys of sampled events.
+const (
+	// EventDecodeError is emitted when a packet or frame cannot be decoded.
+	EventDecodeError = "decodeError"
+
+	// EventPacketsLost is emitted when packets are lost.
+	EventPacketsLost = "packetsLost"
+)
+
+// number of events of each kind that are represented by a single printed event.
+var sampleRates = map[string]uint64{
+	EventDecodeError: 1000,
+	EventPacketsLost: 100,
+}
+
+// sampling rate of events whose key is not listed in sampleRates.
+const defaultSampleRate = 100
+
+func suppressedField(n uint64) Field {
+	return Field{
+		Key:      "suppressed",
+		Label:    "suppressed",
+		Value:    n,
+		Trailing: true,
+	}
+}
+
+type samplerCounter struct {
+	count      uint64
+	suppressed uint64
+}
+
+// Sampler is a wrapper around a Writer that samples events by key.
+// The first event of each key is printed, then one every N events,
+// where N is the sampling rate of the key.
+// Events that are not printed are counted, and their count
+// is attached to the next printed event of the same key as a "suppressed" field.
+type Sampler struct {
+	w Writer
+
+	mutex    sync.Mutex
+	counters map[string]*samplerCounter
+}
+
+// NewSampler allocates a Sampler.
+func NewSampler(w Writer) *Sampler {
+	return &Sampler{
+		w:        w,
+		counters: make(map[string]*samplerCounter),
+	}
+}
+
+// Sample emits an event.
+// args can start with fields, like in Log().
+func (s *Sampler) Sample(key string, level Level, format string, args ...interface{}) {
+	rate, ok := sampleRates[key]
+	if !ok {
+		rate = defaultSampleRate
+	}
+
+	s.mutex.Lock()
+
+	c, ok := s.counters[key]
+	if !ok {
+		c = &samplerCounter{}
+		s.counters[key] = c
+	}
+
+	n := c.count
+	c.count++
+
+	if n%rate != 0 {
+		c.suppressed++
+		s.mutex.Unlock()
+		return
+	}
+
+	suppressed := c.suppressed
+	c.suppressed = 0
+
+	s.mutex.Unlock()
+
+	if suppressed != 0 {
+		args = WithField(suppressedField(suppressed), args)
+	}
+
+	s.w.Log(level, format, args...)
+}
@@ -0,0 +1,165 @@
+package logger
+
+import (
+	"bytes"
+	"fmt"
+	"time"
+	"unicode/utf8"
+)
+
+const hexDigits = "0123456789abcdef"
+
+var levelNames = map[Level]string{
+	Debug: "debug",
+	Info:  "info",
+	Warn:  "warn",
+	Error: "error",
+}
+
+func writeJSONString(buf *bytes.Buffer, s []byte) {
+	buf.WriteByte('"')
+	writeJSONStringContent(buf, s)
+	buf.WriteByte('"')
+}
+
+func writeJSONStringContent(buf *bytes.Buffer, s []byte) {
+	start := 0
+
+	for i := 0; i < len(s); {
+		c := s[i]
+
+		if c < utf8.RuneSelf {
+			if c >= 0x20 && c != '"' && c != '\\' {
+				i++
+				continue
+			}
+
+			buf.Write(s[start:i])
+
+			switch c {
+			case '"', '\\':
+				buf.WriteByte('\\')
+				buf.WriteByte(c)
+
+			case '\n':
+				buf.WriteString(`\n`)
+
+			case '\r':
+				buf.WriteString(`\r`)
+
+			case '\t':
+				buf.WriteString(`\t`)
+
+			default:
+				buf.WriteString(`\u00`)
+				buf.WriteByte(hexDigits[c>>4])
+				buf.WriteByte(hexDigits[c&0xF])
+			}
+
+			i++
+			start = i
+			continue
+		}
+
+		r, size := utf8.DecodeRune(s[i:])
+		if r == utf8.RuneError && size == 1 {
+			buf.Write(s[start:i])
+			buf.WriteString(`�`)
+			i += size
+			start = i
+			continue
+		}
+
+		i += size
+	}
+
+	buf.Write(s[start:])
+}
+
+func writeJSONField(buf *bytes.Buffer, key string, value []byte) {
+	buf.WriteString(`,"`)
+	buf.WriteString(key)
+	buf.WriteString(`":`)
+	writeJSONString(buf, value)
+}
+
+func writeJSONFieldValueContent(buf *bytes.Buffer, v interface{}) {
+	if str, ok := v.(string); ok {
+		writeJSONStringContent(buf, []byte(str))
+	} else {
+		writeJSONStringContent(buf, fmt.Append(nil, v))
+	}
+}
+
+func writeJSONFieldValue(buf *bytes.Buffer, v interface{}) {
+	if isNumericFieldValue(v) {
+		writeFieldValue(buf, v)
+		return
+	}
+
+	buf.WriteByte('"')
+	writeJSONFieldValueContent(buf, v)
+	buf.WriteByte('"')
+}
+
+// isModuleField checks whether a field has to be joined into the "module" key,
+// that happens when its key is "module" or has already been used by a previous field.
+func isModuleField(fields []Field, i int) bool {
+	if fields[i].Key == "module" {
+		return true
+	}
+	for _, f := range fields[:i] {
+		if f.Key == fields[i].Key {
+			return true
+		}
+	}
+	return false
+}
+
+// writeStructured writes an entry as a JSON line.
+// Fields are written as separate keys, except for module fields,
+// that are joined into a single "module" key.
+func writeStructured(buf *bytes.Buffer, e *entry) {
+	buf.WriteString(`{"time":"`)
+	buf.Write(e.t.AppendFormat(buf.AvailableBuffer(), time.RFC3339Nano))
+	buf.WriteString(`","level":"`)
+	buf.WriteString(levelNames[e.level])
+	buf.WriteByte('"')
+
+	hasModules := false
+
+	for i, f := range e.fields {
+		if isModuleField(e.fields, i) {
+			hasModules = true
+			continue
+		}
+
+		buf.WriteString(`,"`)
+		buf.WriteString(f.Key)
+		buf.WriteString(`":`)
+		writeJSONFieldValue(buf, f.Value)
+	}
+
+	if hasModules {
+		buf.WriteString(`,"module":"`)
+		first := true
+		for i, f := range e.fields {
+			if !isModuleField(e.fields, i) {
+				continue
+			}
+			if !first {
+				buf.WriteByte('/')
+			}
+			first = false
+			if f.Label != "" {
+				writeJSONStringContent(buf, []byte(f.Label))
+				buf.WriteByte(' ')
+			}
+			writeJSONFieldValueContent(buf, f.Value)
+		}
+		buf.WriteByte('"')
+	}
+
+	writeJSONField(buf, "message", e.content)
+	buf.WriteString("}\n")
+}
@@ -0,0 +1,206 @@
+// Package membudget contains a global memory budget.
+package membudget
+
+import (
+	"sync"
+	"sync/atomic"
+)
+
+// Subsystem is a subsystem that holds memory.
+type Subsystem int
+
+// subsystems.
+const (
+	SubsystemReaderQueues Subsystem = iota
+	SubsystemHLSSegments
+	SubsystemKeyFrameCache
+	SubsystemRecorderBuffers
+	subsystemCount
+)
+
+// String implements fmt.Stringer.
+func (s Subsystem) String() string {
+	switch s {
+	case SubsystemReaderQueues:
+		return "readerQueues"
+	case SubsystemHLSSegments:
+		return "hlsSegments"
+	case SubsystemKeyFrameCache:
+		return "keyFrameCache"
+	case SubsystemRecorderBuffers:
+		return "recorderBuffers"
+	}
+	return "unknown"
+}
+
+// Subsystems returns all subsystems.
+func Subsystems() []Subsystem {
+	ret := make([]Subsystem, subsystemCount)
+	for i := range ret {
+		ret[i] = Subsystem(i)
+	}
+	return ret
+}
+
+// Budget tracks bytes held by reader queues, HLS segments, key frame caches and recorder buffers,
+// and decides whether new readers can be admitted.
+//
+// Bytes can be accounted either with Acquire() and Release(), or by registering a counter
+// that is owned by a single holder, like a reader queue, and that is summed only when the total is read.
+// The latter avoids writing a counter shared by all holders every time bytes are held.
+//
+// Methods can be called on a nil Budget, in which case they do nothing.
+type Budget struct {
+	max             *uint64
+	keyFramesOnly   *uint32
+	used            [subsystemCount]*uint64
+	readersRejected *uint64
+	readersDegraded *uint64
+
+	countersMutex sync.Mutex
+	counters      [subsystemCount]map[*uint64]struct{}
+}
+
+// Initialize initializes a Budget.
+func (b *Budget) Initialize() {
+	b.max = new(uint64)
+	b.keyFramesOnly = new(uint32)
+	for i := range b.used {
+		b.used[i] = new(uint64)
+		b.counters[i] = make(map[*uint64]struct{})
+	}
+	b.readersRejected = new(uint64)
+	b.readersDegraded = new(uint64)
+}
+
+// SetLimit sets the maximum amount of bytes (0 means unlimited)
+// and whether readers that exceed the budget are degraded to key frames only instead of being rejected.
+// It can be called at any time.
+func (b *Budget) SetLimit(max uint64, keyFramesOnly bool) {
+	atomic.StoreUint64(b.max, max)
+	if keyFramesOnly {
+		atomic.StoreUint32(b.keyFramesOnly, 1)
+	} else {
+		atomic.StoreUint32(b.keyFramesOnly, 0)
+	}
+}
+
+// Max returns the maximum amount of bytes.
+func (b *Budget) Max() uint64 {
+	if b == nil {
+		return 0
+	}
+	return atomic.LoadUint64(b.max)
+}
+
+// Acquire accounts for bytes held by a subsystem.
+func (b *Budget) Acquire(s Subsystem, n uint64) {
+	if b == nil || n == 0 {
+		return
+	}
+	atomic.AddUint64(b.used[s], n)
+}
+
+// Release accounts for bytes released by a subsystem.
+func (b *Budget) Release(s Subsystem, n uint64) {
+	if b == nil || n == 0 {
+		return
+	}
+	atomic.AddUint64(b.used[s], ^(n - 1))
+}
+
+// AddCounter registers a counter of bytes held by a subsystem.
+// The counter must be updated atomically.
+func (b *Budget) AddCounter(s Subsystem, counter *uint64) {
+	if b == nil {
+		return
+	}
+	b.countersMutex.Lock()
+	defer b.countersMutex.Unlock()
+	b.counters[s][counter] = struct{}{}
+}
+
+// RemoveCounter unregisters a counter. Bytes that are still in the counter are released.
+func (b *Budget) RemoveCounter(s Subsystem, counter *uint64) {
+	if b == nil {
+		return
+	}
+	b.countersMutex.Lock()
+	defer b.countersMutex.Unlock()
+	delete(b.counters[s], counter)
+}
+
+// Used returns bytes held by a subsystem.
+func (b *Budget) Used(s Subsystem) uint64 {
+	if b == nil {
+		return 0
+	}
+
+	ret := atomic.LoadUint64(b.used[s])
+
+	b.countersMutex.Lock()
+	defer b.countersMutex.Unlock()
+
+	for c := range b.counters[s] {
+		ret += atomic.LoadUint64(c)
+	}
+
+	return ret
+}
+
+// Total returns bytes held by all subsystems.
+func (b *Budget) Total() uint64 {
+	if b == nil {
+		return 0
+	}
+	var ret uint64
+	for i := range b.used {
+		ret += b.Used(Subsystem(i))
+	}
+	return ret
+}
+
+// Exceeded returns whether the budget is exceeded.
+func (b *Budget) Exceeded() bool {
+	max := b.Max()
+	return max != 0 && b.Total() >= max
+}
+
+// AdmitReader returns whether a new reader can be added.
+// Readers are rejected when the budget is exceeded, unless they are degraded to key frames only.
+// It must be called once per reader, since rejections are counted.
+func (b *Budget) AdmitReader() bool {
+	if !b.Exceeded() || atomic.LoadUint32(b.keyFramesOnly) == 1 {
+		return true
+	}
+
+	atomic.AddUint64(b.readersRejected, 1)
+	return false
+}
+
+// DegradeReader returns whether a new reader must receive key frames only.
+// It must be called once per reader, since degradations are counted.
+func (b *Budget) DegradeReader() bool {
+	if !b.Exceeded() || atomic.LoadUint32(b.keyFramesOnly) == 0 {
+		return false
+	}
+
+	atomic.AddUint64(b.readersDegraded, 1)
+	return true
+}
+
+// ReadersRejected returns the number of readers that have been rejected.
+func (b *Budget) ReadersRejected() uint64 {
+	if b == nil {
+		return 0
+	}
+	return atomic.LoadUint64(b.readersRejected)
+}
+
+// ReadersDegraded returns the number of readers that have been degraded to key frames only.
+func (b *Budget) ReadersDegraded() uint64 {
+	if b == nil {
+		return 0
+	}
+	return atomic.LoadUint64(b.readersDegraded)
+}
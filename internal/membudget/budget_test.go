@@ -0,0 +1,88 @@
+package membudget
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestBudget(t *testing.T) {
+	var b Budget
+	b.Initialize()
+
+	b.Acquire(SubsystemReaderQueues, 600)
+	b.Acquire(SubsystemHLSSegments, 500)
+	require.Equal(t, uint64(1100), b.Total())
+	require.False(t, b.Exceeded())
+	require.True(t, b.AdmitReader())
+
+	b.SetLimit(1000, false)
+	require.True(t, b.Exceeded())
+	require.False(t, b.AdmitReader())
+	require.False(t, b.DegradeReader())
+
+	b.SetLimit(1000, true)
+	require.True(t, b.AdmitReader())
+	require.True(t, b.DegradeReader())
+
+	b.Release(SubsystemReaderQueues, 600)
+	require.Equal(t, uint64(500), b.Total())
+	require.False(t, b.Exceeded())
+	require.True(t, b.AdmitReader())
+	require.False(t, b.DegradeReader())
+
+	require.Equal(t, uint64(1), b.ReadersRejected())
+	require.Equal(t, uint64(1), b.ReadersDegraded())
+}
+
+func TestBudgetCounters(t *testing.T) {
+	var b Budget
+	b.Initialize()
+
+	c1 := new(uint64)
+	c2 := new(uint64)
+	b.AddCounter(SubsystemReaderQueues, c1)
+	b.AddCounter(SubsystemReaderQueues, c2)
+	b.Acquire(SubsystemReaderQueues, 100)
+
+	*c1 = 200
+	*c2 = 300
+	require.Equal(t, uint64(600), b.Used(SubsystemReaderQueues))
+	require.Equal(t, uint64(600), b.Total())
+
+	b.RemoveCounter(SubsystemReaderQueues, c2)
+	require.Equal(t, uint64(300), b.Total())
+}
+
+func TestBudgetNil(t *testing.T) {
+	var b *Budget
+	b.Acquire(SubsystemReaderQueues, 100)
+	b.Release(SubsystemReaderQueues, 100)
+	require.Equal(t, uint64(0), b.Total())
+	require.True(t, b.AdmitReader())
+	require.False(t, b.DegradeReader())
+}
+
+func TestRetention(t *testing.T) {
+	var b Budget
+	b.Initialize()
+
+	r := &Retention{
+		Budget:    &b,
+		Subsystem: SubsystemHLSSegments,
+		Duration:  10 * time.Second,
+		Max:       50000,
+	}
+
+	now := time.Date(2010, 1, 1, 0, 0, 0, 0, time.UTC)
+	r.Write(1000, now)
+	r.Write(1000, now.Add(2*time.Second))
+	require.Equal(t, uint64(10000), b.Used(SubsystemHLSSegments))
+
+	r.Write(100000, now.Add(3*time.Second))
+	require.Equal(t, uint64(50000), b.Used(SubsystemHLSSegments))
+
+	r.Close()
+	require.Equal(t, uint64(0), b.Used(SubsystemHLSSegments))
+}
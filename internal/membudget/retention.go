@@ -0,0 +1,56 @@
+package membudget
+
+import (
+	"time"
+)
+
+const (
+	retentionWindow = 1 * time.Second
+)
+
+// Retention estimates bytes held by a buffer that retains data for a fixed duration,
+// like the segments of a HLS muxer, by multiplying the input bitrate by the duration.
+//
+// It is not thread safe.
+type Retention struct {
+	Budget    *Budget
+	Subsystem Subsystem
+	Duration  time.Duration
+	Max       uint64
+
+	windowStart time.Time
+	windowBytes uint64
+	held        uint64
+}
+
+// Write accounts for bytes written into the buffer.
+func (r *Retention) Write(n uint64, now time.Time) {
+	if r.windowStart.IsZero() {
+		r.windowStart = now
+	}
+
+	r.windowBytes += n
+
+	elapsed := now.Sub(r.windowStart)
+	if elapsed < retentionWindow {
+		return
+	}
+
+	held := uint64(float64(r.windowBytes) * r.Duration.Seconds() / elapsed.Seconds())
+	if r.Max != 0 && held > r.Max {
+		held = r.Max
+	}
+
+	r.Budget.Acquire(r.Subsystem, held)
+	r.Budget.Release(r.Subsystem, r.held)
+	r.held = held
+
+	r.windowStart = now
+	r.windowBytes = 0
+}
+
+// Close releases bytes held by the buffer.
+func (r *Retention) Close() {
+	r.Budget.Release(r.Subsystem, r.held)
+	r.held = 0
+}
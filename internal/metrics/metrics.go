@@ -6,6 +6,7 @@ import (
 	"net"
 	"net/http"
 	"reflect"
+	"sort"
 	"strconv"
 	"sync"
 	"time"
@@ -15,7 +16,9 @@ import (
 	"github.com/bluenviron/mediamtx/internal/api"
 	"github.com/bluenviron/mediamtx/internal/auth"
 	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/protocols/httpp"
 	"github.com/bluenviron/mediamtx/internal/restrictnetwork"
 )
@@ -32,6 +35,33 @@ func metricFloat(key string, tags string, value float64) string {
 	return key + tags + " " + strconv.FormatFloat(value, 'f', -1, 64) + "\n"
 }
 
+func metricHistogram(key string, tags string, h *defs.APIHistogram) string {
+	bucketTags := func(le string) string {
+		if tags == "" {
+			return "{le=\"" + le + "\"}"
+		}
+		return tags[:len(tags)-1] + ",le=\"" + le + "\"}"
+	}
+
+	out := ""
+	for _, b := range h.Buckets {
+		out += metric(key+"_bucket", bucketTags(strconv.FormatFloat(b.Le, 'f', -1, 64)), int64(b.Count))
+	}
+	out += metric(key+"_bucket", bucketTags("+Inf"), int64(h.Count))
+	out += metricFloat(key+"_sum", tags, h.Sum)
+	out += metric(key+"_count", tags, int64(h.Count))
+	return out
+}
+
+func sortedKeys(m map[string]*defs.APIHistogram) []string {
+	keys := make([]string, 0, len(m))
+	for k := range m {
+		keys = append(keys, k)
+	}
+	sort.Strings(keys)
+	return keys
+}
+
 type metricsAuthManager interface {
 	Authenticate(req *auth.Request) error
 }
@@ -50,6 +80,7 @@ type Metrics struct {
 	TrustedProxies conf.IPNetworks
 	ReadTimeout    conf.StringDuration
 	AuthManager    metricsAuthManager
+	MemoryBudget   *membudget.Budget // optional
 	Parent         metricsParent
 
 	httpServer   *httpp.WrappedServer
@@ -100,7 +131,7 @@ func (m *Metrics) Close() {
 
 // Log implements logger.Writer.
 func (m *Metrics) Log(level logger.Level, format string, args ...interface{}) {
-	m.Parent.Log(level, "[metrics] "+format, args...)
+	m.Parent.Log(level, format, logger.WithField(logger.Module("metrics"), args)...)
 }
 
 func (m *Metrics) onRequest(ctx *gin.Context) {
@@ -150,11 +181,42 @@ func (m *Metrics) onRequest(ctx *gin.Context) {
 			out += metric("paths", tags, 1)
 			out += metric("paths_bytes_received", tags, int64(i.BytesReceived))
 			out += metric("paths_bytes_sent", tags, int64(i.BytesSent))
+			out += metricFloat("paths_transcoding_cpu_seconds", tags, i.TranscodingCPUTime)
+
+			if i.JitterBuffer != nil {
+				out += metric("paths_rtp_packets_reordered", tags, int64(i.JitterBuffer.PacketsReordered))
+				out += metric("paths_rtp_packets_late", tags, int64(i.JitterBuffer.PacketsLate))
+				out += metric("paths_rtp_packets_duplicate", tags, int64(i.JitterBuffer.PacketsDuplicate))
+				out += metric("paths_rtp_packets_lost", tags, int64(i.JitterBuffer.PacketsLost))
+				out += metric("paths_rtp_reorder_depth", tags, int64(i.JitterBuffer.ReorderDepth))
+				out += metricFloat("paths_rtp_jitter_buffer_delay_seconds", tags, i.JitterBuffer.Delay)
+			}
+
+			for _, typ := range sortedKeys(i.ReaderQueueDelays) {
+				out += metricHistogram("paths_readers_queue_delay_seconds",
+					"{name=\""+i.Name+"\",state=\""+state+"\",reader=\""+typ+"\"}", i.ReaderQueueDelays[typ])
+			}
 		}
 	} else {
 		out += metric("paths", "", 0)
 	}
 
+	upstreams := m.pathManager.APIStaticSourceUpstreams()
+	out += metric("static_source_upstreams", "", int64(upstreams.Upstreams))
+	out += metric("static_source_upstreams_shared", "", int64(upstreams.SharedUpstreams))
+	out += metric("static_source_upstream_paths", "", int64(upstreams.Paths))
+	out += metric("static_source_upstreams_bytes_received", "", int64(upstreams.BytesReceived))
+	out += metric("static_source_upstreams_bytes_sent", "", int64(upstreams.BytesSent))
+
+	if m.MemoryBudget != nil {
+		out += metric("memory_budget_limit_bytes", "", int64(m.MemoryBudget.Max()))
+		for _, s := range membudget.Subsystems() {
+			out += metric("memory_budget_used_bytes", "{subsystem=\""+s.String()+"\"}", int64(m.MemoryBudget.Used(s)))
+		}
+		out += metric("memory_budget_readers_rejected", "", int64(m.MemoryBudget.ReadersRejected()))
+		out += metric("memory_budget_readers_degraded", "", int64(m.MemoryBudget.ReadersDegraded()))
+	}
+
 	if !interfaceIsEmpty(m.hlsManager) {
 		data, err := m.hlsManager.APIMuxersList()
 		if err == nil && len(data.Items) != 0 {
@@ -348,6 +410,8 @@ func (m *Metrics) onRequest(ctx *gin.Context) {
 			out += metric("webrtc_sessions_bytes_received", "", 0)
 			out += metric("webrtc_sessions_bytes_sent", "", 0)
 		}
+
+		out += metricHistogram("webrtc_sessions_setup_seconds", "", m.webRTCServer.APISessionSetupTimes())
 	}
 
 	ctx.Writer.WriteHeader(http.StatusOK)
@@ -0,0 +1,21 @@
+package playback
+
+// muxerKeyFrames is a muxer that discards non-key frames.
+// Payloads of discarded frames are not read.
+type muxerKeyFrames struct {
+	muxer
+}
+
+func (w *muxerKeyFrames) writeSample(
+	dts int64,
+	ptsOffset int32,
+	isNonSyncSample bool,
+	payloadSize uint32,
+	getPayload func() ([]byte, error),
+) error {
+	if isNonSyncSample {
+		return nil
+	}
+
+	return w.muxer.writeSample(dts, ptsOffset, isNonSyncSample, payloadSize, getPayload)
+}
@@ -0,0 +1,56 @@
+package playback
+
+import (
+	"testing"
+
+	"github.com/bluenviron/mediacommon/pkg/formats/fmp4"
+	"github.com/stretchr/testify/require"
+)
+
+type testMuxer struct {
+	dtss []int64
+}
+
+func (*testMuxer) writeInit(*fmp4.Init) {}
+
+func (*testMuxer) setTrack(int) {}
+
+func (m *testMuxer) writeSample(
+	dts int64,
+	_ int32,
+	_ bool,
+	_ uint32,
+	getPayload func() ([]byte, error),
+) error {
+	_, err := getPayload()
+	if err != nil {
+		return err
+	}
+	m.dtss = append(m.dtss, dts)
+	return nil
+}
+
+func (*testMuxer) writeFinalDTS(int64) {}
+
+func (*testMuxer) flush() error {
+	return nil
+}
+
+func TestMuxerKeyFrames(t *testing.T) {
+	inner := &testMuxer{}
+	m := &muxerKeyFrames{muxer: inner}
+
+	payloadsRead := 0
+	getPayload := func() ([]byte, error) {
+		payloadsRead++
+		return []byte{1}, nil
+	}
+
+	for i, isNonSyncSample := range []bool{false, true, true, false, true} {
+		err := m.writeSample(int64(i)*90000, 0, isNonSyncSample, 1, getPayload)
+		require.NoError(t, err)
+	}
+
+	require.Equal(t, []int64{0, 3 * 90000}, inner.dtss)
+	require.Equal(t, 2, payloadsRead)
+}
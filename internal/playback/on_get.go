@@ -11,6 +11,7 @@ import (
 
 	"github.com/bluenviron/mediacommon/pkg/formats/fmp4"
 	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
 	"github.com/gin-gonic/gin"
 )
@@ -146,6 +147,10 @@ func (p *Server) onGet(ctx *gin.Context) {
 		return
 	}
 
+	if defs.ReaderKeyFramesOnly(ctx.Request.URL.RawQuery) {
+		m = &muxerKeyFrames{muxer: m}
+	}
+
 	pathConf, err := p.safeFindPathConf(pathName)
 	if err != nil {
 		p.writeError(ctx, http.StatusBadRequest, err)
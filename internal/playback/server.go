@@ -80,7 +80,7 @@ func (s *Server) Close() {
 
 // Log implements logger.Writer.
 func (s *Server) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[playback] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("playback"), args)...)
 }
 
 // ReloadPathConfs is called by core.Core.
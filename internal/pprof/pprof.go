@@ -76,7 +76,7 @@ func (pp *PPROF) Close() {
 
 // Log implements logger.Writer.
 func (pp *PPROF) Log(level logger.Level, format string, args ...interface{}) {
-	pp.Parent.Log(level, "[pprof] "+format, args...)
+	pp.Parent.Log(level, format, logger.WithField(logger.Module("pprof"), args)...)
 }
 
 func (pp *PPROF) onRequest(ctx *gin.Context) {
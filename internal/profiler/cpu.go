@@ -0,0 +1,293 @@
+package profiler
+
+import (
+	"bytes"
+	"compress/gzip"
+	"context"
+	"encoding/binary"
+	"fmt"
+	"io"
+	"runtime/pprof"
+	"time"
+)
+
+// field numbers of the profile.proto messages.
+// The profile is decoded manually since only a few fields are needed.
+const (
+	fieldProfileSampleType  = 1
+	fieldProfileSample      = 2
+	fieldProfileStringTable = 6
+	fieldValueTypeType      = 1
+	fieldSampleValue        = 2
+	fieldSampleLabel        = 3
+	fieldLabelKey           = 1
+	fieldLabelStr           = 2
+)
+
+// CPUBreakdown is the CPU time consumed during a sampling window.
+type CPUBreakdown struct {
+	// CPU time of goroutines, grouped by labels.
+	// Goroutines without labels are grouped under empty labels.
+	Items map[Labels]time.Duration
+	Total time.Duration
+}
+
+type rawLabel struct {
+	key int64
+	str int64
+}
+
+type rawSample struct {
+	values []int64
+	labels []rawLabel
+}
+
+type rawProfile struct {
+	sampleTypes []int64
+	samples     []rawSample
+	strings     []string
+}
+
+// SampleCPU profiles the CPU for the given duration and returns the CPU time consumed by each label set.
+// It fails if another CPU profile is in progress.
+func SampleCPU(ctx context.Context, duration time.Duration) (*CPUBreakdown, error) {
+	var buf bytes.Buffer
+
+	err := pprof.StartCPUProfile(&buf)
+	if err != nil {
+		return nil, err
+	}
+
+	t := time.NewTimer(duration)
+	select {
+	case <-t.C:
+	case <-ctx.Done():
+		t.Stop()
+		pprof.StopCPUProfile()
+		return nil, fmt.Errorf("terminated")
+	}
+
+	pprof.StopCPUProfile()
+
+	return parseCPUProfile(buf.Bytes())
+}
+
+func parseCPUProfile(byts []byte) (*CPUBreakdown, error) {
+	r, err := gzip.NewReader(bytes.NewReader(byts))
+	if err != nil {
+		return nil, err
+	}
+
+	byts, err = io.ReadAll(r)
+	if err != nil {
+		return nil, err
+	}
+
+	var p rawProfile
+	err = p.unmarshal(byts)
+	if err != nil {
+		return nil, err
+	}
+
+	str := func(i int64) string {
+		if i < 0 || i >= int64(len(p.strings)) {
+			return ""
+		}
+		return p.strings[i]
+	}
+
+	// CPU profiles contain "samples/count" and "cpu/nanoseconds"
+	valueIndex := -1
+	for i, typ := range p.sampleTypes {
+		if str(typ) == "cpu" {
+			valueIndex = i
+			break
+		}
+	}
+	if valueIndex < 0 {
+		return nil, fmt.Errorf("CPU sample type not found")
+	}
+
+	ret := &CPUBreakdown{
+		Items: make(map[Labels]time.Duration),
+	}
+
+	for _, s := range p.samples {
+		if valueIndex >= len(s.values) {
+			continue
+		}
+		v := time.Duration(s.values[valueIndex])
+
+		var l Labels
+		for _, label := range s.labels {
+			switch str(label.key) {
+			case labelPath:
+				l.Path = str(label.str)
+			case labelProtocol:
+				l.Protocol = str(label.str)
+			case labelRole:
+				l.Role = str(label.str)
+			}
+		}
+
+		ret.Items[l] += v
+		ret.Total += v
+	}
+
+	return ret, nil
+}
+
+// wire types of the protobuf encoding.
+const (
+	wireVarint = 0
+	wireI64    = 1
+	wireBytes  = 2
+	wireI32    = 5
+)
+
+func consumeVarint(byts []byte) (uint64, []byte, error) {
+	v, n := binary.Uvarint(byts)
+	if n <= 0 {
+		return 0, nil, fmt.Errorf("invalid varint")
+	}
+	return v, byts[n:], nil
+}
+
+// forEachField calls cb for each field of a protobuf message.
+// val is filled with the content of length-delimited fields, v with the value of varint fields.
+func forEachField(byts []byte, cb func(num uint64, typ uint64, val []byte, v uint64) error) error {
+	for len(byts) != 0 {
+		tag, rest, err := consumeVarint(byts)
+		if err != nil {
+			return err
+		}
+		byts = rest
+
+		num := tag >> 3
+		typ := tag & 0x07
+
+		var val []byte
+		var v uint64
+
+		switch typ {
+		case wireVarint:
+			v, byts, err = consumeVarint(byts)
+			if err != nil {
+				return err
+			}
+
+		case wireBytes:
+			var l uint64
+			l, byts, err = consumeVarint(byts)
+			if err != nil {
+				return err
+			}
+			if l > uint64(len(byts)) {
+				return fmt.Errorf("invalid field length")
+			}
+			val, byts = byts[:l], byts[l:]
+
+		case wireI64:
+			if len(byts) < 8 {
+				return fmt.Errorf("invalid field length")
+			}
+			byts = byts[8:]
+
+		case wireI32:
+			if len(byts) < 4 {
+				return fmt.Errorf("invalid field length")
+			}
+			byts = byts[4:]
+
+		default:
+			return fmt.Errorf("unsupported wire type %d", typ)
+		}
+
+		err = cb(num, typ, val, v)
+		if err != nil {
+			return err
+		}
+	}
+
+	return nil
+}
+
+// unmarshalInt64s decodes a repeated int64 field, that can be either packed or not.
+func unmarshalInt64s(dest []int64, typ uint64, val []byte, v uint64) ([]int64, error) {
+	if typ == wireVarint {
+		return append(dest, int64(v)), nil
+	}
+
+	for len(val) != 0 {
+		var err error
+		v, val, err = consumeVarint(val)
+		if err != nil {
+			return nil, err
+		}
+		dest = append(dest, int64(v))
+	}
+
+	return dest, nil
+}
+
+func (p *rawProfile) unmarshal(byts []byte) error {
+	return forEachField(byts, func(num uint64, typ uint64, val []byte, _ uint64) error {
+		switch {
+		case num == fieldProfileSampleType && typ == wireBytes:
+			return forEachField(val, func(num uint64, typ uint64, _ []byte, v uint64) error {
+				if num == fieldValueTypeType && typ == wireVarint {
+					p.sampleTypes = append(p.sampleTypes, int64(v))
+				}
+				return nil
+			})
+
+		case num == fieldProfileSample && typ == wireBytes:
+			var s rawSample
+			err := s.unmarshal(val)
+			if err != nil {
+				return err
+			}
+			p.samples = append(p.samples, s)
+
+		case num == fieldProfileStringTable && typ == wireBytes:
+			p.strings = append(p.strings, string(val))
+		}
+
+		return nil
+	})
+}
+
+func (s *rawSample) unmarshal(byts []byte) error {
+	return forEachField(byts, func(num uint64, typ uint64, val []byte, v uint64) error {
+		switch num {
+		case fieldSampleValue:
+			var err error
+			s.values, err = unmarshalInt64s(s.values, typ, val, v)
+			return err
+
+		case fieldSampleLabel:
+			if typ != wireBytes {
+				return nil
+			}
+
+			var l rawLabel
+			err := forEachField(val, func(num uint64, typ uint64, _ []byte, v uint64) error {
+				if typ == wireVarint {
+					switch num {
+					case fieldLabelKey:
+						l.key = int64(v)
+					case fieldLabelStr:
+						l.str = int64(v)
+					}
+				}
+				return nil
+			})
+			if err != nil {
+				return err
+			}
+			s.labels = append(s.labels, l)
+		}
+
+		return nil
+	})
+}
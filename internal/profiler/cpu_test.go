@@ -0,0 +1,48 @@
+package profiler
+
+import (
+	"context"
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestSampleCPU(t *testing.T) {
+	done := make(chan struct{})
+	defer close(done)
+
+	l := Labels{
+		Path:     "mypath",
+		Protocol: "rtsp",
+		Role:     "source",
+	}
+
+	go func() {
+		SetGoroutineLabels(l)
+
+		for {
+			select {
+			case <-done:
+				return
+			default:
+			}
+
+			n := 0
+			for i := 0; i < 100000; i++ {
+				n += i
+			}
+			_ = n
+		}
+	}()
+
+	b, err := SampleCPU(context.Background(), 500*time.Millisecond)
+	require.NoError(t, err)
+	require.NotZero(t, b.Items[l])
+	require.GreaterOrEqual(t, b.Total, b.Items[l])
+}
+
+func TestSourceProtocol(t *testing.T) {
+	require.Equal(t, "rtsps", SourceProtocol("rtsps://localhost:8554/mystream"))
+	require.Equal(t, "rpiCamera", SourceProtocol("rpiCamera"))
+}
@@ -0,0 +1,58 @@
+// Package profiler allows to attribute CPU usage to paths.
+package profiler
+
+import (
+	"context"
+	"runtime/pprof"
+	"strings"
+)
+
+const (
+	labelPath     = "path"
+	labelProtocol = "protocol"
+	labelRole     = "role"
+)
+
+// Labels are the profiler labels of a goroutine.
+type Labels struct {
+	Path     string
+	Protocol string
+	Role     string
+}
+
+// SetGoroutineLabels sets the profiler labels of the current goroutine.
+// They are inherited by goroutines that are started by the current goroutine after the call,
+// therefore it must be called before starting workers (asyncwriters, muxers, clients, etc).
+func SetGoroutineLabels(l Labels) {
+	pprof.SetGoroutineLabels(LabelContext(l))
+}
+
+// LabelContext returns a context that contains the given labels.
+// It can be computed once and passed to SetGoroutineLabelContext many times.
+func LabelContext(l Labels) context.Context {
+	return pprof.WithLabels(context.Background(), pprof.Labels(
+		labelPath, l.Path,
+		labelProtocol, l.Protocol,
+		labelRole, l.Role))
+}
+
+// SetGoroutineLabelContext sets the profiler labels of the current goroutine
+// from a context returned by LabelContext.
+// It allows to attribute work that is performed on goroutines that are not owned by the caller,
+// that must be given back without labels by calling ResetGoroutineLabels.
+func SetGoroutineLabelContext(ctx context.Context) {
+	pprof.SetGoroutineLabels(ctx)
+}
+
+// ResetGoroutineLabels removes the profiler labels of the current goroutine.
+func ResetGoroutineLabels() {
+	pprof.SetGoroutineLabels(context.Background())
+}
+
+// SourceProtocol returns the protocol of a static source.
+func SourceProtocol(source string) string {
+	if i := strings.Index(source, "://"); i >= 0 {
+		return source[:i]
+	}
+	return source
+}
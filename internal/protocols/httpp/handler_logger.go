@@ -10,9 +10,9 @@ import (
 )
 
 type loggerWriter struct {
-	w      http.ResponseWriter
-	status int
-	buf    bytes.Buffer
+	w        http.ResponseWriter
+	status   int
+	bodySize int
 }
 
 func (w *loggerWriter) Header() http.Header {
@@ -23,7 +23,7 @@ func (w *loggerWriter) Write(b []byte) (int, error) {
 	if w.status == 0 {
 		w.status = http.StatusOK
 	}
-	w.buf.Write(b)
+	w.bodySize += len(b)
 	return w.w.Write(b)
 }
 
@@ -32,13 +32,20 @@ func (w *loggerWriter) WriteHeader(statusCode int) {
 	w.w.WriteHeader(statusCode)
 }
 
+// Flush implements http.Flusher, needed by streaming responses.
+func (w *loggerWriter) Flush() {
+	if f, ok := w.w.(http.Flusher); ok {
+		f.Flush()
+	}
+}
+
 func (w *loggerWriter) dump() string {
 	var buf bytes.Buffer
 	fmt.Fprintf(&buf, "%s %d %s\n", "HTTP/1.1", w.status, http.StatusText(w.status))
 	w.w.Header().Write(&buf) //nolint:errcheck
 	buf.Write([]byte("\n"))
-	if w.buf.Len() > 0 {
-		fmt.Fprintf(&buf, "(body of %d bytes)", w.buf.Len())
+	if w.bodySize > 0 {
+		fmt.Fprintf(&buf, "(body of %d bytes)", w.bodySize)
 	}
 	return buf.String()
 }
@@ -2,17 +2,18 @@ package mpegts
 
 import (
 	"bufio"
+	"errors"
 	"fmt"
 	"time"
 
 	"github.com/bluenviron/gortsplib/v4/pkg/format"
 	"github.com/bluenviron/mediacommon/pkg/codecs/ac3"
-	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
 	"github.com/bluenviron/mediacommon/pkg/codecs/h265"
 	mcmpegts "github.com/bluenviron/mediacommon/pkg/formats/mpegts"
 	srt "github.com/datarhei/gosrt"
 
 	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/formatprocessor"
 	"github.com/bluenviron/mediamtx/internal/stream"
 	"github.com/bluenviron/mediamtx/internal/unit"
 )
@@ -79,7 +80,7 @@ func FromStream(
 			case *format.H264: //nolint:dupl
 				track := addTrack(&mcmpegts.CodecH264{})
 
-				var dtsExtractor *h264.DTSExtractor
+				var dtsExtractor formatprocessor.H264DTSExtractor
 
 				stream.AddReader(writer, medi, forma, func(u unit.Unit) error {
 					tunit := u.(*unit.H264)
@@ -87,22 +88,19 @@ func FromStream(
 						return nil
 					}
 
-					idrPresent := h264.IDRPresent(tunit.AU)
-
-					if dtsExtractor == nil {
-						if !idrPresent {
-							return nil
-						}
-						dtsExtractor = h264.NewDTSExtractor()
-					}
+					// IDRs and recovery points.
+					randomAccess := formatprocessor.H264IsRandomAccess(tunit.AU)
 
 					dts, err := dtsExtractor.Extract(tunit.AU, tunit.PTS)
 					if err != nil {
+						if errors.Is(err, formatprocessor.ErrH264DTSNotReady) {
+							return nil
+						}
 						return err
 					}
 
 					sconn.SetWriteDeadline(time.Now().Add(writeTimeout))
-					err = (*w).WriteH264(track, durationGoToMPEGTS(tunit.PTS), durationGoToMPEGTS(dts), idrPresent, tunit.AU)
+					err = (*w).WriteH264(track, durationGoToMPEGTS(tunit.PTS), durationGoToMPEGTS(dts), randomAccess, tunit.AU)
 					if err != nil {
 						return err
 					}
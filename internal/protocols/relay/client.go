@@ -0,0 +1,408 @@
+package relay
+
+import (
+	"bufio"
+	"context"
+	"errors"
+	"fmt"
+	"net"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/gortsplib/v4/pkg/sdp"
+
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+// OnUnitFunc is the prototype of the callback passed to Subscription.OnUnit().
+type OnUnitFunc func(*description.Media, format.Format, unit.Unit)
+
+// Subscription is a subscription to a path of a relay server.
+type Subscription struct {
+	client  *Client
+	channel uint32
+
+	mutex  sync.Mutex
+	desc   *description.Session
+	onUnit OnUnitFunc
+	err    error
+
+	described chan struct{}
+	done      chan struct{}
+}
+
+func (s *Subscription) initialize() {
+	s.described = make(chan struct{})
+	s.done = make(chan struct{})
+}
+
+// Close closes the subscription.
+func (s *Subscription) Close() {
+	if s.client.removeSubscription(s) {
+		s.client.writeFrame(&Frame{ //nolint:errcheck
+			Type:    FrameTypeUnsubscribe,
+			Channel: s.channel,
+		})
+	}
+	s.terminate(fmt.Errorf("terminated"))
+}
+
+// Describe waits for the description of the stream.
+func (s *Subscription) Describe(ctx context.Context) (*description.Session, error) {
+	select {
+	case <-s.described:
+		return s.desc, nil
+
+	case <-s.done:
+		return nil, s.Err()
+
+	case <-ctx.Done():
+		return nil, fmt.Errorf("terminated")
+	}
+}
+
+// OnUnit sets the callback that is called when a unit is received.
+func (s *Subscription) OnUnit(cb OnUnitFunc) {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+	s.onUnit = cb
+}
+
+// Done returns a channel that is closed when the subscription is terminated.
+func (s *Subscription) Done() <-chan struct{} {
+	return s.done
+}
+
+// Err returns the reason why the subscription was terminated.
+func (s *Subscription) Err() error {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+	return s.err
+}
+
+func (s *Subscription) terminate(err error) {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+
+	if s.err != nil {
+		return
+	}
+
+	s.err = err
+	close(s.done)
+}
+
+func (s *Subscription) setDescription(desc *description.Session) error {
+	select {
+	case <-s.described:
+		return fmt.Errorf("stream has already been described")
+	default:
+	}
+
+	s.desc = desc
+	close(s.described)
+	return nil
+}
+
+func (s *Subscription) writeUnit(buf []byte) error {
+	select {
+	case <-s.described:
+	default:
+		return fmt.Errorf("received unit before description")
+	}
+
+	mediaIndex, formatIndex, u, err := UnmarshalUnit(buf)
+	if err != nil {
+		return err
+	}
+
+	if mediaIndex >= len(s.desc.Medias) || formatIndex >= len(s.desc.Medias[mediaIndex].Formats) {
+		return fmt.Errorf("invalid media or format index")
+	}
+
+	s.mutex.Lock()
+	onUnit := s.onUnit
+	s.mutex.Unlock()
+
+	if onUnit != nil {
+		medi := s.desc.Medias[mediaIndex]
+		onUnit(medi, medi.Formats[formatIndex], u)
+	}
+
+	return nil
+}
+
+// Client is a connection to a relay server.
+// Subscriptions to multiple paths are multiplexed over the same connection.
+type Client struct {
+	Address      string
+	ReadTimeout  time.Duration
+	WriteTimeout time.Duration
+
+	ctx           context.Context
+	ctxCancel     func()
+	nconn         net.Conn
+	dialErr       error
+	writeMutex    sync.Mutex
+	mutex         sync.Mutex
+	subscriptions map[uint32]*Subscription
+	nextChannel   uint32
+
+	// out
+	ready chan struct{}
+	done  chan struct{}
+}
+
+// Initialize initializes Client. The connection is opened in the background.
+func (c *Client) Initialize() {
+	c.ctx, c.ctxCancel = context.WithCancel(context.Background())
+	c.subscriptions = make(map[uint32]*Subscription)
+	c.ready = make(chan struct{})
+	c.done = make(chan struct{})
+
+	go c.run()
+}
+
+// Close closes the connection and all subscriptions.
+func (c *Client) Close() {
+	c.ctxCancel()
+	<-c.done
+}
+
+// Wait waits until the connection is established.
+func (c *Client) Wait(ctx context.Context) error {
+	select {
+	case <-c.ready:
+		return c.dialErr
+
+	case <-ctx.Done():
+		return fmt.Errorf("terminated")
+	}
+}
+
+// Done returns a channel that is closed when the connection is closed.
+func (c *Client) Done() <-chan struct{} {
+	return c.done
+}
+
+// Subscribe subscribes to a path.
+func (c *Client) Subscribe(req SubscribeRequest) (*Subscription, error) {
+	payload, err := req.Marshal()
+	if err != nil {
+		return nil, err
+	}
+
+	c.mutex.Lock()
+
+	if c.subscriptions == nil {
+		c.mutex.Unlock()
+		return nil, fmt.Errorf("connection is closed")
+	}
+
+	c.nextChannel++
+	s := &Subscription{
+		client:  c,
+		channel: c.nextChannel,
+	}
+	s.initialize()
+	c.subscriptions[s.channel] = s
+
+	c.mutex.Unlock()
+
+	err = c.writeFrame(&Frame{
+		Type:    FrameTypeSubscribe,
+		Channel: s.channel,
+		Payload: payload,
+	})
+	if err != nil {
+		c.removeSubscription(s)
+		return nil, err
+	}
+
+	return s, nil
+}
+
+func (c *Client) run() {
+	defer close(c.done)
+
+	err := c.runInner()
+
+	c.mutex.Lock()
+	subscriptions := c.subscriptions
+	c.subscriptions = nil
+	c.mutex.Unlock()
+
+	for _, s := range subscriptions {
+		s.terminate(err)
+	}
+}
+
+func (c *Client) runInner() error {
+	c.dialErr = c.dial()
+	close(c.ready)
+	if c.dialErr != nil {
+		return c.dialErr
+	}
+
+	readErr := make(chan error)
+	go func() {
+		readErr <- c.runReader()
+	}()
+
+	// send pings in order to allow the server to detect dead connections.
+	pingTicker := time.NewTicker(c.ReadTimeout / 2)
+	defer pingTicker.Stop()
+
+	for {
+		select {
+		case err := <-readErr:
+			c.nconn.Close()
+			return err
+
+		case <-pingTicker.C:
+			err := c.writeFrame(&Frame{Type: FrameTypePing})
+			if err != nil {
+				c.nconn.Close()
+				<-readErr
+				return err
+			}
+
+		case <-c.ctx.Done():
+			c.nconn.Close()
+			<-readErr
+			return fmt.Errorf("terminated")
+		}
+	}
+}
+
+func (c *Client) dial() error {
+	dialCtx, dialCtxCancel := context.WithTimeout(c.ctx, c.ReadTimeout)
+	defer dialCtxCancel()
+
+	var err error
+	c.nconn, err = (&net.Dialer{}).DialContext(dialCtx, "tcp", c.Address)
+	if err != nil {
+		return err
+	}
+
+	err = c.writeRaw(Magic)
+	if err != nil {
+		c.nconn.Close()
+		return err
+	}
+
+	return nil
+}
+
+func (c *Client) runReader() error {
+	br := bufio.NewReaderSize(c.nconn, 64*1024)
+
+	// units can only be received after a subscription has been accepted.
+	maxPayloadSize := uint32(MaxControlFramePayloadSize)
+
+	for {
+		c.nconn.SetReadDeadline(time.Now().Add(c.ReadTimeout))
+
+		var f Frame
+		err := f.Unmarshal(br, maxPayloadSize)
+		if err != nil {
+			return err
+		}
+
+		switch f.Type {
+		case FrameTypePong:
+
+		case FrameTypeDescribe:
+			s := c.findSubscription(f.Channel)
+			if s == nil {
+				continue
+			}
+
+			err := c.describe(s, f.Payload)
+			if err != nil {
+				s.terminate(err)
+				s.Close()
+				continue
+			}
+
+			maxPayloadSize = MaxFramePayloadSize
+
+		case FrameTypeUnit:
+			s := c.findSubscription(f.Channel)
+			if s == nil {
+				continue
+			}
+
+			err := s.writeUnit(f.Payload)
+			if err != nil {
+				s.terminate(err)
+				s.Close()
+			}
+
+		case FrameTypeError:
+			s := c.findSubscription(f.Channel)
+			if s == nil {
+				continue
+			}
+
+			c.removeSubscription(s)
+			s.terminate(errors.New(string(f.Payload)))
+
+		default:
+			return fmt.Errorf("unexpected frame type: %d", f.Type)
+		}
+	}
+}
+
+func (c *Client) describe(s *Subscription, payload []byte) error {
+	var sd sdp.SessionDescription
+	err := sd.Unmarshal(payload)
+	if err != nil {
+		return err
+	}
+
+	var desc description.Session
+	err = desc.Unmarshal(&sd)
+	if err != nil {
+		return err
+	}
+
+	return s.setDescription(&desc)
+}
+
+func (c *Client) findSubscription(channel uint32) *Subscription {
+	c.mutex.Lock()
+	defer c.mutex.Unlock()
+	return c.subscriptions[channel]
+}
+
+func (c *Client) removeSubscription(s *Subscription) bool {
+	c.mutex.Lock()
+	defer c.mutex.Unlock()
+
+	if c.subscriptions == nil || c.subscriptions[s.channel] != s {
+		return false
+	}
+
+	delete(c.subscriptions, s.channel)
+	return true
+}
+
+func (c *Client) writeFrame(f *Frame) error {
+	return c.writeRaw(f.Marshal())
+}
+
+func (c *Client) writeRaw(buf []byte) error {
+	c.writeMutex.Lock()
+	defer c.writeMutex.Unlock()
+
+	if c.nconn == nil {
+		return fmt.Errorf("not connected")
+	}
+
+	c.nconn.SetWriteDeadline(time.Now().Add(c.WriteTimeout))
+	_, err := c.nconn.Write(buf)
+	return err
+}
@@ -0,0 +1,82 @@
+package relay
+
+import (
+	"context"
+	"sync"
+	"time"
+)
+
+// ClientPool allows sources that pull from the same relay server to share a single connection.
+// Connections are opened when first needed and closed when they are not used anymore.
+type ClientPool struct {
+	ReadTimeout  time.Duration
+	WriteTimeout time.Duration
+
+	mutex   sync.Mutex
+	clients map[string]*Client
+	refs    map[*Client]int
+}
+
+// Initialize initializes ClientPool.
+func (p *ClientPool) Initialize() {
+	p.clients = make(map[string]*Client)
+	p.refs = make(map[*Client]int)
+}
+
+// Acquire returns a connection to the given address, opening it if it doesn't exist.
+// The connection must be returned with Release().
+func (p *ClientPool) Acquire(ctx context.Context, address string) (*Client, error) {
+	p.mutex.Lock()
+
+	c, ok := p.clients[address]
+	if ok {
+		select {
+		case <-c.Done():
+			// the connection has been closed, open a new one.
+			ok = false
+		default:
+		}
+	}
+
+	if !ok {
+		c = &Client{
+			Address:      address,
+			ReadTimeout:  p.ReadTimeout,
+			WriteTimeout: p.WriteTimeout,
+		}
+		c.Initialize()
+		p.clients[address] = c
+	}
+
+	p.refs[c]++
+
+	p.mutex.Unlock()
+
+	err := c.Wait(ctx)
+	if err != nil {
+		p.Release(c)
+		return nil, err
+	}
+
+	return c, nil
+}
+
+// Release releases a connection returned by Acquire().
+func (p *ClientPool) Release(c *Client) {
+	p.mutex.Lock()
+
+	p.refs[c]--
+	unused := (p.refs[c] == 0)
+	if unused {
+		delete(p.refs, c)
+		if p.clients[c.Address] == c {
+			delete(p.clients, c.Address)
+		}
+	}
+
+	p.mutex.Unlock()
+
+	if unused {
+		c.Close()
+	}
+}
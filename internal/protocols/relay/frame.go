@@ -0,0 +1,94 @@
+// Package relay contains the relay protocol, that is used to distribute streams between servers.
+//
+// A client opens a single TCP connection to a server and multiplexes on it
+// any number of subscriptions, each identified by a channel ID.
+// Units are transferred as they are, together with their timestamps,
+// without being packetized and depacketized.
+package relay
+
+import (
+	"bufio"
+	"encoding/binary"
+	"fmt"
+	"io"
+)
+
+const (
+	// MaxFramePayloadSize is the maximum size of a frame payload.
+	MaxFramePayloadSize = 32 * 1024 * 1024
+
+	// MaxControlFramePayloadSize is the maximum size of the payload of frames that don't contain units.
+	// It is used until a subscription has been accepted, in order to prevent
+	// peers from making the receiver allocate big buffers.
+	MaxControlFramePayloadSize = 64 * 1024
+
+	frameHeaderSize = 9
+)
+
+// Magic is the sequence of bytes that is sent by clients at the beginning of every connection.
+var Magic = []byte{'M', 'T', 'X', 'R', 1}
+
+// FrameType is the type of a frame.
+type FrameType uint8
+
+// frame types.
+const (
+	// sent by clients to subscribe to a path. Payload is a SubscribeRequest.
+	FrameTypeSubscribe FrameType = iota + 1
+
+	// sent by clients to remove a subscription.
+	FrameTypeUnsubscribe
+
+	// sent by servers when a subscription is accepted. Payload is a SDP.
+	FrameTypeDescribe
+
+	// sent by servers. Payload is a marshaled unit.
+	FrameTypeUnit
+
+	// sent by servers when a subscription is terminated. Payload is the error message.
+	FrameTypeError
+
+	// sent by clients to keep the connection alive.
+	FrameTypePing
+
+	// sent by servers in response to a ping.
+	FrameTypePong
+)
+
+// Frame is a relay protocol frame.
+type Frame struct {
+	Type    FrameType
+	Channel uint32
+	Payload []byte
+}
+
+// Unmarshal reads a frame, whose payload size must not exceed maxPayloadSize.
+func (f *Frame) Unmarshal(br *bufio.Reader, maxPayloadSize uint32) error {
+	var header [frameHeaderSize]byte
+	_, err := io.ReadFull(br, header[:])
+	if err != nil {
+		return err
+	}
+
+	f.Type = FrameType(header[0])
+	f.Channel = binary.BigEndian.Uint32(header[1:5])
+	le := binary.BigEndian.Uint32(header[5:9])
+
+	if le > maxPayloadSize {
+		return fmt.Errorf("frame payload size (%d) exceeds maximum allowed (%d)", le, maxPayloadSize)
+	}
+
+	f.Payload = make([]byte, le)
+	_, err = io.ReadFull(br, f.Payload)
+	return err
+}
+
+// Marshal encodes a frame.
+func (f Frame) Marshal() []byte {
+	buf := make([]byte, frameHeaderSize+len(f.Payload))
+	buf[0] = byte(f.Type)
+	binary.BigEndian.PutUint32(buf[1:5], f.Channel)
+	binary.BigEndian.PutUint32(buf[5:9], uint32(len(f.Payload)))
+	copy(buf[frameHeaderSize:], f.Payload)
+	return buf
+}
@@ -0,0 +1,23 @@
+package relay
+
+import (
+	"encoding/json"
+)
+
+// SubscribeRequest is the payload of a subscribe frame.
+type SubscribeRequest struct {
+	Path  string `json:"path"`
+	Query string `json:"query"`
+	User  string `json:"user"`
+	Pass  string `json:"pass"`
+}
+
+// Unmarshal decodes a SubscribeRequest.
+func (r *SubscribeRequest) Unmarshal(buf []byte) error {
+	return json.Unmarshal(buf, r)
+}
+
+// Marshal encodes a SubscribeRequest.
+func (r SubscribeRequest) Marshal() ([]byte, error) {
+	return json.Marshal(r)
+}
@@ -0,0 +1,254 @@
+package relay
+
+import (
+	"encoding/binary"
+	"fmt"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+const (
+	unitHeaderSize = 23
+)
+
+type unitKind uint8
+
+const (
+	unitKindAV1 unitKind = iota + 1
+	unitKindVP9
+	unitKindVP8
+	unitKindH265
+	unitKindH264
+	unitKindMPEG4Video
+	unitKindMPEG1Video
+	unitKindMJPEG
+	unitKindOpus
+	unitKindMPEG4Audio
+	unitKindMPEG1Audio
+	unitKindAC3
+	unitKindG711
+	unitKindLPCM
+)
+
+func unitContent(u unit.Unit) (unitKind, [][]byte, error) {
+	frameToSlice := func(frame []byte) [][]byte {
+		if frame == nil {
+			return nil
+		}
+		return [][]byte{frame}
+	}
+
+	switch tunit := u.(type) {
+	case *unit.AV1:
+		return unitKindAV1, tunit.TU, nil
+
+	case *unit.VP9:
+		return unitKindVP9, frameToSlice(tunit.Frame), nil
+
+	case *unit.VP8:
+		return unitKindVP8, frameToSlice(tunit.Frame), nil
+
+	case *unit.H265:
+		return unitKindH265, tunit.AU, nil
+
+	case *unit.H264:
+		return unitKindH264, tunit.AU, nil
+
+	case *unit.MPEG4Video:
+		return unitKindMPEG4Video, frameToSlice(tunit.Frame), nil
+
+	case *unit.MPEG1Video:
+		return unitKindMPEG1Video, frameToSlice(tunit.Frame), nil
+
+	case *unit.MJPEG:
+		return unitKindMJPEG, frameToSlice(tunit.Frame), nil
+
+	case *unit.Opus:
+		return unitKindOpus, tunit.Packets, nil
+
+	case *unit.MPEG4Audio:
+		return unitKindMPEG4Audio, tunit.AUs, nil
+
+	case *unit.MPEG1Audio:
+		return unitKindMPEG1Audio, tunit.Frames, nil
+
+	case *unit.AC3:
+		return unitKindAC3, tunit.Frames, nil
+
+	case *unit.G711:
+		return unitKindG711, frameToSlice(tunit.Samples), nil
+
+	case *unit.LPCM:
+		return unitKindLPCM, frameToSlice(tunit.Samples), nil
+
+	default:
+		return 0, nil, fmt.Errorf("unsupported unit type: %T", u)
+	}
+}
+
+func newUnit(kind unitKind, base unit.Base, content [][]byte) (unit.Unit, error) {
+	sliceToFrame := func() ([]byte, error) {
+		switch len(content) {
+		case 0:
+			return nil, nil
+		case 1:
+			return content[0], nil
+		default:
+			return nil, fmt.Errorf("unexpected element count: %d", len(content))
+		}
+	}
+
+	switch kind {
+	case unitKindAV1:
+		return &unit.AV1{Base: base, TU: content}, nil
+
+	case unitKindVP9:
+		frame, err := sliceToFrame()
+		return &unit.VP9{Base: base, Frame: frame}, err
+
+	case unitKindVP8:
+		frame, err := sliceToFrame()
+		return &unit.VP8{Base: base, Frame: frame}, err
+
+	case unitKindH265:
+		return &unit.H265{Base: base, AU: content}, nil
+
+	case unitKindH264:
+		return &unit.H264{Base: base, AU: content}, nil
+
+	case unitKindMPEG4Video:
+		frame, err := sliceToFrame()
+		return &unit.MPEG4Video{Base: base, Frame: frame}, err
+
+	case unitKindMPEG1Video:
+		frame, err := sliceToFrame()
+		return &unit.MPEG1Video{Base: base, Frame: frame}, err
+
+	case unitKindMJPEG:
+		frame, err := sliceToFrame()
+		return &unit.MJPEG{Base: base, Frame: frame}, err
+
+	case unitKindOpus:
+		return &unit.Opus{Base: base, Packets: content}, nil
+
+	case unitKindMPEG4Audio:
+		return &unit.MPEG4Audio{Base: base, AUs: content}, nil
+
+	case unitKindMPEG1Audio:
+		return &unit.MPEG1Audio{Base: base, Frames: content}, nil
+
+	case unitKindAC3:
+		return &unit.AC3{Base: base, Frames: content}, nil
+
+	case unitKindG711:
+		samples, err := sliceToFrame()
+		return &unit.G711{Base: base, Samples: samples}, err
+
+	case unitKindLPCM:
+		samples, err := sliceToFrame()
+		return &unit.LPCM{Base: base, Samples: samples}, err
+
+	default:
+		return nil, fmt.Errorf("unsupported unit kind: %d", kind)
+	}
+}
+
+// MarshalUnit encodes a unit, together with the indexes of its media and format.
+//
+// Layout:
+// media index (1 byte), format index (1 byte), unit kind (1 byte),
+// PTS in nanoseconds (8 bytes), NTP in Unix nanoseconds or zero (8 bytes),
+// element count (4 bytes), then, for each element, its size (4 bytes) and content.
+func MarshalUnit(mediaIndex int, formatIndex int, u unit.Unit) ([]byte, error) {
+	kind, content, err := unitContent(u)
+	if err != nil {
+		return nil, err
+	}
+
+	n := unitHeaderSize
+	for _, el := range content {
+		n += 4 + len(el)
+	}
+
+	buf := make([]byte, n)
+	buf[0] = uint8(mediaIndex)
+	buf[1] = uint8(formatIndex)
+	buf[2] = uint8(kind)
+	binary.BigEndian.PutUint64(buf[3:11], uint64(u.GetPTS()))
+
+	var ntp int64
+	if t := u.GetNTP(); !t.IsZero() {
+		ntp = t.UnixNano()
+	}
+	binary.BigEndian.PutUint64(buf[11:19], uint64(ntp))
+
+	binary.BigEndian.PutUint32(buf[19:23], uint32(len(content)))
+	pos := unitHeaderSize
+
+	for _, el := range content {
+		binary.BigEndian.PutUint32(buf[pos:], uint32(len(el)))
+		pos += 4
+		pos += copy(buf[pos:], el)
+	}
+
+	return buf, nil
+}
+
+// UnmarshalUnit decodes a unit, together with the indexes of its media and format.
+// The returned unit shares memory with buf.
+func UnmarshalUnit(buf []byte) (int, int, unit.Unit, error) {
+	if len(buf) < unitHeaderSize {
+		return 0, 0, nil, fmt.Errorf("buffer is too short")
+	}
+
+	mediaIndex := int(buf[0])
+	formatIndex := int(buf[1])
+	kind := unitKind(buf[2])
+
+	base := unit.Base{
+		PTS: time.Duration(binary.BigEndian.Uint64(buf[3:11])),
+	}
+
+	if ntp := int64(binary.BigEndian.Uint64(buf[11:19])); ntp != 0 {
+		base.NTP = time.Unix(0, ntp)
+	}
+
+	count := binary.BigEndian.Uint32(buf[19:23])
+	pos := unitHeaderSize
+
+	// each element takes at least 4 bytes.
+	if uint64(count)*4 > uint64(len(buf)-pos) {
+		return 0, 0, nil, fmt.Errorf("invalid element count: %d", count)
+	}
+
+	var content [][]byte
+	if count != 0 {
+		content = make([][]byte, count)
+	}
+
+	for i := range content {
+		if (len(buf) - pos) < 4 {
+			return 0, 0, nil, fmt.Errorf("buffer is too short")
+		}
+		le := int(binary.BigEndian.Uint32(buf[pos:]))
+		pos += 4
+
+		if le > (len(buf) - pos) {
+			return 0, 0, nil, fmt.Errorf("buffer is too short")
+		}
+		content[i] = buf[pos : pos+le]
+		pos += le
+	}
+
+	if pos != len(buf) {
+		return 0, 0, nil, fmt.Errorf("unexpected trailing bytes")
+	}
+
+	u, err := newUnit(kind, base, content)
+	if err != nil {
+		return 0, 0, nil, err
+	}
+
+	return mediaIndex, formatIndex, u, nil
+}
@@ -0,0 +1,88 @@
+package relay
+
+import (
+	"testing"
+	"time"
+
+	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+var casesUnit = []struct {
+	name string
+	u    unit.Unit
+}{
+	{
+		"h264",
+		&unit.H264{
+			Base: unit.Base{
+				PTS: 2 * time.Second,
+				NTP: time.Date(2024, 5, 1, 10, 0, 0, 123, time.UTC),
+			},
+			AU: [][]byte{{1, 2, 3}, {5, 4}},
+		},
+	},
+	{
+		"vp9",
+		&unit.VP9{
+			Base: unit.Base{
+				PTS: -500 * time.Millisecond,
+			},
+			Frame: []byte{1, 2, 3, 4},
+		},
+	},
+	{
+		"opus",
+		&unit.Opus{
+			Base: unit.Base{
+				PTS: 20 * time.Millisecond,
+			},
+			Packets: [][]byte{{1}, {2}},
+		},
+	},
+	{
+		"g711",
+		&unit.G711{
+			Samples: []byte{1, 2, 3},
+		},
+	},
+	{
+		"empty",
+		&unit.H265{},
+	},
+}
+
+func TestUnitMarshal(t *testing.T) {
+	for _, ca := range casesUnit {
+		t.Run(ca.name, func(t *testing.T) {
+			buf, err := MarshalUnit(1, 2, ca.u)
+			require.NoError(t, err)
+
+			mediaIndex, formatIndex, u, err := UnmarshalUnit(buf)
+			require.NoError(t, err)
+			require.Equal(t, 1, mediaIndex)
+			require.Equal(t, 2, formatIndex)
+
+			if ca.name == "h264" {
+				// compare timestamps separately since time.Time contains a location.
+				require.True(t, ca.u.GetNTP().Equal(u.GetNTP()))
+				u.(*unit.H264).NTP = ca.u.GetNTP()
+			}
+
+			require.Equal(t, ca.u, u)
+		})
+	}
+}
+
+func FuzzUnitUnmarshal(f *testing.F) {
+	for _, ca := range casesUnit {
+		buf, err := MarshalUnit(0, 0, ca.u)
+		require.NoError(f, err)
+		f.Add(buf)
+	}
+
+	f.Fuzz(func(_ *testing.T, buf []byte) {
+		UnmarshalUnit(buf) //nolint:errcheck
+	})
+}
@@ -72,6 +72,19 @@ static PixelFormat mode_to_pixel_format(sensor_mode_t *mode) {
     return formats::SBGGR12_CSI2P;
 }
 
+// crop rectangle of the ISP, in sensor coordinates.
+// Floats are used in order to interpolate smoothly between rectangles.
+struct CropRect {
+    float x;
+    float y;
+    float width;
+    float height;
+
+    bool operator==(const CropRect &other) const {
+        return x == other.x && y == other.y && width == other.width && height == other.height;
+    }
+};
+
 struct CameraPriv {
     const parameters_t *params;
     camera_frame_cb frame_cb;
@@ -83,6 +96,10 @@ struct CameraPriv {
     std::mutex ctrls_mutex;
     std::unique_ptr<ControlList> ctrls;
     std::map<FrameBuffer *, uint8_t *> mapped_buffers;
+    std::optional<Rectangle> sensor_area;
+    CropRect crop;
+    CropRect crop_target;
+    unsigned int crop_frames_left;
 };
 
 static int get_v4l2_colorspace(std::optional<ColorSpace> const &cs) {
@@ -270,6 +287,42 @@ static int buffer_size(const std::vector<FrameBuffer::Plane> &planes) {
     return size;
 }
 
+static Rectangle crop_to_rectangle(const CameraPriv *camp, const CropRect &crop) {
+    Rectangle r(crop.x, crop.y, crop.width, crop.height);
+    r.translateBy(camp->sensor_area->topLeft());
+    return r;
+}
+
+static CropRect crop_from_window(const CameraPriv *camp, const window_t *window) {
+    if (window == NULL) {
+        return CropRect{0, 0, (float)camp->sensor_area->width, (float)camp->sensor_area->height};
+    }
+
+    return CropRect{
+        window->x * camp->sensor_area->width,
+        window->y * camp->sensor_area->height,
+        window->width * camp->sensor_area->width,
+        window->height * camp->sensor_area->height,
+    };
+}
+
+// move the crop rectangle one step towards the target.
+// It must be called with ctrls_mutex locked.
+static void advance_crop(CameraPriv *camp) {
+    if (camp->crop_frames_left == 0) {
+        return;
+    }
+
+    float n = camp->crop_frames_left;
+    camp->crop.x += (camp->crop_target.x - camp->crop.x) / n;
+    camp->crop.y += (camp->crop_target.y - camp->crop.y) / n;
+    camp->crop.width += (camp->crop_target.width - camp->crop.width) / n;
+    camp->crop.height += (camp->crop_target.height - camp->crop.height) / n;
+    camp->crop_frames_left--;
+
+    camp->ctrls->set(controls::ScalerCrop, crop_to_rectangle(camp, camp->crop));
+}
+
 static void on_request_complete(Request *request) {
     if (request->status() == Request::RequestCancelled) {
         return;
@@ -291,6 +344,7 @@ static void on_request_complete(Request *request) {
 
     {
         std::lock_guard<std::mutex> lock(camp->ctrls_mutex);
+        advance_crop(camp);
         request->controls() = *camp->ctrls;
         camp->ctrls->clear();
     }
@@ -451,23 +505,20 @@ bool camera_start(camera_t *cam) {
         }
     }
 
+    camp->sensor_area = camp->camera->properties().get(properties::ScalerCropMaximum);
+
     if (camp->params->roi != NULL) {
-        std::optional<Rectangle> opt = camp->camera->properties().get(properties::ScalerCropMaximum);
-        Rectangle sensor_area;
-        try {
-            sensor_area = opt.value();
-        } catch(const std::bad_optional_access& exc) {
+        if (!camp->sensor_area.has_value()) {
             set_error("get(ScalerCropMaximum) failed");
             return false;
         }
 
-        Rectangle crop(
-            camp->params->roi->x * sensor_area.width,
-            camp->params->roi->y * sensor_area.height,
-            camp->params->roi->width * sensor_area.width,
-            camp->params->roi->height * sensor_area.height);
-        crop.translateBy(sensor_area.topLeft());
-        camp->ctrls->set(controls::ScalerCrop, crop);
+        camp->ctrls->set(controls::ScalerCrop, crop_to_rectangle(camp, crop_from_window(camp, camp->params->roi)));
+    }
+
+    if (camp->sensor_area.has_value()) {
+        camp->crop = crop_from_window(camp, camp->params->roi);
+        camp->crop_target = camp->crop;
     }
 
     int res = camp->camera->start(camp->ctrls.get());
@@ -497,3 +548,29 @@ void camera_reload_params(camera_t *cam, const parameters_t *params) {
     std::lock_guard<std::mutex> lock(camp->ctrls_mutex);
     fill_dynamic_controls(camp->ctrls.get(), params);
 }
+
+void camera_set_roi(camera_t *cam, const window_t *roi, unsigned int transition) {
+    CameraPriv *camp = (CameraPriv *)cam;
+
+    if (!camp->sensor_area.has_value()) {
+        return;
+    }
+
+    CropRect target = crop_from_window(camp, roi);
+
+    std::lock_guard<std::mutex> lock(camp->ctrls_mutex);
+
+    if (target == camp->crop_target) {
+        return;
+    }
+
+    camp->crop_target = target;
+
+    // the crop rectangle is updated once per completed request,
+    // therefore a transition of N frames takes N requests.
+    if (transition == 0) {
+        camp->crop_frames_left = 1;
+    } else {
+        camp->crop_frames_left = transition;
+    }
+}
@@ -23,6 +23,7 @@ int camera_get_mode_stride(camera_t *cam);
 int camera_get_mode_colorspace(camera_t *cam);
 bool camera_start(camera_t *cam);
 void camera_reload_params(camera_t *cam, const parameters_t *params);
+void camera_set_roi(camera_t *cam, const window_t *roi, unsigned int transition);
 
 #ifdef __cplusplus
 }
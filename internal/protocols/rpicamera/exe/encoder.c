@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <poll.h>
 #include <pthread.h>
+#include <stdatomic.h>
 
 #include <linux/videodev2.h>
 
@@ -18,6 +19,7 @@
 
 #define DEVICE              "/dev/video11"
 #define POLL_TIMEOUT_MS     200
+#define SEI_MAX_SIZE        32
 
 static char errbuf[256];
 
@@ -40,8 +42,196 @@ typedef struct {
     pthread_t output_thread;
     bool ts_initialized;
     uint64_t start_ts;
+    unsigned int refresh_frames; // length of an intra refresh cycle, 0 if disabled
+    unsigned int refresh_count;
+    uint8_t *sei_buffer;
+    int sei_buffer_size;
+    uint8_t *param_sets; // SPS and PPS of the first IDR, in Annex-B format
+    int param_sets_size;
+    atomic_bool restart_requested;
+    atomic_int output_in_flight; // frames that have been queued and not encoded yet
 } encoder_priv_t;
 
+typedef struct {
+    uint8_t *buf;
+    int pos;
+    int bit;
+} bit_writer_t;
+
+static void bit_writer_write(bit_writer_t *w, uint32_t value, int bits) {
+    for (int i = bits - 1; i >= 0; i--) {
+        if (w->bit == 0) {
+            w->buf[w->pos] = 0;
+        }
+        w->buf[w->pos] |= ((value >> i) & 0x01) << (7 - w->bit);
+        w->bit++;
+        if (w->bit == 8) {
+            w->bit = 0;
+            w->pos++;
+        }
+    }
+}
+
+static void bit_writer_write_ue(bit_writer_t *w, uint32_t value) {
+    value++;
+    int bits = 0;
+    for (uint32_t v = value; v > 1; v >>= 1) {
+        bits++;
+    }
+    bit_writer_write(w, 0, bits);
+    bit_writer_write(w, value, bits + 1);
+}
+
+// write_recovery_point_sei writes a SEI NALU that contains a recovery point (H264, D.1.8),
+// prefixed by a start code, and returns its size.
+static int write_recovery_point_sei(uint8_t *out, unsigned int recovery_frame_cnt) {
+    uint8_t payload[16];
+    bit_writer_t w = { payload, 0, 0 };
+    bit_writer_write_ue(&w, recovery_frame_cnt);
+    bit_writer_write(&w, 1, 1); // exact_match_flag
+    bit_writer_write(&w, 0, 1); // broken_link_flag
+    bit_writer_write(&w, 0, 2); // changing_slice_group_idc
+    if (w.bit != 0) {
+        int padding = 7 - w.bit;
+        bit_writer_write(&w, 1, 1); // bit_equal_to_one
+        bit_writer_write(&w, 0, padding);
+    }
+
+    uint8_t rbsp[SEI_MAX_SIZE];
+    int n = 0;
+    rbsp[n++] = 6; // payload type: recovery point
+    rbsp[n++] = w.pos;
+    memcpy(&rbsp[n], payload, w.pos);
+    n += w.pos;
+    rbsp[n++] = 0x80; // rbsp_trailing_bits
+
+    int pos = 0;
+    out[pos++] = 0;
+    out[pos++] = 0;
+    out[pos++] = 0;
+    out[pos++] = 1;
+    out[pos++] = 0x06; // SEI
+
+    // emulation prevention
+    int zeros = 0;
+    for (int i = 0; i < n; i++) {
+        if (zeros == 2 && rbsp[i] <= 3) {
+            out[pos++] = 3;
+            zeros = 0;
+        }
+        out[pos++] = rbsp[i];
+        zeros = (rbsp[i] == 0) ? (zeros + 1) : 0;
+    }
+
+    return pos;
+}
+
+// is_idr returns whether the first slice of an Annex-B access unit belongs to an IDR.
+static bool is_idr(const uint8_t *buf, int size) {
+    for (int i = 0; i + 3 < size; i++) {
+        if (buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 1) {
+            int typ = buf[i+3] & 0x1F;
+            if (typ == 5) {
+                return true;
+            }
+            if (typ == 1) {
+                return false;
+            }
+            i += 3;
+        }
+    }
+    return false;
+}
+
+// first_slice_offset returns the position of the start code of the first slice of an Annex-B access unit.
+static int first_slice_offset(const uint8_t *buf, int size) {
+    for (int i = 0; i + 3 < size; i++) {
+        if (buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 1) {
+            int typ = buf[i+3] & 0x1F;
+            if (typ == 1 || typ == 5) {
+                return (i > 0 && buf[i-1] == 0) ? (i - 1) : i;
+            }
+            i += 3;
+        }
+    }
+    return size;
+}
+
+// output_restart_idr sends the first IDR after a restart, with timestamps that start from zero.
+// Since the encoder emits parameter sets with the first IDR only, they are prepended when missing.
+static void output_restart_idr(encoder_priv_t *encp, uint64_t ts, const uint8_t *buf, int size) {
+    encp->start_ts += ts;
+
+    if (first_slice_offset(buf, size) != 0 || encp->param_sets == NULL) {
+        encp->output_cb(0, buf, size);
+        return;
+    }
+
+    uint8_t *tmp = malloc(encp->param_sets_size + size);
+    memcpy(tmp, encp->param_sets, encp->param_sets_size);
+    memcpy(&tmp[encp->param_sets_size], buf, size);
+    encp->output_cb(0, tmp, encp->param_sets_size + size);
+    free(tmp);
+}
+
+// output_buffer sends an access unit to output_cb.
+// When intra refresh is enabled, a recovery point SEI is prepended to the first frame of each refresh cycle,
+// in order to allow readers to start decoding from there.
+static void output_buffer(encoder_priv_t *encp, uint64_t ts, const uint8_t *buf, int size) {
+    bool idr = is_idr(buf, size);
+
+    if (idr && encp->param_sets == NULL) {
+        int n = first_slice_offset(buf, size);
+        if (n != 0) {
+            encp->param_sets = malloc(n);
+            memcpy(encp->param_sets, buf, n);
+            encp->param_sets_size = n;
+        }
+    }
+
+    if (atomic_load(&encp->restart_requested)) {
+        // frames that precede the requested IDR can't be decoded by the new reader.
+        if (!idr) {
+            return;
+        }
+
+        atomic_store(&encp->restart_requested, false);
+        encp->refresh_count = 1;
+        output_restart_idr(encp, ts, buf, size);
+        return;
+    }
+
+    if (encp->refresh_frames == 0) {
+        encp->output_cb(ts, buf, size);
+        return;
+    }
+
+    if (idr) {
+        encp->refresh_count = 1;
+        encp->output_cb(ts, buf, size);
+        return;
+    }
+
+    if (encp->refresh_count == encp->refresh_frames) {
+        encp->refresh_count = 1;
+
+        if (encp->sei_buffer_size < (SEI_MAX_SIZE + size)) {
+            encp->sei_buffer_size = SEI_MAX_SIZE + size;
+            encp->sei_buffer = realloc(encp->sei_buffer, encp->sei_buffer_size);
+        }
+
+        int n = write_recovery_point_sei(encp->sei_buffer, encp->refresh_frames);
+        memcpy(&encp->sei_buffer[n], buf, size);
+        encp->output_cb(ts, encp->sei_buffer, n + size);
+        return;
+    }
+
+    if (encp->refresh_count != 0) {
+        encp->refresh_count++;
+    }
+    encp->output_cb(ts, buf, size);
+}
+
 static void *output_thread(void *userdata) {
     encoder_priv_t *encp = (encoder_priv_t *)userdata;
 
@@ -66,6 +256,8 @@ static void *output_thread(void *userdata) {
                 exit(1);
             }
 
+            atomic_fetch_sub(&encp->output_in_flight, 1);
+
             memset(&buf, 0, sizeof(buf));
             memset(planes, 0, sizeof(planes));
             buf.type = V4L2_BUF_TYPE_VIDEO_CAPTURE_MPLANE;
@@ -85,7 +277,7 @@ static void *output_thread(void *userdata) {
 
                 const uint8_t *bufmem = (const uint8_t *)encp->capture_buffers[buf.index];
                 int bufsize = buf.m.planes[0].bytesused;
-                encp->output_cb(ts, bufmem, bufsize);
+                output_buffer(encp, ts, bufmem, bufsize);
 
                 int index = buf.index;
                 int length = buf.m.planes[0].length;
@@ -111,10 +303,12 @@ static void *output_thread(void *userdata) {
     return NULL;
 }
 
-static bool fill_dynamic_params(int fd, const parameters_t *params) {
+static bool fill_dynamic_params(int fd, const parameters_t *params, bool intra_refresh) {
     struct v4l2_control ctrl = {0};
     ctrl.id = V4L2_CID_MPEG_VIDEO_H264_I_PERIOD;
-    ctrl.value = params->idr_period;
+    // with intra refresh, periodic IDRs would bring back the bursts that intra refresh avoids,
+    // and recovery points already allow to start decoding. 0 means that only the first frame is an IDR.
+    ctrl.value = intra_refresh ? 0 : params->idr_period;
     int res = ioctl(fd, VIDIOC_S_CTRL, &ctrl);
     if (res != 0) {
         set_error("unable to set IDR period");
@@ -132,6 +326,38 @@ static bool fill_dynamic_params(int fd, const parameters_t *params) {
     return true;
 }
 
+// set_intra_refresh enables cyclic intra refresh and returns the length of a refresh cycle, in frames.
+// It returns 0 when intra refresh is not supported by the device.
+static unsigned int set_intra_refresh(int fd, const parameters_t *params) {
+    struct v4l2_control ctrl = {0};
+
+#ifdef V4L2_CID_MPEG_VIDEO_INTRA_REFRESH_PERIOD
+#ifdef V4L2_CID_MPEG_VIDEO_INTRA_REFRESH_PERIOD_TYPE
+    ctrl.id = V4L2_CID_MPEG_VIDEO_INTRA_REFRESH_PERIOD_TYPE;
+    ctrl.value = V4L2_CID_MPEG_VIDEO_INTRA_REFRESH_PERIOD_TYPE_CYCLIC;
+    ioctl(fd, VIDIOC_S_CTRL, &ctrl);
+#endif
+
+    ctrl.id = V4L2_CID_MPEG_VIDEO_INTRA_REFRESH_PERIOD;
+    ctrl.value = params->intra_refresh;
+    if (ioctl(fd, VIDIOC_S_CTRL, &ctrl) == 0) {
+        return params->intra_refresh;
+    }
+#endif
+
+    // older drivers allow to set the number of macroblocks that are refreshed in each frame.
+    unsigned int mbs = ((params->width + 15) / 16) * ((params->height + 15) / 16);
+    unsigned int mbs_per_frame = (mbs + params->intra_refresh - 1) / params->intra_refresh;
+
+    ctrl.id = V4L2_CID_MPEG_VIDEO_CYCLIC_INTRA_REFRESH_MB;
+    ctrl.value = mbs_per_frame;
+    if (ioctl(fd, VIDIOC_S_CTRL, &ctrl) == 0) {
+        return (mbs + mbs_per_frame - 1) / mbs_per_frame;
+    }
+
+    return 0;
+}
+
 bool encoder_create(const parameters_t *params, int stride, int colorspace, encoder_output_cb output_cb, encoder_t **enc) {
     *enc = malloc(sizeof(encoder_priv_t));
     encoder_priv_t *encp = (encoder_priv_t *)(*enc);
@@ -143,7 +369,14 @@ bool encoder_create(const parameters_t *params, int stride, int colorspace, enco
         goto failed;
     }
 
-    bool res2 = fill_dynamic_params(encp->fd, params);
+    if (params->intra_refresh != 0) {
+        encp->refresh_frames = set_intra_refresh(encp->fd, params);
+        if (encp->refresh_frames == 0) {
+            fprintf(stderr, "intra refresh is not supported by the encoder, using periodic IDR frames only\n");
+        }
+    }
+
+    bool res2 = fill_dynamic_params(encp->fd, params, encp->refresh_frames != 0);
     if (!res2) {
         goto failed;
     }
@@ -207,7 +440,8 @@ bool encoder_create(const parameters_t *params, int stride, int colorspace, enco
     struct v4l2_streamparm parm = {0};
     parm.type = V4L2_BUF_TYPE_VIDEO_OUTPUT_MPLANE;
     parm.parm.output.timeperframe.numerator = 1;
-    parm.parm.output.timeperframe.denominator = params->fps;
+    parm.parm.output.timeperframe.denominator = (params->output_fps > 0 && params->output_fps < params->fps) ?
+        params->output_fps : params->fps;
     res = ioctl(encp->fd, VIDIOC_S_PARM, &parm);
     if (res != 0) {
         set_error("unable to set fps");
@@ -304,7 +538,14 @@ failed:
     return false;
 }
 
-void encoder_encode(encoder_t *enc, int buffer_fd, size_t size, int64_t timestamp_us) {
+bool encoder_busy(encoder_t *enc) {
+    encoder_priv_t *encp = (encoder_priv_t *)enc;
+
+    // the next buffer is still owned by the encoder, therefore a new frame would be rejected.
+    return atomic_load(&encp->output_in_flight) >= (int)(encp->params->buffer_count - 1);
+}
+
+bool encoder_encode(encoder_t *enc, int buffer_fd, size_t size, int64_t timestamp_us) {
     encoder_priv_t *encp = (encoder_priv_t *)enc;
 
     int index = encp->cur_buffer++;
@@ -325,13 +566,30 @@ void encoder_encode(encoder_t *enc, int buffer_fd, size_t size, int64_t timestam
     buf.m.planes[0].length = size;
     int res = ioctl(encp->fd, VIDIOC_QBUF, &buf);
     if (res != 0) {
-        fprintf(stderr, "encoder_encode(): ioctl(VIDIOC_QBUF) failed\n");
         // it happens when the raspberry is under pressure. do not exit.
+        return false;
     }
+
+    atomic_fetch_add(&encp->output_in_flight, 1);
+    return true;
 }
 
 void encoder_reload_params(encoder_t *enc, const parameters_t *params) {
      encoder_priv_t *encp = (encoder_priv_t *)enc;
 
-     fill_dynamic_params(encp->fd, params);
+     fill_dynamic_params(encp->fd, params, encp->refresh_frames != 0);
+}
+
+void encoder_restart(encoder_t *enc) {
+    encoder_priv_t *encp = (encoder_priv_t *)enc;
+
+    atomic_store(&encp->restart_requested, true);
+
+    struct v4l2_control ctrl = {0};
+    ctrl.id = V4L2_CID_MPEG_VIDEO_FORCE_KEY_FRAME;
+    ctrl.value = 1;
+    int res = ioctl(encp->fd, VIDIOC_S_CTRL, &ctrl);
+    if (res != 0) {
+        fprintf(stderr, "encoder_restart(): unable to force a key frame, waiting for the next IDR\n");
+    }
 }
@@ -9,7 +9,9 @@ typedef void (*encoder_output_cb)(uint64_t ts, const uint8_t *buf, uint64_t size
 
 const char *encoder_get_error();
 bool encoder_create(const parameters_t *params, int stride, int colorspace, encoder_output_cb output_cb, encoder_t **enc);
-void encoder_encode(encoder_t *enc, int buffer_fd, size_t size, int64_t timestamp_us);
+bool encoder_busy(encoder_t *enc);
+bool encoder_encode(encoder_t *enc, int buffer_fd, size_t size, int64_t timestamp_us);
 void encoder_reload_params(encoder_t *enc, const parameters_t *params);
+void encoder_restart(encoder_t *enc);
 
 #endif
@@ -5,15 +5,25 @@
 #include <stdlib.h>
 #include <string.h>
 #include <pthread.h>
+#include <poll.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
 
 #include "parameters.h"
 #include "pipe.h"
 #include "camera.h"
+#include "scheduler.h"
+#include "overlay.h"
 #include "text.h"
 #include "encoder.h"
 
-static int pipe_video_fd;
+static int pipe_video_fd = -1;
 static pthread_mutex_t pipe_video_mutex;
+static camera_t *cam;
+static scheduler_t *sched;
+static overlay_t *overlay;
 static text_t *text;
 static encoder_t *enc;
 
@@ -24,64 +34,159 @@ static void on_frame(
     int buffer_fd,
     uint64_t size,
     uint64_t timestamp) {
+    if (!scheduler_admit(sched, timestamp, encoder_busy(enc))) {
+        return;
+    }
+
+    overlay_draw(overlay, mapped_buffer, stride, height);
     text_draw(text, mapped_buffer, stride, height);
-    encoder_encode(enc, buffer_fd, size, timestamp);
+
+    if (!encoder_encode(enc, buffer_fd, size, timestamp)) {
+        scheduler_report_failure(sched);
+    }
 }
 
 static void on_encoder_output(uint64_t ts, const uint8_t *buf, uint64_t size) {
     pthread_mutex_lock(&pipe_video_mutex);
-    pipe_write_buf(pipe_video_fd, ts, buf, size);
+    // when the helper is detached, frames are discarded.
+    if (pipe_video_fd >= 0) {
+        pipe_write_buf(pipe_video_fd, ts, buf, size);
+    }
     pthread_mutex_unlock(&pipe_video_mutex);
 }
 
-int main() {
-    int pipe_conf_fd = atoi(getenv("PIPE_CONF_FD"));
-    pipe_video_fd = atoi(getenv("PIPE_VIDEO_FD"));
-
-    uint8_t *buf;
-    uint32_t n = pipe_read(pipe_conf_fd, &buf);
-
-    parameters_t params;
-    bool ok = parameters_unserialize(&params, &buf[1], n-1);
-    free(buf);
+// start creates all components and starts the camera.
+// In case of errors, they are written into fd.
+static bool start(const parameters_t *params, int fd) {
+    bool ok = camera_create(
+        params,
+        on_frame,
+        &cam);
     if (!ok) {
-        pipe_write_error(pipe_video_fd, "parameters_unserialize(): %s", parameters_get_error());
-        return 5;
+        pipe_write_error(fd, "camera_create(): %s", camera_get_error());
+        return false;
     }
 
-    pthread_mutex_init(&pipe_video_mutex, NULL);
-    pthread_mutex_lock(&pipe_video_mutex);
+    ok = scheduler_create(params, &sched);
+    if (!ok) {
+        pipe_write_error(fd, "scheduler_create(): %s", scheduler_get_error());
+        return false;
+    }
 
-    camera_t *cam;
-    ok = camera_create(
-        &params,
-        on_frame,
-        &cam);
+    ok = overlay_create(params, &overlay);
     if (!ok) {
-        pipe_write_error(pipe_video_fd, "camera_create(): %s", camera_get_error());
-        return 5;
+        pipe_write_error(fd, "overlay_create(): %s", overlay_get_error());
+        return false;
     }
 
-    ok = text_create(&params, &text);
+    ok = text_create(params, &text);
     if (!ok) {
-        pipe_write_error(pipe_video_fd, "text_create(): %s", text_get_error());
-        return 5;
+        pipe_write_error(fd, "text_create(): %s", text_get_error());
+        return false;
     }
 
     ok = encoder_create(
-        &params,
+        params,
         camera_get_mode_stride(cam),
         camera_get_mode_colorspace(cam),
         on_encoder_output,
         &enc);
     if (!ok) {
-        pipe_write_error(pipe_video_fd, "encoder_create(): %s", encoder_get_error());
-        return 5;
+        pipe_write_error(fd, "encoder_create(): %s", encoder_get_error());
+        return false;
     }
 
     ok = camera_start(cam);
     if (!ok) {
-        pipe_write_error(pipe_video_fd, "camera_start(): %s", camera_get_error());
+        pipe_write_error(fd, "camera_start(): %s", camera_get_error());
+        return false;
+    }
+
+    return true;
+}
+
+static void reload_params(const parameters_t *params) {
+    camera_reload_params(cam, params);
+    camera_set_roi(cam, params->roi, params->roi_transition);
+    encoder_reload_params(enc, params);
+    scheduler_reload_params(sched, params);
+}
+
+static void set_roi(uint8_t *buf, uint32_t n) {
+    char *str = malloc(n);
+    memcpy(str, &buf[1], n - 1);
+    str[n - 1] = 0x00;
+
+    char *roi_str;
+    unsigned int transition = strtoul(str, &roi_str, 10);
+    while (*roi_str == ' ') {
+        roi_str++;
+    }
+
+    if (*roi_str == 0x00) {
+        camera_set_roi(cam, NULL, transition);
+    } else {
+        window_t roi;
+        if (window_load(roi_str, &roi)) {
+            camera_set_roi(cam, &roi, transition);
+        } else {
+            printf("skipping region of interest since it is invalid\n");
+        }
+    }
+
+    free(str);
+}
+
+// handle_message handles a message received after startup.
+// It returns false when the helper must exit.
+static bool handle_message(uint8_t *buf, uint32_t n) {
+    switch (buf[0]) {
+    case 'e':
+        return false;
+
+    case 'c':
+        {
+            parameters_t params;
+            bool ok = parameters_unserialize(&params, &buf[1], n-1);
+            if (!ok) {
+                printf("skipping reloading parameters since they are invalid: %s\n", parameters_get_error());
+                break;
+            }
+            reload_params(&params);
+            parameters_destroy(&params);
+        }
+        break;
+
+    case 'p':
+        set_roi(buf, n);
+        break;
+    }
+
+    return true;
+}
+
+static int run_pipes() {
+    int pipe_conf_fd = atoi(getenv("PIPE_CONF_FD"));
+    pipe_video_fd = atoi(getenv("PIPE_VIDEO_FD"));
+
+    uint8_t *buf;
+    uint32_t n = pipe_read(pipe_conf_fd, &buf);
+    if (n == 0) {
+        return 5;
+    }
+
+    parameters_t params;
+    bool ok = parameters_unserialize(&params, &buf[1], n-1);
+    free(buf);
+    if (!ok) {
+        pipe_write_error(pipe_video_fd, "parameters_unserialize(): %s", parameters_get_error());
+        return 5;
+    }
+
+    pthread_mutex_lock(&pipe_video_mutex);
+
+    ok = start(&params, pipe_video_fd);
+    if (!ok) {
         return 5;
     }
 
@@ -91,26 +196,193 @@ int main() {
     while (true) {
         uint8_t *buf;
         uint32_t n = pipe_read(pipe_conf_fd, &buf);
+        if (n == 0) {
+            return 0;
+        }
 
-        switch (buf[0]) {
-        case 'e':
+        bool ok = handle_message(buf, n);
+        free(buf);
+        if (!ok) {
             return 0;
+        }
+    }
+
+    return 0;
+}
+
+static int listen_socket(const char *socket_path) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        return -1;
+    }
+
+    struct sockaddr_un addr = {0};
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+    unlink(socket_path);
+
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, 1) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+// attach handles the first message of a server, that contains parameters.
+// It returns false when the helper must exit.
+static bool attach(int conn, parameters_t *params, bool *started) {
+    uint8_t *buf;
+    uint32_t n = pipe_read(conn, &buf);
+    if (n == 0) {
+        return true;
+    }
+
+    if (buf[0] != 'c') {
+        bool stop = (buf[0] == 'e');
+        free(buf);
+        return !stop;
+    }
+
+    parameters_t next;
+    bool ok = parameters_unserialize(&next, &buf[1], n-1);
+    free(buf);
+    if (!ok) {
+        pipe_write_error(conn, "parameters_unserialize(): %s", parameters_get_error());
+        return true;
+    }
+
+    pthread_mutex_lock(&pipe_video_mutex);
+
+    if (!*started) {
+        *params = next;
+
+        ok = start(params, conn);
+        if (!ok) {
+            pthread_mutex_unlock(&pipe_video_mutex);
+            return false;
+        }
+
+        *started = true;
+    } else {
+        // parameters that can't be changed at runtime are different,
+        // therefore the helper must be restarted.
+        if (!parameters_can_be_reloaded(params, &next)) {
+            pipe_write_mismatch(conn);
+            pthread_mutex_unlock(&pipe_video_mutex);
+            parameters_destroy(&next);
+            return false;
+        }
+
+        reload_params(&next);
+        parameters_destroy(&next);
+
+        // readers need an IDR to start decoding.
+        encoder_restart(enc);
+    }
+
+    pipe_write_ready(conn);
+    pipe_video_fd = conn;
+    pthread_mutex_unlock(&pipe_video_mutex);
+
+    return true;
+}
+
+static void detach() {
+    pthread_mutex_lock(&pipe_video_mutex);
+    pipe_video_fd = -1;
+    pthread_mutex_unlock(&pipe_video_mutex);
+}
+
+// run_socket runs the helper in detached mode.
+// The helper listens on a Unix socket and keeps capturing when the server detaches,
+// in order to survive server restarts.
+static int run_socket(const char *socket_path) {
+    // writes into a socket whose server is gone must not kill the helper.
+    signal(SIGPIPE, SIG_IGN);
+
+    int listen_fd = listen_socket(socket_path);
+    if (listen_fd < 0) {
+        fprintf(stderr, "unable to listen on %s\n", socket_path);
+        return 5;
+    }
+
+    static parameters_t params;
+    bool started = false;
+    int ret = 0;
+
+    while (true) {
+        int conn = accept(listen_fd, NULL, NULL);
+        if (conn < 0) {
+            continue;
+        }
+
+        bool ok = attach(conn, &params, &started);
+        if (!ok) {
+            close(conn);
+            ret = started ? 0 : 5;
+            break;
+        }
+
+        if (pipe_video_fd != conn) {
+            close(conn);
+            continue;
+        }
+
+        while (true) {
+            struct pollfd fds[2] = {
+                { conn, POLLIN, 0 },
+                { listen_fd, POLLIN, 0 },
+            };
+            poll(fds, 2, -1);
 
-        case 'c':
-            {
-                parameters_t params;
-                bool ok = parameters_unserialize(&params, &buf[1], n-1);
+            // only one server at a time can be attached.
+            if (fds[1].revents & POLLIN) {
+                int other = accept(listen_fd, NULL, NULL);
+                if (other >= 0) {
+                    pipe_write_error(other, "camera is in use by another server");
+                    close(other);
+                }
+            }
+
+            if (fds[0].revents != 0) {
+                uint8_t *buf;
+                uint32_t n = pipe_read(conn, &buf);
+                if (n == 0 || buf[0] == 'd') {
+                    free(buf);
+                    break;
+                }
+
+                ok = handle_message(buf, n);
                 free(buf);
                 if (!ok) {
-                    printf("skipping reloading parameters since they are invalid: %s\n", parameters_get_error());
-                    continue;
+                    break;
                 }
-                camera_reload_params(cam, &params);
-                encoder_reload_params(enc, &params);
-                parameters_destroy(&params);
             }
         }
+
+        detach();
+        close(conn);
+
+        if (!ok) {
+            break;
+        }
     }
 
-    return 0;
+    close(listen_fd);
+    unlink(socket_path);
+
+    return ret;
+}
+
+int main() {
+    pthread_mutex_init(&pipe_video_mutex, NULL);
+
+    const char *socket_path = getenv("SOCKET_PATH");
+    if (socket_path != NULL) {
+        return run_socket(socket_path);
+    }
+
+    return run_pipes();
 }
@@ -0,0 +1,268 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <png.h>
+
+#include "overlay.h"
+
+#define OVERLAY_IMAGES_MAX 4
+
+static char errbuf[256];
+
+static void set_error(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(errbuf, 256, format, args);
+}
+
+const char *overlay_get_error() {
+    return errbuf;
+}
+
+// an image converted into the format of frames (YUV420).
+// Planes are premultiplied by alpha, in order to blend them with a multiplication and an addition.
+typedef struct {
+    unsigned int x;
+    unsigned int y;
+    unsigned int width;
+    unsigned int height;
+    uint8_t *luma;
+    uint8_t *luma_inv_alpha;
+    uint8_t *cb;
+    uint8_t *cr;
+    uint8_t *chroma_inv_alpha;
+} overlay_image_t;
+
+typedef struct {
+    unsigned int count;
+    overlay_image_t images[OVERLAY_IMAGES_MAX];
+} overlay_priv_t;
+
+// coefficients to convert RGB into limited range YCbCr.
+typedef struct {
+    float kr;
+    float kb;
+} yuv_matrix_t;
+
+static const yuv_matrix_t bt601 = {0.299f, 0.114f};
+static const yuv_matrix_t bt709 = {0.2126f, 0.0722f};
+
+static void rgb_to_yuv(const yuv_matrix_t *m, const uint8_t *rgb, float *y, float *cb, float *cr) {
+    float r = rgb[0] / 255.0f;
+    float g = rgb[1] / 255.0f;
+    float b = rgb[2] / 255.0f;
+    float l = m->kr * r + (1.0f - m->kr - m->kb) * g + m->kb * b;
+
+    *y = 16.0f + 219.0f * l;
+    *cb = 128.0f + 224.0f * (b - l) / (2.0f * (1.0f - m->kb));
+    *cr = 128.0f + 224.0f * (r - l) / (2.0f * (1.0f - m->kr));
+}
+
+static uint8_t to_u8(float v) {
+    if (v <= 0) {
+        return 0;
+    }
+    if (v >= 255) {
+        return 255;
+    }
+    return (uint8_t)(v + 0.5f);
+}
+
+// convert_image converts a RGBA image into premultiplied planes.
+// Chroma is subsampled by averaging 2x2 blocks, like in YUV420.
+static void convert_image(overlay_image_t *img, const yuv_matrix_t *m, const uint8_t *rgba, unsigned int rgba_stride) {
+    unsigned int cw = img->width / 2;
+    unsigned int ch = img->height / 2;
+
+    img->luma = malloc(img->width * img->height);
+    img->luma_inv_alpha = malloc(img->width * img->height);
+    img->cb = malloc(cw * ch);
+    img->cr = malloc(cw * ch);
+    img->chroma_inv_alpha = malloc(cw * ch);
+
+    for (unsigned int cy = 0; cy < ch; cy++) {
+        for (unsigned int cx = 0; cx < cw; cx++) {
+            float sum_cb = 0;
+            float sum_cr = 0;
+            float sum_a = 0;
+
+            for (unsigned int j = 0; j < 2; j++) {
+                for (unsigned int i = 0; i < 2; i++) {
+                    unsigned int px = cx * 2 + i;
+                    unsigned int py = cy * 2 + j;
+                    const uint8_t *p = &rgba[py * rgba_stride + px * 4];
+                    float a = p[3] / 255.0f;
+                    float y, cb, cr;
+                    rgb_to_yuv(m, p, &y, &cb, &cr);
+
+                    img->luma[py * img->width + px] = to_u8(y * a);
+                    img->luma_inv_alpha[py * img->width + px] = 255 - p[3];
+
+                    sum_cb += cb * a;
+                    sum_cr += cr * a;
+                    sum_a += a;
+                }
+            }
+
+            img->cb[cy * cw + cx] = to_u8(sum_cb / 4);
+            img->cr[cy * cw + cx] = to_u8(sum_cr / 4);
+            img->chroma_inv_alpha[cy * cw + cx] = 255 - to_u8(sum_a * 255 / 4);
+        }
+    }
+}
+
+static bool load_image(overlay_image_t *img, const parameters_t *params, float x, float y, const char *path) {
+    png_image png;
+    memset(&png, 0, sizeof(png));
+    png.version = PNG_IMAGE_VERSION;
+
+    if (!png_image_begin_read_from_file(&png, path)) {
+        set_error("unable to read %s: %s", path, png.message);
+        return false;
+    }
+
+    png.format = PNG_FORMAT_RGBA;
+    uint8_t *rgba = malloc(PNG_IMAGE_SIZE(png));
+
+    if (!png_image_finish_read(&png, NULL, rgba, 0, NULL)) {
+        set_error("unable to decode %s: %s", path, png.message);
+        free(rgba);
+        return false;
+    }
+
+    // position and size must be even, in order to be aligned with chroma.
+    img->x = ((unsigned int)(x * params->width)) & ~1;
+    img->y = ((unsigned int)(y * params->height)) & ~1;
+
+    // the part of the image that exceeds the frame is discarded.
+    img->width = png.width;
+    if ((img->x + img->width) > params->width) {
+        img->width = params->width - img->x;
+    }
+    img->width &= ~1;
+
+    img->height = png.height;
+    if ((img->y + img->height) > params->height) {
+        img->height = params->height - img->y;
+    }
+    img->height &= ~1;
+
+    const yuv_matrix_t *m = (params->width >= 1280 || params->height >= 720) ? &bt709 : &bt601;
+    convert_image(img, m, rgba, PNG_IMAGE_ROW_STRIDE(png));
+
+    free(rgba);
+    return true;
+}
+
+static bool load_images(overlay_priv_t *overp, const parameters_t *params) {
+    char *tmp = strdup(params->image_overlays);
+    char *saveptr;
+    bool ok = true;
+
+    for (char *entry = strtok_r(tmp, ";", &saveptr); entry != NULL; entry = strtok_r(NULL, ";", &saveptr)) {
+        if (overp->count == OVERLAY_IMAGES_MAX) {
+            set_error("too many image overlays");
+            ok = false;
+            break;
+        }
+
+        // entries are in format x,y,path
+        char *x = entry;
+        char *y = strchr(x, ',');
+        char *path = (y != NULL) ? strchr(y + 1, ',') : NULL;
+        if (path == NULL) {
+            set_error("invalid image overlay: %s", entry);
+            ok = false;
+            break;
+        }
+        *y++ = 0x00;
+        *path++ = 0x00;
+
+        ok = load_image(&overp->images[overp->count], params, atof(x), atof(y), path);
+        if (!ok) {
+            break;
+        }
+
+        overp->count++;
+    }
+
+    free(tmp);
+    return ok;
+}
+
+bool overlay_create(const parameters_t *params, overlay_t **overlay) {
+    *overlay = malloc(sizeof(overlay_priv_t));
+    overlay_priv_t *overp = (overlay_priv_t *)(*overlay);
+    memset(overp, 0, sizeof(overlay_priv_t));
+
+    if (params->image_overlays != NULL) {
+        bool ok = load_images(overp, params);
+        if (!ok) {
+            goto failed;
+        }
+    }
+
+    return true;
+
+failed:
+    free(overp);
+
+    return false;
+}
+
+// blend_row blends a premultiplied row into a frame row.
+// It is written without branches, in order to allow the compiler to vectorize it.
+static void blend_row(uint8_t *restrict dst, const uint8_t *restrict src, const uint8_t *restrict inv_alpha, unsigned int n) {
+    for (unsigned int i = 0; i < n; i++) {
+        uint16_t v = (uint16_t)dst[i] * inv_alpha[i] + 128;
+        uint16_t r = src[i] + ((v + (v >> 8)) >> 8);
+        dst[i] = (r > 255) ? 255 : r;
+    }
+}
+
+static void blend_plane(uint8_t *dst, int dst_stride, const uint8_t *src, const uint8_t *inv_alpha,
+    unsigned int width, unsigned int height) {
+    for (unsigned int y = 0; y < height; y++) {
+        blend_row(&dst[y * dst_stride], &src[y * width], &inv_alpha[y * width], width);
+    }
+}
+
+void overlay_draw(overlay_t *overlay, uint8_t *buf, int stride, int height) {
+    overlay_priv_t *overp = (overlay_priv_t *)overlay;
+
+    uint8_t *Y = buf;
+    uint8_t *U = Y + stride * height;
+    uint8_t *V = U + (stride / 2) * (height / 2);
+
+    for (unsigned int i = 0; i < overp->count; i++) {
+        const overlay_image_t *img = &overp->images[i];
+
+        blend_plane(
+            &Y[img->y * stride + img->x],
+            stride,
+            img->luma,
+            img->luma_inv_alpha,
+            img->width,
+            img->height);
+
+        int chroma_offset = (img->y / 2) * (stride / 2) + (img->x / 2);
+
+        blend_plane(
+            &U[chroma_offset],
+            stride / 2,
+            img->cb,
+            img->chroma_inv_alpha,
+            img->width / 2,
+            img->height / 2);
+
+        blend_plane(
+            &V[chroma_offset],
+            stride / 2,
+            img->cr,
+            img->chroma_inv_alpha,
+            img->width / 2,
+            img->height / 2);
+    }
+}
@@ -0,0 +1,15 @@
+#ifndef __OVERLAY_H__
+#define __OVERLAY_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "parameters.h"
+
+typedef void overlay_t;
+
+const char *overlay_get_error();
+bool overlay_create(const parameters_t *params, overlay_t **overlay);
+void overlay_draw(overlay_t *overlay, uint8_t *buf, int stride, int height);
+
+#endif
@@ -87,6 +87,8 @@ bool parameters_unserialize(parameters_t *params, const uint8_t *buf, size_t buf
                 }
             }
             free(decoded_val);
+        } else if (strcmp(key, "ROITransition") == 0) {
+            params->roi_transition = atoi(val);
         } else if (strcmp(key, "HDR") == 0) {
             params->hdr = (strcmp(val, "1") == 0);
         } else if (strcmp(key, "TuningFile") == 0) {
@@ -105,8 +107,12 @@ bool parameters_unserialize(parameters_t *params, const uint8_t *buf, size_t buf
             free(decoded_val);
         } else if (strcmp(key, "FPS") == 0) {
             params->fps = atof(val);
+        } else if (strcmp(key, "OutputFPS") == 0) {
+            params->output_fps = atof(val);
         } else if (strcmp(key, "IDRPeriod") == 0) {
             params->idr_period = atoi(val);
+        } else if (strcmp(key, "IntraRefresh") == 0) {
+            params->intra_refresh = atoi(val);
         } else if (strcmp(key, "Bitrate") == 0) {
             params->bitrate = atoi(val);
         } else if (strcmp(key, "Profile") == 0) {
@@ -153,6 +159,13 @@ bool parameters_unserialize(parameters_t *params, const uint8_t *buf, size_t buf
             params->text_overlay_enable = (strcmp(val, "1") == 0);
         } else if (strcmp(key, "TextOverlay") == 0) {
             params->text_overlay = base64_decode(val);
+        } else if (strcmp(key, "ImageOverlays") == 0) {
+            char *decoded_val = base64_decode(val);
+            if (strlen(decoded_val) != 0) {
+                params->image_overlays = decoded_val;
+            } else {
+                free(decoded_val);
+            }
         }
     }
 
@@ -170,6 +183,45 @@ failed:
     return false;
 }
 
+static bool string_equal(const char *a, const char *b) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return strcmp(a, b) == 0;
+}
+
+static bool struct_equal(const void *a, const void *b, size_t size) {
+    if (a == NULL || b == NULL) {
+        return a == b;
+    }
+    return memcmp(a, b, size) == 0;
+}
+
+// parameters_can_be_reloaded returns whether next differs from cur only in parameters
+// that can be changed without restarting the camera and the encoder.
+bool parameters_can_be_reloaded(const parameters_t *cur, const parameters_t *next) {
+    return cur->camera_id == next->camera_id &&
+        cur->width == next->width &&
+        cur->height == next->height &&
+        cur->h_flip == next->h_flip &&
+        cur->v_flip == next->v_flip &&
+        cur->hdr == next->hdr &&
+        string_equal(cur->tuning_file, next->tuning_file) &&
+        struct_equal(cur->mode, next->mode, sizeof(sensor_mode_t)) &&
+        cur->output_fps == next->output_fps &&
+        cur->intra_refresh == next->intra_refresh &&
+        cur->profile == next->profile &&
+        cur->level == next->level &&
+        string_equal(cur->af_mode, next->af_mode) &&
+        string_equal(cur->af_range, next->af_range) &&
+        string_equal(cur->af_speed, next->af_speed) &&
+        cur->lens_position == next->lens_position &&
+        struct_equal(cur->af_window, next->af_window, sizeof(window_t)) &&
+        cur->text_overlay_enable == next->text_overlay_enable &&
+        string_equal(cur->text_overlay, next->text_overlay) &&
+        string_equal(cur->image_overlays, next->image_overlays);
+}
+
 void parameters_destroy(parameters_t *params) {
     if (params->exposure != NULL) {
         free(params->exposure);
@@ -207,4 +259,7 @@ void parameters_destroy(parameters_t *params) {
     if (params->text_overlay != NULL) {
         free(params->text_overlay);
     }
+    if (params->image_overlays != NULL) {
+        free(params->image_overlays);
+    }
 }
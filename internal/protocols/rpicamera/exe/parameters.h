@@ -28,11 +28,14 @@ typedef struct {
     float gain;
     float ev;
     window_t *roi;
+    unsigned int roi_transition;
     bool hdr;
     char *tuning_file;
     sensor_mode_t *mode;
     float fps;
+    float output_fps;
     unsigned int idr_period;
+    unsigned int intra_refresh;
     unsigned int bitrate;
     unsigned int profile;
     unsigned int level;
@@ -43,6 +46,7 @@ typedef struct {
     window_t *af_window;
     bool text_overlay_enable;
     char *text_overlay;
+    char *image_overlays;
 
     // private
     unsigned int buffer_count;
@@ -55,6 +59,7 @@ extern "C" {
 
 const char *parameters_get_error();
 bool parameters_unserialize(parameters_t *params, const uint8_t *buf, size_t buf_size);
+bool parameters_can_be_reloaded(const parameters_t *cur, const parameters_t *next);
 void parameters_destroy(parameters_t *params);
 
 #ifdef __cplusplus
@@ -18,6 +18,13 @@ void pipe_write_error(int fd, const char *format, ...) {
     write(fd, buf, n);
 }
 
+void pipe_write_mismatch(int fd) {
+    char buf[] = {'m'};
+    uint32_t n = 1;
+    write(fd, &n, 4);
+    write(fd, buf, n);
+}
+
 void pipe_write_ready(int fd) {
     char buf[] = {'r'};
     uint32_t n = 1;
@@ -34,11 +41,35 @@ void pipe_write_buf(int fd, uint64_t ts, const uint8_t *buf, uint32_t n) {
     write(fd, buf, n - 1 - sizeof(uint64_t));
 }
 
+static bool read_all(int fd, void *buf, size_t size) {
+    uint8_t *pos = buf;
+
+    while (size > 0) {
+        ssize_t n = read(fd, pos, size);
+        if (n <= 0) {
+            return false;
+        }
+        pos += n;
+        size -= n;
+    }
+
+    return true;
+}
+
+// pipe_read reads a message. It returns zero when the other side has been closed.
 uint32_t pipe_read(int fd, uint8_t **pbuf) {
     uint32_t n;
-    read(fd, &n, 4);
+    if (!read_all(fd, &n, 4) || n == 0) {
+        *pbuf = NULL;
+        return 0;
+    }
 
     *pbuf = malloc(n);
-    read(fd, *pbuf, n);
+    if (!read_all(fd, *pbuf, n)) {
+        free(*pbuf);
+        *pbuf = NULL;
+        return 0;
+    }
+
     return n;
 }
@@ -0,0 +1,170 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#include "scheduler.h"
+
+// period between reports of counters, in microseconds.
+#define REPORT_PERIOD 10000000
+
+static char errbuf[256];
+
+static void set_error(const char *format, ...) {
+    va_list args;
+    va_start(args, format);
+    vsnprintf(errbuf, 256, format, args);
+}
+
+const char *scheduler_get_error() {
+    return errbuf;
+}
+
+typedef struct {
+    bool debug;
+    float output_fps;
+    pthread_mutex_t mutex;
+    uint64_t interval;  // interval between encoded frames, 0 if all frames are encoded
+    uint64_t tolerance; // half the interval between captured frames, to absorb jitter
+    bool next_set;
+    uint64_t next;
+
+    uint64_t last_report;
+    uint64_t encoded;
+    uint64_t decimated; // frames skipped in order to reach the output rate
+    uint64_t dropped;   // frames skipped because the encoder was busy or failed
+} scheduler_priv_t;
+
+static void fill_intervals(scheduler_priv_t *schedp, float fps) {
+    schedp->tolerance = (fps > 0) ? (uint64_t)(1000000.0f / fps / 2) : 0;
+
+    if (schedp->output_fps > 0 && schedp->output_fps < fps) {
+        schedp->interval = (uint64_t)(1000000.0f / schedp->output_fps);
+    } else {
+        schedp->interval = 0;
+    }
+
+    schedp->next_set = false;
+}
+
+bool scheduler_create(const parameters_t *params, scheduler_t **sched) {
+    *sched = malloc(sizeof(scheduler_priv_t));
+    scheduler_priv_t *schedp = (scheduler_priv_t *)(*sched);
+    memset(schedp, 0, sizeof(scheduler_priv_t));
+
+    if (params->output_fps < 0) {
+        set_error("invalid output FPS");
+        goto failed;
+    }
+
+    schedp->debug = (strcmp(params->log_level, "debug") == 0);
+    schedp->output_fps = params->output_fps;
+    pthread_mutex_init(&schedp->mutex, NULL);
+
+    fill_intervals(schedp, params->fps);
+
+    return true;
+
+failed:
+    free(schedp);
+
+    return false;
+}
+
+void scheduler_reload_params(scheduler_t *sched, const parameters_t *params) {
+    scheduler_priv_t *schedp = (scheduler_priv_t *)sched;
+
+    pthread_mutex_lock(&schedp->mutex);
+    fill_intervals(schedp, params->fps);
+    pthread_mutex_unlock(&schedp->mutex);
+}
+
+// report prints counters periodically. Drops are always reported,
+// while decimation, that is expected, is reported in debug mode only.
+static void report(scheduler_priv_t *schedp, uint64_t timestamp) {
+    if (schedp->last_report == 0) {
+        schedp->last_report = timestamp;
+        return;
+    }
+
+    if ((timestamp - schedp->last_report) < REPORT_PERIOD) {
+        return;
+    }
+
+    if (schedp->dropped != 0 || schedp->debug) {
+        printf("frames in the last %ds: %llu encoded, %llu decimated, %llu dropped\n",
+            REPORT_PERIOD / 1000000,
+            (unsigned long long)schedp->encoded,
+            (unsigned long long)schedp->decimated,
+            (unsigned long long)schedp->dropped);
+        fflush(stdout);
+    }
+
+    schedp->last_report = timestamp;
+    schedp->encoded = 0;
+    schedp->decimated = 0;
+    schedp->dropped = 0;
+}
+
+// decimate returns whether a frame must be skipped in order to reach the output rate.
+// Decisions depend on timestamps only, therefore the output rate is kept
+// even when the capture rate is not a multiple of it.
+static bool decimate(scheduler_priv_t *schedp, uint64_t timestamp) {
+    if (schedp->interval == 0) {
+        return false;
+    }
+
+    if (!schedp->next_set) {
+        schedp->next_set = true;
+        schedp->next = timestamp;
+    }
+
+    if ((timestamp + schedp->tolerance) < schedp->next) {
+        return true;
+    }
+
+    schedp->next += schedp->interval;
+
+    // after a gap, restart from the current frame instead of encoding a burst.
+    if (schedp->next <= timestamp) {
+        schedp->next = timestamp + schedp->interval;
+    }
+
+    return false;
+}
+
+bool scheduler_admit(scheduler_t *sched, uint64_t timestamp, bool encoder_busy) {
+    scheduler_priv_t *schedp = (scheduler_priv_t *)sched;
+
+    pthread_mutex_lock(&schedp->mutex);
+
+    report(schedp, timestamp);
+
+    bool ok;
+
+    if (decimate(schedp, timestamp)) {
+        schedp->decimated++;
+        ok = false;
+    } else if (encoder_busy) {
+        // skipping the frame here is cheaper than having it rejected by the encoder.
+        schedp->dropped++;
+        ok = false;
+    } else {
+        schedp->encoded++;
+        ok = true;
+    }
+
+    pthread_mutex_unlock(&schedp->mutex);
+
+    return ok;
+}
+
+void scheduler_report_failure(scheduler_t *sched) {
+    scheduler_priv_t *schedp = (scheduler_priv_t *)sched;
+
+    pthread_mutex_lock(&schedp->mutex);
+    schedp->encoded--;
+    schedp->dropped++;
+    pthread_mutex_unlock(&schedp->mutex);
+}
@@ -0,0 +1,17 @@
+#ifndef __SCHEDULER_H__
+#define __SCHEDULER_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#include "parameters.h"
+
+typedef void scheduler_t;
+
+const char *scheduler_get_error();
+bool scheduler_create(const parameters_t *params, scheduler_t **sched);
+void scheduler_reload_params(scheduler_t *sched, const parameters_t *params);
+bool scheduler_admit(scheduler_t *sched, uint64_t timestamp, bool encoder_busy);
+void scheduler_report_failure(scheduler_t *sched);
+
+#endif
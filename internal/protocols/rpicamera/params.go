@@ -29,11 +29,14 @@ type Params struct {
 	Gain              float64
 	EV                float64
 	ROI               string
+	ROITransition     int
 	HDR               bool
 	TuningFile        string
 	Mode              string
 	FPS               float64
+	OutputFPS         float64
 	IDRPeriod         int
+	IntraRefresh      int
 	Bitrate           int
 	Profile           string
 	Level             string
@@ -44,6 +47,7 @@ type Params struct {
 	AfWindow          string
 	TextOverlayEnable bool
 	TextOverlay       string
+	ImageOverlays     string
 }
 
 func (p Params) serialize() []byte { //nolint:unused
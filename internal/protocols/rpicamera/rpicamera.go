@@ -6,6 +6,7 @@ package rpicamera
 import (
 	"debug/elf"
 	_ "embed"
+	"errors"
 	"fmt"
 	"os"
 	"os/exec"
@@ -13,19 +14,26 @@ import (
 	"strconv"
 	"strings"
 	"sync"
+	"syscall"
 	"time"
 
 	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
 )
 
 const (
-	tempPathPrefix = "/dev/shm/rtspss-embeddedexe-"
+	tempPathPrefix   = "/dev/shm/rtspss-embeddedexe-"
+	socketPathPrefix = "/dev/shm/mediamtx-rpicamera-"
+
+	detachedStartTimeout = 5 * time.Second
+	detachedExitTimeout  = 10 * time.Second
 )
 
+var errHelperMismatch = errors.New("detached helper was started with different parameters")
+
 //go:embed exe/exe
 var exeContent []byte
 
-func startEmbeddedExe(content []byte, env []string) (*exec.Cmd, error) {
+func startEmbeddedExe(content []byte, env []string, detached bool) (*exec.Cmd, error) {
 	tempPath := tempPathPrefix + strconv.FormatInt(time.Now().UnixNano(), 10)
 
 	err := os.WriteFile(tempPath, content, 0o755)
@@ -38,6 +46,11 @@ func startEmbeddedExe(content []byte, env []string) (*exec.Cmd, error) {
 	cmd.Stderr = os.Stderr
 	cmd.Env = env
 
+	// a detached helper runs in its own session, in order to survive the server.
+	if detached {
+		cmd.SysProcAttr = &syscall.SysProcAttr{Setsid: true}
+	}
+
 	err = cmd.Start()
 	os.Remove(tempPath)
 
@@ -111,14 +124,64 @@ func checkLibraries64Bit() error {
 	return nil
 }
 
+// channel is a bidirectional message channel with the helper.
+type channel interface {
+	read() ([]byte, error)
+	write([]byte) error
+	close()
+}
+
+func startDetachedHelper(socketPath string) (*socket, error) {
+	cmd, err := startEmbeddedExe(exeContent, []string{"SOCKET_PATH=" + socketPath}, true)
+	if err != nil {
+		return nil, err
+	}
+
+	// release resources of the process when it exits, without waiting for it.
+	go cmd.Wait() //nolint:errcheck
+
+	t := time.Now()
+
+	for {
+		time.Sleep(100 * time.Millisecond)
+
+		sock, err := dialSocket(socketPath)
+		if err == nil {
+			return sock, nil
+		}
+
+		if time.Since(t) >= detachedStartTimeout {
+			return nil, fmt.Errorf("detached helper did not start")
+		}
+	}
+}
+
+// stopDetachedHelper stops a detached helper that may have been started previously.
+func stopDetachedHelper(socketPath string) {
+	sock, err := dialSocket(socketPath)
+	if err != nil {
+		return
+	}
+	defer sock.close()
+
+	err = sock.write([]byte{'e'})
+	if err == nil {
+		sock.waitClose(detachedExitTimeout)
+	}
+}
+
 // RPICamera is a RPI Camera reader.
 type RPICamera struct {
 	Params Params
 	OnData func(time.Duration, [][]byte)
 
+	// keep the helper running after Close(), and attach to it
+	// during Initialize(), in order to avoid restarting the camera.
+	Detached bool
+
 	cmd       *exec.Cmd
-	pipeConf  *pipe
-	pipeVideo *pipe
+	pipeConf  channel
+	pipeVideo channel
 
 	waitDone   chan error
 	readerDone chan error
@@ -133,24 +196,32 @@ func (c *RPICamera) Initialize() error {
 		}
 	}
 
-	var err error
-	c.pipeConf, err = newPipe()
+	if c.Detached {
+		return c.initializeDetached()
+	}
+
+	// the camera can't be shared with a helper that was previously started in detached mode.
+	stopDetachedHelper(c.socketPath())
+
+	pipeConf, err := newPipe()
 	if err != nil {
 		return err
 	}
+	c.pipeConf = pipeConf
 
-	c.pipeVideo, err = newPipe()
+	pipeVideo, err := newPipe()
 	if err != nil {
 		c.pipeConf.close()
 		return err
 	}
+	c.pipeVideo = pipeVideo
 
 	env := []string{
-		"PIPE_CONF_FD=" + strconv.FormatInt(int64(c.pipeConf.readFD), 10),
-		"PIPE_VIDEO_FD=" + strconv.FormatInt(int64(c.pipeVideo.writeFD), 10),
+		"PIPE_CONF_FD=" + strconv.FormatInt(int64(pipeConf.readFD), 10),
+		"PIPE_VIDEO_FD=" + strconv.FormatInt(int64(pipeVideo.writeFD), 10),
 	}
 
-	c.cmd, err = startEmbeddedExe(exeContent, env)
+	c.cmd, err = startEmbeddedExe(exeContent, env, false)
 	if err != nil {
 		c.pipeConf.close()
 		c.pipeVideo.close()
@@ -194,7 +265,62 @@ func (c *RPICamera) Initialize() error {
 	return nil
 }
 
+func (c *RPICamera) socketPath() string {
+	return socketPathPrefix + strconv.FormatInt(int64(c.Params.CameraID), 10) + ".sock"
+}
+
+func (c *RPICamera) initializeDetached() error {
+	socketPath := c.socketPath()
+
+	for attempt := 0; ; attempt++ {
+		sock, err := dialSocket(socketPath)
+		if err != nil {
+			sock, err = startDetachedHelper(socketPath)
+			if err != nil {
+				return err
+			}
+		}
+
+		c.pipeConf = sock
+		c.pipeVideo = sock
+
+		err = sock.write(append([]byte{'c'}, c.Params.serialize()...))
+		if err == nil {
+			err = c.readReady()
+		}
+
+		if err == nil {
+			break
+		}
+
+		// the helper exits when parameters can't be applied to a running camera.
+		// Wait for it and start a new one.
+		if errors.Is(err, errHelperMismatch) && attempt == 0 {
+			sock.waitClose(detachedExitTimeout)
+			sock.close()
+			continue
+		}
+
+		sock.close()
+		return err
+	}
+
+	c.readerDone = make(chan error)
+	go func() {
+		c.readerDone <- c.readData()
+	}()
+
+	return nil
+}
+
 func (c *RPICamera) Close() {
+	if c.Detached {
+		c.pipeConf.write([]byte{'d'})
+		c.pipeConf.close()
+		<-c.readerDone
+		return
+	}
+
 	c.pipeConf.write([]byte{'e'})
 	<-c.waitDone
 	c.pipeConf.close()
@@ -203,7 +329,19 @@ func (c *RPICamera) Close() {
 }
 
 func (c *RPICamera) ReloadParams(params Params) {
-	c.pipeConf.write(append([]byte{'c'}, params.serialize()...))
+	// when only the region of interest changes, send a lightweight message
+	// that updates the crop rectangle of the ISP without reloading all parameters.
+	cur := c.Params
+	cur.ROI = params.ROI
+	cur.ROITransition = params.ROITransition
+
+	if cur == params {
+		c.pipeConf.write([]byte("p" + strconv.FormatInt(int64(params.ROITransition), 10) + " " + params.ROI))
+	} else {
+		c.pipeConf.write(append([]byte{'c'}, params.serialize()...))
+	}
+
+	c.Params = params
 }
 
 func (c *RPICamera) readReady() error {
@@ -219,6 +357,9 @@ func (c *RPICamera) readReady() error {
 	case 'r':
 		return nil
 
+	case 'm':
+		return errHelperMismatch
+
 	default:
 		return fmt.Errorf("unexpected output from video pipe: '0x%.2x'", buf[0])
 	}
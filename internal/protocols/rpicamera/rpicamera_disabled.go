@@ -15,8 +15,9 @@ func Cleanup() {
 
 // RPICamera is a RPI Camera reader.
 type RPICamera struct {
-	Params Params
-	OnData func(time.Duration, [][]byte)
+	Params   Params
+	OnData   func(time.Duration, [][]byte)
+	Detached bool
 }
 
 // Initialize initializes a RPICamera.
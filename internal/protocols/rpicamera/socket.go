@@ -0,0 +1,59 @@
+//go:build rpicamera
+// +build rpicamera
+
+package rpicamera
+
+import (
+	"io"
+	"net"
+	"time"
+)
+
+// socket is a connection with a detached helper.
+// Messages are framed in the same way as pipes.
+type socket struct {
+	conn net.Conn
+}
+
+func dialSocket(path string) (*socket, error) {
+	conn, err := net.Dial("unix", path)
+	if err != nil {
+		return nil, err
+	}
+
+	return &socket{conn: conn}, nil
+}
+
+func (s *socket) close() {
+	s.conn.Close()
+}
+
+func (s *socket) read() ([]byte, error) {
+	buf := make([]byte, 4)
+	_, err := io.ReadFull(s.conn, buf)
+	if err != nil {
+		return nil, err
+	}
+
+	le := int(buf[3])<<24 | int(buf[2])<<16 | int(buf[1])<<8 | int(buf[0])
+	buf = make([]byte, le)
+
+	_, err = io.ReadFull(s.conn, buf)
+	if err != nil {
+		return nil, err
+	}
+
+	return buf, nil
+}
+
+func (s *socket) write(byts []byte) error {
+	le := len(byts)
+	_, err := s.conn.Write(append([]byte{byte(le), byte(le >> 8), byte(le >> 16), byte(le >> 24)}, byts...))
+	return err
+}
+
+// waitClose waits until the helper closes the connection, that happens when it exits.
+func (s *socket) waitClose(timeout time.Duration) {
+	s.conn.SetReadDeadline(time.Now().Add(timeout)) //nolint:errcheck
+	io.Copy(io.Discard, s.conn)                     //nolint:errcheck
+}
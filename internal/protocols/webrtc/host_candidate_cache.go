@@ -0,0 +1,41 @@
+package webrtc
+
+import (
+	"strconv"
+	"strings"
+	"sync"
+
+	"github.com/pion/ice/v2"
+	"github.com/pion/webrtc/v3"
+)
+
+func hostCandidateKey(candidate *webrtc.ICECandidateInit) (string, bool) {
+	c, err := ice.UnmarshalCandidate(strings.TrimPrefix(candidate.Candidate, "candidate:"))
+	if err != nil || c.Type() != ice.CandidateTypeHost {
+		return "", false
+	}
+
+	return c.NetworkType().String() + "/" + c.Address() + "/" + strconv.FormatInt(int64(c.Port()), 10), true
+}
+
+// HostCandidateCache contains the host candidates gathered by previous peer connections.
+//
+// When ICE muxes are in use, host candidates are the same for every peer connection,
+// therefore answers can be sent as soon as these candidates are gathered again,
+// without waiting for server reflexive and relay candidates.
+type HostCandidateCache struct {
+	mutex      sync.RWMutex
+	candidates map[string]struct{}
+}
+
+func (c *HostCandidateCache) get() map[string]struct{} {
+	c.mutex.RLock()
+	defer c.mutex.RUnlock()
+	return c.candidates
+}
+
+func (c *HostCandidateCache) set(candidates map[string]struct{}) {
+	c.mutex.Lock()
+	defer c.mutex.Unlock()
+	c.candidates = candidates
+}
@@ -3,6 +3,7 @@ package webrtc
 import (
 	"fmt"
 	"strconv"
+	"strings"
 
 	"github.com/pion/sdp/v3"
 	"github.com/pion/webrtc/v3"
@@ -77,7 +78,7 @@ func ICEFragmentMarshal(offer string, candidates []*webrtc.ICECandidateInit) ([]
 				"a=mid:" + strconv.FormatUint(uint64(mid), 10) + "\r\n"
 
 			for _, candidate := range cbm {
-				frag += "a=candidate:" + candidate.Candidate + "\r\n"
+				frag += "a=candidate:" + strings.TrimPrefix(candidate.Candidate, "candidate:") + "\r\n"
 			}
 		}
 	}
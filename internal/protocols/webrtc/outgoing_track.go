@@ -21,7 +21,9 @@ var multichannelOpusSDP = map[int]string{
 type OutgoingTrack struct {
 	Format format.Format
 
-	track *webrtc.TrackLocalStaticRTP
+	track      *webrtc.TrackLocalStaticRTP
+	pc         *PeerConnection
+	packetSent bool
 }
 
 func (t *OutgoingTrack) codecParameters() (webrtc.RTPCodecParameters, error) {
@@ -232,6 +234,8 @@ func (t *OutgoingTrack) setup(p *PeerConnection) error {
 		trackID = "audio"
 	}
 
+	t.pc = p
+
 	var err error
 	t.track, err = webrtc.NewTrackLocalStaticRTP(
 		params.RTPCodecCapability,
@@ -263,5 +267,15 @@ func (t *OutgoingTrack) setup(p *PeerConnection) error {
 
 // WriteRTP writes a RTP packet.
 func (t *OutgoingTrack) WriteRTP(pkt *rtp.Packet) error {
-	return t.track.WriteRTP(pkt)
+	err := t.track.WriteRTP(pkt)
+	if err != nil {
+		return err
+	}
+
+	if !t.packetSent {
+		t.packetSent = true
+		t.pc.onPacketSent()
+	}
+
+	return nil
 }
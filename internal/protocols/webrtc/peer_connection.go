@@ -5,6 +5,7 @@ import (
 	"errors"
 	"fmt"
 	"strconv"
+	"strings"
 	"sync"
 	"time"
 
@@ -79,28 +80,35 @@ type PeerConnection struct {
 	AdditionalHosts       []string
 	Publish               bool
 	OutgoingTracks        []*OutgoingTrack
+	HostCandidateCache    *HostCandidateCache
+	SharedResources       *SharedResources
 	Log                   logger.Writer
 
-	wr                *webrtc.PeerConnection
-	stateChangeMutex  sync.Mutex
-	newLocalCandidate chan *webrtc.ICECandidateInit
-	connected         chan struct{}
-	disconnected      chan struct{}
-	done              chan struct{}
-	gatheringDone     chan struct{}
-	incomingTrack     chan trackRecvPair
+	wr                  *webrtc.PeerConnection
+	stateChangeMutex    sync.Mutex
+	newLocalCandidate   chan *webrtc.ICECandidateInit
+	connected           chan struct{}
+	disconnected        chan struct{}
+	done                chan struct{}
+	gatheringDone       chan struct{}
+	incomingTrack       chan trackRecvPair
+	firstPacketSent     chan struct{}
+	firstPacketSentOnce sync.Once
 
 	ctx       context.Context
 	ctxCancel context.CancelFunc
 }
 
-// Start starts the peer connection.
-func (co *PeerConnection) Start() error {
+func (co *PeerConnection) newAPI() (*webrtc.API, error) {
 	settingsEngine := webrtc.SettingEngine{}
 
+	// do not reference co, since the API can be shared with other peer connections
+	ipsFromInterfaces := co.IPsFromInterfaces
+	ipsFromInterfacesList := co.IPsFromInterfacesList
+
 	settingsEngine.SetInterfaceFilter(func(iface string) bool {
-		return co.IPsFromInterfaces && (len(co.IPsFromInterfacesList) == 0 ||
-			stringInSlice(iface, co.IPsFromInterfacesList))
+		return ipsFromInterfaces && (len(ipsFromInterfacesList) == 0 ||
+			stringInSlice(iface, ipsFromInterfacesList))
 	})
 
 	settingsEngine.SetAdditionalHosts(co.AdditionalHosts)
@@ -134,7 +142,7 @@ func (co *PeerConnection) Start() error {
 		for _, tr := range co.OutgoingTracks {
 			params, err := tr.codecParameters()
 			if err != nil {
-				return err
+				return nil, err
 			}
 
 			var codecType webrtc.RTPCodecType
@@ -148,7 +156,7 @@ func (co *PeerConnection) Start() error {
 
 			err = mediaEngine.RegisterCodec(params, codecType)
 			if err != nil {
-				return err
+				return nil, err
 			}
 		}
 
@@ -163,7 +171,7 @@ func (co *PeerConnection) Start() error {
 				PayloadType: 96,
 			}, webrtc.RTPCodecTypeVideo)
 			if err != nil {
-				return err
+				return nil, err
 			}
 		}
 		if !audioSetupped {
@@ -175,21 +183,21 @@ func (co *PeerConnection) Start() error {
 				PayloadType: 0,
 			}, webrtc.RTPCodecTypeAudio)
 			if err != nil {
-				return err
+				return nil, err
 			}
 		}
 	} else {
 		for _, codec := range incomingVideoCodecs {
 			err := mediaEngine.RegisterCodec(codec, webrtc.RTPCodecTypeVideo)
 			if err != nil {
-				return err
+				return nil, err
 			}
 		}
 
 		for _, codec := range incomingAudioCodecs {
 			err := mediaEngine.RegisterCodec(codec, webrtc.RTPCodecTypeAudio)
 			if err != nil {
-				return err
+				return nil, err
 			}
 		}
 	}
@@ -198,16 +206,33 @@ func (co *PeerConnection) Start() error {
 
 	err := webrtc.RegisterDefaultInterceptors(mediaEngine, interceptorRegistry)
 	if err != nil {
-		return err
+		return nil, err
 	}
 
-	api := webrtc.NewAPI(
+	return webrtc.NewAPI(
 		webrtc.WithSettingEngine(settingsEngine),
 		webrtc.WithMediaEngine(mediaEngine),
-		webrtc.WithInterceptorRegistry(interceptorRegistry))
+		webrtc.WithInterceptorRegistry(interceptorRegistry)), nil
+}
+
+// Start starts the peer connection.
+func (co *PeerConnection) Start() error {
+	var api *webrtc.API
+	var certificates []webrtc.Certificate
+	var err error
+
+	if co.SharedResources != nil {
+		api, certificates, err = co.SharedResources.get(co)
+	} else {
+		api, err = co.newAPI()
+	}
+	if err != nil {
+		return err
+	}
 
 	co.wr, err = api.NewPeerConnection(webrtc.Configuration{
-		ICEServers: co.ICEServers,
+		ICEServers:   co.ICEServers,
+		Certificates: certificates,
 	})
 	if err != nil {
 		return err
@@ -219,6 +244,7 @@ func (co *PeerConnection) Start() error {
 	co.done = make(chan struct{})
 	co.gatheringDone = make(chan struct{})
 	co.incomingTrack = make(chan trackRecvPair)
+	co.firstPacketSent = make(chan struct{})
 
 	co.ctx, co.ctxCancel = context.WithCancel(context.Background())
 
@@ -330,25 +356,29 @@ func (co *PeerConnection) AddRemoteCandidate(candidate *webrtc.ICECandidateInit)
 	return co.wr.AddICECandidate(*candidate)
 }
 
-// CreateFullAnswer creates a full answer.
-func (co *PeerConnection) CreateFullAnswer(
-	ctx context.Context,
-	offer *webrtc.SessionDescription,
-) (*webrtc.SessionDescription, error) {
+func (co *PeerConnection) setOfferAndCreateAnswer(offer *webrtc.SessionDescription) error {
 	err := co.wr.SetRemoteDescription(*offer)
 	if err != nil {
-		return nil, err
+		return err
 	}
 
 	answer, err := co.wr.CreateAnswer(nil)
 	if err != nil {
 		if errors.Is(err, webrtc.ErrSenderWithNoCodecs) {
-			return nil, fmt.Errorf("codecs not supported by client")
+			return fmt.Errorf("codecs not supported by client")
 		}
-		return nil, err
+		return err
 	}
 
-	err = co.wr.SetLocalDescription(answer)
+	return co.wr.SetLocalDescription(answer)
+}
+
+// CreateFullAnswer creates a full answer.
+func (co *PeerConnection) CreateFullAnswer(
+	ctx context.Context,
+	offer *webrtc.SessionDescription,
+) (*webrtc.SessionDescription, error) {
+	err := co.setOfferAndCreateAnswer(offer)
 	if err != nil {
 		return nil, err
 	}
@@ -361,6 +391,84 @@ func (co *PeerConnection) CreateFullAnswer(
 	return co.wr.LocalDescription(), nil
 }
 
+func offerSupportsTrickle(offer *webrtc.SessionDescription) bool {
+	var desc sdp.SessionDescription
+	err := desc.Unmarshal([]byte(offer.SDP))
+	if err != nil {
+		return false
+	}
+
+	hasTrickle := func(attributes []sdp.Attribute) bool {
+		for _, attr := range attributes {
+			if attr.Key == "ice-options" && stringInSlice("trickle", strings.Fields(attr.Value)) {
+				return true
+			}
+		}
+		return false
+	}
+
+	if hasTrickle(desc.Attributes) {
+		return true
+	}
+
+	for _, media := range desc.MediaDescriptions {
+		if hasTrickle(media.Attributes) {
+			return true
+		}
+	}
+
+	return false
+}
+
+// CreateEarlyAnswer creates an answer without waiting for the gathering of all local candidates.
+// If HostCandidateCache is filled, the answer is returned as soon as cached host candidates
+// are gathered again, and remaining candidates are returned by NewLocalCandidate().
+// Otherwise, all candidates are gathered and HostCandidateCache is filled.
+// Since remaining candidates can only be sent with trickle ICE, the answer is returned
+// early only when the offer advertises trickle ICE or when there are no STUN or TURN servers,
+// that is, when there are no candidates other than host candidates.
+func (co *PeerConnection) CreateEarlyAnswer(
+	ctx context.Context,
+	offer *webrtc.SessionDescription,
+) (*webrtc.SessionDescription, error) {
+	if co.HostCandidateCache == nil ||
+		(len(co.ICEServers) != 0 && !offerSupportsTrickle(offer)) {
+		return co.CreateFullAnswer(ctx, offer)
+	}
+
+	err := co.setOfferAndCreateAnswer(offer)
+	if err != nil {
+		return nil, err
+	}
+
+	expected := co.HostCandidateCache.get()
+	gathered := make(map[string]struct{})
+
+	for {
+		if expected != nil && len(gathered) == len(expected) {
+			return co.wr.LocalDescription(), nil
+		}
+
+		select {
+		case candidate := <-co.NewLocalCandidate():
+			if key, ok := hostCandidateKey(candidate); ok {
+				if _, ok := expected[key]; ok || expected == nil {
+					gathered[key] = struct{}{}
+				}
+			}
+
+		case <-co.GatheringDone():
+			if expected == nil && len(gathered) != 0 {
+				co.HostCandidateCache.set(gathered)
+			}
+			return co.wr.LocalDescription(), nil
+
+		case <-ctx.Done():
+			return nil, fmt.Errorf("terminated")
+		}
+	}
+}
+
 func (co *PeerConnection) waitGatheringDone(ctx context.Context) error {
 	for {
 		select {
@@ -437,6 +545,17 @@ func (co *PeerConnection) GatherIncomingTracks(ctx context.Context) ([]*Incoming
 	}
 }
 
+func (co *PeerConnection) onPacketSent() {
+	co.firstPacketSentOnce.Do(func() {
+		close(co.firstPacketSent)
+	})
+}
+
+// FirstPacketSent returns when the first media packet has been sent.
+func (co *PeerConnection) FirstPacketSent() <-chan struct{} {
+	return co.firstPacketSent
+}
+
 // Connected returns when connected.
 func (co *PeerConnection) Connected() <-chan struct{} {
 	return co.connected
@@ -486,3 +486,136 @@ func TestPeerConnectionFallbackCodecs(t *testing.T) {
 		},
 	}, s.MediaDescriptions)
 }
+
+func BenchmarkPeerConnectionSetup(b *testing.B) {
+	for _, ca := range []string{
+		"standard",
+		"shared resources",
+	} {
+		b.Run(ca, func(b *testing.B) {
+			var sharedResources *SharedResources
+
+			if ca == "shared resources" {
+				sharedResources = &SharedResources{}
+				err := sharedResources.Initialize()
+				require.NoError(b, err)
+			}
+
+			for i := 0; i < b.N; i++ {
+				pc1 := &PeerConnection{
+					HandshakeTimeout:   conf.StringDuration(10 * time.Second),
+					TrackGatherTimeout: conf.StringDuration(2 * time.Second),
+					LocalRandomUDP:     true,
+					IPsFromInterfaces:  true,
+					Publish:            false,
+					Log:                test.NilLogger,
+				}
+				err := pc1.Start()
+				require.NoError(b, err)
+
+				pc2 := &PeerConnection{
+					HandshakeTimeout:   conf.StringDuration(10 * time.Second),
+					TrackGatherTimeout: conf.StringDuration(2 * time.Second),
+					LocalRandomUDP:     true,
+					IPsFromInterfaces:  true,
+					Publish:            true,
+					OutgoingTracks: []*OutgoingTrack{{
+						Format: &format.H264{
+							PayloadTyp:        96,
+							PacketizationMode: 1,
+						},
+					}},
+					SharedResources: sharedResources,
+					Log:             test.NilLogger,
+				}
+				err = pc2.Start()
+				require.NoError(b, err)
+
+				offer, err := pc1.CreatePartialOffer()
+				require.NoError(b, err)
+
+				answer, err := pc2.CreateFullAnswer(context.Background(), offer)
+				require.NoError(b, err)
+
+				err = pc1.SetAnswer(answer)
+				require.NoError(b, err)
+
+				go func() {
+					for {
+						select {
+						case cnd := <-pc1.NewLocalCandidate():
+							pc2.AddRemoteCandidate(cnd) //nolint:errcheck
+
+						case <-pc1.Connected():
+							return
+						}
+					}
+				}()
+
+				err = pc1.WaitUntilConnected(context.Background())
+				require.NoError(b, err)
+
+				err = pc2.WaitUntilConnected(context.Background())
+				require.NoError(b, err)
+
+				pc1.Close()
+				pc2.Close()
+			}
+
+			b.ReportMetric(float64(b.N)/b.Elapsed().Seconds(), "sessions/s")
+		})
+	}
+}
+
+func TestOfferSupportsTrickle(t *testing.T) {
+	for _, ca := range []struct {
+		name string
+		sdp  string
+		ok   bool
+	}{
+		{
+			"session level",
+			"v=0\r\n" +
+				"o=- 0 0 IN IP4 127.0.0.1\r\n" +
+				"s=-\r\n" +
+				"t=0 0\r\n" +
+				"a=ice-options:trickle\r\n" +
+				"m=video 9 UDP/TLS/RTP/SAVPF 96\r\n" +
+				"c=IN IP4 0.0.0.0\r\n" +
+				"a=rtpmap:96 VP8/90000\r\n",
+			true,
+		},
+		{
+			"media level",
+			"v=0\r\n" +
+				"o=- 0 0 IN IP4 127.0.0.1\r\n" +
+				"s=-\r\n" +
+				"t=0 0\r\n" +
+				"m=video 9 UDP/TLS/RTP/SAVPF 96\r\n" +
+				"c=IN IP4 0.0.0.0\r\n" +
+				"a=ice-options:renomination trickle\r\n" +
+				"a=rtpmap:96 VP8/90000\r\n",
+			true,
+		},
+		{
+			"missing",
+			"v=0\r\n" +
+				"o=- 0 0 IN IP4 127.0.0.1\r\n" +
+				"s=-\r\n" +
+				"t=0 0\r\n" +
+				"m=video 9 UDP/TLS/RTP/SAVPF 96\r\n" +
+				"c=IN IP4 0.0.0.0\r\n" +
+				"a=ice-options:renomination\r\n" +
+				"a=rtpmap:96 VP8/90000\r\n",
+			false,
+		},
+	} {
+		t.Run(ca.name, func(t *testing.T) {
+			ok := offerSupportsTrickle(&webrtc.SessionDescription{
+				Type: webrtc.SDPTypeOffer,
+				SDP:  ca.sdp,
+			})
+			require.Equal(t, ca.ok, ok)
+		})
+	}
+}
@@ -0,0 +1,109 @@
+package webrtc
+
+import (
+	"crypto/ecdsa"
+	"crypto/elliptic"
+	"crypto/rand"
+	"strconv"
+	"sync"
+	"time"
+
+	"github.com/pion/webrtc/v3"
+)
+
+const (
+	// pion certificates expire after a month.
+	sharedResourcesCertificateRotationPeriod = 24 * time.Hour
+)
+
+func generateCertificate() (*webrtc.Certificate, error) {
+	sk, err := ecdsa.GenerateKey(elliptic.P256(), rand.Reader)
+	if err != nil {
+		return nil, err
+	}
+
+	return webrtc.GenerateCertificate(sk)
+}
+
+// SharedResources contains resources that are shared by peer connections,
+// in order to avoid generating them for each peer connection:
+// a DTLS certificate, that is rotated periodically,
+// and APIs, that contain setting engine, media engine and interceptor registry
+// and are copied by each peer connection.
+//
+// Peer connections that use the same SharedResources must have the same ICE settings.
+type SharedResources struct {
+	mutex              sync.Mutex
+	certificate        *webrtc.Certificate
+	certificateCreated time.Time
+	apis               map[string]*webrtc.API
+}
+
+// Initialize initializes SharedResources.
+func (r *SharedResources) Initialize() error {
+	r.apis = make(map[string]*webrtc.API)
+
+	var err error
+	r.certificate, err = generateCertificate()
+	if err != nil {
+		return err
+	}
+	r.certificateCreated = time.Now()
+
+	return nil
+}
+
+func (r *SharedResources) get(co *PeerConnection) (*webrtc.API, []webrtc.Certificate, error) {
+	key, err := co.apiKey()
+	if err != nil {
+		return nil, nil, err
+	}
+
+	r.mutex.Lock()
+	defer r.mutex.Unlock()
+
+	if time.Since(r.certificateCreated) >= sharedResourcesCertificateRotationPeriod {
+		cert, err := generateCertificate()
+		if err != nil {
+			return nil, nil, err
+		}
+
+		r.certificate = cert
+		r.certificateCreated = time.Now()
+	}
+
+	api, ok := r.apis[key]
+	if !ok {
+		api, err = co.newAPI()
+		if err != nil {
+			return nil, nil, err
+		}
+		r.apis[key] = api
+	}
+
+	return api, []webrtc.Certificate{*r.certificate}, nil
+}
+
+// apiKey returns a key that identifies the media engine of the peer connection.
+func (co *PeerConnection) apiKey() (string, error) {
+	if !co.Publish {
+		return "receive", nil
+	}
+
+	key := "publish"
+
+	for _, tr := range co.OutgoingTracks {
+		params, err := tr.codecParameters()
+		if err != nil {
+			return "", err
+		}
+
+		key += " " + params.MimeType +
+			"/" + strconv.FormatUint(uint64(params.ClockRate), 10) +
+			"/" + strconv.FormatUint(uint64(params.Channels), 10) +
+			"/" + strconv.FormatUint(uint64(params.PayloadType), 10) +
+			"/" + params.SDPFmtpLine
+	}
+
+	return key, nil
+}
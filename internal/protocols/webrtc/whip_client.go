@@ -345,11 +345,34 @@ func (c *WHIPClient) patchCandidate(
 	}
 	defer res.Body.Close()
 
-	if res.StatusCode != http.StatusNoContent {
+	switch res.StatusCode {
+	case http.StatusNoContent:
+		return nil
+
+	// the server is sending back its own candidates
+	case http.StatusOK:
+		byts, err := io.ReadAll(res.Body)
+		if err != nil {
+			return err
+		}
+
+		candidates, err := ICEFragmentUnmarshal(byts)
+		if err != nil {
+			return err
+		}
+
+		for _, candidate := range candidates {
+			err = c.pc.AddRemoteCandidate(candidate)
+			if err != nil {
+				return err
+			}
+		}
+
+		return nil
+
+	default:
 		return fmt.Errorf("bad status code: %v", res.StatusCode)
 	}
-
-	return nil
 }
 
 func (c *WHIPClient) deleteSession(
@@ -5,6 +5,7 @@ import (
 
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
 
@@ -23,6 +24,7 @@ type Agent struct {
 	SegmentDuration   time.Duration
 	PathName          string
 	Stream            *stream.Stream
+	MemoryBudget      *membudget.Budget // optional
 	OnSegmentCreate   OnSegmentCreateFunc
 	OnSegmentComplete OnSegmentCompleteFunc
 	Parent            logger.Writer
@@ -62,7 +64,7 @@ func (w *Agent) Initialize() {
 
 // Log implements logger.Writer.
 func (w *Agent) Log(level logger.Level, format string, args ...interface{}) {
-	w.Parent.Log(level, "[record] "+format, args...)
+	w.Parent.Log(level, format, logger.WithField(logger.Module("record"), args)...)
 }
 
 // Close closes the agent.
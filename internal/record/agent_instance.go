@@ -9,6 +9,7 @@ import (
 	"github.com/bluenviron/mediamtx/internal/asyncwriter"
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 )
 
 type sample struct {
@@ -66,6 +67,12 @@ func (a *agentInstance) close() {
 func (a *agentInstance) run() {
 	defer close(a.done)
 
+	protocol := "fmp4"
+	if a.agent.Format == conf.RecordFormatMPEGTS {
+		protocol = "mpegts"
+	}
+	profiler.SetGoroutineLabels(profiler.Labels{Path: a.agent.PathName, Protocol: protocol, Role: "recorder"})
+
 	a.writer.Start()
 
 	select {
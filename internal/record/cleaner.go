@@ -47,7 +47,7 @@ func (c *Cleaner) Close() {
 
 // Log implements logger.Writer.
 func (c *Cleaner) Log(level logger.Level, format string, args ...interface{}) {
-	c.Parent.Log(level, "[record cleaner]"+format, args...)
+	c.Parent.Log(level, format, logger.WithField(logger.Module("record cleaner"), args)...)
 }
 
 func (c *Cleaner) run() {
@@ -2,6 +2,7 @@ package record
 
 import (
 	"bytes"
+	"errors"
 	"fmt"
 	"time"
 
@@ -20,6 +21,7 @@ import (
 	"github.com/bluenviron/mediacommon/pkg/formats/fmp4"
 
 	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/formatprocessor"
 	"github.com/bluenviron/mediamtx/internal/logger"
 	"github.com/bluenviron/mediamtx/internal/test"
 	"github.com/bluenviron/mediamtx/internal/unit"
@@ -385,7 +387,7 @@ func (f *formatFMP4) initialize() {
 				}
 				track := addTrack(forma, codec)
 
-				var dtsExtractor *h264.DTSExtractor
+				var dtsExtractor formatprocessor.H264DTSExtractor
 
 				f.a.agent.Stream.AddReader(f.a.writer, media, forma, func(u unit.Unit) error {
 					tunit := u.(*unit.H264)
@@ -415,15 +417,16 @@ func (f *formatFMP4) initialize() {
 						}
 					}
 
-					if dtsExtractor == nil {
-						if !randomAccess {
-							return nil
-						}
-						dtsExtractor = h264.NewDTSExtractor()
+					if !randomAccess {
+						// recovery points can be used as sync samples.
+						randomAccess = formatprocessor.H264IsRandomAccess(tunit.AU)
 					}
 
 					dts, err := dtsExtractor.Extract(tunit.AU, tunit.PTS)
 					if err != nil {
+						if errors.Is(err, formatprocessor.ErrH264DTSNotReady) {
+							return nil
+						}
 						return err
 					}
 
@@ -10,6 +10,7 @@ import (
 	"github.com/bluenviron/mediacommon/pkg/formats/fmp4/seekablebuffer"
 
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 )
 
 func writePart(
@@ -46,6 +47,7 @@ type formatFMP4Part struct {
 
 	partTracks map[*formatFMP4Track]*fmp4.PartTrack
 	endDTS     time.Duration
+	size       uint64
 }
 
 func (p *formatFMP4Part) initialize() {
@@ -53,6 +55,9 @@ func (p *formatFMP4Part) initialize() {
 }
 
 func (p *formatFMP4Part) close() error {
+	// samples are released after the part is written, or when writing fails.
+	defer p.s.f.a.agent.MemoryBudget.Release(membudget.SubsystemRecorderBuffers, p.size)
+
 	if p.s.fi == nil {
 		p.s.path = Path{Start: p.s.startNTP}.Encode(p.s.f.a.pathFormat)
 		p.s.f.a.agent.Log(logger.Debug, "creating segment %s", p.s.path)
@@ -94,6 +99,10 @@ func (p *formatFMP4Part) write(track *formatFMP4Track, sample *sample) error {
 	partTrack.Samples = append(partTrack.Samples, sample.PartSample)
 	p.endDTS = sample.dts
 
+	size := uint64(len(sample.Payload))
+	p.size += size
+	p.s.f.a.agent.MemoryBudget.Acquire(membudget.SubsystemRecorderBuffers, size)
+
 	return nil
 }
 
@@ -3,18 +3,19 @@ package record
 import (
 	"bufio"
 	"bytes"
+	"errors"
 	"fmt"
 	"io"
 	"time"
 
 	rtspformat "github.com/bluenviron/gortsplib/v4/pkg/format"
 	"github.com/bluenviron/mediacommon/pkg/codecs/ac3"
-	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
 	"github.com/bluenviron/mediacommon/pkg/codecs/h265"
 	"github.com/bluenviron/mediacommon/pkg/codecs/mpeg4video"
 	"github.com/bluenviron/mediacommon/pkg/formats/mpegts"
 
 	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/formatprocessor"
 	"github.com/bluenviron/mediamtx/internal/logger"
 	"github.com/bluenviron/mediamtx/internal/unit"
 )
@@ -105,7 +106,7 @@ func (f *formatMPEGTS) initialize() {
 			case *rtspformat.H264: //nolint:dupl
 				track := addTrack(forma, &mpegts.CodecH264{})
 
-				var dtsExtractor *h264.DTSExtractor
+				var dtsExtractor formatprocessor.H264DTSExtractor
 
 				f.a.agent.Stream.AddReader(f.a.writer, media, forma, func(u unit.Unit) error {
 					tunit := u.(*unit.H264)
@@ -113,17 +114,14 @@ func (f *formatMPEGTS) initialize() {
 						return nil
 					}
 
-					randomAccess := h264.IDRPresent(tunit.AU)
-
-					if dtsExtractor == nil {
-						if !randomAccess {
-							return nil
-						}
-						dtsExtractor = h264.NewDTSExtractor()
-					}
+					// IDRs and recovery points.
+					randomAccess := formatprocessor.H264IsRandomAccess(tunit.AU)
 
 					dts, err := dtsExtractor.Extract(tunit.AU, tunit.PTS)
 					if err != nil {
+						if errors.Is(err, formatprocessor.ErrH264DTSNotReady) {
+							return nil
+						}
 						return err
 					}
 
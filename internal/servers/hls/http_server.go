@@ -202,6 +202,9 @@ func (s *httpServer) onRequest(ctx *gin.Context) {
 		ctx.Writer.WriteHeader(http.StatusOK)
 		ctx.Writer.Write(hlsIndex)
 
+	case keyFrameFileName:
+		s.handleKeyFrameRequest(ctx, dir, ctx.Request.URL.RawQuery)
+
 	default:
 		mux, err := s.parent.getMuxer(serverGetMuxerReq{
 			path:           dir,
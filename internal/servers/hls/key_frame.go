@@ -0,0 +1,308 @@
+package hls
+
+import (
+	"context"
+	"fmt"
+	"net/http"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/mediacommon/pkg/codecs/av1"
+	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
+	"github.com/bluenviron/mediacommon/pkg/codecs/h265"
+	"github.com/bluenviron/mediacommon/pkg/codecs/vp9"
+	"github.com/bluenviron/mediacommon/pkg/formats/fmp4"
+	"github.com/bluenviron/mediacommon/pkg/formats/fmp4/seekablebuffer"
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/stream"
+	"github.com/bluenviron/mediamtx/internal/unit"
+	"github.com/gin-gonic/gin"
+)
+
+const (
+	keyFrameFileName    = "keyframe.mp4"
+	keyFrameWaitTimeout = 10 * time.Second
+	keyFrameTimeScale   = 90000
+	keyFrameDuration    = keyFrameTimeScale / 30
+)
+
+func findKeyFrameFormat(desc *description.Session) (*description.Media, format.Format) {
+	var av1Format *format.AV1
+	if media := desc.FindFormat(&av1Format); media != nil {
+		return media, av1Format
+	}
+
+	var vp9Format *format.VP9
+	if media := desc.FindFormat(&vp9Format); media != nil {
+		return media, vp9Format
+	}
+
+	var h265Format *format.H265
+	if media := desc.FindFormat(&h265Format); media != nil {
+		return media, h265Format
+	}
+
+	var h264Format *format.H264
+	if media := desc.FindFormat(&h264Format); media != nil {
+		return media, h264Format
+	}
+
+	return nil, nil
+}
+
+// waitKeyFrame waits for the next key frame by using a temporary key-frame-only reader.
+func waitKeyFrame(
+	ctx context.Context,
+	strm *stream.Stream,
+	medi *description.Media,
+	forma format.Format,
+	parent logger.Writer,
+) unit.Unit {
+	writer := asyncwriter.New(8, parent)
+	keyFrame := make(chan unit.Unit, 1)
+
+	strm.SetReaderKeyFramesOnly(writer)
+	strm.AddReader(writer, medi, forma, func(u unit.Unit) error {
+		select {
+		case keyFrame <- u:
+		default:
+		}
+		return nil
+	})
+	writer.Start()
+
+	defer func() {
+		strm.RemoveReader(writer)
+		writer.Stop()
+	}()
+
+	t := time.NewTimer(keyFrameWaitTimeout)
+	defer t.Stop()
+
+	select {
+	case u := <-keyFrame:
+		return u
+	case <-t.C:
+		return nil
+	case <-ctx.Done():
+		return nil
+	}
+}
+
+// marshalKeyFrame generates a fMP4 file that contains a single key frame.
+func marshalKeyFrame(forma format.Format, u unit.Unit) ([]byte, error) {
+	var codec fmp4.Codec
+	var sample *fmp4.PartSample
+
+	switch forma := forma.(type) {
+	case *format.AV1:
+		tunit := u.(*unit.AV1)
+
+		var sequenceHeader []byte
+		for _, obu := range tunit.TU {
+			var h av1.OBUHeader
+			err := h.Unmarshal(obu)
+			if err == nil && h.Type == av1.OBUTypeSequenceHeader {
+				sequenceHeader = obu
+			}
+		}
+
+		codec = &fmp4.CodecAV1{
+			SequenceHeader: sequenceHeader,
+		}
+
+		var err error
+		sample, err = fmp4.NewPartSampleAV1(true, tunit.TU)
+		if err != nil {
+			return nil, err
+		}
+
+	case *format.VP9:
+		tunit := u.(*unit.VP9)
+
+		var h vp9.Header
+		err := h.Unmarshal(tunit.Frame)
+		if err != nil {
+			return nil, err
+		}
+
+		codec = &fmp4.CodecVP9{
+			Width:             h.Width(),
+			Height:            h.Height(),
+			Profile:           h.Profile,
+			BitDepth:          h.ColorConfig.BitDepth,
+			ChromaSubsampling: h.ChromaSubsampling(),
+			ColorRange:        h.ColorConfig.ColorRange,
+		}
+
+		sample = &fmp4.PartSample{
+			Payload: tunit.Frame,
+		}
+
+	case *format.H265:
+		tunit := u.(*unit.H265)
+
+		// parameters are prepended to key frames by the format processor.
+		var vps, sps, pps []byte
+		for _, nalu := range tunit.AU {
+			switch h265.NALUType((nalu[0] >> 1) & 0b111111) {
+			case h265.NALUType_VPS_NUT:
+				vps = nalu
+			case h265.NALUType_SPS_NUT:
+				sps = nalu
+			case h265.NALUType_PPS_NUT:
+				pps = nalu
+			}
+		}
+
+		if vps == nil || sps == nil || pps == nil {
+			vps, sps, pps = forma.SafeParams()
+		}
+
+		codec = &fmp4.CodecH265{
+			VPS: vps,
+			SPS: sps,
+			PPS: pps,
+		}
+
+		var err error
+		sample, err = fmp4.NewPartSampleH26x(0, true, tunit.AU)
+		if err != nil {
+			return nil, err
+		}
+
+	case *format.H264:
+		tunit := u.(*unit.H264)
+
+		var sps, pps []byte
+		for _, nalu := range tunit.AU {
+			switch h264.NALUType(nalu[0] & 0x1F) {
+			case h264.NALUTypeSPS:
+				sps = nalu
+			case h264.NALUTypePPS:
+				pps = nalu
+			}
+		}
+
+		if sps == nil || pps == nil {
+			sps, pps = forma.SafeParams()
+		}
+
+		codec = &fmp4.CodecH264{
+			SPS: sps,
+			PPS: pps,
+		}
+
+		var err error
+		sample, err = fmp4.NewPartSampleH26x(0, true, tunit.AU)
+		if err != nil {
+			return nil, err
+		}
+
+	default:
+		return nil, fmt.Errorf("unsupported format")
+	}
+
+	sample.Duration = keyFrameDuration
+
+	init := fmp4.Init{
+		Tracks: []*fmp4.InitTrack{{
+			ID:        1,
+			TimeScale: keyFrameTimeScale,
+			Codec:     codec,
+		}},
+	}
+
+	var buf seekablebuffer.Buffer
+	err := init.Marshal(&buf)
+	if err != nil {
+		return nil, err
+	}
+
+	part := fmp4.Part{
+		SequenceNumber: 1,
+		Tracks: []*fmp4.PartTrack{{
+			ID:      1,
+			Samples: []*fmp4.PartSample{sample},
+		}},
+	}
+
+	err = part.Marshal(&buf)
+	if err != nil {
+		return nil, err
+	}
+
+	return buf.Bytes(), nil
+}
+
+// keyFrameReader is the reader of a key frame request.
+// It doesn't need a muxer, since the key frame is taken from the stream.
+type keyFrameReader struct {
+	ctxCancel func()
+}
+
+// Close implements defs.Reader.
+func (r *keyFrameReader) Close() {
+	r.ctxCancel()
+}
+
+// APIReaderDescribe implements defs.Reader.
+func (r *keyFrameReader) APIReaderDescribe() defs.APIPathSourceOrReader {
+	return defs.APIPathSourceOrReader{
+		Type: "hlsKeyFrame",
+		ID:   "",
+	}
+}
+
+// handleKeyFrameRequest writes the last key frame of the stream as a single-frame fMP4 file.
+func (s *httpServer) handleKeyFrameRequest(ctx *gin.Context, pathName string, query string) {
+	rctx, rctxCancel := context.WithCancel(ctx.Request.Context())
+	defer rctxCancel()
+
+	r := &keyFrameReader{ctxCancel: rctxCancel}
+
+	path, strm, err := s.pathManager.AddReader(defs.PathAddReaderReq{
+		Author: r,
+		AccessRequest: defs.PathAccessRequest{
+			Name:     pathName,
+			SkipAuth: true,
+			Query:    query,
+		},
+	})
+	if err != nil {
+		ctx.Writer.WriteHeader(http.StatusNotFound)
+		return
+	}
+
+	defer path.RemoveReader(defs.PathRemoveReaderReq{Author: r})
+
+	medi, forma := findKeyFrameFormat(strm.Desc())
+	if forma == nil {
+		ctx.Writer.WriteHeader(http.StatusNotFound)
+		return
+	}
+
+	u := strm.LastKeyFrame(medi, forma)
+	if u == nil {
+		u = waitKeyFrame(rctx, strm, medi, forma, s)
+		if u == nil {
+			ctx.Writer.WriteHeader(http.StatusNotFound)
+			return
+		}
+	}
+
+	byts, err := marshalKeyFrame(forma, u)
+	if err != nil {
+		s.Log(logger.Warn, "unable to generate key frame: %v", err)
+		ctx.Writer.WriteHeader(http.StatusInternalServerError)
+		return
+	}
+
+	ctx.Writer.Header().Set("Cache-Control", "no-cache")
+	ctx.Writer.Header().Set("Content-Type", "video/mp4")
+	ctx.Writer.WriteHeader(http.StatusOK)
+	ctx.Writer.Write(byts) //nolint:errcheck
+}
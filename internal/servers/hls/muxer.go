@@ -9,9 +9,13 @@ import (
 	"sync/atomic"
 	"time"
 
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 )
 
 const (
@@ -55,6 +59,7 @@ type muxer struct {
 	directory       string
 	writeQueueSize  int
 	closeAfter      conf.StringDuration
+	memoryBudget    *membudget.Budget
 	wg              *sync.WaitGroup
 	pathName        string
 	pathManager     serverPathManager
@@ -67,6 +72,7 @@ type muxer struct {
 	path            defs.Path
 	lastRequestTime *int64
 	bytesSent       *uint64
+	queueDelay      *histogram.Histogram
 
 	// in
 	chGetInstance chan muxerGetInstanceReq
@@ -80,6 +86,8 @@ func (m *muxer) initialize() {
 	m.created = time.Now()
 	m.lastRequestTime = int64Ptr(time.Now().UnixNano())
 	m.bytesSent = new(uint64)
+	m.queueDelay = &histogram.Histogram{Buckets: asyncwriter.QueueDelayBuckets}
+	m.queueDelay.Initialize()
 	m.chGetInstance = make(chan muxerGetInstanceReq)
 
 	m.Log(logger.Info, "created %s", func() string {
@@ -99,7 +107,11 @@ func (m *muxer) Close() {
 
 // Log implements logger.Writer.
 func (m *muxer) Log(level logger.Level, format string, args ...interface{}) {
-	m.parent.Log(level, "[muxer %s] "+format, append([]interface{}{m.pathName}, args...)...)
+	m.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "path",
+		Label: "muxer",
+		Value: m.pathName,
+	}, args)...)
 }
 
 // PathName returns the path name.
@@ -110,6 +122,8 @@ func (m *muxer) PathName() string {
 func (m *muxer) run() {
 	defer m.wg.Done()
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: m.pathName, Protocol: "hls", Role: "muxer"})
+
 	err := m.runInner()
 
 	m.ctxCancel()
@@ -150,6 +164,8 @@ func (m *muxer) runInner() error {
 		pathName:        m.pathName,
 		stream:          stream,
 		bytesSent:       m.bytesSent,
+		queueDelay:      m.queueDelay,
+		memoryBudget:    m.memoryBudget,
 		parent:          m,
 	}
 	err = mi.initialize()
@@ -208,6 +224,8 @@ func (m *muxer) runInner() error {
 				pathName:        m.pathName,
 				stream:          stream,
 				bytesSent:       m.bytesSent,
+				queueDelay:      m.queueDelay,
+				memoryBudget:    m.memoryBudget,
 				parent:          m,
 			}
 			err := mi.initialize()
@@ -254,6 +272,11 @@ func (m *muxer) APIReaderDescribe() defs.APIPathSourceOrReader {
 	}
 }
 
+// APIReaderQueueDelay implements defs.ReaderWithQueueDelay.
+func (m *muxer) APIReaderQueueDelay() *defs.APIHistogram {
+	return m.queueDelay.APIDescribe()
+}
+
 func (m *muxer) apiItem() *defs.APIHLSMuxer {
 	return &defs.APIHLSMuxer{
 		Path:        m.pathName,
@@ -9,11 +9,14 @@ import (
 
 	"github.com/bluenviron/gohlslib"
 	"github.com/bluenviron/gohlslib/pkg/codecs"
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
 	"github.com/bluenviron/gortsplib/v4/pkg/format"
 	"github.com/bluenviron/mediamtx/internal/asyncwriter"
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/stream"
 	"github.com/bluenviron/mediamtx/internal/unit"
 	"github.com/gin-gonic/gin"
@@ -33,14 +36,28 @@ type muxerInstance struct {
 	pathName        string
 	stream          *stream.Stream
 	bytesSent       *uint64
+	queueDelay      *histogram.Histogram
+	memoryBudget    *membudget.Budget
 	parent          logger.Writer
 
-	writer *asyncwriter.Writer
-	hmuxer *gohlslib.Muxer
+	writer    *asyncwriter.Writer
+	hmuxer    *gohlslib.Muxer
+	retention *membudget.Retention
 }
 
 func (mi *muxerInstance) initialize() error {
 	mi.writer = asyncwriter.New(mi.writeQueueSize, mi)
+	mi.writer.SetQueueDelay(mi.queueDelay)
+
+	// segments are kept in memory when they are not written to disk.
+	if mi.memoryBudget.Max() != 0 && mi.directory == "" {
+		mi.retention = &membudget.Retention{
+			Budget:    mi.memoryBudget,
+			Subsystem: membudget.SubsystemHLSSegments,
+			Duration:  time.Duration(mi.segmentDuration) * time.Duration(mi.segmentCount+1),
+			Max:       uint64(mi.segmentMaxSize) * uint64(mi.segmentCount+1),
+		}
+	}
 
 	videoTrack := mi.createVideoTrack()
 	audioTrack := mi.createAudioTrack()
@@ -93,6 +110,30 @@ func (mi *muxerInstance) close() {
 	if mi.hmuxer.Directory != "" {
 		os.Remove(mi.hmuxer.Directory)
 	}
+	if mi.retention != nil {
+		mi.retention.Close()
+	}
+}
+
+func unitSize(u unit.Unit) uint64 {
+	n := uint64(0)
+	for _, pkt := range u.GetRTPPackets() {
+		n += uint64(len(pkt.Payload))
+	}
+	return n
+}
+
+// addReader adds a reader that accounts for bytes held by segments.
+func (mi *muxerInstance) addReader(medi *description.Media, forma format.Format, cb stream.ReadFunc) {
+	if mi.retention == nil {
+		mi.stream.AddReader(mi.writer, medi, forma, cb)
+		return
+	}
+
+	mi.stream.AddReader(mi.writer, medi, forma, func(u unit.Unit) error {
+		mi.retention.Write(unitSize(u), time.Now())
+		return cb(u)
+	})
 }
 
 func (mi *muxerInstance) createVideoTrack() *gohlslib.Track {
@@ -100,7 +141,7 @@ func (mi *muxerInstance) createVideoTrack() *gohlslib.Track {
 	videoMedia := mi.stream.Desc().FindFormat(&videoFormatAV1)
 
 	if videoFormatAV1 != nil {
-		mi.stream.AddReader(mi.writer, videoMedia, videoFormatAV1, func(u unit.Unit) error {
+		mi.addReader(videoMedia, videoFormatAV1, func(u unit.Unit) error {
 			tunit := u.(*unit.AV1)
 
 			if tunit.TU == nil {
@@ -124,7 +165,7 @@ func (mi *muxerInstance) createVideoTrack() *gohlslib.Track {
 	videoMedia = mi.stream.Desc().FindFormat(&videoFormatVP9)
 
 	if videoFormatVP9 != nil {
-		mi.stream.AddReader(mi.writer, videoMedia, videoFormatVP9, func(u unit.Unit) error {
+		mi.addReader(videoMedia, videoFormatVP9, func(u unit.Unit) error {
 			tunit := u.(*unit.VP9)
 
 			if tunit.Frame == nil {
@@ -148,7 +189,7 @@ func (mi *muxerInstance) createVideoTrack() *gohlslib.Track {
 	videoMedia = mi.stream.Desc().FindFormat(&videoFormatH265)
 
 	if videoFormatH265 != nil {
-		mi.stream.AddReader(mi.writer, videoMedia, videoFormatH265, func(u unit.Unit) error {
+		mi.addReader(videoMedia, videoFormatH265, func(u unit.Unit) error {
 			tunit := u.(*unit.H265)
 
 			if tunit.AU == nil {
@@ -178,7 +219,7 @@ func (mi *muxerInstance) createVideoTrack() *gohlslib.Track {
 	videoMedia = mi.stream.Desc().FindFormat(&videoFormatH264)
 
 	if videoFormatH264 != nil {
-		mi.stream.AddReader(mi.writer, videoMedia, videoFormatH264, func(u unit.Unit) error {
+		mi.addReader(videoMedia, videoFormatH264, func(u unit.Unit) error {
 			tunit := u.(*unit.H264)
 
 			if tunit.AU == nil {
@@ -211,7 +252,7 @@ func (mi *muxerInstance) createAudioTrack() *gohlslib.Track {
 	audioMedia := mi.stream.Desc().FindFormat(&audioFormatOpus)
 
 	if audioMedia != nil {
-		mi.stream.AddReader(mi.writer, audioMedia, audioFormatOpus, func(u unit.Unit) error {
+		mi.addReader(audioMedia, audioFormatOpus, func(u unit.Unit) error {
 			tunit := u.(*unit.Opus)
 
 			err := mi.hmuxer.WriteOpus(
@@ -236,7 +277,7 @@ func (mi *muxerInstance) createAudioTrack() *gohlslib.Track {
 	audioMedia = mi.stream.Desc().FindFormat(&audioFormatMPEG4Audio)
 
 	if audioMedia != nil {
-		mi.stream.AddReader(mi.writer, audioMedia, audioFormatMPEG4Audio, func(u unit.Unit) error {
+		mi.addReader(audioMedia, audioFormatMPEG4Audio, func(u unit.Unit) error {
 			tunit := u.(*unit.MPEG4Audio)
 
 			if tunit.AUs == nil {
@@ -11,6 +11,7 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
 
@@ -76,6 +77,7 @@ type Server struct {
 	ReadTimeout     conf.StringDuration
 	WriteQueueSize  int
 	MuxerCloseAfter conf.StringDuration
+	MemoryBudget    *membudget.Budget
 	PathManager     serverPathManager
 	Parent          serverParent
 
@@ -135,7 +137,7 @@ func (s *Server) Initialize() error {
 
 // Log implements logger.Writer.
 func (s *Server) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[HLS] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("HLS"), args)...)
 }
 
 // Close closes the server.
@@ -234,6 +236,7 @@ func (s *Server) createMuxer(pathName string, remoteAddr string, query string) *
 		parent:          s,
 		query:           query,
 		closeAfter:      s.MuxerCloseAfter,
+		memoryBudget:    s.MemoryBudget,
 	}
 	r.initialize()
 	s.muxers[pathName] = r
@@ -0,0 +1,326 @@
+package relay
+
+import (
+	"bufio"
+	"bytes"
+	"context"
+	"fmt"
+	"io"
+	"net"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
+)
+
+type pendingWrite struct {
+	f    *relay.Frame
+	done chan error
+}
+
+// conn is a connection with another server,
+// that can contain multiple sessions, one for each subscribed path.
+type conn struct {
+	parentCtx      context.Context
+	readTimeout    conf.StringDuration
+	writeTimeout   conf.StringDuration
+	writeQueueSize int
+	nconn          net.Conn
+	wg             *sync.WaitGroup
+	pathManager    serverPathManager
+	parent         *Server
+
+	ctx          context.Context
+	ctxCancel    func()
+	mutex        sync.Mutex
+	sessions     map[uint32]*session
+	writeMutex   sync.Mutex
+	writePending map[uint32][]*pendingWrite
+	writeOrder   []uint32
+	writeNotify  chan struct{}
+}
+
+func (c *conn) initialize() {
+	c.ctx, c.ctxCancel = context.WithCancel(c.parentCtx)
+
+	c.sessions = make(map[uint32]*session)
+	c.writePending = make(map[uint32][]*pendingWrite)
+	c.writeNotify = make(chan struct{}, 1)
+
+	c.Log(logger.Info, "opened")
+
+	c.wg.Add(1)
+	go c.run()
+}
+
+// Log implements logger.Writer.
+func (c *conn) Log(level logger.Level, format string, args ...interface{}) {
+	c.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "remoteAddr",
+		Label: "conn",
+		Value: c.nconn.RemoteAddr(),
+	}, args)...)
+}
+
+func (c *conn) ip() net.IP {
+	return c.nconn.RemoteAddr().(*net.TCPAddr).IP
+}
+
+func (c *conn) run() {
+	defer c.wg.Done()
+
+	err := c.runInner()
+
+	c.ctxCancel()
+
+	c.nconn.Close()
+
+	// sessions are children of the connection context and exit by themselves.
+	c.mutex.Lock()
+	c.sessions = nil
+	c.mutex.Unlock()
+
+	c.parent.closeConn(c)
+
+	c.Log(logger.Info, "closed: %v", err)
+}
+
+func (c *conn) runInner() error {
+	readErr := make(chan error)
+	go func() {
+		readErr <- c.runReader()
+	}()
+
+	writeErr := make(chan error)
+	go func() {
+		writeErr <- c.runWriter()
+	}()
+
+	select {
+	case err := <-readErr:
+		c.ctxCancel()
+		c.nconn.Close()
+		<-writeErr
+		return err
+
+	case err := <-writeErr:
+		c.nconn.Close()
+		<-readErr
+		return err
+	}
+}
+
+func (c *conn) runReader() error {
+	c.nconn.SetReadDeadline(time.Now().Add(time.Duration(c.readTimeout)))
+	br := bufio.NewReader(c.nconn)
+
+	magic := make([]byte, len(relay.Magic))
+	_, err := io.ReadFull(br, magic)
+	if err != nil {
+		return err
+	}
+
+	if !bytes.Equal(magic, relay.Magic) {
+		return fmt.Errorf("invalid magic or unsupported protocol version")
+	}
+
+	for {
+		c.nconn.SetReadDeadline(time.Now().Add(time.Duration(c.readTimeout)))
+
+		// clients send control frames only.
+		var f relay.Frame
+		err := f.Unmarshal(br, relay.MaxControlFramePayloadSize)
+		if err != nil {
+			return err
+		}
+
+		switch f.Type {
+		case relay.FrameTypeSubscribe:
+			var req relay.SubscribeRequest
+			err := req.Unmarshal(f.Payload)
+			if err != nil {
+				return err
+			}
+
+			err = c.addSession(f.Channel, req)
+			if err != nil {
+				return err
+			}
+
+		case relay.FrameTypeUnsubscribe:
+			c.mutex.Lock()
+			s, ok := c.sessions[f.Channel]
+			if ok {
+				delete(c.sessions, f.Channel)
+			}
+			c.mutex.Unlock()
+
+			if ok {
+				s.Close()
+			}
+
+		case relay.FrameTypePing:
+			err := c.writeFrame(&relay.Frame{Type: relay.FrameTypePong})
+			if err != nil {
+				return err
+			}
+
+		default:
+			return fmt.Errorf("unexpected frame type: %d", f.Type)
+		}
+	}
+}
+
+func (c *conn) addSession(channel uint32, req relay.SubscribeRequest) error {
+	c.mutex.Lock()
+	defer c.mutex.Unlock()
+
+	if c.sessions == nil {
+		return fmt.Errorf("terminated")
+	}
+
+	if _, ok := c.sessions[channel]; ok {
+		return fmt.Errorf("channel %d is already in use", channel)
+	}
+
+	s := &session{
+		parentCtx:      c.ctx,
+		writeQueueSize: c.writeQueueSize,
+		channel:        channel,
+		req:            req,
+		wg:             c.wg,
+		pathManager:    c.pathManager,
+		parent:         c,
+	}
+	s.initialize()
+	c.sessions[channel] = s
+
+	return nil
+}
+
+// closeSession is called by session.
+func (c *conn) closeSession(s *session, err error) {
+	c.mutex.Lock()
+	ok := (c.sessions != nil && c.sessions[s.channel] == s)
+	if ok {
+		delete(c.sessions, s.channel)
+	}
+	c.mutex.Unlock()
+
+	// notify the client only if the session was not closed by the client itself.
+	if ok {
+		c.writeFrame(&relay.Frame{ //nolint:errcheck
+			Type:    relay.FrameTypeError,
+			Channel: s.channel,
+			Payload: []byte(err.Error()),
+		})
+	}
+}
+
+// runWriter writes pending frames to the connection, taking one frame
+// from each channel in turn, in order to prevent a session with a high bitrate
+// from delaying frames of other sessions.
+func (c *conn) runWriter() error {
+	for {
+		select {
+		case <-c.ctx.Done():
+			c.failPendingWrites()
+			return fmt.Errorf("terminated")
+		default:
+		}
+
+		pw := c.nextPendingWrite()
+
+		if pw == nil {
+			select {
+			case <-c.writeNotify:
+				continue
+
+			case <-c.ctx.Done():
+				c.failPendingWrites()
+				return fmt.Errorf("terminated")
+			}
+		}
+
+		c.nconn.SetWriteDeadline(time.Now().Add(time.Duration(c.writeTimeout)))
+		_, err := c.nconn.Write(pw.f.Marshal())
+		pw.done <- err
+
+		if err != nil {
+			// the connection is broken, close it together with all sessions.
+			c.ctxCancel()
+			c.failPendingWrites()
+			return err
+		}
+	}
+}
+
+func (c *conn) nextPendingWrite() *pendingWrite {
+	c.writeMutex.Lock()
+	defer c.writeMutex.Unlock()
+
+	if len(c.writeOrder) == 0 {
+		return nil
+	}
+
+	channel := c.writeOrder[0]
+	c.writeOrder = c.writeOrder[1:]
+
+	queue := c.writePending[channel]
+	pw := queue[0]
+
+	if len(queue) == 1 {
+		delete(c.writePending, channel)
+	} else {
+		c.writePending[channel] = queue[1:]
+		c.writeOrder = append(c.writeOrder, channel)
+	}
+
+	return pw
+}
+
+func (c *conn) failPendingWrites() {
+	c.writeMutex.Lock()
+	defer c.writeMutex.Unlock()
+
+	for _, queue := range c.writePending {
+		for _, pw := range queue {
+			pw.done <- fmt.Errorf("terminated")
+		}
+	}
+
+	c.writePending = nil
+	c.writeOrder = nil
+}
+
+// writeFrame is called by sessions.
+func (c *conn) writeFrame(f *relay.Frame) error {
+	pw := &pendingWrite{
+		f:    f,
+		done: make(chan error, 1),
+	}
+
+	c.writeMutex.Lock()
+
+	if c.writePending == nil {
+		c.writeMutex.Unlock()
+		return fmt.Errorf("terminated")
+	}
+
+	queue, ok := c.writePending[f.Channel]
+	if !ok {
+		c.writeOrder = append(c.writeOrder, f.Channel)
+	}
+	c.writePending[f.Channel] = append(queue, pw)
+
+	c.writeMutex.Unlock()
+
+	select {
+	case c.writeNotify <- struct{}{}:
+	default:
+	}
+
+	return <-pw.done
+}
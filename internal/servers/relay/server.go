@@ -0,0 +1,148 @@
+// Package relay contains a relay server.
+package relay
+
+import (
+	"context"
+	"net"
+	"sync"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/restrictnetwork"
+	"github.com/bluenviron/mediamtx/internal/stream"
+)
+
+type serverPathManager interface {
+	AddReader(req defs.PathAddReaderReq) (defs.Path, *stream.Stream, error)
+}
+
+type serverParent interface {
+	logger.Writer
+}
+
+// Server is a relay server.
+// It allows other servers to pull streams with the relay protocol.
+type Server struct {
+	Address        string
+	ReadTimeout    conf.StringDuration
+	WriteTimeout   conf.StringDuration
+	WriteQueueSize int
+	PathManager    serverPathManager
+	Parent         serverParent
+
+	ctx       context.Context
+	ctxCancel func()
+	wg        sync.WaitGroup
+	ln        net.Listener
+	conns     map[*conn]struct{}
+
+	// in
+	chNewConn   chan net.Conn
+	chAcceptErr chan error
+	chCloseConn chan *conn
+}
+
+// Initialize initializes the server.
+func (s *Server) Initialize() error {
+	var err error
+	s.ln, err = net.Listen(restrictnetwork.Restrict("tcp", s.Address))
+	if err != nil {
+		return err
+	}
+
+	s.ctx, s.ctxCancel = context.WithCancel(context.Background())
+
+	s.conns = make(map[*conn]struct{})
+	s.chNewConn = make(chan net.Conn)
+	s.chAcceptErr = make(chan error)
+	s.chCloseConn = make(chan *conn)
+
+	s.Log(logger.Info, "listener opened on "+s.Address+" (TCP)")
+
+	l := &listener{
+		ln:     s.ln,
+		wg:     &s.wg,
+		parent: s,
+	}
+	l.initialize()
+
+	s.wg.Add(1)
+	go s.run()
+
+	return nil
+}
+
+// Log implements logger.Writer.
+func (s *Server) Log(level logger.Level, format string, args ...interface{}) {
+	s.Parent.Log(level, format, logger.WithField(logger.Module("relay"), args)...)
+}
+
+// Close closes the server.
+func (s *Server) Close() {
+	s.Log(logger.Info, "listener is closing")
+	s.ctxCancel()
+	s.wg.Wait()
+}
+
+func (s *Server) run() {
+	defer s.wg.Done()
+
+outer:
+	for {
+		select {
+		case err := <-s.chAcceptErr:
+			s.Log(logger.Error, "%s", err)
+			break outer
+
+		case nconn := <-s.chNewConn:
+			c := &conn{
+				parentCtx:      s.ctx,
+				readTimeout:    s.ReadTimeout,
+				writeTimeout:   s.WriteTimeout,
+				writeQueueSize: s.WriteQueueSize,
+				nconn:          nconn,
+				wg:             &s.wg,
+				pathManager:    s.PathManager,
+				parent:         s,
+			}
+			c.initialize()
+			s.conns[c] = struct{}{}
+
+		case c := <-s.chCloseConn:
+			delete(s.conns, c)
+
+		case <-s.ctx.Done():
+			break outer
+		}
+	}
+
+	s.ctxCancel()
+
+	s.ln.Close()
+}
+
+// newConn is called by listener.
+func (s *Server) newConn(nconn net.Conn) {
+	select {
+	case s.chNewConn <- nconn:
+	case <-s.ctx.Done():
+		nconn.Close()
+	}
+}
+
+// acceptError is called by listener.
+func (s *Server) acceptError(err error) {
+	select {
+	case s.chAcceptErr <- err:
+	case <-s.ctx.Done():
+	}
+}
+
+// closeConn is called by conn.
+func (s *Server) closeConn(c *conn) {
+	select {
+	case s.chCloseConn <- c:
+	case <-s.ctx.Done():
+	}
+}
@@ -0,0 +1,209 @@
+package relay
+
+import (
+	"context"
+	"errors"
+	"fmt"
+	"sync"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/google/uuid"
+
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/auth"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/histogram"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+// relayDescription returns a description that contains the formats that can be relayed,
+// together with the corresponding medias of the original description.
+// Generic formats are excluded, since they can't be converted back into RTP packets
+// by the receiving server.
+func relayDescription(desc *description.Session) (*description.Session, []*description.Media) {
+	ret := &description.Session{}
+	var medias []*description.Media
+
+	for _, medi := range desc.Medias {
+		var formats []format.Format
+
+		for _, forma := range medi.Formats {
+			if _, ok := forma.(*format.Generic); !ok {
+				formats = append(formats, forma)
+			}
+		}
+
+		if len(formats) != 0 {
+			ret.Medias = append(ret.Medias, &description.Media{
+				Type:    medi.Type,
+				ID:      medi.ID,
+				Control: medi.Control,
+				Formats: formats,
+			})
+			medias = append(medias, medi)
+		}
+	}
+
+	return ret, medias
+}
+
+// session is a subscription of another server to a path.
+// Each session has its own write queue, therefore a path whose units can't be sent
+// fast enough only drops its own units, without affecting the other paths of the connection.
+type session struct {
+	parentCtx      context.Context
+	writeQueueSize int
+	channel        uint32
+	req            relay.SubscribeRequest
+	wg             *sync.WaitGroup
+	pathManager    serverPathManager
+	parent         *conn
+
+	ctx        context.Context
+	ctxCancel  func()
+	uuid       uuid.UUID
+	queueDelay *histogram.Histogram
+}
+
+func (s *session) initialize() {
+	s.ctx, s.ctxCancel = context.WithCancel(s.parentCtx)
+	s.uuid = uuid.New()
+	s.queueDelay = &histogram.Histogram{Buckets: asyncwriter.QueueDelayBuckets}
+	s.queueDelay.Initialize()
+
+	s.wg.Add(1)
+	go s.run()
+}
+
+// Close closes the session.
+func (s *session) Close() {
+	s.ctxCancel()
+}
+
+// Log implements logger.Writer.
+func (s *session) Log(level logger.Level, format string, args ...interface{}) {
+	s.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "session",
+		Label: "session",
+		Value: s.channel,
+	}, args)...)
+}
+
+func (s *session) run() {
+	defer s.wg.Done()
+
+	err := s.runInner()
+
+	s.ctxCancel()
+
+	s.parent.closeSession(s, err)
+
+	s.Log(logger.Info, "closed: %v", err)
+}
+
+func (s *session) runInner() error {
+	path, stream, err := s.pathManager.AddReader(defs.PathAddReaderReq{
+		Author: s,
+		AccessRequest: defs.PathAccessRequest{
+			Name:  s.req.Path,
+			Query: s.req.Query,
+			IP:    s.parent.ip(),
+			User:  s.req.User,
+			Pass:  s.req.Pass,
+			Proto: auth.ProtocolRelay,
+			ID:    &s.uuid,
+		},
+	})
+	if err != nil {
+		var terr auth.Error
+		if errors.As(err, &terr) {
+			// wait some seconds to mitigate brute force attacks
+			select {
+			case <-time.After(auth.PauseAfterError):
+			case <-s.ctx.Done():
+			}
+			return terr
+		}
+		return err
+	}
+
+	defer path.RemoveReader(defs.PathRemoveReaderReq{Author: s})
+
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "relay", Role: "reader"})
+
+	desc, medias := relayDescription(stream.Desc())
+	if len(desc.Medias) == 0 {
+		return fmt.Errorf("the stream doesn't contain any supported codec")
+	}
+
+	sdp, err := desc.Marshal(false)
+	if err != nil {
+		return err
+	}
+
+	err = s.parent.writeFrame(&relay.Frame{
+		Type:    relay.FrameTypeDescribe,
+		Channel: s.channel,
+		Payload: sdp,
+	})
+	if err != nil {
+		return err
+	}
+
+	writer := asyncwriter.New(s.writeQueueSize, s)
+	writer.SetQueueDelay(s.queueDelay)
+
+	defer stream.RemoveReader(writer)
+
+	for i, medi := range desc.Medias {
+		for j, forma := range medi.Formats {
+			mediaIndex := i
+			formatIndex := j
+
+			stream.AddReader(writer, medias[i], forma, func(u unit.Unit) error {
+				buf, err := relay.MarshalUnit(mediaIndex, formatIndex, u)
+				if err != nil {
+					return err
+				}
+
+				return s.parent.writeFrame(&relay.Frame{
+					Type:    relay.FrameTypeUnit,
+					Channel: s.channel,
+					Payload: buf,
+				})
+			})
+		}
+	}
+
+	s.Log(logger.Info, "is reading from path '%s', %s",
+		path.Name(), defs.FormatsInfo(stream.FormatsForReader(writer)))
+
+	writer.Start()
+	defer writer.Stop()
+
+	select {
+	case <-s.ctx.Done():
+		return fmt.Errorf("terminated")
+
+	case err := <-writer.Error():
+		return err
+	}
+}
+
+// APIReaderDescribe implements reader.
+func (s *session) APIReaderDescribe() defs.APIPathSourceOrReader {
+	return defs.APIPathSourceOrReader{
+		Type: "relaySession",
+		ID:   s.uuid.String(),
+	}
+}
+
+// APIReaderQueueDelay implements defs.ReaderWithQueueDelay.
+func (s *session) APIReaderQueueDelay() *defs.APIHistogram {
+	return s.queueDelay.APIDescribe()
+}
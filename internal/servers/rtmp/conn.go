@@ -22,8 +22,10 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/hooks"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 	"github.com/bluenviron/mediamtx/internal/protocols/rtmp"
 	"github.com/bluenviron/mediamtx/internal/stream"
 	"github.com/bluenviron/mediamtx/internal/unit"
@@ -63,15 +65,16 @@ type conn struct {
 	pathManager         serverPathManager
 	parent              *Server
 
-	ctx       context.Context
-	ctxCancel func()
-	uuid      uuid.UUID
-	created   time.Time
-	mutex     sync.RWMutex
-	rconn     *rtmp.Conn
-	state     connState
-	pathName  string
-	query     string
+	ctx        context.Context
+	ctxCancel  func()
+	uuid       uuid.UUID
+	created    time.Time
+	mutex      sync.RWMutex
+	rconn      *rtmp.Conn
+	state      connState
+	pathName   string
+	query      string
+	queueDelay *histogram.Histogram
 }
 
 func (c *conn) initialize() {
@@ -79,6 +82,8 @@ func (c *conn) initialize() {
 
 	c.uuid = uuid.New()
 	c.created = time.Now()
+	c.queueDelay = &histogram.Histogram{Buckets: asyncwriter.QueueDelayBuckets}
+	c.queueDelay.Initialize()
 
 	c.Log(logger.Info, "opened")
 
@@ -96,7 +101,11 @@ func (c *conn) remoteAddr() net.Addr {
 
 // Log implements logger.Writer.
 func (c *conn) Log(level logger.Level, format string, args ...interface{}) {
-	c.parent.Log(level, "[conn %v] "+format, append([]interface{}{c.nconn.RemoteAddr()}, args...)...)
+	c.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "remoteAddr",
+		Label: "conn",
+		Value: c.nconn.RemoteAddr(),
+	}, args)...)
 }
 
 func (c *conn) ip() net.IP {
@@ -189,6 +198,8 @@ func (c *conn) runRead(conn *rtmp.Conn, u *url.URL) error {
 
 	defer path.RemoveReader(defs.PathRemoveReaderReq{Author: c})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "rtmp", Role: "reader"})
+
 	c.mutex.Lock()
 	c.state = connStateRead
 	c.pathName = pathName
@@ -196,6 +207,7 @@ func (c *conn) runRead(conn *rtmp.Conn, u *url.URL) error {
 	c.mutex.Unlock()
 
 	writer := asyncwriter.New(c.writeQueueSize, c)
+	writer.SetQueueDelay(c.queueDelay)
 
 	defer stream.RemoveReader(writer)
 
@@ -418,6 +430,8 @@ func (c *conn) runPublish(conn *rtmp.Conn, u *url.URL) error {
 
 	defer path.RemovePublisher(defs.PathRemovePublisherReq{Author: c})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "rtmp", Role: "publisher"})
+
 	c.mutex.Lock()
 	c.state = connStatePublish
 	c.pathName = pathName
@@ -581,6 +595,11 @@ func (c *conn) APIReaderDescribe() defs.APIPathSourceOrReader {
 	}
 }
 
+// APIReaderQueueDelay implements defs.ReaderWithQueueDelay.
+func (c *conn) APIReaderQueueDelay() *defs.APIHistogram {
+	return c.queueDelay.APIDescribe()
+}
+
 // APISourceDescribe implements source.
 func (c *conn) APISourceDescribe() defs.APIPathSourceOrReader {
 	return c.APIReaderDescribe()
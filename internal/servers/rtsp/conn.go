@@ -73,7 +73,11 @@ func (c *conn) initialize() {
 
 // Log implements logger.Writer.
 func (c *conn) Log(level logger.Level, format string, args ...interface{}) {
-	c.parent.Log(level, "[conn %v] "+format, append([]interface{}{c.rconn.NetConn().RemoteAddr()}, args...)...)
+	c.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "remoteAddr",
+		Label: "conn",
+		Value: c.rconn.NetConn().RemoteAddr(),
+	}, args)...)
 }
 
 // Conn returns the RTSP connection.
@@ -167,9 +171,14 @@ func (c *conn) onDescribe(ctx *gortsplib.ServerHandlerOnDescribeCtx,
 	}
 
 	var stream *gortsplib.ServerStream
-	if !c.isTLS {
+	switch {
+	case defs.ReaderKeyFramesOnly(ctx.Query) && !c.isTLS:
+		stream = res.Stream.RTSPKeyFramesStream(c.rserver)
+	case defs.ReaderKeyFramesOnly(ctx.Query):
+		stream = res.Stream.RTSPSKeyFramesStream(c.rserver)
+	case !c.isTLS:
 		stream = res.Stream.RTSPStream(c.rserver)
-	} else {
+	default:
 		stream = res.Stream.RTSPSStream(c.rserver)
 	}
 
@@ -20,6 +20,7 @@ import (
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
 	"github.com/bluenviron/mediamtx/internal/hooks"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
 
@@ -33,25 +34,25 @@ type session struct {
 	pathManager     serverPathManager
 	parent          *Server
 
-	uuid            uuid.UUID
-	created         time.Time
-	path            defs.Path
-	stream          *stream.Stream
-	onUnreadHook    func()
-	mutex           sync.Mutex
-	state           gortsplib.ServerSessionState
-	transport       *gortsplib.Transport
-	pathName        string
-	query           string
-	decodeErrLogger logger.Writer
-	writeErrLogger  logger.Writer
+	uuid           uuid.UUID
+	created        time.Time
+	path           defs.Path
+	stream         *stream.Stream
+	onUnreadHook   func()
+	mutex          sync.Mutex
+	state          gortsplib.ServerSessionState
+	transport      *gortsplib.Transport
+	pathName       string
+	query          string
+	sampler        *logger.Sampler
+	writeErrLogger logger.Writer
 }
 
 func (s *session) initialize() {
 	s.uuid = uuid.New()
 	s.created = time.Now()
 
-	s.decodeErrLogger = logger.NewLimitedLogger(s)
+	s.sampler = logger.NewSampler(s)
 	s.writeErrLogger = logger.NewLimitedLogger(s)
 
 	s.Log(logger.Info, "created by %v", s.rconn.NetConn().RemoteAddr())
@@ -69,7 +70,11 @@ func (s *session) remoteAddr() net.Addr {
 // Log implements logger.Writer.
 func (s *session) Log(level logger.Level, format string, args ...interface{}) {
 	id := hex.EncodeToString(s.uuid[:4])
-	s.parent.Log(level, "[session %s] "+format, append([]interface{}{id}, args...)...)
+	s.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "session",
+		Label: "session",
+		Value: id,
+	}, args)...)
 }
 
 // onClose is called by rtspServer.
@@ -223,9 +228,14 @@ func (s *session) onSetup(c *conn, ctx *gortsplib.ServerHandlerOnSetupCtx,
 		s.mutex.Unlock()
 
 		var rstream *gortsplib.ServerStream
-		if !s.isTLS {
+		switch {
+		case defs.ReaderKeyFramesOnly(ctx.Query) && !s.isTLS:
+			rstream = stream.RTSPKeyFramesStream(s.rserver)
+		case defs.ReaderKeyFramesOnly(ctx.Query):
+			rstream = stream.RTSPSKeyFramesStream(s.rserver)
+		case !s.isTLS:
 			rstream = stream.RTSPStream(s.rserver)
-		} else {
+		default:
 			rstream = stream.RTSPSStream(s.rserver)
 		}
 
@@ -286,6 +296,10 @@ func (s *session) onRecord(_ *gortsplib.ServerHandlerOnRecordCtx) (*base.Respons
 
 	s.stream = stream
 
+	// packets are read by goroutines of the RTSP library, that are shared by sessions
+	// or outlive them, therefore they are labeled only while packets are processed.
+	labelCtx := profiler.LabelContext(profiler.Labels{Path: s.path.Name(), Protocol: "rtsp", Role: "publisher"})
+
 	for _, medi := range s.rsession.AnnouncedDescription().Medias {
 		for _, forma := range medi.Formats {
 			cmedi := medi
@@ -297,7 +311,9 @@ func (s *session) onRecord(_ *gortsplib.ServerHandlerOnRecordCtx) (*base.Respons
 					return
 				}
 
+				profiler.SetGoroutineLabelContext(labelCtx)
 				stream.WriteRTPPacket(cmedi, cforma, pkt, time.Now(), pts)
+				profiler.ResetGoroutineLabels()
 			})
 		}
 	}
@@ -355,12 +371,12 @@ func (s *session) APISourceDescribe() defs.APIPathSourceOrReader {
 
 // onPacketLost is called by rtspServer.
 func (s *session) onPacketLost(ctx *gortsplib.ServerHandlerOnPacketLostCtx) {
-	s.decodeErrLogger.Log(logger.Warn, ctx.Error.Error())
+	s.sampler.Sample(logger.EventPacketsLost, logger.Warn, "%v", ctx.Error)
 }
 
 // onDecodeError is called by rtspServer.
 func (s *session) onDecodeError(ctx *gortsplib.ServerHandlerOnDecodeErrorCtx) {
-	s.decodeErrLogger.Log(logger.Warn, ctx.Error.Error())
+	s.sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", ctx.Error)
 }
 
 // onStreamWriteError is called by rtspServer.
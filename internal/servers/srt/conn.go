@@ -19,8 +19,10 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/hooks"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 	"github.com/bluenviron/mediamtx/internal/protocols/mpegts"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
@@ -65,15 +67,16 @@ type conn struct {
 	pathManager         serverPathManager
 	parent              *Server
 
-	ctx       context.Context
-	ctxCancel func()
-	created   time.Time
-	uuid      uuid.UUID
-	mutex     sync.RWMutex
-	state     connState
-	pathName  string
-	query     string
-	sconn     srt.Conn
+	ctx        context.Context
+	ctxCancel  func()
+	created    time.Time
+	uuid       uuid.UUID
+	mutex      sync.RWMutex
+	state      connState
+	pathName   string
+	query      string
+	sconn      srt.Conn
+	queueDelay *histogram.Histogram
 
 	chNew     chan srtNewConnReq
 	chSetConn chan srt.Conn
@@ -84,6 +87,8 @@ func (c *conn) initialize() {
 
 	c.created = time.Now()
 	c.uuid = uuid.New()
+	c.queueDelay = &histogram.Histogram{Buckets: asyncwriter.QueueDelayBuckets}
+	c.queueDelay.Initialize()
 	c.chNew = make(chan srtNewConnReq)
 	c.chSetConn = make(chan srt.Conn)
 
@@ -99,7 +104,11 @@ func (c *conn) Close() {
 
 // Log implements logger.Writer.
 func (c *conn) Log(level logger.Level, format string, args ...interface{}) {
-	c.parent.Log(level, "[conn %v] "+format, append([]interface{}{c.connReq.RemoteAddr()}, args...)...)
+	c.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "remoteAddr",
+		Label: "conn",
+		Value: c.connReq.RemoteAddr(),
+	}, args)...)
 }
 
 func (c *conn) ip() net.IP {
@@ -185,6 +194,8 @@ func (c *conn) runPublish(req srtNewConnReq, streamID *streamID) (bool, error) {
 
 	defer path.RemovePublisher(defs.PathRemovePublisherReq{Author: c})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "srt", Role: "publisher"})
+
 	err = srtCheckPassphrase(req.connReq, path.SafeConf().SRTPublishPassphrase)
 	if err != nil {
 		return false, err
@@ -226,10 +237,10 @@ func (c *conn) runPublishReader(sconn srt.Conn, path defs.Path) error {
 		return err
 	}
 
-	decodeErrLogger := logger.NewLimitedLogger(c)
+	sampler := logger.NewSampler(c)
 
 	r.OnDecodeError(func(err error) {
-		decodeErrLogger.Log(logger.Warn, err.Error())
+		sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", err)
 	})
 
 	var stream *stream.Stream
@@ -281,6 +292,8 @@ func (c *conn) runRead(req srtNewConnReq, streamID *streamID) (bool, error) {
 
 	defer path.RemoveReader(defs.PathRemoveReaderReq{Author: c})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "srt", Role: "reader"})
+
 	err = srtCheckPassphrase(req.connReq, path.SafeConf().SRTReadPassphrase)
 	if err != nil {
 		return false, err
@@ -300,6 +313,7 @@ func (c *conn) runRead(req srtNewConnReq, streamID *streamID) (bool, error) {
 	c.mutex.Unlock()
 
 	writer := asyncwriter.New(c.writeQueueSize, c)
+	writer.SetQueueDelay(c.queueDelay)
 
 	defer stream.RemoveReader(writer)
 
@@ -377,6 +391,11 @@ func (c *conn) APIReaderDescribe() defs.APIPathSourceOrReader {
 	}
 }
 
+// APIReaderQueueDelay implements defs.ReaderWithQueueDelay.
+func (c *conn) APIReaderQueueDelay() *defs.APIHistogram {
+	return c.queueDelay.APIDescribe()
+}
+
 // APISourceDescribe implements source.
 func (c *conn) APISourceDescribe() defs.APIPathSourceOrReader {
 	return c.APIReaderDescribe()
@@ -283,6 +283,14 @@ func (s *httpServer) onWHIPPatch(ctx *gin.Context, pathName string, rawSecret st
 		return
 	}
 
+	// send back local candidates that were gathered after the answer
+	if res.localCandidates != nil {
+		ctx.Writer.Header().Set("Content-Type", "application/trickle-ice-sdpfrag")
+		ctx.Writer.WriteHeader(http.StatusOK)
+		ctx.Writer.Write(res.localCandidates)
+		return
+	}
+
 	ctx.Writer.WriteHeader(http.StatusNoContent)
 }
 
@@ -24,11 +24,23 @@ import (
 	"github.com/bluenviron/mediamtx/internal/conf"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/protocols/webrtc"
 	"github.com/bluenviron/mediamtx/internal/restrictnetwork"
 	"github.com/bluenviron/mediamtx/internal/stream"
 )
 
+var sessionSetupTimeBuckets = []time.Duration{
+	100 * time.Millisecond,
+	250 * time.Millisecond,
+	500 * time.Millisecond,
+	1 * time.Second,
+	2 * time.Second,
+	5 * time.Second,
+	10 * time.Second,
+}
+
 const (
 	webrtcTurnSecretExpiration = 24 * 3600 * time.Second
 	webrtcPayloadMaxSize       = 1188 // 1200 - 12 (RTP header)
@@ -145,8 +157,9 @@ type webRTCNewSessionReq struct {
 }
 
 type webRTCAddSessionCandidatesRes struct {
-	sx  *session
-	err error
+	sx              *session
+	localCandidates []byte
+	err             error
 }
 
 type webRTCAddSessionCandidatesReq struct {
@@ -194,19 +207,23 @@ type Server struct {
 	ICEServers            []conf.WebRTCICEServer
 	HandshakeTimeout      conf.StringDuration
 	TrackGatherTimeout    conf.StringDuration
+	AudioTranscoding      bool
 	ExternalCmdPool       *externalcmd.Pool
 	PathManager           serverPathManager
 	Parent                serverParent
 
-	ctx              context.Context
-	ctxCancel        func()
-	httpServer       *httpServer
-	udpMuxLn         net.PacketConn
-	tcpMuxLn         net.Listener
-	iceUDPMux        ice.UDPMux
-	iceTCPMux        ice.TCPMux
-	sessions         map[*session]struct{}
-	sessionsBySecret map[uuid.UUID]*session
+	ctx                context.Context
+	ctxCancel          func()
+	httpServer         *httpServer
+	udpMuxLn           net.PacketConn
+	tcpMuxLn           net.Listener
+	iceUDPMux          ice.UDPMux
+	iceTCPMux          ice.TCPMux
+	hostCandidateCache *webrtc.HostCandidateCache
+	sharedResources    *webrtc.SharedResources
+	sessionSetupTimes  *histogram.Histogram
+	sessions           map[*session]struct{}
+	sessionsBySecret   map[uuid.UUID]*session
 
 	// in
 	chNewSession           chan webRTCNewSessionReq
@@ -238,6 +255,16 @@ func (s *Server) Initialize() error {
 	s.chAPIConnsKick = make(chan serverAPISessionsKickReq)
 	s.done = make(chan struct{})
 
+	s.sessionSetupTimes = &histogram.Histogram{Buckets: sessionSetupTimeBuckets}
+	s.sessionSetupTimes.Initialize()
+
+	s.sharedResources = &webrtc.SharedResources{}
+	err := s.sharedResources.Initialize()
+	if err != nil {
+		ctxCancel()
+		return err
+	}
+
 	s.httpServer = &httpServer{
 		address:        s.Address,
 		encryption:     s.Encryption,
@@ -249,7 +276,7 @@ func (s *Server) Initialize() error {
 		pathManager:    s.PathManager,
 		parent:         s,
 	}
-	err := s.httpServer.initialize()
+	err = s.httpServer.initialize()
 	if err != nil {
 		ctxCancel()
 		return err
@@ -276,6 +303,11 @@ func (s *Server) Initialize() error {
 		s.iceTCPMux = pwebrtc.NewICETCPMux(webrtcNilLogger, s.tcpMuxLn, 8)
 	}
 
+	// host candidates are static when ICE muxes are used
+	if s.iceUDPMux != nil || s.iceTCPMux != nil {
+		s.hostCandidateCache = &webrtc.HostCandidateCache{}
+	}
+
 	str := "listener opened on " + s.Address + " (HTTP)"
 	if s.udpMuxLn != nil {
 		str += ", " + s.LocalUDPAddress + " (ICE/UDP)"
@@ -292,7 +324,7 @@ func (s *Server) Initialize() error {
 
 // Log implements logger.Writer.
 func (s *Server) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[WebRTC] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("WebRTC"), args)...)
 }
 
 // Close closes the server.
@@ -319,6 +351,8 @@ outer:
 				additionalHosts:       s.AdditionalHosts,
 				iceUDPMux:             s.iceUDPMux,
 				iceTCPMux:             s.iceTCPMux,
+				hostCandidateCache:    s.hostCandidateCache,
+				sharedResources:       s.sharedResources,
 				req:                   req,
 				wg:                    &wg,
 				externalCmdPool:       s.ExternalCmdPool,
@@ -561,3 +595,8 @@ func (s *Server) APISessionsKick(uuid uuid.UUID) error {
 		return fmt.Errorf("terminated")
 	}
 }
+
+// APISessionSetupTimes is called by api.
+func (s *Server) APISessionSetupTimes() *defs.APIHistogram {
+	return s.sessionSetupTimes.APIDescribe()
+}
@@ -29,13 +29,21 @@ import (
 	"github.com/bluenviron/mediamtx/internal/auth"
 	"github.com/bluenviron/mediamtx/internal/defs"
 	"github.com/bluenviron/mediamtx/internal/externalcmd"
+	"github.com/bluenviron/mediamtx/internal/histogram"
 	"github.com/bluenviron/mediamtx/internal/hooks"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/profiler"
 	"github.com/bluenviron/mediamtx/internal/protocols/webrtc"
 	"github.com/bluenviron/mediamtx/internal/stream"
+	"github.com/bluenviron/mediamtx/internal/transcoder"
 	"github.com/bluenviron/mediamtx/internal/unit"
 )
 
+const (
+	// maximum time a PATCH request is held while waiting for the gathering of local candidates.
+	candidateGatheringTimeout = 5 * time.Second
+)
+
 var errNoSupportedCodecs = errors.New(
 	"the stream doesn't contain any supported codec, which are currently AV1, VP9, VP8, H264, Opus, G722, G711, LPCM")
 
@@ -224,9 +232,18 @@ func findVideoTrack(
 	return nil, nil
 }
 
+func newAACToOpus(forma *format.MPEG4Audio) stream.NewTranscoderFunc {
+	return func() stream.Transcoder {
+		return &transcoder.AACToOpus{
+			InputFormat: forma,
+		}
+	}
+}
+
 func findAudioTrack(
 	stream *stream.Stream,
 	writer *asyncwriter.Writer,
+	audioTranscoding bool,
 ) (format.Format, setupStreamFunc) {
 	var opusFormat *format.Opus
 	media := stream.Desc().FindFormat(&opusFormat)
@@ -383,6 +400,31 @@ func findAudioTrack(
 		}
 	}
 
+	if audioTranscoding {
+		var mpeg4AudioFormat *format.MPEG4Audio
+		media = stream.Desc().FindFormat(&mpeg4AudioFormat)
+
+		if mpeg4AudioFormat != nil {
+			outFormat := &format.Opus{
+				PayloadTyp:   96,
+				ChannelCount: 2,
+			}
+
+			return outFormat, func(track *webrtc.OutgoingTrack) error {
+				// the transcoder is shared among all WebRTC readers of the stream.
+				return stream.AddTranscodedReader(writer, media, mpeg4AudioFormat, "opus",
+					newAACToOpus(mpeg4AudioFormat),
+					func(u unit.Unit) error {
+						for _, pkt := range u.GetRTPPackets() {
+							track.WriteRTP(pkt) //nolint:errcheck
+						}
+
+						return nil
+					})
+			}
+		}
+	}
+
 	return nil, nil
 }
 
@@ -401,19 +443,22 @@ type session struct {
 	additionalHosts       []string
 	iceUDPMux             ice.UDPMux
 	iceTCPMux             ice.TCPMux
+	hostCandidateCache    *webrtc.HostCandidateCache
+	sharedResources       *webrtc.SharedResources
 	req                   webRTCNewSessionReq
 	wg                    *sync.WaitGroup
 	externalCmdPool       *externalcmd.Pool
 	pathManager           serverPathManager
 	parent                *Server
 
-	ctx       context.Context
-	ctxCancel func()
-	created   time.Time
-	uuid      uuid.UUID
-	secret    uuid.UUID
-	mutex     sync.RWMutex
-	pc        *webrtc.PeerConnection
+	ctx        context.Context
+	ctxCancel  func()
+	created    time.Time
+	uuid       uuid.UUID
+	secret     uuid.UUID
+	mutex      sync.RWMutex
+	pc         *webrtc.PeerConnection
+	queueDelay *histogram.Histogram
 
 	chNew           chan webRTCNewSessionReq
 	chAddCandidates chan webRTCAddSessionCandidatesReq
@@ -427,6 +472,8 @@ func (s *session) initialize() {
 	s.created = time.Now()
 	s.uuid = uuid.New()
 	s.secret = uuid.New()
+	s.queueDelay = &histogram.Histogram{Buckets: asyncwriter.QueueDelayBuckets}
+	s.queueDelay.Initialize()
 	s.chNew = make(chan webRTCNewSessionReq)
 	s.chAddCandidates = make(chan webRTCAddSessionCandidatesReq)
 
@@ -439,7 +486,11 @@ func (s *session) initialize() {
 // Log implements logger.Writer.
 func (s *session) Log(level logger.Level, format string, args ...interface{}) {
 	id := hex.EncodeToString(s.uuid[:4])
-	s.parent.Log(level, "[session %v] "+format, append([]interface{}{id}, args...)...)
+	s.parent.Log(level, format, logger.WithField(logger.Field{
+		Key:   "session",
+		Label: "session",
+		Value: id,
+	}, args)...)
 }
 
 func (s *session) Close() {
@@ -514,6 +565,8 @@ func (s *session) runPublish() (int, error) {
 
 	defer path.RemovePublisher(defs.PathRemovePublisherReq{Author: s})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "webrtc", Role: "publisher"})
+
 	iceServers, err := s.parent.generateICEServers(false)
 	if err != nil {
 		return http.StatusInternalServerError, err
@@ -528,6 +581,8 @@ func (s *session) runPublish() (int, error) {
 		AdditionalHosts:       s.additionalHosts,
 		ICEUDPMux:             s.iceUDPMux,
 		ICETCPMux:             s.iceTCPMux,
+		HostCandidateCache:    s.hostCandidateCache,
+		SharedResources:       s.sharedResources,
 		Publish:               false,
 		Log:                   s,
 	}
@@ -555,14 +610,14 @@ func (s *session) runPublish() (int, error) {
 		return http.StatusNotAcceptable, err
 	}
 
-	answer, err := pc.CreateFullAnswer(s.ctx, offer)
+	answer, err := pc.CreateEarlyAnswer(s.ctx, offer)
 	if err != nil {
 		return http.StatusBadRequest, err
 	}
 
 	s.writeAnswer(answer)
 
-	go s.readRemoteCandidates(pc)
+	go s.exchangeCandidates(pc, answer)
 
 	err = pc.WaitUntilConnected(s.ctx)
 	if err != nil {
@@ -655,15 +710,18 @@ func (s *session) runRead() (int, error) {
 
 	defer path.RemoveReader(defs.PathRemoveReaderReq{Author: s})
 
+	profiler.SetGoroutineLabels(profiler.Labels{Path: path.Name(), Protocol: "webrtc", Role: "reader"})
+
 	iceServers, err := s.parent.generateICEServers(false)
 	if err != nil {
 		return http.StatusInternalServerError, err
 	}
 
 	writer := asyncwriter.New(s.writeQueueSize, s)
+	writer.SetQueueDelay(s.queueDelay)
 
 	videoTrack, videoSetup := findVideoTrack(stream, writer)
-	audioTrack, audioSetup := findAudioTrack(stream, writer)
+	audioTrack, audioSetup := findAudioTrack(stream, writer, s.parent.AudioTranscoding)
 
 	if videoTrack == nil && audioTrack == nil {
 		return http.StatusBadRequest, errNoSupportedCodecs
@@ -687,6 +745,8 @@ func (s *session) runRead() (int, error) {
 		AdditionalHosts:       s.additionalHosts,
 		ICEUDPMux:             s.iceUDPMux,
 		ICETCPMux:             s.iceTCPMux,
+		HostCandidateCache:    s.hostCandidateCache,
+		SharedResources:       s.sharedResources,
 		Publish:               true,
 		OutgoingTracks:        outgoingTracks,
 		Log:                   s,
@@ -699,14 +759,14 @@ func (s *session) runRead() (int, error) {
 
 	offer := whipOffer(s.req.offer)
 
-	answer, err := pc.CreateFullAnswer(s.ctx, offer)
+	answer, err := pc.CreateEarlyAnswer(s.ctx, offer)
 	if err != nil {
 		return http.StatusBadRequest, err
 	}
 
 	s.writeAnswer(answer)
 
-	go s.readRemoteCandidates(pc)
+	go s.exchangeCandidates(pc, answer)
 
 	err = pc.WaitUntilConnected(s.ctx)
 	if err != nil {
@@ -719,6 +779,10 @@ func (s *session) runRead() (int, error) {
 
 	defer stream.RemoveReader(writer)
 
+	if defs.ReaderKeyFramesOnly(s.req.query) {
+		stream.SetReaderKeyFramesOnly(writer)
+	}
+
 	n := 0
 
 	if videoTrack != nil {
@@ -752,6 +816,14 @@ func (s *session) runRead() (int, error) {
 	writer.Start()
 	defer writer.Stop()
 
+	go func() {
+		select {
+		case <-pc.FirstPacketSent():
+			s.parent.sessionSetupTimes.Observe(time.Since(s.created))
+		case <-s.ctx.Done():
+		}
+	}()
+
 	select {
 	case <-pc.Disconnected():
 		return 0, fmt.Errorf("peer connection closed")
@@ -771,24 +843,106 @@ func (s *session) writeAnswer(answer *pwebrtc.SessionDescription) {
 	}
 }
 
-func (s *session) readRemoteCandidates(pc *webrtc.PeerConnection) {
+// exchangeCandidates adds remote candidates received through PATCH requests
+// and sends back local candidates that were gathered after the answer.
+// Since the client might not send other PATCH requests, responses are held
+// until gathering is complete or candidateGatheringTimeout has passed,
+// in order to deliver candidates that are gathered after the last request.
+func (s *session) exchangeCandidates(pc *webrtc.PeerConnection, answer *pwebrtc.SessionDescription) {
+	var localCandidates []*pwebrtc.ICECandidateInit
+	gatheringDone := pc.GatheringDone()
+	var held []webRTCAddSessionCandidatesReq
+	var holdTimer *time.Timer
+	var holdTimeout <-chan time.Time
+
+	respondHeld := func() {
+		res := s.localCandidatesRes(answer, localCandidates)
+		localCandidates = nil
+
+		for _, req := range held {
+			req.res <- res
+		}
+		held = nil
+
+		if holdTimer != nil {
+			holdTimer.Stop()
+			holdTimer = nil
+			holdTimeout = nil
+		}
+	}
+
 	for {
 		select {
+		case candidate := <-pc.NewLocalCandidate():
+			localCandidates = append(localCandidates, candidate)
+
+		case <-gatheringDone:
+			gatheringDone = nil
+			respondHeld()
+
+		case <-holdTimeout:
+			respondHeld()
+
 		case req := <-s.chAddCandidates:
-			for _, candidate := range req.candidates {
-				err := pc.AddRemoteCandidate(candidate)
-				if err != nil {
-					req.res <- webRTCAddSessionCandidatesRes{err: err}
-				}
+			err := s.addRemoteCandidates(pc, req.candidates)
+			if err != nil {
+				req.res <- webRTCAddSessionCandidatesRes{err: err}
+				continue
+			}
+
+			if gatheringDone == nil {
+				req.res <- s.localCandidatesRes(answer, localCandidates)
+				localCandidates = nil
+				continue
+			}
+
+			held = append(held, req)
+			if holdTimer == nil {
+				holdTimer = time.NewTimer(candidateGatheringTimeout)
+				holdTimeout = holdTimer.C
 			}
-			req.res <- webRTCAddSessionCandidatesRes{}
 
 		case <-s.ctx.Done():
+			for _, req := range held {
+				req.res <- webRTCAddSessionCandidatesRes{err: fmt.Errorf("terminated")}
+			}
+			if holdTimer != nil {
+				holdTimer.Stop()
+			}
 			return
 		}
 	}
 }
 
+func (s *session) addRemoteCandidates(
+	pc *webrtc.PeerConnection,
+	remoteCandidates []*pwebrtc.ICECandidateInit,
+) error {
+	for _, candidate := range remoteCandidates {
+		err := pc.AddRemoteCandidate(candidate)
+		if err != nil {
+			return err
+		}
+	}
+	return nil
+}
+
+func (s *session) localCandidatesRes(
+	answer *pwebrtc.SessionDescription,
+	localCandidates []*pwebrtc.ICECandidateInit,
+) webRTCAddSessionCandidatesRes {
+	if len(localCandidates) == 0 {
+		return webRTCAddSessionCandidatesRes{}
+	}
+
+	frag, err := webrtc.ICEFragmentMarshal(answer.SDP, localCandidates)
+	if err != nil {
+		return webRTCAddSessionCandidatesRes{err: err}
+	}
+
+	return webRTCAddSessionCandidatesRes{localCandidates: frag}
+}
+
 // new is called by webRTCHTTPServer through Server.
 func (s *session) new(req webRTCNewSessionReq) webRTCNewSessionRes {
 	select {
@@ -821,6 +975,11 @@ func (s *session) APIReaderDescribe() defs.APIPathSourceOrReader {
 	}
 }
 
+// APIReaderQueueDelay implements defs.ReaderWithQueueDelay.
+func (s *session) APIReaderQueueDelay() *defs.APIHistogram {
+	return s.queueDelay.APIDescribe()
+}
+
 // APISourceDescribe implements source.
 func (s *session) APISourceDescribe() defs.APIPathSourceOrReader {
 	return s.APIReaderDescribe()
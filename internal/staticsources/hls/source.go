@@ -26,7 +26,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[HLS source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("HLS source"), args)...)
 }
 
 // Run implements StaticSource.
@@ -39,7 +39,7 @@ func (s *Source) Run(params defs.StaticSourceRunParams) error {
 		}
 	}()
 
-	decodeErrLogger := logger.NewLimitedLogger(s)
+	sampler := logger.NewSampler(s)
 
 	tr := &http.Transport{
 		TLSClientConfig: tls.ConfigForFingerprint(params.Conf.SourceFingerprint),
@@ -66,7 +66,7 @@ func (s *Source) Run(params defs.StaticSourceRunParams) error {
 			s.Log(logger.Debug, "downloading part %v", u)
 		},
 		OnDecodeError: func(err error) {
-			decodeErrLogger.Log(logger.Warn, err.Error())
+			sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", err)
 		},
 		OnTracks: func(tracks []*gohlslib.Track) error {
 			var medias []*description.Media
@@ -0,0 +1,112 @@
+// Package relay contains the relay static source.
+package relay
+
+import (
+	"context"
+	"net/url"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+
+	"github.com/bluenviron/mediamtx/internal/conf"
+	"github.com/bluenviron/mediamtx/internal/defs"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/protocols/relay"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+// Source is a relay static source.
+// Sources that pull from the same server share the same connection.
+type Source struct {
+	ReadTimeout conf.StringDuration
+	Clients     *relay.ClientPool
+	Parent      defs.StaticSourceParent
+}
+
+// Log implements logger.Writer.
+func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
+	s.Parent.Log(level, format, logger.WithField(logger.Module("relay source"), args)...)
+}
+
+// Run implements StaticSource.
+func (s *Source) Run(params defs.StaticSourceRunParams) error {
+	s.Log(logger.Debug, "connecting")
+
+	u, err := url.Parse(params.ResolvedSource)
+	if err != nil {
+		return err
+	}
+
+	req := relay.SubscribeRequest{
+		Path:  u.Path,
+		Query: u.RawQuery,
+	}
+	if len(req.Path) != 0 {
+		req.Path = req.Path[1:]
+	}
+	if u.User != nil {
+		req.User = u.User.Username()
+		req.Pass, _ = u.User.Password()
+	}
+
+	client, err := s.Clients.Acquire(params.Context, u.Host)
+	if err != nil {
+		return err
+	}
+	defer s.Clients.Release(client)
+
+	sub, err := client.Subscribe(req)
+	if err != nil {
+		return err
+	}
+	defer sub.Close()
+
+	describeCtx, describeCtxCancel := context.WithTimeout(params.Context, time.Duration(s.ReadTimeout))
+	desc, err := sub.Describe(describeCtx)
+	describeCtxCancel()
+	if err != nil {
+		select {
+		case <-params.Context.Done():
+			return nil
+		default:
+			return err
+		}
+	}
+
+	res := s.Parent.SetReady(defs.PathSourceStaticSetReadyReq{
+		Desc:               desc,
+		GenerateRTPPackets: true,
+	})
+	if res.Err != nil {
+		return res.Err
+	}
+
+	defer s.Parent.SetNotReady(defs.PathSourceStaticSetNotReadyReq{})
+
+	stream := res.Stream
+
+	sub.OnUnit(func(medi *description.Media, forma format.Format, u unit.Unit) {
+		stream.WriteUnit(medi, forma, u)
+	})
+
+	for {
+		select {
+		case <-sub.Done():
+			return sub.Err()
+
+		case <-params.ReloadConf:
+
+		case <-params.Context.Done():
+			return nil
+		}
+	}
+}
+
+// APISourceDescribe implements StaticSource.
+func (*Source) APISourceDescribe() defs.APIPathSourceOrReader {
+	return defs.APIPathSourceOrReader{
+		Type: "relaySource",
+		ID:   "",
+	}
+}
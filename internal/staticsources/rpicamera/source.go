@@ -47,11 +47,14 @@ func paramsFromConf(logLevel conf.LogLevel, cnf *conf.Path) rpicamera.Params {
 		Gain:              cnf.RPICameraGain,
 		EV:                cnf.RPICameraEV,
 		ROI:               cnf.RPICameraROI,
+		ROITransition:     cnf.RPICameraROITransition,
 		HDR:               cnf.RPICameraHDR,
 		TuningFile:        cnf.RPICameraTuningFile,
 		Mode:              cnf.RPICameraMode,
 		FPS:               cnf.RPICameraFPS,
+		OutputFPS:         cnf.RPICameraOutputFPS,
 		IDRPeriod:         cnf.RPICameraIDRPeriod,
+		IntraRefresh:      cnf.RPICameraIntraRefresh,
 		Bitrate:           cnf.RPICameraBitrate,
 		Profile:           cnf.RPICameraProfile,
 		Level:             cnf.RPICameraLevel,
@@ -62,6 +65,7 @@ func paramsFromConf(logLevel conf.LogLevel, cnf *conf.Path) rpicamera.Params {
 		AfWindow:          cnf.RPICameraAfWindow,
 		TextOverlayEnable: cnf.RPICameraTextOverlayEnable,
 		TextOverlay:       cnf.RPICameraTextOverlay,
+		ImageOverlays:     cnf.RPICameraImageOverlays,
 	}
 }
 
@@ -73,7 +77,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[RPI Camera source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("RPI Camera source"), args)...)
 }
 
 // Run implements StaticSource.
@@ -111,8 +115,9 @@ func (s *Source) Run(params defs.StaticSourceRunParams) error {
 	}
 
 	cam := &rpicamera.RPICamera{
-		Params: paramsFromConf(s.LogLevel, params.Conf),
-		OnData: onData,
+		Params:   paramsFromConf(s.LogLevel, params.Conf),
+		OnData:   onData,
+		Detached: params.Conf.RPICameraDetached,
 	}
 	err := cam.Initialize()
 	if err != nil {
@@ -30,7 +30,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[RTMP source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("RTMP source"), args)...)
 }
 
 // Run implements StaticSource.
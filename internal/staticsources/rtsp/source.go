@@ -70,14 +70,14 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[RTSP source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("RTSP source"), args)...)
 }
 
 // Run implements StaticSource.
 func (s *Source) Run(params defs.StaticSourceRunParams) error {
 	s.Log(logger.Debug, "connecting")
 
-	decodeErrLogger := logger.NewLimitedLogger(s)
+	sampler := logger.NewSampler(s)
 
 	c := &gortsplib.Client{
 		Transport:      params.Conf.RTSPTransport.Transport,
@@ -96,10 +96,10 @@ func (s *Source) Run(params defs.StaticSourceRunParams) error {
 			s.Log(logger.Warn, err.Error())
 		},
 		OnPacketLost: func(err error) {
-			decodeErrLogger.Log(logger.Warn, err.Error())
+			sampler.Sample(logger.EventPacketsLost, logger.Warn, "%v", err)
 		},
 		OnDecodeError: func(err error) {
-			decodeErrLogger.Log(logger.Warn, err.Error())
+			sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", err)
 		},
 	}
 
@@ -23,7 +23,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[SRT source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("SRT source"), args)...)
 }
 
 // Run implements StaticSource.
@@ -74,10 +74,10 @@ func (s *Source) runReader(sconn srt.Conn) error {
 		return err
 	}
 
-	decodeErrLogger := logger.NewLimitedLogger(s)
+	sampler := logger.NewSampler(s)
 
 	r.OnDecodeError(func(err error) {
-		decodeErrLogger.Log(logger.Warn, err.Error())
+		sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", err)
 	})
 
 	var stream *stream.Stream
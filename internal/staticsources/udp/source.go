@@ -51,7 +51,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[UDP source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("UDP source"), args)...)
 }
 
 // Run implements StaticSource.
@@ -111,10 +111,10 @@ func (s *Source) runReader(pc net.PacketConn) error {
 		return err
 	}
 
-	decodeErrLogger := logger.NewLimitedLogger(s)
+	sampler := logger.NewSampler(s)
 
 	r.OnDecodeError(func(err error) {
-		decodeErrLogger.Log(logger.Warn, err.Error())
+		sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", err)
 	})
 
 	var stream *stream.Stream
@@ -25,7 +25,7 @@ type Source struct {
 
 // Log implements logger.Writer.
 func (s *Source) Log(level logger.Level, format string, args ...interface{}) {
-	s.Parent.Log(level, "[WebRTC source] "+format, args...)
+	s.Parent.Log(level, format, logger.WithField(logger.Module("WebRTC source"), args)...)
 }
 
 // Run implements StaticSource.
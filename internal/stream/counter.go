@@ -0,0 +1,24 @@
+package stream
+
+import (
+	"sync/atomic"
+)
+
+// cacheLineSize is the size of a CPU cache line on amd64 and arm64.
+const cacheLineSize = 64
+
+// counter is a byte counter that occupies a whole cache line,
+// in order not to share it with counters written by other goroutines.
+// It must be allocated on its own with new().
+type counter struct {
+	n uint64
+	_ [cacheLineSize - 8]byte
+}
+
+func (c *counter) add(v uint64) {
+	atomic.AddUint64(&c.n, v)
+}
+
+func (c *counter) load() uint64 {
+	return atomic.LoadUint64(&c.n)
+}
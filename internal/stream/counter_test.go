@@ -0,0 +1,29 @@
+package stream
+
+import (
+	"sync/atomic"
+	"testing"
+)
+
+// BenchmarkCounter compares a counter shared by all readers with per-reader counters.
+// Run it with -cpu 1,2,4,8,16,32,64 to measure scaling.
+func BenchmarkCounter(b *testing.B) {
+	b.Run("shared", func(b *testing.B) {
+		shared := new(uint64)
+
+		b.RunParallel(func(pb *testing.PB) {
+			for pb.Next() {
+				atomic.AddUint64(shared, 1316)
+			}
+		})
+	})
+
+	b.Run("per reader", func(b *testing.B) {
+		b.RunParallel(func(pb *testing.PB) {
+			c := new(counter)
+			for pb.Next() {
+				c.add(1316)
+			}
+		})
+	})
+}
@@ -0,0 +1,59 @@
+package stream
+
+import (
+	"bytes"
+
+	"github.com/bluenviron/mediacommon/pkg/codecs/av1"
+	"github.com/bluenviron/mediacommon/pkg/codecs/h265"
+	"github.com/bluenviron/mediacommon/pkg/codecs/mpeg4video"
+	"github.com/bluenviron/mediacommon/pkg/codecs/vp9"
+
+	"github.com/bluenviron/mediamtx/internal/formatprocessor"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+// IsKeyFrame returns whether a unit is a key frame (a random access point),
+// and whether the unit belongs to a video format that supports this check.
+// Units that have not been decoded are never key frames.
+func IsKeyFrame(u unit.Unit) (bool, bool) {
+	switch tunit := u.(type) {
+	case *unit.AV1:
+		for _, obu := range tunit.TU {
+			var h av1.OBUHeader
+			err := h.Unmarshal(obu)
+			if err == nil && h.Type == av1.OBUTypeSequenceHeader {
+				return true, true
+			}
+		}
+		return false, true
+
+	case *unit.VP9:
+		if tunit.Frame == nil {
+			return false, true
+		}
+		var h vp9.Header
+		err := h.Unmarshal(tunit.Frame)
+		return err == nil && !h.NonKeyFrame, true
+
+	case *unit.VP8:
+		return len(tunit.Frame) != 0 && (tunit.Frame[0]&0x01) == 0, true
+
+	case *unit.H265:
+		return tunit.AU != nil && h265.IsRandomAccess(tunit.AU), true
+
+	case *unit.H264:
+		// recovery points are random access points too.
+		return tunit.AU != nil && formatprocessor.H264IsRandomAccess(tunit.AU), true
+
+	case *unit.MPEG4Video:
+		return bytes.Contains(tunit.Frame, []byte{0, 0, 1, byte(mpeg4video.GroupOfVOPStartCode)}), true
+
+	case *unit.MPEG1Video:
+		return bytes.Contains(tunit.Frame, []byte{0, 0, 1, 0xB8}), true
+
+	case *unit.MJPEG:
+		return tunit.Frame != nil, true
+	}
+
+	return false, false
+}
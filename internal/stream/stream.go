@@ -12,7 +12,9 @@ import (
 	"github.com/pion/rtp"
 
 	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/jitterbuffer"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/unit"
 )
 
@@ -22,34 +24,48 @@ type ReadFunc func(unit.Unit) error
 // Stream is a media stream.
 // It stores tracks, readers and allows to write data to readers.
 type Stream struct {
-	desc *description.Session
-
-	bytesReceived *uint64
-	bytesSent     *uint64
-	smedias       map[*description.Media]*streamMedia
-	mutex         sync.RWMutex
-	rtspStream    *gortsplib.ServerStream
-	rtspsStream   *gortsplib.ServerStream
+	udpMaxPayloadSize int
+	desc              *description.Session
+	logger            logger.Writer
+	sampler           *logger.Sampler
+	memoryBudget      *membudget.Budget
+
+	bytesSent            *uint64 // bytes sent to removed readers
+	transcodingCPUTime   *uint64 // CPU time of closed transcoders
+	smedias              map[*description.Media]*streamMedia
+	transcodings         map[streamTranscodingKey]*streamTranscoding
+	keyFramesOnlyReaders map[*asyncwriter.Writer]struct{}
+	mutex                sync.RWMutex
+	rtspStream           *gortsplib.ServerStream
+	rtspsStream          *gortsplib.ServerStream
+	rtspKeyFramesStream  *gortsplib.ServerStream
+	rtspsKeyFramesStream *gortsplib.ServerStream
 }
 
 // New allocates a Stream.
+// Decode errors and lost packets are sampled before being written to parent.
 func New(
 	udpMaxPayloadSize int,
 	desc *description.Session,
 	generateRTPPackets bool,
-	decodeErrLogger logger.Writer,
+	parent logger.Writer,
 ) (*Stream, error) {
 	s := &Stream{
-		desc:          desc,
-		bytesReceived: new(uint64),
-		bytesSent:     new(uint64),
+		udpMaxPayloadSize:    udpMaxPayloadSize,
+		desc:                 desc,
+		logger:               parent,
+		sampler:              logger.NewSampler(parent),
+		bytesSent:            new(uint64),
+		transcodingCPUTime:   new(uint64),
+		transcodings:         make(map[streamTranscodingKey]*streamTranscoding),
+		keyFramesOnlyReaders: make(map[*asyncwriter.Writer]struct{}),
 	}
 
 	s.smedias = make(map[*description.Media]*streamMedia)
 
 	for _, media := range desc.Medias {
 		var err error
-		s.smedias[media], err = newStreamMedia(udpMaxPayloadSize, media, generateRTPPackets, decodeErrLogger)
+		s.smedias[media], err = newStreamMedia(udpMaxPayloadSize, media, generateRTPPackets, s.sampler)
 		if err != nil {
 			return nil, err
 		}
@@ -58,14 +74,91 @@ func New(
 	return s, nil
 }
 
+// EnableJitterBuffer enables a jitter buffer for every format,
+// that reorders RTP packets passed to WriteRTPPacket().
+// It must be called before writing to the stream.
+func (s *Stream) EnableJitterBuffer(minDelay time.Duration, maxDelay time.Duration) {
+	for _, sm := range s.smedias {
+		for forma, sf := range sm.formats {
+			sf.enableJitterBuffer(forma, minDelay, maxDelay)
+		}
+	}
+}
+
+// SetMemoryBudget sets a memory budget that accounts for bytes held by reader queues
+// and by the key frame cache, and that degrades new readers to key frames only when exceeded.
+// The budget is ignored when it has no limit, in order to avoid accounting costs.
+// It must be called before writing to the stream.
+func (s *Stream) SetMemoryBudget(b *membudget.Budget) {
+	if b.Max() == 0 {
+		return
+	}
+	s.memoryBudget = b
+}
+
+// JitterBufferStats returns statistics of jitter buffers,
+// or nil if jitter buffers are not enabled.
+// Counters are summed, while the reorder depth and the delay are the maximum among formats.
+func (s *Stream) JitterBufferStats() *jitterbuffer.Stats {
+	var ret *jitterbuffer.Stats
+
+	for _, sm := range s.smedias {
+		for _, sf := range sm.formats {
+			if sf.jitterBuffer == nil {
+				continue
+			}
+
+			if ret == nil {
+				ret = &jitterbuffer.Stats{}
+			}
+
+			stats := sf.jitterBuffer.Stats()
+			ret.PacketsReordered += stats.PacketsReordered
+			ret.PacketsLate += stats.PacketsLate
+			ret.PacketsDuplicate += stats.PacketsDuplicate
+			ret.PacketsLost += stats.PacketsLost
+			if stats.ReorderDepth > ret.ReorderDepth {
+				ret.ReorderDepth = stats.ReorderDepth
+			}
+			if stats.Delay > ret.Delay {
+				ret.Delay = stats.Delay
+			}
+		}
+	}
+
+	return ret
+}
+
 // Close closes all resources of the stream.
 func (s *Stream) Close() {
+	s.mutex.Lock()
+	transcodings := s.transcodings
+	s.transcodings = make(map[streamTranscodingKey]*streamTranscoding)
+	s.mutex.Unlock()
+
+	for _, st := range transcodings {
+		s.closeTranscoding(st)
+	}
+
+	for _, sm := range s.smedias {
+		for _, sf := range sm.formats {
+			sf.closeJitterBuffer()
+			sf.releaseLastKeyFrame(s)
+		}
+	}
+
 	if s.rtspStream != nil {
 		s.rtspStream.Close()
 	}
 	if s.rtspsStream != nil {
 		s.rtspsStream.Close()
 	}
+	if s.rtspKeyFramesStream != nil {
+		s.rtspKeyFramesStream.Close()
+	}
+	if s.rtspsKeyFramesStream != nil {
+		s.rtspsKeyFramesStream.Close()
+	}
 }
 
 // Desc returns the description of the stream.
@@ -75,7 +168,13 @@ func (s *Stream) Desc() *description.Session {
 
 // BytesReceived returns received bytes.
 func (s *Stream) BytesReceived() uint64 {
-	return atomic.LoadUint64(s.bytesReceived)
+	bytesReceived := uint64(0)
+	for _, sm := range s.smedias {
+		for _, sf := range sm.formats {
+			bytesReceived += sf.bytesReceived.load()
+		}
+	}
+	return bytesReceived
 }
 
 // BytesSent returns sent bytes.
@@ -84,15 +183,41 @@ func (s *Stream) BytesSent() uint64 {
 	defer s.mutex.RUnlock()
 
 	bytesSent := atomic.LoadUint64(s.bytesSent)
+	for _, sm := range s.smedias {
+		for _, sf := range sm.formats {
+			bytesSent += sf.bytesSent()
+		}
+	}
+	for _, st := range s.transcodings {
+		bytesSent += st.bytesSent()
+	}
 	if s.rtspStream != nil {
 		bytesSent += s.rtspStream.BytesSent()
 	}
 	if s.rtspsStream != nil {
 		bytesSent += s.rtspsStream.BytesSent()
 	}
+	if s.rtspKeyFramesStream != nil {
+		bytesSent += s.rtspKeyFramesStream.BytesSent()
+	}
+	if s.rtspsKeyFramesStream != nil {
+		bytesSent += s.rtspsKeyFramesStream.BytesSent()
+	}
 	return bytesSent
 }
 
+// TranscodingCPUTime returns the CPU time consumed by transcoders.
+func (s *Stream) TranscodingCPUTime() time.Duration {
+	s.mutex.RLock()
+	defer s.mutex.RUnlock()
+
+	cpuTime := time.Duration(atomic.LoadUint64(s.transcodingCPUTime))
+	for _, st := range s.transcodings {
+		cpuTime += st.transcoder.CPUTime()
+	}
+	return cpuTime
+}
+
 // RTSPStream returns the RTSP stream.
 func (s *Stream) RTSPStream(server *gortsplib.Server) *gortsplib.ServerStream {
 	s.mutex.Lock()
@@ -115,26 +240,185 @@ func (s *Stream) RTSPSStream(server *gortsplib.Server) *gortsplib.ServerStream {
 	return s.rtspsStream
 }
 
+// RTSPKeyFramesStream returns the RTSP stream that contains key frames only.
+func (s *Stream) RTSPKeyFramesStream(server *gortsplib.Server) *gortsplib.ServerStream {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+
+	if s.rtspKeyFramesStream == nil {
+		s.rtspKeyFramesStream = gortsplib.NewServerStream(server, s.desc)
+	}
+	return s.rtspKeyFramesStream
+}
+
+// RTSPSKeyFramesStream returns the RTSPS stream that contains key frames only.
+func (s *Stream) RTSPSKeyFramesStream(server *gortsplib.Server) *gortsplib.ServerStream {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+
+	if s.rtspsKeyFramesStream == nil {
+		s.rtspsKeyFramesStream = gortsplib.NewServerStream(server, s.desc)
+	}
+	return s.rtspsKeyFramesStream
+}
+
+// SetReaderKeyFramesOnly makes a reader receive only key frames of video formats.
+// Non-key video units are discarded before entering the reader queue,
+// while units of other formats are left untouched.
+// It must be called before AddReader().
+func (s *Stream) SetReaderKeyFramesOnly(r *asyncwriter.Writer) {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+
+	s.keyFramesOnlyReaders[r] = struct{}{}
+}
+
+// LastKeyFrame returns the last key frame of a video format.
+// Key frames are cached only after this has been called and until it is not called for a while,
+// therefore it returns nil when the cache was unused, and the caller has to wait for the next key frame.
+func (s *Stream) LastKeyFrame(medi *description.Media, forma format.Format) unit.Unit {
+	sm := s.smedias[medi]
+	sf := sm.formats[forma]
+	return sf.getLastKeyFrame()
+}
+
 // AddReader adds a reader.
 func (s *Stream) AddReader(r *asyncwriter.Writer, medi *description.Media, forma format.Format, cb ReadFunc) {
 	s.mutex.Lock()
 	defer s.mutex.Unlock()
 
+	s.admitReader(r)
+
 	sm := s.smedias[medi]
 	sf := sm.formats[forma]
 	sf.addReader(r, cb)
 }
 
+// AddTranscodedReader adds a reader of the output of a transcoder.
+// Readers that use the same input format and transcoder name share a single transcoder,
+// that is started when the first reader is added and closed when the last one is removed.
+func (s *Stream) AddTranscodedReader(
+	r *asyncwriter.Writer,
+	medi *description.Media,
+	forma format.Format,
+	name string,
+	newTranscoder NewTranscoderFunc,
+	cb ReadFunc,
+) error {
+	s.mutex.Lock()
+	defer s.mutex.Unlock()
+
+	key := streamTranscodingKey{medi: medi, forma: forma, name: name}
+
+	st, ok := s.transcodings[key]
+	if !ok {
+		st = &streamTranscoding{
+			transcoder: newTranscoder(),
+		}
+		err := st.initialize(s)
+		if err != nil {
+			return err
+		}
+
+		sm := s.smedias[medi]
+		sf := sm.formats[forma]
+		sf.addReader(st.writer, st.transcode(s))
+
+		s.transcodings[key] = st
+	}
+
+	s.admitReader(r)
+
+	st.readers[r] = &streamReader{
+		cb:        cb,
+		bytesSent: new(counter),
+	}
+
+	return nil
+}
+
+func (s *Stream) hasReader(r *asyncwriter.Writer) bool {
+	for _, sm := range s.smedias {
+		for _, sf := range sm.formats {
+			if _, ok := sf.readers[r]; ok {
+				return true
+			}
+		}
+	}
+
+	for _, st := range s.transcodings {
+		if _, ok := st.readers[r]; ok {
+			return true
+		}
+	}
+
+	return false
+}
+
+// admitReader applies the memory budget to a reader, when it is added for the first time.
+func (s *Stream) admitReader(r *asyncwriter.Writer) {
+	if s.memoryBudget == nil || s.hasReader(r) {
+		return
+	}
+
+	r.SetMemoryBudget(s.memoryBudget)
+
+	if s.memoryBudget.DegradeReader() {
+		s.logger.Log(logger.Warn, "memory budget exceeded, reader will receive key frames only")
+		s.keyFramesOnlyReaders[r] = struct{}{}
+	}
+}
+
 // RemoveReader removes a reader.
 func (s *Stream) RemoveReader(r *asyncwriter.Writer) {
+	for _, st := range s.removeReader(r) {
+		s.closeTranscoding(st)
+	}
+}
+
+// removeReader removes a reader and returns transcodings that are not used anymore.
+func (s *Stream) removeReader(r *asyncwriter.Writer) []*streamTranscoding {
 	s.mutex.Lock()
 	defer s.mutex.Unlock()
 
+	delete(s.keyFramesOnlyReaders, r)
+
 	for _, sm := range s.smedias {
 		for _, sf := range sm.formats {
-			sf.removeReader(r)
+			sf.removeReader(s, r)
+		}
+	}
+
+	var unused []*streamTranscoding
+
+	for key, st := range s.transcodings {
+		sr, ok := st.readers[r]
+		if !ok {
+			continue
+		}
+
+		// keep bytes sent to removed readers.
+		atomic.AddUint64(s.bytesSent, sr.bytesSent.load())
+		delete(st.readers, r)
+
+		if len(st.readers) == 0 {
+			sm := s.smedias[key.medi]
+			sf := sm.formats[key.forma]
+			sf.removeReader(s, st.writer)
+
+			delete(s.transcodings, key)
+			unused = append(unused, st)
 		}
 	}
+
+	return unused
+}
+
+// closeTranscoding is called without holding the mutex,
+// since transcodings write their output while holding it.
+func (s *Stream) closeTranscoding(st *streamTranscoding) {
+	st.close()
+	atomic.AddUint64(s.transcodingCPUTime, uint64(st.transcoder.CPUTime()))
 }
 
 // FormatsForReader returns all formats that a reader is reading.
@@ -152,6 +436,12 @@ func (s *Stream) FormatsForReader(r *asyncwriter.Writer) []format.Format {
 		}
 	}
 
+	for _, st := range s.transcodings {
+		if _, ok := st.readers[r]; ok {
+			formats = append(formats, st.transcoder.Format())
+		}
+	}
+
 	return formats
 }
 
@@ -1,19 +1,28 @@
 package stream
 
 import (
+	"sync"
 	"sync/atomic"
 	"time"
 
+	"github.com/bluenviron/gortsplib/v4"
 	"github.com/bluenviron/gortsplib/v4/pkg/description"
 	"github.com/bluenviron/gortsplib/v4/pkg/format"
 	"github.com/pion/rtp"
 
 	"github.com/bluenviron/mediamtx/internal/asyncwriter"
 	"github.com/bluenviron/mediamtx/internal/formatprocessor"
+	"github.com/bluenviron/mediamtx/internal/jitterbuffer"
 	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/membudget"
 	"github.com/bluenviron/mediamtx/internal/unit"
 )
 
+const (
+	// the key frame cache is emptied when it is not used for this duration.
+	keyFrameCacheTimeout = 30 * time.Second
+)
+
 func unitSize(u unit.Unit) uint64 {
 	n := uint64(0)
 	for _, pkt := range u.GetRTPPackets() {
@@ -22,17 +31,78 @@ func unitSize(u unit.Unit) uint64 {
 	return n
 }
 
+func writeRTSPStream(rs *gortsplib.ServerStream, medi *description.Media, pkts []*rtp.Packet, ntp time.Time) {
+	for _, pkt := range pkts {
+		rs.WritePacketRTPWithNTP(medi, pkt, ntp) //nolint:errcheck
+	}
+}
+
+// seqNumRewriter assigns consecutive sequence numbers to packets of a stream
+// that skips some units, in order not to make readers detect packet losses.
+type seqNumRewriter struct {
+	initialized bool
+	next        uint16
+}
+
+func (r *seqNumRewriter) rewrite(pkts []*rtp.Packet) []*rtp.Packet {
+	ret := make([]*rtp.Packet, len(pkts))
+
+	for i, pkt := range pkts {
+		if !r.initialized {
+			r.initialized = true
+			r.next = pkt.SequenceNumber
+		}
+
+		// packets are shared with other readers and can't be modified.
+		cpkt := *pkt
+		cpkt.SequenceNumber = r.next
+		r.next++
+		ret[i] = &cpkt
+	}
+
+	return ret
+}
+
+// streamReader is a reader of a format.
+// Each reader counts sent bytes by itself, since a counter shared by all readers
+// would be written by all reader goroutines at once.
+type streamReader struct {
+	cb        ReadFunc
+	bytesSent *counter
+}
+
 type streamFormat struct {
-	decodeErrLogger logger.Writer
-	proc            formatprocessor.Processor
-	readers         map[*asyncwriter.Writer]ReadFunc
+	sampler       *logger.Sampler
+	codecField    logger.Field
+	proc          formatprocessor.Processor
+	readers       map[*asyncwriter.Writer]*streamReader
+	bytesReceived *counter
+
+	keyFramesSeqNums seqNumRewriter
+
+	// the key frame cache is filled only after getLastKeyFrame() has been called,
+	// since detecting and storing key frames has a cost.
+	// keyFrameCacheLastUse is the time of the last call in Unix nanoseconds, or zero when the cache is unused.
+	keyFrameCacheLastUse *int64
+	lastKeyFrameMutex    sync.Mutex
+	lastKeyFrame         unit.Unit
+	lastKeyFrameSize     uint64
+
+	// optional. The mutex serializes packets released by writeRTPPacket() and by the timer.
+	jitterBuffer      *jitterbuffer.JitterBuffer
+	jitterBufferMutex sync.Mutex
+	jitterBufferTimer *time.Timer
+	jitterBufferDone  bool
+
+	// set when RTP packets are lost, until the next key frame.
+	waitingKeyFrame bool
 }
 
 func newStreamFormat(
 	udpMaxPayloadSize int,
 	forma format.Format,
 	generateRTPPackets bool,
-	decodeErrLogger logger.Writer,
+	sampler *logger.Sampler,
 ) (*streamFormat, error) {
 	proc, err := formatprocessor.New(udpMaxPayloadSize, forma, generateRTPPackets)
 	if err != nil {
@@ -40,32 +110,124 @@ func newStreamFormat(
 	}
 
 	sf := &streamFormat{
-		decodeErrLogger: decodeErrLogger,
-		proc:            proc,
-		readers:         make(map[*asyncwriter.Writer]ReadFunc),
+		sampler: sampler,
+		codecField: logger.Field{
+			Key:   "codec",
+			Value: forma.Codec(),
+		},
+		proc:                 proc,
+		readers:              make(map[*asyncwriter.Writer]*streamReader),
+		bytesReceived:        new(counter),
+		keyFrameCacheLastUse: new(int64),
 	}
 
 	return sf, nil
 }
 
 func (sf *streamFormat) addReader(r *asyncwriter.Writer, cb ReadFunc) {
-	sf.readers[r] = cb
+	sf.readers[r] = &streamReader{
+		cb:        cb,
+		bytesSent: new(counter),
+	}
 }
 
-func (sf *streamFormat) removeReader(r *asyncwriter.Writer) {
+func (sf *streamFormat) removeReader(s *Stream, r *asyncwriter.Writer) {
+	sr, ok := sf.readers[r]
+	if !ok {
+		return
+	}
+
+	// keep bytes sent to removed readers.
+	atomic.AddUint64(s.bytesSent, sr.bytesSent.load())
+
 	delete(sf.readers, r)
 }
 
+// bytesSent returns bytes sent to current readers.
+func (sf *streamFormat) bytesSent() uint64 {
+	n := uint64(0)
+	for _, sr := range sf.readers {
+		n += sr.bytesSent.load()
+	}
+	return n
+}
+
+func (sf *streamFormat) keyFrameCacheUsed() bool {
+	return atomic.LoadInt64(sf.keyFrameCacheLastUse) != 0
+}
+
+// getLastKeyFrame returns the last key frame,
+// or nil when the cache was unused, since its content might be outdated.
+func (sf *streamFormat) getLastKeyFrame() unit.Unit {
+	if atomic.SwapInt64(sf.keyFrameCacheLastUse, time.Now().UnixNano()) == 0 {
+		return nil
+	}
+
+	sf.lastKeyFrameMutex.Lock()
+	defer sf.lastKeyFrameMutex.Unlock()
+	return sf.lastKeyFrame
+}
+
+func (sf *streamFormat) setLastKeyFrame(s *Stream, u unit.Unit, size uint64) {
+	// empty the cache when it is not used anymore.
+	lastUse := atomic.LoadInt64(sf.keyFrameCacheLastUse)
+	if time.Since(time.Unix(0, lastUse)) >= keyFrameCacheTimeout &&
+		atomic.CompareAndSwapInt64(sf.keyFrameCacheLastUse, lastUse, 0) {
+		u = nil
+		size = 0
+	}
+
+	sf.lastKeyFrameMutex.Lock()
+	defer sf.lastKeyFrameMutex.Unlock()
+
+	s.memoryBudget.Acquire(membudget.SubsystemKeyFrameCache, size)
+	s.memoryBudget.Release(membudget.SubsystemKeyFrameCache, sf.lastKeyFrameSize)
+
+	sf.lastKeyFrame = u
+	sf.lastKeyFrameSize = size
+}
+
+func (sf *streamFormat) releaseLastKeyFrame(s *Stream) {
+	sf.lastKeyFrameMutex.Lock()
+	defer sf.lastKeyFrameMutex.Unlock()
+
+	s.memoryBudget.Release(membudget.SubsystemKeyFrameCache, sf.lastKeyFrameSize)
+	sf.lastKeyFrameSize = 0
+}
+
 func (sf *streamFormat) writeUnit(s *Stream, medi *description.Media, u unit.Unit) {
 	err := sf.proc.ProcessUnit(u)
 	if err != nil {
-		sf.decodeErrLogger.Log(logger.Warn, err.Error())
+		sf.sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", sf.codecField, err)
 		return
 	}
 
 	sf.writeUnitInner(s, medi, u)
 }
 
+func (sf *streamFormat) enableJitterBuffer(forma format.Format, minDelay time.Duration, maxDelay time.Duration) {
+	sf.jitterBuffer = &jitterbuffer.JitterBuffer{
+		ClockRate: forma.ClockRate(),
+		MinDelay:  minDelay,
+		MaxDelay:  maxDelay,
+	}
+	sf.jitterBuffer.Initialize()
+}
+
+func (sf *streamFormat) closeJitterBuffer() {
+	if sf.jitterBuffer == nil {
+		return
+	}
+
+	sf.jitterBufferMutex.Lock()
+	defer sf.jitterBufferMutex.Unlock()
+
+	sf.jitterBufferDone = true
+	if sf.jitterBufferTimer != nil {
+		sf.jitterBufferTimer.Stop()
+	}
+}
+
 func (sf *streamFormat) writeRTPPacket(
 	s *Stream,
 	medi *description.Media,
@@ -73,11 +235,88 @@ func (sf *streamFormat) writeRTPPacket(
 	ntp time.Time,
 	pts time.Duration,
 ) {
-	hasNonRTSPReaders := len(sf.readers) > 0
+	if sf.jitterBuffer != nil {
+		sf.jitterBufferMutex.Lock()
+		defer sf.jitterBufferMutex.Unlock()
+
+		for _, e := range sf.jitterBuffer.Push(jitterbuffer.Entry{Packet: pkt, NTP: ntp, PTS: pts}, time.Now()) {
+			sf.processRTPPacket(s, medi, e.Packet, e.NTP, e.PTS, e.AfterLoss)
+		}
+
+		sf.scheduleJitterBufferExpiration(s, medi)
+		return
+	}
+
+	sf.processRTPPacket(s, medi, pkt, ntp, pts, false)
+}
+
+// scheduleJitterBufferExpiration releases packets that are waiting for missing ones
+// even when no other packets are written.
+func (sf *streamFormat) scheduleJitterBufferExpiration(s *Stream, medi *description.Media) {
+	if sf.jitterBufferTimer != nil {
+		sf.jitterBufferTimer.Stop()
+		sf.jitterBufferTimer = nil
+	}
+
+	deadline, ok := sf.jitterBuffer.Deadline()
+	if !ok {
+		return
+	}
+
+	sf.jitterBufferTimer = time.AfterFunc(time.Until(deadline), func() {
+		s.mutex.RLock()
+		defer s.mutex.RUnlock()
+
+		sf.jitterBufferMutex.Lock()
+		defer sf.jitterBufferMutex.Unlock()
+
+		if sf.jitterBufferDone {
+			return
+		}
+
+		lostBefore := sf.jitterBuffer.Stats().PacketsLost
+
+		for _, e := range sf.jitterBuffer.Expire(time.Now()) {
+			sf.processRTPPacket(s, medi, e.Packet, e.NTP, e.PTS, e.AfterLoss)
+		}
+
+		if lost := sf.jitterBuffer.Stats().PacketsLost - lostBefore; lost != 0 {
+			sf.sampler.Sample(logger.EventPacketsLost, logger.Warn, "%d RTP %s lost", sf.codecField, lost, func() string {
+				if lost == 1 {
+					return "packet"
+				}
+				return "packets"
+			}())
+		}
+
+		sf.scheduleJitterBufferExpiration(s, medi)
+	})
+}
+
+func (sf *streamFormat) processRTPPacket(
+	s *Stream,
+	medi *description.Media,
+	pkt *rtp.Packet,
+	ntp time.Time,
+	pts time.Duration,
+	afterLoss bool,
+) {
+	if afterLoss {
+		// the unit that is being decoded misses some packets, and following units
+		// may depend on missing data: discard them until the next key frame.
+		sf.proc.ResetDecoder()
+		sf.waitingKeyFrame = true
+	}
+
+	// key frames can only be detected in decoded units.
+	hasNonRTSPReaders := len(sf.readers) > 0 ||
+		s.rtspKeyFramesStream != nil ||
+		s.rtspsKeyFramesStream != nil ||
+		sf.keyFrameCacheUsed()
 
 	u, err := sf.proc.ProcessRTPPacket(pkt, ntp, pts, hasNonRTSPReaders)
 	if err != nil {
-		sf.decodeErrLogger.Log(logger.Warn, err.Error())
+		sf.sampler.Sample(logger.EventDecodeError, logger.Warn, "%v", sf.codecField, err)
 		return
 	}
 
@@ -87,25 +326,66 @@ func (sf *streamFormat) writeRTPPacket(
 func (sf *streamFormat) writeUnitInner(s *Stream, medi *description.Media, u unit.Unit) {
 	size := unitSize(u)
 
-	atomic.AddUint64(s.bytesReceived, size)
+	sf.bytesReceived.add(size)
+
+	keyFrameCacheUsed := sf.keyFrameCacheUsed()
+
+	// key frames are detected only when someone needs them.
+	var keyFrame, isVideo bool
+	if keyFrameCacheUsed ||
+		sf.waitingKeyFrame ||
+		len(s.keyFramesOnlyReaders) != 0 ||
+		s.rtspKeyFramesStream != nil ||
+		s.rtspsKeyFramesStream != nil {
+		keyFrame, isVideo = IsKeyFrame(u)
+	}
+	skipKeyFramesOnly := isVideo && !keyFrame
+
+	if sf.waitingKeyFrame && !skipKeyFramesOnly {
+		sf.waitingKeyFrame = false
+	}
+
+	if keyFrame && keyFrameCacheUsed {
+		sf.setLastKeyFrame(s, u, size)
+	}
 
 	if s.rtspStream != nil {
-		for _, pkt := range u.GetRTPPackets() {
-			s.rtspStream.WritePacketRTPWithNTP(medi, pkt, u.GetNTP()) //nolint:errcheck
-		}
+		writeRTSPStream(s.rtspStream, medi, u.GetRTPPackets(), u.GetNTP())
 	}
 
 	if s.rtspsStream != nil {
-		for _, pkt := range u.GetRTPPackets() {
-			s.rtspsStream.WritePacketRTPWithNTP(medi, pkt, u.GetNTP()) //nolint:errcheck
+		writeRTSPStream(s.rtspsStream, medi, u.GetRTPPackets(), u.GetNTP())
+	}
+
+	// units that follow a loss are discarded until the next key frame.
+	// RTSP readers receive packets as they are, and see the gap in sequence numbers.
+	if sf.waitingKeyFrame {
+		return
+	}
+
+	if (s.rtspKeyFramesStream != nil || s.rtspsKeyFramesStream != nil) && !skipKeyFramesOnly {
+		pkts := sf.keyFramesSeqNums.rewrite(u.GetRTPPackets())
+
+		if s.rtspKeyFramesStream != nil {
+			writeRTSPStream(s.rtspKeyFramesStream, medi, pkts, u.GetNTP())
+		}
+
+		if s.rtspsKeyFramesStream != nil {
+			writeRTSPStream(s.rtspsKeyFramesStream, medi, pkts, u.GetNTP())
 		}
 	}
 
-	for writer, cb := range sf.readers {
-		ccb := cb
-		writer.Push(func() error {
-			atomic.AddUint64(s.bytesSent, size)
-			return ccb(u)
+	for writer, sr := range sf.readers {
+		if skipKeyFramesOnly {
+			if _, ok := s.keyFramesOnlyReaders[writer]; ok {
+				continue
+			}
+		}
+
+		csr := sr
+		writer.PushSized(size, func() error {
+			csr.bytesSent.add(size)
+			return csr.cb(u)
 		})
 	}
 }
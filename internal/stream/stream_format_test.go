@@ -0,0 +1,33 @@
+package stream
+
+import (
+	"testing"
+
+	"github.com/pion/rtp"
+	"github.com/stretchr/testify/require"
+)
+
+func TestSeqNumRewriter(t *testing.T) {
+	var r seqNumRewriter
+
+	// the first unit is written, the second one is skipped.
+	in1 := []*rtp.Packet{
+		{Header: rtp.Header{SequenceNumber: 65534}},
+		{Header: rtp.Header{SequenceNumber: 65535}},
+	}
+	in3 := []*rtp.Packet{
+		{Header: rtp.Header{SequenceNumber: 5}},
+	}
+
+	var out []uint16
+	for _, pkts := range [][]*rtp.Packet{in1, in3} {
+		for _, pkt := range r.rewrite(pkts) {
+			out = append(out, pkt.SequenceNumber)
+		}
+	}
+
+	require.Equal(t, []uint16{65534, 65535, 0}, out)
+
+	// original packets are left untouched.
+	require.Equal(t, uint16(5), in3[0].SequenceNumber)
+}
@@ -0,0 +1,300 @@
+package stream_test
+
+import (
+	"fmt"
+	"testing"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+	"github.com/bluenviron/mediacommon/pkg/codecs/h264"
+	"github.com/pion/rtp"
+	"github.com/stretchr/testify/require"
+
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/membudget"
+	"github.com/bluenviron/mediamtx/internal/stream"
+	"github.com/bluenviron/mediamtx/internal/test"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+func TestKeyFramesOnlyReader(t *testing.T) {
+	desc := &description.Session{Medias: []*description.Media{{
+		Type:    description.MediaTypeVideo,
+		Formats: []format.Format{test.FormatH264},
+	}}}
+
+	strm, err := stream.New(1460, desc, true, test.NilLogger)
+	require.NoError(t, err)
+	defer strm.Close()
+
+	writer := asyncwriter.New(64, test.NilLogger)
+	recv := make(chan time.Duration, 10)
+
+	strm.SetReaderKeyFramesOnly(writer)
+	strm.AddReader(writer, desc.Medias[0], test.FormatH264, func(u unit.Unit) error {
+		recv <- u.GetPTS()
+		return nil
+	})
+	writer.Start()
+	defer writer.Stop()
+	defer strm.RemoveReader(writer)
+
+	// the key frame cache is filled only after it has been used once.
+	require.Nil(t, strm.LastKeyFrame(desc.Medias[0], test.FormatH264))
+
+	for i, typ := range []h264.NALUType{h264.NALUTypeIDR, h264.NALUTypeNonIDR, h264.NALUTypeNonIDR, h264.NALUTypeIDR} {
+		strm.WriteUnit(desc.Medias[0], test.FormatH264, &unit.H264{
+			Base: unit.Base{
+				PTS: time.Duration(i) * time.Second,
+			},
+			AU: [][]byte{{byte(typ), 1, 2, 3}},
+		})
+	}
+
+	require.Equal(t, 0*time.Second, <-recv)
+	require.Equal(t, 3*time.Second, <-recv)
+
+	lastKeyFrame := strm.LastKeyFrame(desc.Medias[0], test.FormatH264)
+	require.Equal(t, 3*time.Second, lastKeyFrame.GetPTS())
+}
+
+func TestJitterBufferLoss(t *testing.T) {
+	desc := &description.Session{Medias: []*description.Media{{
+		Type:    description.MediaTypeVideo,
+		Formats: []format.Format{test.FormatH264},
+	}}}
+
+	strm, err := stream.New(1460, desc, false, test.NilLogger)
+	require.NoError(t, err)
+	strm.EnableJitterBuffer(50*time.Millisecond, 200*time.Millisecond)
+	defer strm.Close()
+
+	writer := asyncwriter.New(64, test.NilLogger)
+	recv := make(chan time.Duration, 10)
+
+	strm.AddReader(writer, desc.Medias[0], test.FormatH264, func(u unit.Unit) error {
+		if u.(*unit.H264).AU != nil {
+			recv <- u.GetPTS()
+		}
+		return nil
+	})
+	writer.Start()
+	defer writer.Stop()
+	defer strm.RemoveReader(writer)
+
+	// packet 101 is lost.
+	for _, ca := range []struct {
+		seq uint16
+		typ h264.NALUType
+	}{
+		{100, h264.NALUTypeIDR},
+		{102, h264.NALUTypeNonIDR},
+		{103, h264.NALUTypeIDR},
+		{104, h264.NALUTypeNonIDR},
+	} {
+		strm.WriteRTPPacket(desc.Medias[0], test.FormatH264, &rtp.Packet{
+			Header: rtp.Header{
+				Version:        2,
+				Marker:         true,
+				PayloadType:    96,
+				SequenceNumber: ca.seq,
+				Timestamp:      uint32(ca.seq-100) * 90000,
+			},
+			Payload: []byte{byte(ca.typ), 1, 2, 3},
+		}, time.Time{}, time.Duration(ca.seq-100)*time.Second)
+	}
+
+	require.Equal(t, 0*time.Second, <-recv)
+
+	// packets that follow the loss are released by the timer,
+	// and units are discarded until the next key frame.
+	select {
+	case pts := <-recv:
+		require.Equal(t, 3*time.Second, pts)
+	case <-time.After(2 * time.Second):
+		t.Errorf("packets have not been released")
+	}
+
+	require.Equal(t, 4*time.Second, <-recv)
+
+	require.Equal(t, uint64(1), strm.JitterBufferStats().PacketsLost)
+}
+
+func TestMemoryBudgetReaderQueues(t *testing.T) {
+	desc := &description.Session{Medias: []*description.Media{{
+		Type:    description.MediaTypeVideo,
+		Formats: []format.Format{test.FormatH264},
+	}}}
+
+	budget := &membudget.Budget{}
+	budget.Initialize()
+	budget.SetLimit(1024*1024*1024, false)
+
+	strm, err := stream.New(1460, desc, true, test.NilLogger)
+	require.NoError(t, err)
+	strm.SetMemoryBudget(budget)
+	defer strm.Close()
+
+	writeUnit := func() {
+		strm.WriteUnit(desc.Medias[0], test.FormatH264, &unit.H264{
+			AU: [][]byte{{byte(h264.NALUTypeIDR), 1, 2, 3}},
+		})
+	}
+
+	for i := 0; i < 100; i++ {
+		writer := asyncwriter.New(64, test.NilLogger)
+		strm.AddReader(writer, desc.Medias[0], test.FormatH264, func(_ unit.Unit) error {
+			return nil
+		})
+		writer.Start()
+
+		writeUnit()
+
+		// readers stop their writer before removing themselves from the stream,
+		// therefore units can be pushed into stopped writers.
+		writer.Stop()
+		writeUnit()
+		strm.RemoveReader(writer)
+	}
+
+	require.Equal(t, uint64(0), budget.Used(membudget.SubsystemReaderQueues))
+}
+
+func BenchmarkWriteUnit(b *testing.B) {
+	desc := &description.Session{Medias: []*description.Media{{
+		Type:    description.MediaTypeVideo,
+		Formats: []format.Format{test.FormatH264},
+	}}}
+
+	for _, readerCount := range []int{1, 10, 100} {
+		for _, limit := range []uint64{0, 1024 * 1024 * 1024} {
+			b.Run(fmt.Sprintf("readers=%d,budget=%d", readerCount, limit), func(b *testing.B) {
+				budget := &membudget.Budget{}
+				budget.Initialize()
+				budget.SetLimit(limit, false)
+
+				strm, err := stream.New(1460, desc, true, test.NilLogger)
+				require.NoError(b, err)
+				strm.SetMemoryBudget(budget)
+				defer strm.Close()
+
+				for i := 0; i < readerCount; i++ {
+					writer := asyncwriter.New(4096, test.NilLogger)
+					strm.AddReader(writer, desc.Medias[0], test.FormatH264, func(_ unit.Unit) error {
+						return nil
+					})
+					writer.Start()
+					defer strm.RemoveReader(writer)
+					defer writer.Stop()
+				}
+
+				b.ReportAllocs()
+				b.ResetTimer()
+
+				for i := 0; i < b.N; i++ {
+					strm.WriteUnit(desc.Medias[0], test.FormatH264, &unit.H264{
+						Base: unit.Base{
+							PTS: time.Duration(i) * time.Millisecond,
+						},
+						AU: [][]byte{{byte(h264.NALUTypeNonIDR), 1, 2, 3}},
+					})
+				}
+			})
+		}
+	}
+}
+
+type dummyTranscoder struct {
+	closed chan struct{}
+}
+
+func (t *dummyTranscoder) Initialize() error {
+	return nil
+}
+
+func (t *dummyTranscoder) Close() {
+	close(t.closed)
+}
+
+func (t *dummyTranscoder) Format() format.Format {
+	return &format.Opus{
+		PayloadTyp:   96,
+		ChannelCount: 2,
+	}
+}
+
+func (t *dummyTranscoder) Transcode(u unit.Unit) (unit.Unit, error) {
+	return &unit.Opus{
+		Base: unit.Base{
+			PTS: u.GetPTS(),
+		},
+		Packets: [][]byte{{1, 2, 3}},
+	}, nil
+}
+
+func (t *dummyTranscoder) CPUTime() time.Duration {
+	return time.Second
+}
+
+func TestTranscodedReaders(t *testing.T) {
+	desc := &description.Session{Medias: []*description.Media{{
+		Type:    description.MediaTypeAudio,
+		Formats: []format.Format{test.FormatMPEG4Audio},
+	}}}
+
+	strm, err := stream.New(1460, desc, true, test.NilLogger)
+	require.NoError(t, err)
+	defer strm.Close()
+
+	created := 0
+	tr := &dummyTranscoder{closed: make(chan struct{})}
+	newTranscoder := func() stream.Transcoder {
+		created++
+		return tr
+	}
+
+	var writers []*asyncwriter.Writer
+	recv := make(chan time.Duration, 10)
+
+	for i := 0; i < 2; i++ {
+		writer := asyncwriter.New(64, test.NilLogger)
+		err = strm.AddTranscodedReader(writer, desc.Medias[0], test.FormatMPEG4Audio, "opus", newTranscoder,
+			func(u unit.Unit) error {
+				require.Len(t, u.GetRTPPackets(), 1)
+				recv <- u.GetPTS()
+				return nil
+			})
+		require.NoError(t, err)
+		writer.Start()
+		defer writer.Stop()
+		writers = append(writers, writer)
+	}
+
+	// readers of the same transcoding share a single transcoder.
+	require.Equal(t, 1, created)
+	require.Equal(t, "Opus", strm.FormatsForReader(writers[0])[0].Codec())
+
+	strm.WriteUnit(desc.Medias[0], test.FormatMPEG4Audio, &unit.MPEG4Audio{
+		Base: unit.Base{
+			PTS: 2 * time.Second,
+		},
+		AUs: [][]byte{{1, 2}},
+	})
+
+	require.Equal(t, 2*time.Second, <-recv)
+	require.Equal(t, 2*time.Second, <-recv)
+
+	strm.RemoveReader(writers[0])
+
+	select {
+	case <-tr.closed:
+		t.Errorf("transcoder closed while in use")
+	default:
+	}
+
+	strm.RemoveReader(writers[1])
+	<-tr.closed
+
+	require.Equal(t, time.Second, strm.TranscodingCPUTime())
+}
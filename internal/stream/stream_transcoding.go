@@ -0,0 +1,135 @@
+package stream
+
+import (
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/description"
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+
+	"github.com/bluenviron/mediamtx/internal/asyncwriter"
+	"github.com/bluenviron/mediamtx/internal/formatprocessor"
+	"github.com/bluenviron/mediamtx/internal/logger"
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+const (
+	transcodingQueueSize = 512
+
+	// key of sampled transcoding errors.
+	eventTranscodingError = "transcodingError"
+)
+
+// Transcoder converts units of a format into units of another format.
+type Transcoder interface {
+	// Initialize initializes the transcoder.
+	Initialize() error
+
+	// Close closes the transcoder.
+	Close()
+
+	// Format returns the output format.
+	Format() format.Format
+
+	// Transcode converts a unit.
+	// It returns nil when the unit doesn't produce any output yet.
+	Transcode(unit.Unit) (unit.Unit, error)
+
+	// CPUTime returns the CPU time consumed by the transcoder.
+	CPUTime() time.Duration
+}
+
+// NewTranscoderFunc allocates a Transcoder.
+type NewTranscoderFunc func() Transcoder
+
+type streamTranscodingKey struct {
+	medi  *description.Media
+	forma format.Format
+	name  string
+}
+
+// streamTranscoding is a transcoder shared by all readers of its output.
+// It reads the input format like any other reader,
+// and transcodes units in the goroutine of its own writer.
+type streamTranscoding struct {
+	transcoder Transcoder
+	proc       formatprocessor.Processor
+	writer     *asyncwriter.Writer
+	readers    map[*asyncwriter.Writer]*streamReader
+}
+
+func (st *streamTranscoding) initialize(s *Stream) error {
+	err := st.transcoder.Initialize()
+	if err != nil {
+		return err
+	}
+
+	// generate RTP packets, in order to count output bytes like the ones of other formats.
+	st.proc, err = formatprocessor.New(s.udpMaxPayloadSize, st.transcoder.Format(), true)
+	if err != nil {
+		st.transcoder.Close()
+		return err
+	}
+
+	st.readers = make(map[*asyncwriter.Writer]*streamReader)
+
+	st.writer = asyncwriter.New(transcodingQueueSize, s.logger)
+	if s.memoryBudget != nil {
+		st.writer.SetMemoryBudget(s.memoryBudget)
+	}
+	st.writer.Start()
+
+	return nil
+}
+
+func (st *streamTranscoding) close() {
+	// stop the writer first, in order to stop calls to Transcode().
+	st.writer.Stop()
+	st.transcoder.Close()
+}
+
+func (st *streamTranscoding) transcode(s *Stream) ReadFunc {
+	return func(u unit.Unit) error {
+		out, err := st.transcoder.Transcode(u)
+		if err != nil {
+			s.sampler.Sample(eventTranscodingError, logger.Warn, "transcoding error: %v", err)
+			return nil
+		}
+
+		if out == nil {
+			return nil
+		}
+
+		err = st.proc.ProcessUnit(out)
+		if err != nil {
+			s.sampler.Sample(eventTranscodingError, logger.Warn, "transcoding error: %v", err)
+			return nil
+		}
+
+		st.writeUnit(s, out)
+		return nil
+	}
+}
+
+func (st *streamTranscoding) writeUnit(s *Stream, u unit.Unit) {
+	size := unitSize(u)
+
+	s.mutex.RLock()
+	defer s.mutex.RUnlock()
+
+	for writer, sr := range st.readers {
+		csr := sr
+		writer.PushSized(size, func() error {
+			csr.bytesSent.add(size)
+			return csr.cb(u)
+		})
+	}
+}
+
+// bytesSent returns bytes sent to current readers.
+func (st *streamTranscoding) bytesSent() uint64 {
+	n := uint64(0)
+	for _, sr := range st.readers {
+		n += sr.bytesSent.load()
+	}
+	return n
+}
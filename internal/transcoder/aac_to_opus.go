@@ -0,0 +1,189 @@
+// Package transcoder contains stream transcoders.
+package transcoder
+
+import (
+	"fmt"
+	"sync/atomic"
+	"time"
+
+	"github.com/bluenviron/gortsplib/v4/pkg/format"
+
+	"github.com/bluenviron/mediamtx/internal/unit"
+)
+
+const (
+	opusSampleRate = 48000
+
+	// duration of Opus frames, in samples (20ms).
+	opusFrameSize = 960
+
+	// the transcoder is synchronized again when the timestamp of an input unit
+	// differs from the one computed from previous units by more than this.
+	maxTimestampDrift = 500 * time.Millisecond
+)
+
+func samplesToDuration(n int64, sampleRate int) time.Duration {
+	rate := int64(sampleRate)
+	return time.Duration(n/rate)*time.Second + time.Duration(n%rate)*time.Second/time.Duration(rate)
+}
+
+// AACToOpus is a transcoder that converts MPEG-4 Audio into stereo Opus.
+//
+// Decoding and encoding are performed in-process by libfdk-aac and libopus,
+// that are available only when the server is compiled with the "transcoding" build tag.
+type AACToOpus struct {
+	InputFormat *format.MPEG4Audio
+
+	outFormat *format.Opus
+	decoder   *aacDecoder
+	encoder   *opusEncoder
+	converter pcmConverter
+	cpuTime   *uint64
+
+	// timestamps of output frames are computed by counting samples,
+	// starting from the timestamp of the first input unit.
+	synced       bool
+	inBasePTS    time.Duration
+	inSampleRate int
+	inSamples    int64
+	outBasePTS   time.Duration
+	outBaseNTP   time.Time
+	outSamples   int64
+}
+
+// Initialize implements stream.Transcoder.
+func (t *AACToOpus) Initialize() error {
+	config := t.InputFormat.GetConfig()
+	if config == nil {
+		return fmt.Errorf("MPEG-4 Audio configuration is missing")
+	}
+
+	var err error
+	t.decoder, err = newAACDecoder(config)
+	if err != nil {
+		return err
+	}
+
+	t.encoder, err = newOpusEncoder(opusSampleRate)
+	if err != nil {
+		t.decoder.close()
+		return err
+	}
+
+	t.outFormat = &format.Opus{
+		PayloadTyp:   96,
+		ChannelCount: 2,
+	}
+
+	t.converter = pcmConverter{
+		outSampleRate: opusSampleRate,
+		frameSize:     opusFrameSize,
+	}
+
+	t.cpuTime = new(uint64)
+
+	return nil
+}
+
+// Close implements stream.Transcoder.
+func (t *AACToOpus) Close() {
+	t.encoder.close()
+	t.decoder.close()
+}
+
+// Format implements stream.Transcoder.
+func (t *AACToOpus) Format() format.Format {
+	return t.outFormat
+}
+
+// CPUTime implements stream.Transcoder.
+func (t *AACToOpus) CPUTime() time.Duration {
+	return time.Duration(atomic.LoadUint64(t.cpuTime))
+}
+
+// Transcode implements stream.Transcoder.
+func (t *AACToOpus) Transcode(u unit.Unit) (unit.Unit, error) {
+	tunit := u.(*unit.MPEG4Audio)
+
+	if tunit.AUs == nil {
+		return nil, nil
+	}
+
+	defer func() {
+		atomic.StoreUint64(t.cpuTime, uint64(t.decoder.cpuTime+t.encoder.cpuTime))
+	}()
+
+	t.sync(tunit)
+
+	outPTS := t.outBasePTS + samplesToDuration(t.outSamples, opusSampleRate)
+	outNTP := t.outBaseNTP.Add(samplesToDuration(t.outSamples, opusSampleRate))
+
+	var packets [][]byte
+
+	for _, au := range tunit.AUs {
+		samples, sampleRate, channelCount, err := t.decoder.decode(au)
+		if err != nil {
+			return nil, err
+		}
+
+		if sampleRate != t.inSampleRate {
+			if t.inSampleRate != 0 {
+				t.inBasePTS += samplesToDuration(t.inSamples, t.inSampleRate)
+			}
+			t.inSampleRate = sampleRate
+			t.inSamples = 0
+		}
+
+		t.inSamples += int64(len(samples) / channelCount)
+
+		err = t.converter.convert(samples, sampleRate, channelCount, func(frame []int16) error {
+			packet, err2 := t.encoder.encode(frame, opusFrameSize)
+			if err2 != nil {
+				return err2
+			}
+
+			packets = append(packets, packet)
+			t.outSamples += opusFrameSize
+			return nil
+		})
+		if err != nil {
+			return nil, err
+		}
+	}
+
+	if packets == nil {
+		return nil, nil
+	}
+
+	return &unit.Opus{
+		Base: unit.Base{
+			NTP: outNTP,
+			PTS: outPTS,
+		},
+		Packets: packets,
+	}, nil
+}
+
+// sync sets the base timestamps with the first unit,
+// and sets them again when the input is discontinuous.
+func (t *AACToOpus) sync(tunit *unit.MPEG4Audio) {
+	if t.synced {
+		expected := t.inBasePTS
+		if t.inSampleRate != 0 {
+			expected += samplesToDuration(t.inSamples, t.inSampleRate)
+		}
+
+		drift := tunit.PTS - expected
+		if drift <= maxTimestampDrift && drift >= -maxTimestampDrift {
+			return
+		}
+	}
+
+	t.synced = true
+	t.inBasePTS = tunit.PTS
+	t.inSamples = 0
+	t.outBasePTS = tunit.PTS
+	t.outBaseNTP = tunit.NTP
+	t.outSamples = 0
+	t.converter.reset()
+}
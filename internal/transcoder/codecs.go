@@ -0,0 +1,190 @@
+//go:build transcoding
+// +build transcoding
+
+package transcoder
+
+/*
+#cgo pkg-config: fdk-aac opus
+
+#include <stdint.h>
+#include <time.h>
+
+#include <fdk-aac/aacdecoder_lib.h>
+#include <opus.h>
+
+static int64_t thread_cpu_time(void) {
+	struct timespec ts;
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static AAC_DECODER_ERROR aac_decoder_config(HANDLE_AACDECODER dec, UCHAR *conf, UINT conf_len) {
+	UCHAR *confs[1] = {conf};
+	UINT lens[1] = {conf_len};
+	AAC_DECODER_ERROR err = aacDecoder_ConfigRaw(dec, confs, lens);
+	if (err != AAC_DEC_OK) {
+		return err;
+	}
+
+	// let the decoder downmix multichannel audio.
+	return aacDecoder_SetParam(dec, AAC_PCM_MAX_OUTPUT_CHANNELS, 2);
+}
+
+static AAC_DECODER_ERROR aac_decoder_decode(HANDLE_AACDECODER dec, UCHAR *au, UINT au_len,
+	INT_PCM *out, INT out_len, int64_t *cpu_time) {
+	int64_t start = thread_cpu_time();
+
+	UCHAR *bufs[1] = {au};
+	UINT lens[1] = {au_len};
+	UINT valid = au_len;
+	AAC_DECODER_ERROR err = aacDecoder_Fill(dec, bufs, lens, &valid);
+	if (err == AAC_DEC_OK) {
+		err = aacDecoder_DecodeFrame(dec, out, out_len, 0);
+	}
+
+	*cpu_time += thread_cpu_time() - start;
+	return err;
+}
+
+static int opus_encoder_set_bitrate(OpusEncoder *enc, opus_int32 bitrate) {
+	return opus_encoder_ctl(enc, OPUS_SET_BITRATE(bitrate));
+}
+
+static opus_int32 opus_encoder_encode(OpusEncoder *enc, const opus_int16 *pcm, int frame_size,
+	unsigned char *out, opus_int32 out_len, int64_t *cpu_time) {
+	int64_t start = thread_cpu_time();
+	opus_int32 n = opus_encode(enc, pcm, frame_size, out, out_len);
+	*cpu_time += thread_cpu_time() - start;
+	return n;
+}
+*/
+import "C"
+
+import (
+	"fmt"
+	"time"
+	"unsafe"
+
+	"github.com/bluenviron/mediacommon/pkg/codecs/mpeg4audio"
+)
+
+const (
+	// maximum number of decoded samples of an access unit (2048 samples with SBR, 8 channels).
+	aacMaxDecodedSamples = 2048 * 8
+
+	opusBitrate = 64000
+
+	// maximum size of an encoded Opus packet, as recommended by libopus.
+	opusMaxPacketSize = 4000
+)
+
+type aacDecoder struct {
+	handle  C.HANDLE_AACDECODER
+	out     []int16
+	cpuTime time.Duration
+}
+
+func newAACDecoder(config *mpeg4audio.Config) (*aacDecoder, error) {
+	buf, err := config.Marshal()
+	if err != nil {
+		return nil, err
+	}
+
+	d := &aacDecoder{
+		out: make([]int16, aacMaxDecodedSamples),
+	}
+
+	d.handle = C.aacDecoder_Open(C.TT_MP4_RAW, 1)
+	if d.handle == nil {
+		return nil, fmt.Errorf("aacDecoder_Open() failed")
+	}
+
+	res := C.aac_decoder_config(d.handle, (*C.UCHAR)(unsafe.Pointer(&buf[0])), C.UINT(len(buf)))
+	if res != C.AAC_DEC_OK {
+		C.aacDecoder_Close(d.handle)
+		return nil, fmt.Errorf("unable to configure the AAC decoder: error 0x%x", int(res))
+	}
+
+	return d, nil
+}
+
+func (d *aacDecoder) close() {
+	C.aacDecoder_Close(d.handle)
+}
+
+// decode decodes an access unit into interleaved samples.
+// The returned slice is reused by next calls.
+func (d *aacDecoder) decode(au []byte) ([]int16, int, int, error) {
+	if len(au) == 0 {
+		return nil, 0, 0, fmt.Errorf("access unit is empty")
+	}
+
+	var cpuTime C.int64_t
+
+	res := C.aac_decoder_decode(d.handle,
+		(*C.UCHAR)(unsafe.Pointer(&au[0])), C.UINT(len(au)),
+		(*C.INT_PCM)(unsafe.Pointer(&d.out[0])), C.INT(len(d.out)),
+		&cpuTime)
+	d.cpuTime += time.Duration(cpuTime)
+
+	if res != C.AAC_DEC_OK {
+		return nil, 0, 0, fmt.Errorf("unable to decode AAC: error 0x%x", int(res))
+	}
+
+	info := C.aacDecoder_GetStreamInfo(d.handle)
+	if info == nil || info.sampleRate <= 0 || info.numChannels <= 0 {
+		return nil, 0, 0, fmt.Errorf("unable to get AAC stream info")
+	}
+
+	n := int(info.frameSize) * int(info.numChannels)
+	return d.out[:n], int(info.sampleRate), int(info.numChannels), nil
+}
+
+type opusEncoder struct {
+	enc     *C.OpusEncoder
+	out     []byte
+	cpuTime time.Duration
+}
+
+func newOpusEncoder(sampleRate int) (*opusEncoder, error) {
+	e := &opusEncoder{
+		out: make([]byte, opusMaxPacketSize),
+	}
+
+	var res C.int
+	e.enc = C.opus_encoder_create(C.opus_int32(sampleRate), 2, C.OPUS_APPLICATION_AUDIO, &res)
+	if res != C.OPUS_OK {
+		return nil, fmt.Errorf("opus_encoder_create() failed: %s", C.GoString(C.opus_strerror(res)))
+	}
+
+	res = C.opus_encoder_set_bitrate(e.enc, opusBitrate)
+	if res != C.OPUS_OK {
+		C.opus_encoder_destroy(e.enc)
+		return nil, fmt.Errorf("unable to set the Opus bitrate: %s", C.GoString(C.opus_strerror(res)))
+	}
+
+	return e, nil
+}
+
+func (e *opusEncoder) close() {
+	C.opus_encoder_destroy(e.enc)
+}
+
+// encode encodes a frame of interleaved stereo samples into an Opus packet.
+func (e *opusEncoder) encode(samples []int16, frameSize int) ([]byte, error) {
+	var cpuTime C.int64_t
+
+	n := C.opus_encoder_encode(e.enc,
+		(*C.opus_int16)(unsafe.Pointer(&samples[0])), C.int(frameSize),
+		(*C.uchar)(unsafe.Pointer(&e.out[0])), C.opus_int32(len(e.out)),
+		&cpuTime)
+	e.cpuTime += time.Duration(cpuTime)
+
+	if n < 0 {
+		return nil, fmt.Errorf("unable to encode Opus: %s", C.GoString(C.opus_strerror(C.int(n))))
+	}
+
+	packet := make([]byte, n)
+	copy(packet, e.out[:n])
+	return packet, nil
+}
@@ -0,0 +1,41 @@
+//go:build !transcoding
+// +build !transcoding
+
+package transcoder
+
+import (
+	"fmt"
+	"time"
+
+	"github.com/bluenviron/mediacommon/pkg/codecs/mpeg4audio"
+)
+
+type aacDecoder struct {
+	cpuTime time.Duration
+}
+
+func newAACDecoder(_ *mpeg4audio.Config) (*aacDecoder, error) {
+	return nil, fmt.Errorf("server was compiled without support for transcoding")
+}
+
+func (d *aacDecoder) close() {
+}
+
+func (d *aacDecoder) decode(_ []byte) ([]int16, int, int, error) {
+	return nil, 0, 0, fmt.Errorf("server was compiled without support for transcoding")
+}
+
+type opusEncoder struct {
+	cpuTime time.Duration
+}
+
+func newOpusEncoder(_ int) (*opusEncoder, error) {
+	return nil, fmt.Errorf("server was compiled without support for transcoding")
+}
+
+func (e *opusEncoder) close() {
+}
+
+func (e *opusEncoder) encode(_ []int16, _ int) ([]byte, error) {
+	return nil, fmt.Errorf("server was compiled without support for transcoding")
+}
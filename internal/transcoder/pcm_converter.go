@@ -0,0 +1,106 @@
+package transcoder
+
+import (
+	"fmt"
+)
+
+// pcmConverter converts interleaved 16-bit PCM samples with any sample rate
+// into interleaved 16-bit stereo samples with a fixed sample rate,
+// and splits them into frames with a fixed size.
+type pcmConverter struct {
+	outSampleRate int
+	frameSize     int
+
+	inSampleRate int
+	initialized  bool
+
+	// position of the next output sample, relative to the last input sample
+	// of the previous call, in units of 1/outSampleRate input samples.
+	pos  int
+	prev [2]int16
+
+	fifo []int16
+}
+
+// reset discards buffered samples, and is called when the input is discontinuous.
+func (c *pcmConverter) reset() {
+	c.initialized = false
+	c.fifo = c.fifo[:0]
+}
+
+// buffered returns the number of samples per channel that are buffered.
+func (c *pcmConverter) buffered() int {
+	return len(c.fifo) / 2
+}
+
+// convert converts samples and calls onFrame for every complete frame.
+// The frame passed to onFrame is reused by next calls.
+func (c *pcmConverter) convert(
+	samples []int16,
+	sampleRate int,
+	channelCount int,
+	onFrame func([]int16) error,
+) error {
+	if channelCount != 1 && channelCount != 2 {
+		return fmt.Errorf("unsupported channel count: %d", channelCount)
+	}
+
+	n := len(samples) / channelCount
+	if n == 0 {
+		return nil
+	}
+
+	sample := func(i int) [2]int16 {
+		if i < 0 {
+			return c.prev
+		}
+		if channelCount == 1 {
+			return [2]int16{samples[i], samples[i]}
+		}
+		return [2]int16{samples[i*2], samples[i*2+1]}
+	}
+
+	if !c.initialized || sampleRate != c.inSampleRate {
+		c.initialized = true
+		c.inSampleRate = sampleRate
+		c.pos = 0
+		c.prev = sample(0)
+	}
+
+	// linear interpolation between the two input samples around each output sample.
+	for {
+		i := c.pos / c.outSampleRate
+		if i >= n {
+			break
+		}
+
+		frac := c.pos % c.outSampleRate
+		a := sample(i - 1)
+		b := sample(i)
+
+		for ch := 0; ch < 2; ch++ {
+			v := int(a[ch]) + (int(b[ch])-int(a[ch]))*frac/c.outSampleRate
+			c.fifo = append(c.fifo, int16(v))
+		}
+
+		c.pos += c.inSampleRate
+	}
+
+	c.pos -= n * c.outSampleRate
+	c.prev = sample(n - 1)
+
+	frameLen := c.frameSize * 2
+	consumed := 0
+
+	for len(c.fifo)-consumed >= frameLen {
+		err := onFrame(c.fifo[consumed : consumed+frameLen])
+		if err != nil {
+			return err
+		}
+		consumed += frameLen
+	}
+
+	c.fifo = append(c.fifo[:0], c.fifo[consumed:]...)
+
+	return nil
+}
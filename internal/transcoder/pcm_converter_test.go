@@ -0,0 +1,110 @@
+package transcoder
+
+import (
+	"testing"
+
+	"github.com/stretchr/testify/require"
+)
+
+func TestPCMConverterFrames(t *testing.T) {
+	c := pcmConverter{
+		outSampleRate: 48000,
+		frameSize:     960,
+	}
+
+	samples := make([]int16, 1024*2)
+	for i := range samples {
+		samples[i] = 1000
+	}
+
+	frames := 0
+
+	for i := 0; i < 15; i++ {
+		err := c.convert(samples, 48000, 2, func(frame []int16) error {
+			require.Equal(t, 960*2, len(frame))
+			for _, v := range frame {
+				require.Equal(t, int16(1000), v)
+			}
+			frames++
+			return nil
+		})
+		require.NoError(t, err)
+	}
+
+	require.Equal(t, 1024*15/960, frames)
+	require.Equal(t, 1024*15%960, c.buffered())
+}
+
+func TestPCMConverterResample(t *testing.T) {
+	for _, ca := range []struct {
+		name       string
+		sampleRate int
+	}{
+		{"8000", 8000},
+		{"22050", 22050},
+		{"44100", 44100},
+		{"96000", 96000},
+	} {
+		t.Run(ca.name, func(t *testing.T) {
+			c := pcmConverter{
+				outSampleRate: 48000,
+				frameSize:     960,
+			}
+
+			// one second of mono audio, split into chunks of 1024 samples.
+			total := 0
+
+			for n := 0; n < ca.sampleRate; n += 1024 {
+				l := 1024
+				if n+l > ca.sampleRate {
+					l = ca.sampleRate - n
+				}
+
+				samples := make([]int16, l)
+				for i := range samples {
+					samples[i] = int16(n + i)
+				}
+
+				err := c.convert(samples, ca.sampleRate, 1, func(frame []int16) error {
+					for i := 0; i < len(frame); i += 2 {
+						require.Equal(t, frame[i], frame[i+1])
+					}
+					total += len(frame) / 2
+					return nil
+				})
+				require.NoError(t, err)
+			}
+
+			total += c.buffered()
+			require.InDelta(t, 48000, total, 1)
+		})
+	}
+}
+
+func TestPCMConverterInterpolation(t *testing.T) {
+	c := pcmConverter{
+		outSampleRate: 4,
+		frameSize:     6,
+	}
+
+	var out []int16
+
+	err := c.convert([]int16{0, 0, 8, 8, 16, 16}, 2, 2, func(frame []int16) error {
+		out = append(out, frame...)
+		return nil
+	})
+	require.NoError(t, err)
+	require.Equal(t, []int16{0, 0, 0, 0, 0, 0, 4, 4, 8, 8, 12, 12}, out)
+}
+
+func TestPCMConverterUnsupportedChannels(t *testing.T) {
+	c := pcmConverter{
+		outSampleRate: 48000,
+		frameSize:     960,
+	}
+
+	err := c.convert(make([]int16, 6), 48000, 6, func(_ []int16) error {
+		return nil
+	})
+	require.EqualError(t, err, "unsupported channel count: 6")
+}
@@ -1,4 +1,9 @@
 bench:
+ifeq ($(NAME),)
+	go generate ./...
+	go run ./bench/loadgen $(ARGS)
+else
 	docker build -q . -f bench/$(NAME)/Dockerfile -t temp \
 	--build-arg BASE_IMAGE=$(BASE_IMAGE)
 	docker run --rm -it -p 9999:9999 temp
+endif
@@ -3,14 +3,14 @@ BINARY_NAME = mediamtx
 define DOCKERFILE_BINARIES
 FROM $(RPI32_IMAGE) AS rpicamera32
 RUN ["cross-build-start"]
-RUN apt update && apt install -y --no-install-recommends g++ pkg-config make libcamera-dev libfreetype-dev xxd
+RUN apt update && apt install -y --no-install-recommends g++ pkg-config make libcamera-dev libfreetype-dev libpng-dev xxd
 WORKDIR /s/internal/protocols/rpicamera/exe
 COPY internal/protocols/rpicamera/exe .
 RUN make -j$$(nproc)
 
 FROM $(RPI64_IMAGE) AS rpicamera64
 RUN ["cross-build-start"]
-RUN apt update && apt install -y --no-install-recommends g++ pkg-config make libcamera-dev libfreetype-dev xxd
+RUN apt update && apt install -y --no-install-recommends g++ pkg-config make libcamera-dev libfreetype-dev libpng-dev xxd
 WORKDIR /s/internal/protocols/rpicamera/exe
 COPY internal/protocols/rpicamera/exe .
 RUN make -j$$(nproc)